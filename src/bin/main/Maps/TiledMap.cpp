@@ -2,7 +2,9 @@
 
 #include <fstream>
 
+#include "game_engine/core/FileSystem.hpp"
 #include "game_engine/graphics/GraphicsObject.hpp"
+#include "game_engine/graphics/MapBundle.hpp"
 #include "game_engine/utility/BasicFunctions.hpp"
 
 namespace ge = game_engine;
@@ -13,7 +15,23 @@ TiledMap::TiledMap() {
 
 int TiledMap::Init(std::string map_name) {
 
-    /* Initialize the static map objects, as generated by the prepare_map_files executable */
+    /* Create the static map objects, and their positions, straight from the binary bundle if there is one */
+    {
+        ge::graphics::MapBundle bundle;
+        if (bundle.Init(ge::FileSystem::GetInstance().GetDirectoryAssets() + map_name + ".mapbundle") == 0) {
+            game_engine::graphics::GraphicsObject::InitObjectAtlas(bundle, map_name + ".obj");
+
+            for (size_t i = 0; i < bundle.GetNumberOfRegions(); i++) {
+                const float * position = bundle.GetRegion(i).position_;
+                packed_tiles_.push_back(std::make_pair(ge::math::Vector3D(position[0], position[1], position[2]), map_name + "_" + std::to_string(i)));
+            }
+
+            bundle.Destroy();
+            return 0;
+        }
+    }
+
+    /* Else initialize the static map objects, as generated by the prepare_map_files executable */
     {
         game_engine::graphics::GraphicsObject::InitObjectAtlas(map_name + ".obj");
     }
@@ -0,0 +1,163 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <string>
+
+#include "game_engine/math/Vector.hpp"
+#include "game_engine/math/AABox.hpp"
+#include "game_engine/utility/QuadTree.hpp"
+
+#include "debug_tools/Console.hpp"
+#include "debug_tools/Timer.hpp"
+
+namespace dt = debug_tools;
+namespace ge = game_engine;
+namespace math = game_engine::math;
+namespace utl = game_engine::utility;
+
+/*
+    Compare the vector storage modes. This executable is built twice, math_benchmark uses the inline 
+    storage, and math_benchmark_heap the old std::vector storage. Run both and compare the timings
+*/
+
+#define WORLD_SIZE 1000.0f
+#define NUMBER_OF_OBJECTS 20000
+#define FRAMES 20
+
+#ifdef GAME_ENGINE_MATH_VECTOR_HEAP_STORAGE
+static const std::string storage_mode("heap");
+#elif defined(GAME_ENGINE_MATH_SIMD)
+static const std::string storage_mode("inline, SIMD");
+#else
+static const std::string storage_mode("inline");
+#endif
+
+/* A moving object, with a bounding box of size 1x1 around its position */
+struct Object {
+    math::Vector2D position_;
+    math::Vector2D velocity_;
+};
+
+void CreateObjects(std::vector<Object>& objects) {
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<ge::Real_t> position(1.0f, WORLD_SIZE - 1.0f);
+    std::uniform_real_distribution<ge::Real_t> velocity(-0.5f, 0.5f);
+
+    objects.resize(NUMBER_OF_OBJECTS);
+    for (size_t i = 0; i < objects.size(); i++) {
+        objects[i].position_ = math::Vector2D(position(generator), position(generator));
+        objects[i].velocity_ = math::Vector2D(velocity(generator), velocity(generator));
+    }
+}
+
+/**
+    Query a small area around every object, the same search done by PhysicsEngine::CheckCollision
+    @param tree The tree holding the objects
+    @param objects The objects
+    @return The total number of neighbours found
+*/
+size_t QueryWorkload(utl::QuadTree<size_t>& tree, std::vector<Object>& objects) {
+    size_t found = 0;
+    std::vector<size_t> neighbours;
+    for (size_t i = 0; i < objects.size(); i++) {
+        neighbours.clear();
+        math::Vector2D& position = objects[i].position_;
+        tree.QueryRange(math::AABox<2>(position - 1.5, position + 1.5), neighbours);
+        found += neighbours.size();
+    }
+    return found;
+}
+
+/**
+    Move every object and check it against its neighbours, separately in the horizontal and vertical directions
+    @param tree The tree holding the objects
+    @param objects The objects
+    @return The number of blocked movements
+*/
+size_t CollisionWorkload(utl::QuadTree<size_t>& tree, std::vector<Object>& objects) {
+    size_t blocked = 0;
+    std::vector<size_t> neighbours;
+    for (size_t i = 0; i < objects.size(); i++) {
+        Object& object = objects[i];
+
+        neighbours.clear();
+        tree.QueryRange(math::AABox<2>(object.position_ - 1.5, object.position_ + 1.5), neighbours);
+
+        math::Vector2D new_position = object.position_ + object.velocity_;
+        math::Vector2D offset = new_position - object.position_;
+
+        math::AABox<2> box_horizontal(math::Vector2D(new_position.x(), object.position_.y()), { 1.0f, 1.0f });
+        math::AABox<2> box_vertical(math::Vector2D(object.position_.x(), new_position.y()), { 1.0f, 1.0f });
+        for (size_t n = 0; n < neighbours.size(); n++) {
+            if (neighbours[n] == i) continue;
+
+            math::AABox<2> neighbour_box(objects[neighbours[n]].position_, { 1.0f, 1.0f });
+            if (box_horizontal.Overlaps(neighbour_box)) offset[0] = 0;
+            if (box_vertical.Overlaps(neighbour_box)) offset[1] = 0;
+        }
+
+        if (math::Vector2D::Distance(object.position_, object.position_ + offset) < 0.001f) blocked++;
+    }
+    return blocked;
+}
+
+/**
+    Plain vector arithmetic
+    @param objects The objects
+    @return The sum of the norms, to keep the compiler from removing the loop
+*/
+ge::Real_t ArithmeticWorkload(std::vector<Object>& objects) {
+    ge::Real_t sum = 0;
+    for (size_t i = 0; i < objects.size(); i++) {
+        math::Vector2D& a = objects[i].position_;
+        math::Vector2D& b = objects[(i + 1) % objects.size()].position_;
+        math::Vector2D c = (a - b) * 0.5f + objects[i].velocity_;
+        sum += c.Norm() + a.DotProduct(b) * 0.0001f + math::Vector2D::Distance(a, b);
+    }
+    return sum;
+}
+
+int main(int argc, char ** argv) {
+
+    dt::Console("Vector storage: " + storage_mode + ", sizeof(Vector2D): " + std::to_string(sizeof(math::Vector2D)) + 
+        ", sizeof(AABox<2>): " + std::to_string(sizeof(math::AABox<2>)));
+
+    std::vector<Object> objects;
+    CreateObjects(objects);
+
+    utl::QuadTree<size_t> tree(math::Vector2D(0, 0), WORLD_SIZE);
+    {
+        dt::Timer timer;
+        for (size_t i = 0; i < objects.size(); i++) {
+            tree.Insert(objects[i].position_, i);
+        }
+        timer.Stop();
+        dt::Console("QuadTree insert " + std::to_string(objects.size()) + " objects: " + timer.ToString());
+    }
+
+    {
+        size_t found = 0;
+        dt::Timer timer;
+        for (size_t f = 0; f < FRAMES; f++) found += QueryWorkload(tree, objects);
+        timer.Stop();
+        dt::Console("QuadTree query, " + std::to_string(FRAMES) + " frames: " + timer.ToString() + ", found: " + std::to_string(found));
+    }
+
+    {
+        size_t blocked = 0;
+        dt::Timer timer;
+        for (size_t f = 0; f < FRAMES; f++) blocked += CollisionWorkload(tree, objects);
+        timer.Stop();
+        dt::Console("Collision, " + std::to_string(FRAMES) + " frames: " + timer.ToString() + ", blocked: " + std::to_string(blocked));
+    }
+
+    {
+        ge::Real_t sum = 0;
+        dt::Timer timer;
+        for (size_t f = 0; f < 50 * FRAMES; f++) sum += ArithmeticWorkload(objects);
+        timer.Stop();
+        dt::Console("Arithmetic, " + std::to_string(50 * FRAMES) + " frames: " + timer.ToString() + ", sum: " + std::to_string(sum));
+    }
+
+    return 0;
+}
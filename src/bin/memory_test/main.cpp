@@ -1,15 +1,23 @@
 #include <iostream>
 #include <vector>
+#include <thread>
+#include <mutex>
+#include <random>
+#include <string>
 
 #include "debug_tools/Console.hpp"
+#include "debug_tools/Timer.hpp"
 
 #include "game_engine/memory/MemoryPage.hpp"
 #include "game_engine/memory/ArrayAllocator.hpp"
 #include "game_engine/memory/PoolAllocator.hpp"
+#include "game_engine/memory/ConcurrentPoolAllocator.hpp"
+#include "game_engine/memory/ExpandablePoolAllocator.hpp"
+#include "game_engine/memory/FrameAllocator.hpp"
 
 
 namespace dt = debug_tools;
-namespace ms = game_engine::memory_subsystem;
+namespace ms = game_engine::memory;
 
 class DummyClass {
 private:
@@ -291,6 +299,182 @@ void CheckPoolAllocator() {
 
 }
 
+void CheckExpandablePoolAllocator() {
+    ms::ExpandablePoolAllocator mpool;
+    mpool.Init(40, 100, 1);
+
+    dt::Console("Checking pool growth");
+    std::vector<ms::BYTE *> blocks;
+    for (size_t i = 0; i < 1000; i++) blocks.push_back(mpool.Allocate());
+    dt::Console("Pools: " + std::to_string(mpool.GetNumberOfPools()) + ", memory allocated: " + std::to_string(mpool.GetBytesAllocated()) + 
+        " Bytes, memory used: " + std::to_string(mpool.GetBytesUsed()) + " Bytes");
+    if (mpool.GetBytesUsed() != 1000 * 40) dt::Console(dt::CRITICAL, "FAILED, wrong memory used");
+
+    dt::Console("Checking pool release, one empty pool should be kept");
+    for (size_t i = 0; i < blocks.size(); i++) mpool.Deallocate(blocks[i]);
+    dt::Console("Pools: " + std::to_string(mpool.GetNumberOfPools()) + ", memory allocated: " + std::to_string(mpool.GetBytesAllocated()) + 
+        " Bytes, memory used: " + std::to_string(mpool.GetBytesUsed()) + " Bytes");
+    if (mpool.GetNumberOfPools() != 1 || mpool.GetBytesUsed() != 0) dt::Console(dt::CRITICAL, "FAILED, wrong number of pools");
+
+    dt::Console("Checking deallocation of an address from a freed pool, should fail");
+    if (mpool.Deallocate(blocks.back())) dt::Console(dt::CRITICAL, "FAILED, address from a freed pool deallocated");
+
+    dt::Console("Checking deallocation of an address from the heap, should fail");
+    int * heap_address = new int(0);
+    if (mpool.Deallocate(heap_address)) dt::Console(dt::CRITICAL, "FAILED, heap address deallocated");
+    delete heap_address;
+
+    dt::Console("Checking deallocation of an address from another allocator, should fail");
+    ms::ExpandablePoolAllocator other;
+    other.Init(40);
+    ms::BYTE * address = other.Allocate();
+    if (mpool.Deallocate(address)) dt::Console(dt::CRITICAL, "FAILED, foreign address deallocated");
+    other.Deallocate(address);
+}
+
+void CheckFrameAllocator() {
+    dt::Console("Checking heap allocations per frame, should be zero after the first frame, counted with GAME_ENGINE_MEMORY_HEAP_COUNTER");
+    for (size_t frame = 0; frame < 5; frame++) {
+        size_t heap_allocations = ms::FrameAllocator::GetHeapAllocations();
+
+        /* Temporary vectors, grown without reserving, and from another thread */
+        size_t sum = 0;
+        ms::FrameVector<size_t> numbers;
+        for (size_t i = 0; i < 2000; i++) numbers.push_back(i);
+        for (size_t i = 0; i < numbers.size(); i++) sum += numbers[i];
+        ms::FrameVector<double> aligned(100, 1.0);
+        if (reinterpret_cast<uintptr_t>(aligned.data()) % alignof(double) != 0) dt::Console(dt::CRITICAL, "FAILED, unaligned memory");
+
+        heap_allocations = ms::FrameAllocator::GetHeapAllocations() - heap_allocations;
+        dt::Console("Frame: " + std::to_string(frame) + ", sum: " + std::to_string(sum) + ", frame memory used: " + 
+            std::to_string(ms::FrameAllocator::GetThreadInstance().GetBytesUsed()) + " Bytes, heap allocations: " + std::to_string(heap_allocations));
+
+        ms::FrameAllocator::ResetAll();
+    }
+
+    dt::Console("Checking allocation larger than a page");
+    ms::BYTE * large = ms::FrameAllocator::GetThreadInstance().Allocate(4 * FRAME_ALLOCATOR_PAGE_SIZE, 256);
+    if (reinterpret_cast<uintptr_t>(large) % 256 != 0) dt::Console(dt::CRITICAL, "FAILED, unaligned large allocation");
+    memset(large, 1, 4 * FRAME_ALLOCATOR_PAGE_SIZE);
+    ms::FrameAllocator::ResetAll();
+    if (ms::FrameAllocator::GetThreadInstance().GetBytesUsed() != 0) dt::Console(dt::CRITICAL, "FAILED, frame memory not reset");
+}
+
+#define STRESS_THREADS 8
+#define STRESS_ITERATIONS 200000
+#define STRESS_BLOCKS_PER_THREAD 256
+#define STRESS_BLOCK_SIZE 64
+
+/**
+    Every thread allocates and frees blocks in a random order, writes a pattern in every block it holds and checks it
+    before freeing it. A quarter of the blocks are freed by the next thread, instead of the one that allocated them
+    @param allocate Function to allocate a block
+    @param deallocate Function to free a block
+    @return The number of corrupted blocks
+*/
+template<typename Allocate, typename Deallocate> size_t StressAllocator(Allocate allocate, Deallocate deallocate) {
+    std::atomic<size_t> corrupted(0);
+    std::mutex handoff_lock;
+    std::vector<std::vector<ms::BYTE *>> handoff(STRESS_THREADS);
+
+    auto thread_function = [&](size_t thread) {
+        std::mt19937 generator(static_cast<unsigned int>(thread));
+        std::vector<ms::BYTE *> blocks;
+        ms::BYTE pattern = static_cast<ms::BYTE>(thread + 1);
+
+        for (size_t i = 0; i < STRESS_ITERATIONS; i++) {
+            if (blocks.empty() || (blocks.size() < STRESS_BLOCKS_PER_THREAD && generator() % 2)) {
+                ms::BYTE * block = allocate();
+                if (block == nullptr) continue;
+                if (block[0] != 0 || block[STRESS_BLOCK_SIZE - 1] != 0) corrupted++;
+                memset(block, pattern, STRESS_BLOCK_SIZE);
+                blocks.push_back(block);
+            } else {
+                size_t index = generator() % blocks.size();
+                ms::BYTE * block = blocks[index];
+                blocks[index] = blocks.back();
+                blocks.pop_back();
+                if (block[0] != pattern || block[STRESS_BLOCK_SIZE - 1] != pattern) corrupted++;
+
+                bool handed_off = false;
+                if (generator() % 4 == 0) {
+                    /* The next thread might have finished, and stopped freeing its handoff blocks */
+                    std::unique_lock<std::mutex> l(handoff_lock);
+                    std::vector<ms::BYTE *>& next = handoff[(thread + 1) % STRESS_THREADS];
+                    if (next.size() < STRESS_BLOCKS_PER_THREAD) {
+                        next.push_back(block);
+                        handed_off = true;
+                    }
+                }
+                if (!handed_off) deallocate(block);
+            }
+
+            /* Free the blocks given by the previous thread */
+            if (i % 1024 == 0) {
+                std::vector<ms::BYTE *> others;
+                {
+                    std::unique_lock<std::mutex> l(handoff_lock);
+                    others.swap(handoff[thread]);
+                }
+                for (size_t b = 0; b < others.size(); b++) deallocate(others[b]);
+            }
+        }
+
+        for (size_t b = 0; b < blocks.size(); b++) deallocate(blocks[b]);
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < STRESS_THREADS; t++) threads.push_back(std::thread(thread_function, t));
+    for (size_t t = 0; t < STRESS_THREADS; t++) threads[t].join();
+
+    for (size_t t = 0; t < STRESS_THREADS; t++) {
+        for (size_t b = 0; b < handoff[t].size(); b++) deallocate(handoff[t][b]);
+    }
+
+    return corrupted;
+}
+
+void CheckConcurrentPoolAllocator() {
+    /* Room for the blocks held by the threads, the blocks waiting to be freed by the next thread, and the caches */
+    size_t number_of_blocks = 4 * STRESS_THREADS * STRESS_BLOCKS_PER_THREAD;
+
+    {
+        dt::Console("Stress test, PoolAllocator with a mutex");
+        ms::PoolAllocator mpool;
+        mpool.Init(STRESS_BLOCK_SIZE, number_of_blocks);
+        std::mutex lock;
+
+        dt::Timer timer;
+        size_t corrupted = StressAllocator(
+            [&]() { std::unique_lock<std::mutex> l(lock); return mpool.Allocate(); },
+            [&](ms::BYTE * block) { std::unique_lock<std::mutex> l(lock); mpool.Deallocate(block); });
+        timer.Stop();
+
+        dt::Console("Threads: " + std::to_string(STRESS_THREADS) + ", time: " + timer.ToString() + " ms, corrupted blocks: " + std::to_string(corrupted) + 
+            ", memory used after: " + std::to_string(mpool.GetBytesUsed()) + " Bytes");
+    }
+
+    {
+        dt::Console("Stress test, ConcurrentPoolAllocator");
+        ms::ConcurrentPoolAllocator mpool;
+        mpool.Init(STRESS_BLOCK_SIZE, number_of_blocks);
+
+        dt::Timer timer;
+        size_t corrupted = StressAllocator(
+            [&]() { return mpool.Allocate(); },
+            [&](ms::BYTE * block) { mpool.Deallocate(block); });
+        timer.Stop();
+
+        dt::Console("Threads: " + std::to_string(STRESS_THREADS) + ", time: " + timer.ToString() + " ms, corrupted blocks: " + std::to_string(corrupted) + 
+            ", memory used after: " + std::to_string(mpool.GetBytesUsed()) + " Bytes");
+
+        dt::Console("Allocating every block, one out of free nodes message is expected");
+        size_t blocks = 0;
+        while (mpool.Allocate() != nullptr) blocks++;
+        if (blocks != number_of_blocks) dt::Console(dt::CRITICAL, "FAILED, blocks lost: " + std::to_string(number_of_blocks - blocks));
+    }
+}
+
 int main(int argc, char ** argv) {
 
     dt::Console(dt::INFO, "Checking Memory page...", dt::DARK_CYAN);
@@ -299,6 +483,12 @@ int main(int argc, char ** argv) {
     CheckArrayAllocator();
     dt::Console(dt::INFO, "Checking Pool allocator...", dt::DARK_CYAN);
     CheckPoolAllocator();
+    dt::Console(dt::INFO, "Checking Expandable pool allocator...", dt::DARK_CYAN);
+    CheckExpandablePoolAllocator();
+    dt::Console(dt::INFO, "Checking Frame allocator...", dt::DARK_CYAN);
+    CheckFrameAllocator();
+    dt::Console(dt::INFO, "Checking Concurrent pool allocator...", dt::DARK_CYAN);
+    CheckConcurrentPoolAllocator();
     
 #ifdef _WIN32
     system("pause");
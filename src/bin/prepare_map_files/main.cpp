@@ -2,21 +2,36 @@
 #include <fstream>
 #include <vector>
 #include <string>
-#include <unordered_map>    
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <unordered_map>
 
-#include "game_engine/math/Vector.hpp"
-#include "game_engine/utility/BasicFunctions.hpp"
+#include <glm/glm.hpp>
+
+#include "game_engine/core/MappedFile.hpp"
+#include "game_engine/utility/JobSystem.hpp"
+#include "game_engine/graphics/MapBundle.hpp"
+
+#include "debug_tools/Console.hpp"
+#include "debug_tools/Timer.hpp"
 
-using namespace game_engine::math;
 using namespace game_engine;
 
-/** 
+namespace dt = debug_tools;
+
+/* The number of regions packed in parallel, before they are written and their buffers reused */
+#define PACKED_MAP_REGIONS_PER_BATCH 256
+
+/**
     Holds a unique tile in the map
 */
 struct Tile {
-    std::vector<Vector3D> vertices_;
-    std::vector<Vector2D> uv_;
-    std::vector<Vector3D> triangles_;
+    glm::vec3 vertices_[4];
+    glm::vec2 uv_[4];
+    /* Two triangles, indices in the vertices */
+    unsigned int triangles_[6];
 };
 
 /**
@@ -44,140 +59,206 @@ void ExportObjFile(std::ofstream& obj_file, std::string file_name, size_t index,
     Function used to create a unique Tile
 */
 Tile CreateTile(float u1, float v1, float u2, float v2, float u3, float v3, float u4, float v4) {
-    
+
     Tile temp;
-    temp.vertices_.push_back(Vector3D(-0.5, -0.5, 0));
-    temp.vertices_.push_back(Vector3D( 0.5, -0.5, 0));
-    temp.vertices_.push_back(Vector3D(-0.5,  0.5, 0));
-    temp.vertices_.push_back(Vector3D( 0.5,  0.5, 0));
-    temp.uv_.push_back(Vector2D(u3, v3));
-    temp.uv_.push_back(Vector2D(u1, v1));
-    temp.uv_.push_back(Vector2D(u2, v2));
-    temp.uv_.push_back(Vector2D(u4, v4));
-    temp.triangles_.push_back(Vector3D(1, 2, 3));
-    temp.triangles_.push_back(Vector3D(2, 4, 3));
+    temp.vertices_[0] = glm::vec3(-0.5, -0.5, 0);
+    temp.vertices_[1] = glm::vec3( 0.5, -0.5, 0);
+    temp.vertices_[2] = glm::vec3(-0.5,  0.5, 0);
+    temp.vertices_[3] = glm::vec3( 0.5,  0.5, 0);
+    temp.uv_[0] = glm::vec2(u3, v3);
+    temp.uv_[1] = glm::vec2(u1, v1);
+    temp.uv_[2] = glm::vec2(u2, v2);
+    temp.uv_[3] = glm::vec2(u4, v4);
+    const unsigned int triangles[6] = { 0, 1, 2, 1, 3, 2 };
+    std::memcpy(temp.triangles_, triangles, sizeof(triangles));
     return temp;
 }
 
-/* Hold the map width and height */
-static int MAP_HEIGHT;
-static int MAP_WIDTH;
-
 void GetXYFromTiled(int i, int j, float&x, float&y) {
     x = j;
     y = -i;
 }
 
-/* Used for hashing the packed map structure */
-struct pair_hash {
-    template <class T1, class T2>
-    std::size_t operator () (const std::pair<T1, T2> &p) const {
-        auto h1 = std::hash<T1>{}(p.first);
-        auto h2 = std::hash<T2>{}(p.second);
+/**
+    A layer of a map, the tile id of every cell in row order, -1 for an empty cell
+*/
+struct MapLayer {
+    std::vector<int> cells_;
+    int width_ = 0;
+    int height_ = 0;
+    /* The height of the tiles of the layer */
+    float z_ = 0;
+};
 
-        return h1 * MAP_HEIGHT + h2;
+/**
+    Read a .csv layer exported by Tiled. The file is mapped in memory, and the numbers are parsed in place, without
+    copying the lines or the cells into strings. Rows are padded with empty cells to the width of the first row
+    @param file_name The .csv file
+    @param[out] layer The layer
+    @return 0=OK, -1=Can't open the file
+*/
+int ReadMapLayer(std::string file_name, MapLayer& layer) {
+    layer.cells_.clear();
+    layer.width_ = 0;
+    layer.height_ = 0;
+
+    MappedFile file;
+    if (file.Init(file_name)) {
+        dt::Console(dt::WARNING, "Can't open map file: " + file_name);
+        return -1;
     }
-};
+
+    const char * c = file.GetData();
+    const char * end = c + file.GetSize();
+    while (c < end) {
+        size_t row_start = layer.cells_.size();
+        while (c < end && *c != '\n') {
+            /* A cell, up to the next comma or the end of the line. Empty cells are skipped */
+            const char * token = c;
+            while (c < end && *c != ',' && *c != '\n') c++;
+            const char * token_end = c;
+            if (c < end && *c == ',') c++;
+
+            while (token < token_end && (*token == ' ' || *token == '\r')) token++;
+            while (token_end > token && (token_end[-1] == ' ' || token_end[-1] == '\r')) token_end--;
+            if (token == token_end) continue;
+
+            bool negative = *token == '-';
+            if (negative) token++;
+            int id = 0;
+            const char * digits = token;
+            while (token < token_end && *token >= '0' && *token <= '9') id = 10 * id + (*token++ - '0');
+            if (token != token_end || digits == token) id = -1;
+            layer.cells_.push_back(negative ? -id : id);
+        }
+        if (c < end) c++;
+
+        size_t row_cells = layer.cells_.size() - row_start;
+        if (row_cells == 0) continue;
+        if (layer.height_ == 0) layer.width_ = static_cast<int>(row_cells);
+        layer.cells_.resize(row_start + layer.width_, -1);
+        layer.height_++;
+    }
+
+    return 0;
+}
+
 class PackedMap {
 public:
-    PackedMap(std::string map_name) {
+    /**
+        Read the layers of a map
+        @param map_name The name of the map, the layers are map_name + "_Tile Layer N.csv"
+        @param region_size The width and the height of a packed region, in tiles
+    */
+    PackedMap(std::string map_name, int region_size) {
         map_name_ = map_name;
+        region_size_ = region_size;
+        region_size2_ = region_size / 2;
+        number_of_packed_tiles_ = 0;
 
         /* Read map layers, init map structures */
-        {
-            std::string name = map_name_ + "_Tile Layer 1.csv";
-            std::string line;
-            std::ifstream myfile(name);
-            if (myfile.is_open()) {
-                while (getline(myfile, line)) {
-                    map_1_.push_back(utility::split(line, ","));
-                }
-                myfile.close();
-            } else {
-                dt::Console(dt::WARNING, "Can't open map file: " + name);
-            }
+        const float layer_z[2] = { 0.0f, 0.03f };
+        for (int l = 0; l < 2; l++) {
+            MapLayer layer;
+            ReadMapLayer(map_name_ + "_Tile Layer " + std::to_string(l + 1) + ".csv", layer);
+            layer.z_ = layer_z[l];
+            layers_.push_back(std::move(layer));
         }
 
-        {
-            std::string name = map_name_ + "_Tile Layer 2.csv";
-            std::string line;
-            std::ifstream myfile(name);
-            if (myfile.is_open()) {
-                while (getline(myfile, line)) {
-                    map_2_.push_back(utility::split(line, ","));
-                }
-                myfile.close();
-            } else {
-                dt::Console(dt::WARNING, "Can't open map file: " + name);
-            }
-        }
-
-        MAP_HEIGHT  = map_1_.size();
-        MAP_WIDTH = map_1_[0].size();
+        map_height_ = layers_[0].height_;
+        map_width_ = layers_[0].width_;
+    }
 
-        map_width_2 = ((float)MAP_HEIGHT) / 2.0f;
-        map_height_2 = ((float)MAP_WIDTH) / 2.0f;
+    /* Get the number of cells in all the layers */
+    size_t GetNumberOfCells() {
+        size_t cells = 0;
+        for (size_t l = 0; l < layers_.size(); l++) cells += layers_[l].cells_.size();
+        return cells;
     }
 
-    /* Pack all the objects in the world map inside a region, into a single object, given a position and a width and a height, that represents a region in the world
-    
-    */
-    void PackMapLayer(std::unordered_map<int, Tile>& tiles, int pos_i, size_t i_width2, int pos_j, size_t j_height2) {
-        int tile_index = 0;
-        /* Read map layers */
-        tile_index = PackMapLayer(map_1_, 0.0f, tiles, tile_index, pos_i, i_width2, pos_j, j_height2);
-        tile_index = PackMapLayer(map_2_, 0.03f, tiles, tile_index, pos_i, i_width2, pos_j, j_height2);
+    /* Get the number of tiles written by the last ExportMapFiles() */
+    size_t GetNumberOfPackedTiles() {
+        return number_of_packed_tiles_;
     }
 
-    void ExportMapFiles() {
+    /**
+        Pack the tiles of the map into regions, and write them as a .obj, a _packed_map_tiles.txt and a .mapbundle.
+        The tiles of every region are counted first, so that the offsets of the regions in the files are known.
+        Then the regions are packed in parallel, a batch at a time, each into its own buffers, and the batch is
+        written before the next one is packed
+        @param tiles The unique tiles, indexed by the id of the tile in the map
+        @param job_system The threads to pack the regions on
+    */
+    void ExportMapFiles(const std::vector<Tile>& tiles, utility::JobSystem& job_system) {
         /* Prepare a small file to hold the correspondence between packed tile regions and positions in the world */
         dt::Console("Preparing the packed map files... ");
         std::ofstream packed_map_tiles_file;
         packed_map_tiles_file.open(map_name_ + "_packed_map_tiles.txt");
         /* Create a single .obj file to hold all tile regions */
         std::ofstream map_obj_file;
-        map_obj_file.open(map_name_ + ".obj");
+        map_obj_file.open(map_name_ + ".obj", std::ios::binary);
         map_obj_file << "mtllib materials/" + map_name_ + ".mtl\n";
+        /* The same regions, in the same order, go in the binary map bundle */
+        graphics::MapBundleWriter bundle;
+        if (bundle.Init(map_name_ + ".mapbundle", "textures/roguelikeSheet_transparent.png", "textures/spec_map_empty.png")) {
+            dt::Console(dt::WARNING, "Can't write map bundle: " + map_name_ + ".mapbundle");
+        }
 
-        int vertex_index = 0;
-        int uv_index = 0;
-        int map_index = 0;
-        for (auto itr = packed_map_.begin(); itr != packed_map_.end(); ++itr) {
-            TileRegion& region = itr->second;
-
-            if (region.vertices_.size() == 0) continue;
-            /* 
-                Write the data for a single packed region, naming static_map.NUMBER
-            */
-            map_obj_file << "o " + map_name_ + "." + std::to_string(map_index) +"\n";
-            
-            /* Write geometry */
-            for (size_t i = 0; i < region.vertices_.size(); i++) {
-                map_obj_file << "v " << region.vertices_[i].x() << " " << region.vertices_[i].y() << " " << region.vertices_[i].z() << "\n";
-            }
-            
-            for (size_t i = 0; i < region.uv_.size(); i++) {
-                map_obj_file << "vt " << region.uv_[i].x() << " " << region.uv_[i].y() << "\n";
-            }
-            
-            map_obj_file << "vn 0.0000 0.0000 1.0000\n";
-            map_obj_file << "usemtl " + map_name_ + "_mtl\n";
-            map_obj_file << "s off\n";
-            
-            /* Write triangles, reflect the fact that everything is written in a singile file, thus, vertex_index, uv_index */
-            for (size_t i = 0; i < region.triangles_.size(); i++) {
-                // v/vt/vn
-                map_obj_file << "f " << region.triangles_[i].x() + vertex_index  << "/" << region.triangles_[i].x() + uv_index << "/1 " 
-                    << region.triangles_[i].y() + vertex_index << "/" << region.triangles_[i].y() + uv_index << "/1 " 
-                    << region.triangles_[i].z() + vertex_index << "/" << region.triangles_[i].z() + uv_index << "/1\n";
+        /* The centers of the regions, in row order */
+        std::vector<Region> regions;
+        for (int i = region_size2_; i < map_height_; i += region_size_) {
+            for (int j = region_size2_; j < map_width_; j += region_size_) {
+                Region region;
+                region.pos_i_ = i;
+                region.pos_j_ = j;
+                regions.push_back(region);
             }
+        }
 
-            vertex_index += region.vertices_.size();
-            uv_index += region.uv_.size();
-
-            /* Write the correspondence in the map .txt */
-            packed_map_tiles_file << itr->first.first << " " << itr->first.second << " " + map_name_ + "_" + std::to_string(map_index) + "\n";
+        /* Count the tiles of the regions, then number the regions that are not empty, and find their first vertex in the .obj */
+        job_system.ParallelFor(regions.size(), 16, [&](size_t, size_t start, size_t end) {
+            for (size_t r = start; r < end; r++) regions[r].number_of_tiles_ = CountRegionTiles(regions[r], tiles);
+        });
+        size_t map_index = 0;
+        size_t vertex_index = 0;
+        for (size_t r = 0; r < regions.size(); r++) {
+            regions[r].map_index_ = map_index;
+            regions[r].vertex_index_ = vertex_index;
+            if (regions[r].number_of_tiles_ == 0) continue;
             map_index++;
+            vertex_index += 4 * regions[r].number_of_tiles_;
+        }
+
+        std::vector<RegionBuffer> buffers(PACKED_MAP_REGIONS_PER_BATCH);
+        for (size_t batch_start = 0; batch_start < regions.size(); batch_start += PACKED_MAP_REGIONS_PER_BATCH) {
+            size_t batch_size = std::min(regions.size() - batch_start, static_cast<size_t>(PACKED_MAP_REGIONS_PER_BATCH));
+
+            job_system.ParallelFor(batch_size, 1, [&](size_t, size_t start, size_t end) {
+                for (size_t r = start; r < end; r++) {
+                    const Region& region = regions[batch_start + r];
+                    if (region.number_of_tiles_ > 0) PackRegion(region, tiles, buffers[r]);
+                }
+            });
+
+            for (size_t r = 0; r < batch_size; r++) {
+                const Region& region = regions[batch_start + r];
+                if (region.number_of_tiles_ == 0) continue;
+                RegionBuffer& buffer = buffers[r];
+
+                float center_x, center_y;
+                GetXYFromTiled(region.pos_i_, region.pos_j_, center_x, center_y);
+
+                map_obj_file.write(buffer.obj_.data(), buffer.obj_.size());
+                bundle.AddRegion(glm::vec3(center_x, center_y, 0.0f), buffer.vertices_.data(), buffer.vertices_.size(), buffer.indices_.data(), buffer.indices_.size());
+
+                /* Write the correspondence in the map .txt */
+                packed_map_tiles_file << static_cast<int>(center_x) << " " << static_cast<int>(center_y) << " " + map_name_ + "_" + std::to_string(region.map_index_) + "\n";
+            }
+        }
+        number_of_packed_tiles_ = vertex_index / 4;
+
+        if (bundle.IsInited() && bundle.Destroy()) {
+            dt::Console(dt::WARNING, "Can't write map bundle: " + map_name_ + ".mapbundle");
         }
 
         /* Write the material file for the map object */
@@ -198,67 +279,166 @@ public:
     }
 
 private:
+    /* A packed region of the world, around a center cell */
+    struct Region {
+        int pos_i_;
+        int pos_j_;
+        size_t number_of_tiles_;
+        /* The index in the name of the region, and the index of its first vertex in the .obj */
+        size_t map_index_;
+        size_t vertex_index_;
+    };
+
+    /* The packed data of a region, reused by the regions of the next batch */
+    struct RegionBuffer {
+        std::vector<graphics::Vertex_t> vertices_;
+        std::vector<unsigned int> indices_;
+        /* The text of the region in the .obj */
+        std::string obj_;
+        /* The text of the numbers written, the tiles of a region repeat the same few coordinates */
+        std::unordered_map<uint32_t, std::string> real_text_;
+    };
+
     std::string map_name_;
     /* holds the .csv map layers */
-    std::vector<std::vector<std::string>> map_1_;
-    std::vector<std::vector<std::string>> map_2_;
-    float map_width_2;
-    float map_height_2;
-
-    typedef Tile TileRegion;
-    /* Holds the packed region tiles */
-    std::unordered_map<std::pair<int, int>, TileRegion, pair_hash> packed_map_;
+    std::vector<MapLayer> layers_;
+    int map_width_;
+    int map_height_;
+    int region_size_;
+    int region_size2_;
+    size_t number_of_packed_tiles_;
 
     /**
-        Reads a map file, and generates tiles for every tile in the map. Adds the vertices, uvs, and triangles into data structures, to be exported to a single .obj
+        Call a function for every tile of a region, in the order they are packed, layers first, then rows
+        @param region The region
+        @param tiles The unique tiles
+        @param func Called as func(layer, i, j, id), with i, j relative to the center of the region
     */
-    int PackMapLayer(std::vector<std::vector<std::string>>& map, float z, std::unordered_map<int, Tile>& tiles, int index, int pos_i, int i_width2, int pos_j, int j_height2) {
-
-        /* Get the position of the big packed region inside the world map */
-        /* TODO: There is a shift happening on the tiles of the map for some reason... */
-        float center_x, center_y;
-        GetXYFromTiled(pos_i, pos_j, center_x, center_y);
-
-        /* Get the tile region from the packed map */
-        TileRegion& region = packed_map_[std::make_pair(center_x, center_y)];
-
-        /* Pack all the unique tiles inside that region, into the single packed tile map */
-        int tile_index = index;
-        for (int i = -i_width2; i < i_width2; i++) {
-            for (int j = -j_height2; j < j_height2; j++) {
-
-                /* If index is valid */
-                if (pos_i + i >= MAP_HEIGHT) continue;
-                if (pos_j + j >= MAP_WIDTH) continue;
-                int id = std::stoi(map[pos_i + i][pos_j + j]);
-                /* and its a valid tile */
-                if (id == -1) continue;
-                if (tiles.find(id) == tiles.end()) continue;
-
-                /* Get the unique tile that should be placed in that point in the world */
-                Tile tile = tiles[id];
-
-                /* Get the position of the tile in the map, invert the coordinates */
-                Vector3D tile_position({ (Real_t)(j), (Real_t)(-i), z });
-
-                /* Transform the vertices of the tile, to reflect the position in the map */
-                for (size_t v = 0; v < tile.vertices_.size(); v++) {
-                    region.vertices_.push_back(tile.vertices_[v] + tile_position);
+    template<typename F> void ForEachRegionTile(const Region& region, const std::vector<Tile>& tiles, F func) {
+        for (size_t l = 0; l < layers_.size(); l++) {
+            const MapLayer& layer = layers_[l];
+            int i_end = std::min(region_size2_, layer.height_ - region.pos_i_);
+            int j_end = std::min(region_size2_, layer.width_ - region.pos_j_);
+            for (int i = -region_size2_; i < i_end; i++) {
+                const int * row = &layer.cells_[0] + static_cast<size_t>(region.pos_i_ + i) * layer.width_ + region.pos_j_;
+                for (int j = -region_size2_; j < j_end; j++) {
+                    /* If it's a valid tile */
+                    int id = row[j];
+                    if (id < 0 || static_cast<size_t>(id) >= tiles.size()) continue;
+                    func(layer, i, j, id);
                 }
+            }
+        }
+    }
 
-                for (size_t uv = 0; uv < tile.uv_.size(); uv++) {
-                    region.uv_.push_back(tile.uv_[uv]);
-                }
+    size_t CountRegionTiles(const Region& region, const std::vector<Tile>& tiles) {
+        size_t number_of_tiles = 0;
+        ForEachRegionTile(region, tiles, [&](const MapLayer&, int, int, int) {
+            number_of_tiles++;
+        });
+        return number_of_tiles;
+    }
 
-                /* Add the index for each triangle, since all tiles are exported into a single packed mesh */
-                for (size_t t = 0; t < tile.triangles_.size(); t++) {
-                    region.triangles_.push_back(tile.triangles_[t] + Vector3D(tile_index));
-                }
+    /* Append a number to the .obj text of a region, like operator<< of a stream does */
+    void AppendReal(RegionBuffer& buffer, float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        auto itr = buffer.real_text_.find(bits);
+        if (itr == buffer.real_text_.end()) {
+            char text[32];
+            int length = std::snprintf(text, sizeof(text), "%g", value);
+            itr = buffer.real_text_.insert(std::make_pair(bits, std::string(text, length))).first;
+        }
+        buffer.obj_ += itr->second;
+    }
+
+    /* Append a vertex index to the .obj text of a region */
+    void AppendIndex(RegionBuffer& buffer, size_t index) {
+        char text[24];
+        char * digits = text + sizeof(text);
+        do {
+            *--digits = static_cast<char>('0' + index % 10);
+            index /= 10;
+        } while (index > 0);
+        buffer.obj_.append(digits, text + sizeof(text) - digits);
+    }
+
+    /**
+        Pack the tiles of a region into a single mesh, and format its .obj text. The vertices and the uvs of the
+        region start at region.vertex_index_ in the .obj
+    */
+    void PackRegion(const Region& region, const std::vector<Tile>& tiles, RegionBuffer& buffer) {
+        buffer.vertices_.clear();
+        buffer.indices_.clear();
+        buffer.obj_.clear();
+        buffer.vertices_.reserve(4 * region.number_of_tiles_);
+        buffer.indices_.reserve(6 * region.number_of_tiles_);
+
+        ForEachRegionTile(region, tiles, [&](const MapLayer& layer, int i, int j, int id) {
+            const Tile& tile = tiles[id];
+
+            /* Get the position of the tile in the map, invert the coordinates */
+            glm::vec3 tile_position(static_cast<float>(j), static_cast<float>(-i), layer.z_);
+
+            /* Add the index for each triangle, since all tiles are exported into a single packed mesh */
+            unsigned int tile_index = static_cast<unsigned int>(buffer.vertices_.size());
+            for (int t = 0; t < 6; t++) {
+                buffer.indices_.push_back(tile.triangles_[t] + tile_index);
+            }
+
+            /* Transform the vertices of the tile, to reflect the position in the map */
+            for (int v = 0; v < 4; v++) {
+                buffer.vertices_.push_back(graphics::Vertex_t(tile.vertices_[v] + tile_position, glm::vec3(0.0f, 0.0f, 1.0f), tile.uv_[v]));
+            }
+        });
+
+        /* Write the data for a single packed region, naming static_map.NUMBER */
+        buffer.obj_.reserve(80 * buffer.vertices_.size() + 128);
+        buffer.obj_ += "o " + map_name_ + "." + std::to_string(region.map_index_) + "\n";
+
+        /* Write geometry */
+        for (size_t v = 0; v < buffer.vertices_.size(); v++) {
+            const glm::vec3& position = buffer.vertices_[v].position_;
+            buffer.obj_ += "v ";
+            AppendReal(buffer, position.x);
+            buffer.obj_ += ' ';
+            AppendReal(buffer, position.y);
+            buffer.obj_ += ' ';
+            AppendReal(buffer, position.z);
+            buffer.obj_ += '\n';
+        }
+        for (size_t v = 0; v < buffer.vertices_.size(); v++) {
+            const glm::vec2& uv = buffer.vertices_[v].uv_;
+            buffer.obj_ += "vt ";
+            AppendReal(buffer, uv.x);
+            buffer.obj_ += ' ';
+            AppendReal(buffer, uv.y);
+            buffer.obj_ += '\n';
+        }
 
-                tile_index += tile.vertices_.size();
+        buffer.obj_ += "vn 0.0000 0.0000 1.0000\n";
+        buffer.obj_ += "usemtl " + map_name_ + "_mtl\n";
+        buffer.obj_ += "s off\n";
+
+        /* Write triangles, the vertices and the uvs of the whole file are numbered from 1, and each vertex has its own uv */
+        size_t base = region.vertex_index_ + 1;
+        for (size_t t = 0; t < buffer.indices_.size(); t += 3) {
+            buffer.obj_ += 'f';
+            for (int c = 0; c < 3; c++) {
+                size_t index = base + buffer.indices_[t + c];
+                buffer.obj_ += ' ';
+                AppendIndex(buffer, index);
+                buffer.obj_ += '/';
+                AppendIndex(buffer, index);
+                buffer.obj_ += "/1";
             }
+            buffer.obj_ += '\n';
+        }
+
+        /* The bundle has the uvs flipped, like the importer of the .obj does */
+        for (size_t v = 0; v < buffer.vertices_.size(); v++) {
+            buffer.vertices_[v].uv_.y = 1.0f - buffer.vertices_[v].uv_.y;
         }
-        return tile_index;
     }
 };
 
@@ -267,6 +447,34 @@ private:
 
 int main(int argc, char ** argv) {
 
+    /*
+        The maps to pack, and --benchmark to report the time it takes. Maps are packed in regions with a width and a
+        height of 20, --region-size N changes it for the maps named after it, e.g. the house maps use 14:
+        prepare_map_files billy_map --region-size 14 house1_a house1_b
+    */
+    bool benchmark = false;
+    int region_size = 20;
+    std::vector<std::string> map_names;
+    std::vector<int> region_sizes;
+    for (int i = 1; i < argc; i++) {
+        std::string argument(argv[i]);
+        if (argument == "--benchmark") benchmark = true;
+        else if (argument == "--region-size") {
+            region_size = (i + 1 < argc) ? atoi(argv[++i]) : 0;
+            if (region_size <= 0) {
+                dt::Console(dt::CRITICAL, "--region-size needs a positive size");
+                return -1;
+            }
+        } else {
+            map_names.push_back(argument);
+            region_sizes.push_back(region_size);
+        }
+    }
+    if (map_names.size() == 0) {
+        map_names.push_back("billy_map");
+        region_sizes.push_back(region_size);
+    }
+
     /* Create a single .obj file, with multiple meshes for all the available unique tiles. Maybe we have to spawn the individually on the fly */
     std::ofstream obj_file;
     obj_file.open("roguelikeSheet_transparent.obj");
@@ -282,19 +490,19 @@ int main(int argc, char ** argv) {
 
     size_t nrows = (vertical_resolution + 1) / (asset_vertical_pixel_width + 1);
     size_t ncols = (horizontal_resolution + 1) / (asset_horizontal_pixel_width + 1);
-    
+
     float asset_width_h = (float)asset_horizontal_pixel_width / (float)horizontal_resolution;
     float asset_width_v = (float)asset_vertical_pixel_width / (float)vertical_resolution;
 
     float asset_border_margin_h = 0.2f / (float)horizontal_resolution;
     float asset_border_margin_v = 0.2f / (float)vertical_resolution;
 
-    /* Create the unique tiles */
+    /* Create the unique tiles, the index of a tile is its id in the map */
     size_t asset_index = 0;
-    std::unordered_map<int, Tile> tiles;
+    std::vector<Tile> tiles;
     for (size_t i = 0; i < nrows; i++) {
         for (size_t j = 0; j < ncols; j++) {
-            
+
             size_t pixel_position_h = (asset_horizontal_pixel_width + horizontal_margin) * j;
             size_t pixel_position_v = (asset_vertical_pixel_width + vertical_margin) * i;
 
@@ -313,13 +521,12 @@ int main(int argc, char ** argv) {
             std::cout << u2 << " " << v2 << std::endl;
             std::cout << u3 << " " << v3 << std::endl;
             std::cout << u4 << " " << v4 << std::endl;*/
-            
+
             /* Export tiles into a single .obj object */
             ExportObjFile(obj_file, "roguelikeSheet_transparent", asset_index, u4, v4, u1, v1, u3, v3, u2, v2);
 
             /* Get a copy of the tile data, to use it for packing the map */
-            Tile tile = CreateTile(u4, v4, u1, v1, u3, v3, u2, v2);
-            tiles.insert(std::make_pair(asset_index, tile));
+            tiles.push_back(CreateTile(u4, v4, u1, v1, u3, v3, u2, v2));
 
             asset_index++;
         }
@@ -341,45 +548,33 @@ int main(int argc, char ** argv) {
     mtl_file << "map_Ks textures/spec_map_empty.png\n";
     mtl_file << "\n";
 
-    /* Init packed map */
-    
-    {
-        PackedMap packed_map("billy_map");
-        //PackedMap packed_map("tavern_1a");
-        //PackedMap packed_map("tavern_1b");
-    
-        /* Pack regions of the world, with a width and a height of 20, into packed meshes */
-        size_t strive = 20;
-        size_t strive2 = 10;
-
-        for (int i = strive2; i < MAP_HEIGHT; i += strive) {
-            for (int j = strive2; j < MAP_WIDTH; j += strive) {
-                packed_map.PackMapLayer(tiles, i, strive2, j, strive2);
-            }
+    utility::JobSystem job_system;
+    job_system.Init();
+
+    /* Pack regions of the world into packed meshes */
+    for (size_t m = 0; m < map_names.size(); m++) {
+        dt::Timer read_timer;
+        PackedMap packed_map(map_names[m], region_sizes[m]);
+        read_timer.Stop();
+
+        dt::Timer export_timer;
+        packed_map.ExportMapFiles(tiles, job_system);
+        export_timer.Stop();
+
+        if (benchmark) {
+            int64_t total_ms = std::max(read_timer.ToInt() + export_timer.ToInt(), static_cast<int64_t>(1));
+            size_t cells = packed_map.GetNumberOfCells();
+            dt::Console(map_names[m] + ": " + std::to_string(cells) + " tiles, " + std::to_string(packed_map.GetNumberOfPackedTiles()) + " packed, "
+                + std::to_string(job_system.GetNumberOfThreads()) + " threads");
+            dt::Console("Read layers: " + read_timer.ToString() + ", pack and write: " + export_timer.ToString()
+                + ", " + std::to_string(static_cast<uint64_t>(cells * 1000.0 / total_ms)) + " tiles/s");
         }
-
-        packed_map.ExportMapFiles();
     }
 
-    //{
-    //    //PackedMap packed_map("house1_a");
-    //    PackedMap packed_map("house1_b");
-
-    //    /* Pack regions of the world, with a width and a height of 20, into packed meshes */
-    //    size_t strive = 14;
-    //    size_t strive2 = 7;
-
-    //    for (int i = strive2; i < MAP_HEIGHT; i += strive) {
-    //        for (int j = strive2; j < MAP_WIDTH; j += strive) {
-    //            packed_map.PackMapLayer(tiles, i, strive2, j, strive2);
-    //        }
-    //    }
-
-    //    packed_map.ExportMapFiles();
-    //}
+    job_system.Destroy();
 
 #ifdef _WIN32
-    system("pause");
+    if (!benchmark) system("pause");
 #endif
 
 }
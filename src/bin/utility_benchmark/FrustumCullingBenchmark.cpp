@@ -0,0 +1,129 @@
+#include "FrustumCullingBenchmark.hpp"
+
+#include <vector>
+#include <random>
+#include <string>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include "glm/gtc/type_ptr.hpp"
+
+#include "game_engine/graphics/Frustum.hpp"
+#include "game_engine/graphics/FrustumCulling.hpp"
+#include "game_engine/utility/BVH.hpp"
+
+#include "debug_tools/Console.hpp"
+#include "debug_tools/Timer.hpp"
+
+namespace dt = debug_tools;
+namespace gph = game_engine::graphics;
+namespace utl = game_engine::utility;
+
+#define CULLING_WORLD_SIZE 200.0f
+#define NUMBER_OF_BOXES 100000
+#define CULLING_FRAMES 100
+
+/**
+    Cull the boxes with the Frustum class, building an AABox per box
+    @return The number of visible boxes in all the frames
+*/
+static size_t CullFrustumClass(Frustum& frustum, gph::CullingBoxes_t& boxes) {
+    size_t visible = 0;
+    for (size_t i = 0; i < boxes.Size(); i++) {
+        Vector3D min({ boxes.min_x_[i], boxes.min_y_[i], boxes.min_z_[i] });
+        Vector3D max({ boxes.max_x_[i], boxes.max_y_[i], boxes.max_z_[i] });
+        AABox<3> box(min, max);
+        if (frustum.BoxInFrustum(box) != Frustum::OUTSIDE) visible++;
+    }
+    return visible;
+}
+
+void FrustumCullingBenchmark() {
+    std::mt19937 generator(17);
+    std::uniform_real_distribution<float> position(-CULLING_WORLD_SIZE / 2, CULLING_WORLD_SIZE / 2);
+    std::uniform_real_distribution<float> size(0.2f, 2.0f);
+
+    gph::CullingBoxes_t boxes;
+    for (size_t i = 0; i < NUMBER_OF_BOXES; i++) {
+        glm::vec3 center(position(generator), position(generator), position(generator));
+        glm::vec3 extent(size(generator), size(generator), size(generator));
+        boxes.Add(center - extent, center + extent);
+    }
+
+    /* A camera in the middle of the boxes, turning every frame */
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, CULLING_WORLD_SIZE / 2);
+    std::vector<glm::mat4> view_projections(CULLING_FRAMES);
+    for (size_t f = 0; f < CULLING_FRAMES; f++) {
+        float angle = 2 * 3.14159265f * f / CULLING_FRAMES;
+        glm::mat4 view = glm::lookAt(glm::vec3(0, 0, 0), glm::vec3(std::cos(angle), std::sin(angle), 0.2f), glm::vec3(0, 0, 1));
+        view_projections[f] = projection * view;
+    }
+
+    size_t visible_frustum = 0;
+    {
+        dt::Timer timer;
+        for (size_t f = 0; f < CULLING_FRAMES; f++) {
+            Frustum frustum;
+            frustum.SetFrustum(glm::value_ptr(view_projections[f]));
+            visible_frustum += CullFrustumClass(frustum, boxes);
+        }
+        timer.Stop();
+        dt::Console("Frustum class, " + std::to_string(NUMBER_OF_BOXES) + " boxes, " + std::to_string(CULLING_FRAMES) + " frames: " + timer.ToString() + ", visible: " + std::to_string(visible_frustum));
+    }
+
+    std::vector<uint32_t> visible;
+    size_t visible_scalar = 0;
+    {
+        dt::Timer timer;
+        for (size_t f = 0; f < CULLING_FRAMES; f++) {
+            gph::FrustumPlanes_t planes;
+            gph::ExtractFrustumPlanes(view_projections[f], planes);
+            visible.clear();
+            gph::CullBoxesScalar(planes, boxes, visible);
+            visible_scalar += visible.size();
+        }
+        timer.Stop();
+        dt::Console("Structure of arrays scalar, " + std::to_string(NUMBER_OF_BOXES) + " boxes, " + std::to_string(CULLING_FRAMES) + " frames: " + timer.ToString() + ", visible: " + std::to_string(visible_scalar));
+    }
+
+    size_t visible_simd = 0;
+    {
+        dt::Timer timer;
+        for (size_t f = 0; f < CULLING_FRAMES; f++) {
+            gph::FrustumPlanes_t planes;
+            gph::ExtractFrustumPlanes(view_projections[f], planes);
+            visible.clear();
+            gph::CullBoxes(planes, boxes, visible);
+            visible_simd += visible.size();
+        }
+        timer.Stop();
+        dt::Console("Structure of arrays SIMD, " + std::to_string(NUMBER_OF_BOXES) + " boxes, " + std::to_string(CULLING_FRAMES) + " frames: " + timer.ToString() + ", visible: " + std::to_string(visible_simd));
+    }
+
+    size_t visible_bvh = 0;
+    {
+        utl::BVH<uint32_t> bvh(NUMBER_OF_BOXES);
+        dt::Timer build_timer;
+        for (size_t i = 0; i < boxes.Size(); i++) {
+            bvh.Insert(glm::vec3(boxes.min_x_[i], boxes.min_y_[i], boxes.min_z_[i]), glm::vec3(boxes.max_x_[i], boxes.max_y_[i], boxes.max_z_[i]), static_cast<uint32_t>(i));
+        }
+        bvh.Rebuild();
+        build_timer.Stop();
+        dt::Console("BVH build, " + std::to_string(NUMBER_OF_BOXES) + " boxes: " + build_timer.ToString());
+
+        dt::Timer timer;
+        for (size_t f = 0; f < CULLING_FRAMES; f++) {
+            glm::vec4 planes[6];
+            gph::ExtractFrustumPlanes(view_projections[f], planes);
+            visible.clear();
+            bvh.QueryFrustum(planes, 6, visible);
+            visible_bvh += visible.size();
+        }
+        timer.Stop();
+        dt::Console("BVH, " + std::to_string(NUMBER_OF_BOXES) + " boxes, " + std::to_string(CULLING_FRAMES) + " frames: " + timer.ToString() + ", visible: " + std::to_string(visible_bvh));
+    }
+
+    if (visible_scalar != visible_simd) dt::Console(dt::CRITICAL, "Frustum culling SIMD kept different boxes than scalar");
+    if (visible_bvh != visible_scalar) dt::Console(dt::CRITICAL, "Frustum culling BVH kept different boxes than scalar");
+    if (visible_frustum != visible_scalar) dt::Console(dt::WARNING, "Frustum culling structure of arrays kept different boxes than the Frustum class");
+}
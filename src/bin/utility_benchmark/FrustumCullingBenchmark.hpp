@@ -0,0 +1,11 @@
+#ifndef __FrustumCullingBenchmark_hpp__
+#define __FrustumCullingBenchmark_hpp__
+
+/**
+    Cull boxes with a view frustum on the CPU. One box at a time with the Frustum class, the way the renderer did
+    per draw call, in a single pass over a structure of arrays, with and without SIMD, and with a BVH. All have to
+    keep the same boxes
+*/
+void FrustumCullingBenchmark();
+
+#endif
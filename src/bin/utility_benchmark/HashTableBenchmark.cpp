@@ -0,0 +1,161 @@
+#include "HashTableBenchmark.hpp"
+
+#include <vector>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+
+#include "game_engine/utility/HashTable.hpp"
+#include "ChainedHashTable.hpp"
+
+#include "debug_tools/Console.hpp"
+#include "debug_tools/Timer.hpp"
+
+namespace dt = debug_tools;
+namespace utl = game_engine::utility;
+
+#define HASHTABLE_INITIAL_SIZE 64
+#define NUMBER_OF_KEYS 200000
+#define NUMBER_OF_PATHS 2000
+#define LOOKUP_ROUNDS 20
+
+/* The same operations on the three tables */
+template<typename Key, typename Value> static void Insert(utl::HashTable<Key, Value>& table, const Key& key, Value value) { table.Insert(key, value); }
+template<typename Key, typename Value> static void Insert(ChainedHashTable<Key, Value>& table, const Key& key, Value value) { table.Insert(key, value); }
+template<typename Key, typename Value> static void Insert(std::unordered_map<Key, Value>& table, const Key& key, Value value) { table.insert(std::make_pair(key, value)); }
+
+template<typename Key, typename Value, typename K> static size_t Find(utl::HashTable<Key, Value>& table, const K& key) {
+    auto itr = table.Find(key);
+    return (itr != table.end()) ? itr.GetValue() : 0;
+}
+template<typename Key, typename Value, typename K> static size_t Find(ChainedHashTable<Key, Value>& table, const K& key) {
+    auto itr = table.Find(key);
+    return (itr != table.end()) ? itr.GetValue() : 0;
+}
+template<typename Key, typename Value, typename K> static size_t Find(std::unordered_map<Key, Value>& table, const K& key) {
+    auto itr = table.find(key);
+    return (itr != table.end()) ? itr->second : 0;
+}
+
+template<typename Key, typename Value> static size_t Iterate(utl::HashTable<Key, Value>& table) {
+    size_t sum = 0;
+    for (auto itr = table.begin(); itr != table.end(); ++itr) sum += itr.GetValue();
+    return sum;
+}
+template<typename Key, typename Value> static size_t Iterate(ChainedHashTable<Key, Value>& table) {
+    size_t sum = 0;
+    for (auto itr = table.begin(); itr != table.end(); ++itr) sum += itr.GetValue();
+    return sum;
+}
+template<typename Key, typename Value> static size_t Iterate(std::unordered_map<Key, Value>& table) {
+    size_t sum = 0;
+    for (auto itr = table.begin(); itr != table.end(); ++itr) sum += itr->second;
+    return sum;
+}
+
+template<typename Key, typename Value> static void Remove(utl::HashTable<Key, Value>& table, const Key& key) { table.Remove(key); }
+template<typename Key, typename Value> static void Remove(ChainedHashTable<Key, Value>& table, const Key& key) { table.Remove(key); }
+template<typename Key, typename Value> static void Remove(std::unordered_map<Key, Value>& table, const Key& key) { table.erase(key); }
+
+/**
+    Run the integer keys workload on a table
+    @param name The name of the table, for printing
+    @param table An empty table
+    @param keys The keys to insert, the values are their positions
+    @param missing Keys that are not inserted
+    @return A sum of the values found, the same for all the tables
+*/
+template<typename Table> static size_t IntegerKeys(std::string name, Table& table, const std::vector<int>& keys, const std::vector<int>& missing) {
+    size_t sum = 0;
+
+    dt::Timer insert_timer;
+    for (size_t i = 0; i < keys.size(); i++) Insert(table, keys[i], static_cast<int>(i));
+    insert_timer.Stop();
+
+    dt::Timer find_timer;
+    for (size_t r = 0; r < LOOKUP_ROUNDS; r++) {
+        for (size_t i = 0; i < keys.size(); i++) sum += Find(table, keys[i]);
+    }
+    find_timer.Stop();
+
+    dt::Timer miss_timer;
+    for (size_t r = 0; r < LOOKUP_ROUNDS; r++) {
+        for (size_t i = 0; i < missing.size(); i++) sum += Find(table, missing[i]);
+    }
+    miss_timer.Stop();
+
+    dt::Timer iterate_timer;
+    for (size_t r = 0; r < LOOKUP_ROUNDS; r++) sum += Iterate(table);
+    iterate_timer.Stop();
+
+    dt::Timer remove_timer;
+    for (size_t i = 0; i < keys.size(); i++) Remove(table, keys[i]);
+    remove_timer.Stop();
+
+    dt::Console(name + ", " + std::to_string(keys.size()) + " integer keys, insert: " + insert_timer.ToString() + " ms, find: " + find_timer.ToString() +
+        " ms, miss: " + miss_timer.ToString() + " ms, iterate: " + iterate_timer.ToString() + " ms, remove: " + remove_timer.ToString() + " ms");
+    return sum;
+}
+
+/**
+    Find paths in a table of paths
+    @param name The name of the table, for printing
+    @param table A table with the paths
+    @param paths The paths, as separate strings than the keys of the table
+    @return A sum of the values found, the same for all the tables
+*/
+template<typename Table> static size_t StringKeys(std::string name, Table& table, const std::vector<std::string>& paths) {
+    size_t sum = 0;
+
+    dt::Timer timer;
+    for (size_t r = 0; r < 50 * LOOKUP_ROUNDS; r++) {
+        for (size_t i = 0; i < paths.size(); i++) sum += Find(table, paths[i]);
+    }
+    timer.Stop();
+
+    dt::Console(name + ", " + std::to_string(50 * LOOKUP_ROUNDS * paths.size()) + " string lookups: " + timer.ToString() + " ms");
+    return sum;
+}
+
+void HashTableBenchmark() {
+    std::mt19937 generator(23);
+
+    /* Distinct keys, half of them are inserted */
+    std::vector<int> keys(2 * NUMBER_OF_KEYS);
+    for (size_t i = 0; i < keys.size(); i++) keys[i] = static_cast<int>(i * 7 + 3);
+    std::shuffle(keys.begin(), keys.end(), generator);
+    std::vector<int> missing(keys.begin() + NUMBER_OF_KEYS, keys.end());
+    keys.resize(NUMBER_OF_KEYS);
+
+    size_t sum_open, sum_chained, sum_map;
+    {
+        utl::HashTable<int, int> table(HASHTABLE_INITIAL_SIZE, 1.0);
+        sum_open = IntegerKeys("HashTable", table, keys, missing);
+    }
+    {
+        ChainedHashTable<int, int> table(HASHTABLE_INITIAL_SIZE, 1.0);
+        sum_chained = IntegerKeys("Chained HashTable", table, keys, missing);
+    }
+    {
+        std::unordered_map<int, int> table(HASHTABLE_INITIAL_SIZE);
+        sum_map = IntegerKeys("std::unordered_map", table, keys, missing);
+    }
+    if (sum_open != sum_map || sum_chained != sum_map) dt::Console(dt::CRITICAL, "HashTable integer keys found different values");
+
+    std::vector<std::string> paths(NUMBER_OF_PATHS);
+    for (size_t i = 0; i < paths.size(); i++) paths[i] = "assets/models/props/model_" + std::to_string(generator()) + ".obj";
+
+    utl::HashTable<std::string, int> table(HASHTABLE_INITIAL_SIZE, 1.0);
+    ChainedHashTable<std::string, int> chained_table(HASHTABLE_INITIAL_SIZE, 1.0);
+    std::unordered_map<std::string, int> map(HASHTABLE_INITIAL_SIZE);
+    for (size_t i = 0; i < paths.size(); i++) {
+        Insert(table, paths[i], static_cast<int>(i));
+        Insert(chained_table, paths[i], static_cast<int>(i));
+        Insert(map, paths[i], static_cast<int>(i));
+    }
+    sum_open = StringKeys("HashTable", table, paths);
+    sum_chained = StringKeys("Chained HashTable", chained_table, paths);
+    sum_map = StringKeys("std::unordered_map", map, paths);
+    if (sum_open != sum_map || sum_chained != sum_map) dt::Console(dt::CRITICAL, "HashTable string keys found different values");
+}
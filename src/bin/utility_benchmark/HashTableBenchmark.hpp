@@ -0,0 +1,11 @@
+#ifndef __HashTableBenchmark_hpp__
+#define __HashTableBenchmark_hpp__
+
+/**
+    Compare the open addressing HashTable with the list chained table it replaced, and with std::unordered_map. Integer
+    keys are inserted, found, missed, iterated and removed, and string keys, like the paths of the AssetManager, are
+    found. All have to find the same values
+*/
+void HashTableBenchmark();
+
+#endif
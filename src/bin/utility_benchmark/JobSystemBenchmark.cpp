@@ -0,0 +1,117 @@
+#include "JobSystemBenchmark.hpp"
+
+#include <vector>
+#include <string>
+#include <atomic>
+#include <chrono>
+
+#include "game_engine/utility/FIFOWorker.hpp"
+#include "game_engine/utility/JobSystem.hpp"
+
+#include "debug_tools/Console.hpp"
+#include "debug_tools/Timer.hpp"
+
+namespace dt = debug_tools;
+namespace utl = game_engine::utility;
+
+#define NUMBER_OF_TASKS 100000
+#define NUMBER_OF_ROUND_TRIPS 10000
+#define TASK_WORK 200
+
+/**
+    A tiny amount of work
+    @param seed A value to start from
+    @return A value that depends on the seed, to keep the compiler from removing the loop
+*/
+static size_t Work(size_t seed) {
+    size_t value = seed;
+    for (size_t i = 0; i < TASK_WORK; i++) value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+    return value & 1;
+}
+
+/**
+    Print the average time of a round trip
+    @param name The name of the scheduler
+    @param time The total time of all round trips
+*/
+static void PrintLatency(std::string name, std::chrono::high_resolution_clock::duration time) {
+    double us = std::chrono::duration_cast<std::chrono::nanoseconds>(time).count() / 1000.0 / NUMBER_OF_ROUND_TRIPS;
+    dt::Console(name + " latency, " + std::to_string(NUMBER_OF_ROUND_TRIPS) + " round trips: " + std::to_string(us) + " us per round trip");
+}
+
+static void FIFOWorkerBenchmark() {
+    utl::FIFOWorker worker;
+    worker.Init();
+
+    {
+        std::atomic<size_t> sum(0);
+        dt::Timer timer;
+        for (size_t i = 0; i < NUMBER_OF_TASKS; i++) {
+            worker.Schedule([&sum, i]() { sum += Work(i); });
+        }
+        worker.BusyWaitAll();
+        timer.Stop();
+        dt::Console("FIFOWorker throughput, " + std::to_string(NUMBER_OF_TASKS) + " tasks: " + timer.ToString() + ", sum: " + std::to_string(sum.load()));
+    }
+
+    {
+        std::atomic<size_t> sum(0);
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < NUMBER_OF_ROUND_TRIPS; i++) {
+            worker.Schedule([&sum, i]() { sum += Work(i); });
+            worker.BusyWaitAll();
+        }
+        PrintLatency("FIFOWorker", std::chrono::high_resolution_clock::now() - start);
+    }
+
+    worker.Stop();
+}
+
+static void JobSystemBenchmark(size_t number_of_threads) {
+    utl::JobSystem job_system;
+    job_system.Init(number_of_threads);
+    std::string name = "JobSystem (" + std::to_string(job_system.GetNumberOfThreads()) + " threads)";
+
+    {
+        std::atomic<size_t> sum(0);
+        utl::JobCounter counter;
+        dt::Timer timer;
+        for (size_t i = 0; i < NUMBER_OF_TASKS; i++) {
+            job_system.Schedule([&sum, i]() { sum += Work(i); }, &counter);
+        }
+        job_system.Wait(&counter);
+        timer.Stop();
+        dt::Console(name + " throughput, " + std::to_string(NUMBER_OF_TASKS) + " tasks: " + timer.ToString() + ", sum: " + std::to_string(sum.load()));
+    }
+
+    {
+        std::atomic<size_t> sum(0);
+        dt::Timer timer;
+        job_system.ParallelFor(NUMBER_OF_TASKS, 64, [&sum](size_t batch, size_t start, size_t end) {
+            size_t batch_sum = 0;
+            for (size_t i = start; i < end; i++) batch_sum += Work(i);
+            sum += batch_sum;
+        });
+        timer.Stop();
+        dt::Console(name + " parallel for, " + std::to_string(NUMBER_OF_TASKS) + " tasks: " + timer.ToString() + ", sum: " + std::to_string(sum.load()));
+    }
+
+    {
+        std::atomic<size_t> sum(0);
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < NUMBER_OF_ROUND_TRIPS; i++) {
+            utl::JobCounter counter;
+            job_system.Schedule([&sum, i]() { sum += Work(i); }, &counter);
+            job_system.Wait(&counter);
+        }
+        PrintLatency(name, std::chrono::high_resolution_clock::now() - start);
+    }
+
+    job_system.Destroy();
+}
+
+void JobSystemBenchmark() {
+    FIFOWorkerBenchmark();
+    JobSystemBenchmark(1);
+    JobSystemBenchmark(0);
+}
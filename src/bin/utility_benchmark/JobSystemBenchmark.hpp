@@ -0,0 +1,10 @@
+#ifndef __JobSystemBenchmark_hpp__
+#define __JobSystemBenchmark_hpp__
+
+/**
+    Compare the JobSystem with the FIFOWorker. Throughput: schedule many tiny tasks and wait for all of them.
+    Latency: schedule a single task and wait for it, many times
+*/
+void JobSystemBenchmark();
+
+#endif
@@ -0,0 +1,120 @@
+#include "PhysicsBenchmark.hpp"
+
+#include <vector>
+#include <random>
+#include <string>
+#include <memory>
+
+#include "game_engine/math/Types.hpp"
+#include "game_engine/math/AABox.hpp"
+#include "game_engine/physics/PhysicsEngine.hpp"
+#include "game_engine/physics/PhysicsObject.hpp"
+#include "game_engine/memory/FrameAllocator.hpp"
+
+#include "debug_tools/Console.hpp"
+#include "debug_tools/Timer.hpp"
+
+namespace dt = debug_tools;
+namespace ge = game_engine;
+namespace math = game_engine::math;
+namespace ph = game_engine::physics;
+namespace ms = game_engine::memory;
+
+#define PHYSICS_WORLD_SIZE 300.0f
+#define NUMBER_OF_STATIC_OBJECTS 20000
+#define NUMBER_OF_MOVING_OBJECTS 2000
+#define PHYSICS_FRAMES 100
+
+/* A moving object, half of them are boxes and half circles */
+struct Mover {
+    math::Vector2D position_;
+    math::Vector2D velocity_;
+};
+
+/**
+    Run the movers for a number of frames
+    @param name The name of the mode, for printing
+    @param broadphase Step the broadphase every frame, or use only the quad tree
+    @param movers The movers, copied, so that every mode runs the same workload
+    @return The number of blocked moves
+*/
+static size_t RunPhysics(std::string name, bool broadphase, std::vector<Mover> movers) {
+    std::mt19937 generator(11);
+    std::uniform_real_distribution<ge::Real_t> position(2.0f, PHYSICS_WORLD_SIZE - 2.0f);
+    std::uniform_real_distribution<ge::Real_t> size(0.5f, 1.0f);
+
+    ph::PhysicsEngine engine;
+    engine.Init(math::AABox<2>(math::Vector2D(0, 0), math::Vector2D(PHYSICS_WORLD_SIZE, PHYSICS_WORLD_SIZE)), NUMBER_OF_STATIC_OBJECTS + NUMBER_OF_MOVING_OBJECTS);
+
+    std::unique_ptr<ph::PhysicsObject[]> static_objects(new ph::PhysicsObject[NUMBER_OF_STATIC_OBJECTS]);
+    for (size_t i = 0; i < NUMBER_OF_STATIC_OBJECTS; i++) {
+        math::Vector2D p(position(generator), position(generator));
+        ge::Real_t s = size(generator) / 2;
+        static_objects[i].Init(p.x(), p.y(), 0);
+        static_objects[i].SetCollision(&engine, math::AABox<2>(p - s, p + s));
+    }
+
+    std::unique_ptr<ph::PhysicsObject[]> moving_objects(new ph::PhysicsObject[movers.size()]);
+    for (size_t i = 0; i < movers.size(); i++) {
+        math::Vector2D& p = movers[i].position_;
+        moving_objects[i].Init(p.x(), p.y(), 0);
+        if (i % 2 == 0) moving_objects[i].SetCollision(&engine, math::AABox<2>(p - 0.3f, p + 0.3f));
+        else moving_objects[i].SetCollision(&engine, math::Circle2D(p.x(), p.y(), 0.3f));
+    }
+
+    size_t blocked = 0;
+    dt::Timer timer;
+    for (size_t f = 0; f < PHYSICS_FRAMES; f++) {
+        if (broadphase) engine.Step();
+
+        for (size_t i = 0; i < movers.size(); i++) {
+            Mover& mover = movers[i];
+            ph::PhysicsObject& object = moving_objects[i];
+
+            math::Vector2D new_position = mover.position_ + mover.velocity_;
+            for (size_t d = 0; d < 2; d++) {
+                if (new_position[d] <= 1.0f || new_position[d] >= PHYSICS_WORLD_SIZE - 1.0f) {
+                    mover.velocity_[d] = -mover.velocity_[d];
+                    new_position[d] = mover.position_[d];
+                }
+            }
+
+            /* Blocked movers turn back */
+            math::Vector2D result = engine.CheckCollision(&object, new_position);
+            if (result[0] != new_position[0] || result[1] != new_position[1]) {
+                blocked++;
+                mover.velocity_ = mover.velocity_ * -1.0f;
+            }
+
+            engine.Update(&object, result);
+            object.SetPosition(result.x(), result.y(), 0);
+            mover.position_ = result;
+        }
+
+        ms::FrameAllocator::ResetAll();
+    }
+    timer.Stop();
+
+    dt::Console(name + ", " + std::to_string(PHYSICS_FRAMES) + " frames: " + timer.ToString() + ", blocked: " + std::to_string(blocked) +
+        (broadphase ? ", pairs: " + std::to_string(engine.GetNumberOfPairs()) : ""));
+
+    engine.Destroy();
+    return blocked;
+}
+
+void PhysicsBenchmark() {
+    std::mt19937 generator(13);
+    std::uniform_real_distribution<ge::Real_t> position(2.0f, PHYSICS_WORLD_SIZE - 2.0f);
+    std::uniform_real_distribution<ge::Real_t> velocity(-0.1f, 0.1f);
+
+    std::vector<Mover> movers(NUMBER_OF_MOVING_OBJECTS);
+    for (size_t i = 0; i < movers.size(); i++) {
+        movers[i].position_ = math::Vector2D(position(generator), position(generator));
+        movers[i].velocity_ = math::Vector2D(velocity(generator), velocity(generator));
+    }
+
+    size_t blocked_quadtree = RunPhysics("Physics quad tree only", false, movers);
+    size_t blocked_broadphase = RunPhysics("Physics broadphase", true, movers);
+
+    if (blocked_quadtree != blocked_broadphase) dt::Console(dt::CRITICAL, "Physics broadphase blocked different moves than the quad tree");
+}
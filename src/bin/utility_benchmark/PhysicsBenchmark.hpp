@@ -0,0 +1,10 @@
+#ifndef __PhysicsBenchmark_hpp__
+#define __PhysicsBenchmark_hpp__
+
+/**
+    Move objects among static objects with the PhysicsEngine, with the broadphase pairs and with quad tree queries
+    only. Both have to block the same moves
+*/
+void PhysicsBenchmark();
+
+#endif
@@ -0,0 +1,167 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <string>
+
+#include "game_engine/math/Types.hpp"
+#include "game_engine/math/AABox.hpp"
+#include "game_engine/utility/QuadTree.hpp"
+#include "game_engine/utility/QuadTreeFlat.hpp"
+
+#include "JobSystemBenchmark.hpp"
+#include "PhysicsBenchmark.hpp"
+#include "FrustumCullingBenchmark.hpp"
+#include "HashTableBenchmark.hpp"
+
+#include "debug_tools/Console.hpp"
+#include "debug_tools/Timer.hpp"
+
+namespace dt = debug_tools;
+namespace ge = game_engine;
+namespace math = game_engine::math;
+namespace utl = game_engine::utility;
+
+/*
+    Compare the pointer based QuadTree with the flat QuadTree, in the way the PhysicsEngine uses them. Every frame,
+    every object is moved to its new position, either with a remove and an insert or with a move, and then a small
+    area around it is queried
+*/
+
+#define WORLD_SIZE 1000.0f
+#define NUMBER_OF_OBJECTS 20000
+#define FRAMES 50
+#define NEIGHBOURS_BUFFER_SIZE 64
+
+/* A moving object */
+struct Object {
+    math::Vector2D position_;
+    math::Vector2D velocity_;
+};
+
+void CreateObjects(std::vector<Object>& objects) {
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<ge::Real_t> position(1.0f, WORLD_SIZE - 1.0f);
+    std::uniform_real_distribution<ge::Real_t> velocity(-0.5f, 0.5f);
+
+    objects.resize(NUMBER_OF_OBJECTS);
+    for (size_t i = 0; i < objects.size(); i++) {
+        objects[i].position_ = math::Vector2D(position(generator), position(generator));
+        objects[i].velocity_ = math::Vector2D(velocity(generator), velocity(generator));
+    }
+}
+
+/**
+    Get the next position of an object, bounce on the world borders
+    @param object The object
+    @return The new position
+*/
+math::Vector2D Move(Object& object) {
+    math::Vector2D new_position = object.position_ + object.velocity_;
+    for (size_t i = 0; i < 2; i++) {
+        if (new_position[i] <= 1.0f || new_position[i] >= WORLD_SIZE - 1.0f) {
+            object.velocity_[i] = -object.velocity_[i];
+            new_position[i] = object.position_[i];
+        }
+    }
+    return new_position;
+}
+
+void Update(utl::QuadTree<size_t>& tree, math::Vector2D& old_position, math::Vector2D& new_position, size_t i, bool move) {
+    tree.Remove(old_position);
+    tree.Insert(new_position, i);
+}
+
+void Update(utl::QuadTreeFlat<size_t>& tree, math::Vector2D& old_position, math::Vector2D& new_position, size_t i, bool move) {
+    if (move) {
+        tree.Move(old_position, new_position, i);
+    } else {
+        tree.Remove(old_position, i);
+        tree.Insert(new_position, i);
+    }
+}
+
+size_t Query(utl::QuadTree<size_t>& tree, math::AABox<2> search_box, std::vector<size_t>& neighbours) {
+    neighbours.clear();
+    tree.QueryRange(search_box, neighbours);
+    return neighbours.size();
+}
+
+size_t Query(utl::QuadTreeFlat<size_t>& tree, math::AABox<2> search_box, std::vector<size_t>& neighbours) {
+    size_t buffer[NEIGHBOURS_BUFFER_SIZE];
+    return tree.QueryRange(search_box, buffer, NEIGHBOURS_BUFFER_SIZE);
+}
+
+/**
+    Run the moving objects workload on a tree
+    @param name The name of the tree, for printing
+    @param tree An empty tree
+    @param objects The objects, copied, so that every tree runs the same workload
+    @param move Use Move() instead of Remove() and Insert(), if the tree supports it
+*/
+template<typename Tree> void Churn(std::string name, Tree& tree, std::vector<Object> objects, bool move) {
+    {
+        dt::Timer timer;
+        for (size_t i = 0; i < objects.size(); i++) {
+            tree.Insert(objects[i].position_, i);
+        }
+        timer.Stop();
+        dt::Console(name + " insert " + std::to_string(objects.size()) + " objects: " + timer.ToString());
+    }
+
+    int64_t update_time = 0;
+    int64_t query_time = 0;
+    size_t found = 0;
+    std::vector<size_t> neighbours;
+    for (size_t f = 0; f < FRAMES; f++) {
+        dt::Timer update_timer;
+        for (size_t i = 0; i < objects.size(); i++) {
+            math::Vector2D new_position = Move(objects[i]);
+            Update(tree, objects[i].position_, new_position, i, move);
+            objects[i].position_ = new_position;
+        }
+        update_timer.Stop();
+        update_time += update_timer.ToInt();
+
+        dt::Timer query_timer;
+        for (size_t i = 0; i < objects.size(); i++) {
+            math::Vector2D& position = objects[i].position_;
+            found += Query(tree, math::AABox<2>(position - 1.5, position + 1.5), neighbours);
+        }
+        query_timer.Stop();
+        query_time += query_timer.ToInt();
+    }
+
+    dt::Console(name + (move ? " move, " : " remove and insert, ") + std::to_string(FRAMES) + " frames: " + std::to_string(update_time) + " ms");
+    dt::Console(name + " query, " + std::to_string(FRAMES) + " frames: " + std::to_string(query_time) + " ms" + ", found: " + std::to_string(found));
+}
+
+int main(int argc, char ** argv) {
+
+    std::vector<Object> objects;
+    CreateObjects(objects);
+
+    {
+        utl::QuadTree<size_t> tree(math::Vector2D(0, 0), WORLD_SIZE);
+        Churn("QuadTree", tree, objects, false);
+    }
+
+    {
+        utl::QuadTreeFlat<size_t> tree(math::Vector2D(0, 0), WORLD_SIZE, NUMBER_OF_OBJECTS);
+        Churn("QuadTreeFlat", tree, objects, false);
+    }
+
+    {
+        utl::QuadTreeFlat<size_t> tree(math::Vector2D(0, 0), WORLD_SIZE, NUMBER_OF_OBJECTS);
+        Churn("QuadTreeFlat", tree, objects, true);
+    }
+
+    JobSystemBenchmark();
+
+    PhysicsBenchmark();
+
+    FrustumCullingBenchmark();
+
+    HashTableBenchmark();
+
+    return 0;
+}
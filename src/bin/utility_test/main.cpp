@@ -1,13 +1,26 @@
 #include <iostream>
+#include <cstdio>
 #include <vector>
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+#include <glm/gtc/matrix_transform.hpp>
 
 #include "game_engine/math/RNGenerator.hpp"
+#include "game_engine/math/RNG.hpp"
 #include "game_engine/utility/QuadTree.hpp"
 #include "game_engine/utility/QuadTreeBoxes.hpp"
+#include "game_engine/utility/QuadTreeFlat.hpp"
 #include "game_engine/math/Types.hpp"
 #include "game_engine/math/AABox.hpp"
 #include "game_engine/utility/List.hpp"
 #include "game_engine/utility/HashTable.hpp"
+#include "game_engine/utility/JobSystem.hpp"
+#include "game_engine/utility/RadixSort.hpp"
+#include "game_engine/utility/BVH.hpp"
+#include "game_engine/graphics/LightClusters.hpp"
+#include "game_engine/graphics/TextureDecoder.hpp"
 
 #include "debug_tools/Console.hpp"
 namespace dt = debug_tools;
@@ -78,6 +91,331 @@ int main(int argc, char ** argv) {
     
     // TODO
 
+    /* Job system, the per batch results merged in batch order must not depend on the number of threads */
+    {
+        std::vector<size_t> expected;
+        for (size_t threads = 1; threads <= 8; threads *= 2) {
+            utl::JobSystem job_system;
+            job_system.Init(threads);
+
+            std::vector<std::vector<size_t>> batches(100);
+            job_system.ParallelFor(10000, 100, [&](size_t batch, size_t start, size_t end) {
+                for (size_t i = start; i < end; i++) if (i % 7 == 0) batches[batch].push_back(i * i);
+            });
+
+            std::vector<size_t> results;
+            for (size_t b = 0; b < batches.size(); b++) results.insert(results.end(), batches[b].begin(), batches[b].end());
+
+            if (expected.empty()) expected = results;
+            if (results != expected) dt::Console(dt::CRITICAL, "JobSystem results depend on the number of threads");
+            else dt::Console("JobSystem with " + std::to_string(job_system.GetNumberOfThreads()) + " threads OK");
+
+            job_system.Destroy();
+        }
+    }
+
+    /* Radix sort, must give the same order as a stable sort */
+    {
+        math::MersenneTwisterGenerator rng(5);
+        std::vector<utl::SortKey_t> keys(5000);
+        for (size_t i = 0; i < keys.size(); i++) {
+            /* Few distinct values in the high bits, to have equal keys and skipped passes */
+            uint64_t high = static_cast<uint64_t>(rng.genrand_int32() % 8) << 56;
+            keys[i] = { high | static_cast<uint64_t>(rng.genrand_int32() % 1000), static_cast<uint32_t>(i) };
+        }
+
+        std::vector<utl::SortKey_t> expected = keys;
+        std::stable_sort(expected.begin(), expected.end(), [](const utl::SortKey_t& a, const utl::SortKey_t& b) { return a.key_ < b.key_; });
+
+        std::vector<utl::SortKey_t> scratch;
+        utl::RadixSort(keys, scratch);
+
+        bool same = true;
+        for (size_t i = 0; i < keys.size(); i++) same = same && keys[i].key_ == expected[i].key_ && keys[i].index_ == expected[i].index_;
+        if (!same) dt::Console(dt::CRITICAL, "RadixSort order is wrong");
+        else dt::Console("RadixSort OK");
+    }
+
+    {
+        /* Insert, remove and move boxes in a BVH, and compare the queries with testing every box */
+        math::MersenneTwisterGenerator rng(7);
+        auto random = [&](float min, float max) { return min + (max - min) * static_cast<float>(rng.genrand_int32()) / 4294967295.0f; };
+
+        const int n = 2000;
+        std::vector<glm::vec3> mins(n), maxs(n);
+        std::vector<int32_t> ids(n);
+        std::vector<bool> alive(n, true);
+        utl::BVH<int> bvh(n);
+        for (int i = 0; i < n; i++) {
+            glm::vec3 center(random(-100, 100), random(-100, 100), random(-100, 100));
+            glm::vec3 extent(random(0.1f, 3), random(0.1f, 3), random(0.1f, 3));
+            mins[i] = center - extent;
+            maxs[i] = center + extent;
+            ids[i] = bvh.Insert(mins[i], maxs[i], i);
+        }
+        for (int i = 0; i < n; i += 5) {
+            bvh.Remove(ids[i]);
+            alive[i] = false;
+        }
+        for (int i = 1; i < n; i += 3) {
+            glm::vec3 offset(random(-10, 10), random(-10, 10), random(-10, 10));
+            mins[i] += offset;
+            maxs[i] += offset;
+            if (alive[i]) bvh.Move(ids[i], mins[i], maxs[i]);
+        }
+
+        /* Box and plane queries, before and after a rebuild */
+        glm::vec3 box_min(-30, -20, -40), box_max(20, 30, 10);
+        glm::vec4 planes[5] = { { 1, 0, 0, 30 }, { -1, 0, 0, 20 }, { 0, 1, 0, 20 }, { 0, -0.7071f, -0.7071f, 30 }, { 0, 0, 1, 40 } };
+        for (int pass = 0; pass < 2; pass++) {
+            std::vector<int> found_box, found_planes;
+            bvh.QueryBox(box_min, box_max, found_box);
+            bvh.QueryFrustum(planes, 5, found_planes);
+            std::sort(found_box.begin(), found_box.end());
+            std::sort(found_planes.begin(), found_planes.end());
+
+            std::vector<int> expected_box, expected_planes;
+            for (int i = 0; i < n; i++) {
+                if (!alive[i]) continue;
+                bool overlap = mins[i].x <= box_max.x && maxs[i].x >= box_min.x && mins[i].y <= box_max.y && maxs[i].y >= box_min.y && mins[i].z <= box_max.z && maxs[i].z >= box_min.z;
+                if (overlap) expected_box.push_back(i);
+
+                bool outside = false;
+                for (int p = 0; p < 5; p++) {
+                    glm::vec3 positive(planes[p].x >= 0 ? maxs[i].x : mins[i].x, planes[p].y >= 0 ? maxs[i].y : mins[i].y, planes[p].z >= 0 ? maxs[i].z : mins[i].z);
+                    outside = outside || glm::dot(glm::vec3(planes[p]), positive) + planes[p].w < 0;
+                }
+                if (!outside) expected_planes.push_back(i);
+            }
+
+            if (found_box != expected_box) dt::Console(dt::CRITICAL, "BVH box query is wrong");
+            else if (found_planes != expected_planes) dt::Console(dt::CRITICAL, "BVH frustum query is wrong");
+            else dt::Console("BVH queries OK, cost: " + std::to_string(bvh.GetCost()) + ", found: " + std::to_string(found_box.size()) + " " + std::to_string(found_planes.size()));
+
+            bvh.Rebuild();
+        }
+
+        /* A ray through the boxes hits the closest one */
+        glm::vec3 origin(-150, 1, 2);
+        glm::vec3 direction = glm::normalize(glm::vec3(1, 0.05f, -0.02f));
+        int hit = -1, expected_hit = -1;
+        float distance = 0, expected_distance = 1000;
+        bvh.RayCast(origin, direction, 1000, hit, distance);
+        for (int i = 0; i < n; i++) {
+            if (!alive[i]) continue;
+            glm::vec3 t1 = (mins[i] - origin) / direction, t2 = (maxs[i] - origin) / direction;
+            glm::vec3 t_min = glm::min(t1, t2), t_max = glm::max(t1, t2);
+            float enter = std::max(std::max(t_min.x, t_min.y), std::max(t_min.z, 0.0f));
+            float exit = std::min(std::min(t_max.x, t_max.y), t_max.z);
+            if (enter <= exit && enter < expected_distance) {
+                expected_distance = enter;
+                expected_hit = i;
+            }
+        }
+        if (hit != expected_hit) dt::Console(dt::CRITICAL, "BVH ray cast is wrong");
+        else dt::Console("BVH ray cast OK, hit: " + std::to_string(hit));
+    }
+
+    {
+        /* Bin lights into clusters, every point lit by a light must find the light in its cluster */
+        math::MersenneTwisterGenerator rng(11);
+        auto random = [&](float min, float max) { return min + (max - min) * static_cast<float>(rng.genrand_int32()) / 4294967295.0f; };
+
+        float radius = game_engine::graphics::LightClusters::GetLightRadius(1.0f, 0.09f, 0.032f, 1.0f);
+        float attenuation = 1.0f / (1.0f + 0.09f * radius + 0.032f * radius * radius);
+        if (std::abs(attenuation - GAME_ENGINE_LIGHT_CLUSTERS_CUTOFF) > 1e-4f) dt::Console(dt::CRITICAL, "LightClusters radius is wrong");
+
+        const size_t width = 1280, height = 720;
+        glm::mat4 view = glm::lookAt(glm::vec3(3, -20, 12), glm::vec3(0, 10, 0), glm::vec3(0, 0, 1));
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), static_cast<float>(width) / height, 0.1f, 150.0f);
+
+        game_engine::graphics::LightClusters clusters;
+        clusters.Init(64, 16);
+        clusters.SetView(width, height, 0.1f, 150.0f);
+
+        const size_t n = 200;
+        std::vector<glm::vec4> lights(n);
+        for (size_t i = 0; i < n; i++) lights[i] = glm::vec4(random(-60, 60), random(-30, 90), random(-5, 10), random(0.5f, 12));
+        clusters.Build(view, projection, &lights[0], n);
+
+        const std::vector<uint32_t>& cluster_data = clusters.GetClusters();
+        const std::vector<uint32_t>& indices = clusters.GetLightIndices();
+        size_t points = 0, missed = 0, evaluated = 0, lit = 0;
+        while (points < 20000) {
+            glm::vec3 point(random(-60, 60), random(-30, 90), random(-5, 10));
+            glm::vec4 point_view = view * glm::vec4(point, 1);
+            glm::vec4 clip = projection * point_view;
+            glm::vec3 ndc = glm::vec3(clip) / clip.w;
+            if (clip.w <= 0 || std::abs(ndc.x) > 1 || std::abs(ndc.y) > 1 || -point_view.z < 0.1f || -point_view.z > 150.0f) continue;
+            points++;
+
+            size_t x = std::min(static_cast<size_t>((ndc.x * 0.5f + 0.5f) * width / 64), clusters.GetTilesX() - 1);
+            size_t y = std::min(static_cast<size_t>((ndc.y * 0.5f + 0.5f) * height / 64), clusters.GetTilesY() - 1);
+            size_t c = clusters.GetClusterIndex(x, y, clusters.GetSlice(-point_view.z));
+            std::vector<uint32_t> cluster_lights(indices.begin() + cluster_data[2 * c], indices.begin() + cluster_data[2 * c] + cluster_data[2 * c + 1]);
+            evaluated += cluster_lights.size();
+
+            for (size_t i = 0; i < n; i++) {
+                if (glm::length(point - glm::vec3(lights[i])) > lights[i].w) continue;
+                lit++;
+                if (std::find(cluster_lights.begin(), cluster_lights.end(), static_cast<uint32_t>(i)) == cluster_lights.end()) missed++;
+            }
+        }
+        if (missed > 0) dt::Console(dt::CRITICAL, "LightClusters missed lights: " + std::to_string(missed));
+        else dt::Console("LightClusters OK, lights per point: " + std::to_string(static_cast<float>(lit) / points) + ", evaluated per point: " + std::to_string(static_cast<float>(evaluated) / points));
+    }
+
+    {
+        /* Random inserts and removals, compared with std::unordered_map */
+        math::MersenneTwisterGenerator rng(5);
+        utl::HashTable<int, int> table(4);
+        std::unordered_map<int, int> expected;
+        bool ok = true;
+        for (int i = 0; i < 100000 && ok; i++) {
+            int key = static_cast<int>(rng.genrand_int32() % 5000);
+            if (rng.genrand_int32() % 3 == 0) {
+                ok = table.Remove(key) == (expected.erase(key) == 1);
+            } else {
+                ok = table.Insert(key, i) == expected.insert(std::make_pair(key, i)).second;
+            }
+        }
+        ok = ok && table.GetNumberOfElements() == expected.size() && table.GetLoad() <= GAME_ENGINE_HASHTABLE_MAX_LOAD;
+        for (int key = 0; key < 5000 && ok; key++) {
+            utl::HashTable<int, int>::iterator itr = table.Find(key);
+            auto expected_itr = expected.find(key);
+            if (expected_itr == expected.end()) ok = itr == table.end();
+            else ok = itr != table.end() && itr.GetValue() == expected_itr->second;
+        }
+
+        /* Erase the odd keys while iterating, every element is visited once */
+        size_t visited = 0, before = table.GetNumberOfElements();
+        for (utl::HashTable<int, int>::iterator itr = table.begin(); itr != table.end();) {
+            visited++;
+            if (itr.GetKey() % 2 == 1) itr = table.Erase(itr);
+            else ++itr;
+        }
+        for (auto itr = expected.begin(); itr != expected.end();) {
+            if (itr->first % 2 == 1) itr = expected.erase(itr);
+            else ++itr;
+        }
+        ok = ok && visited == before && table.GetNumberOfElements() == expected.size();
+        for (auto itr = expected.begin(); itr != expected.end() && ok; ++itr) ok = table.Find(itr->first) != table.end();
+
+        /* Strings are found with a const char * */
+        utl::HashTable<std::string, int> strings(2, 1.0);
+        strings.Insert("assets/models/cube.obj", 1);
+        strings.Insert("assets/models/sphere.obj", 2);
+        ok = ok && strings.Find("assets/models/sphere.obj").GetValue() == 2 && strings.Find("assets/models/cone.obj") == strings.end();
+
+        if (!ok) dt::Console(dt::CRITICAL, "HashTable is wrong");
+        else dt::Console("HashTable OK, elements: " + std::to_string(table.GetNumberOfElements()) + ", size: " + std::to_string(table.GetSize()));
+    }
+
+    {
+        /*
+            Random moves with QuadTreeFlat::Move(), compared with Remove() and Insert(), and with a brute force search.
+            Like the physics engine, the position of an object changes even when the move fails, and some moves leave
+            the region and come back
+        */
+        math::MersenneTwisterGenerator rng(7);
+        utl::QuadTreeFlat<size_t> moved(Vector2D({ -100, -100 }), 200);
+        utl::QuadTreeFlat<size_t> reinserted(Vector2D({ -100, -100 }), 200);
+        std::vector<Vector2D> positions;
+        for (size_t i = 0; i < 500; i++) {
+            positions.push_back(Vector2D({ static_cast<Real_t>(rng.genrand_real1() * 180 - 90), static_cast<Real_t>(rng.genrand_real1() * 180 - 90) }));
+            moved.Insert(positions[i], i);
+            reinserted.Insert(positions[i], i);
+        }
+
+        auto inside = [](const Vector2D& p) { return p[0] > -100 && p[0] < 100 && p[1] > -100 && p[1] < 100; };
+        bool ok = true;
+        size_t left_and_returned = 0;
+        for (int step = 0; step < 50 && ok; step++) {
+            for (size_t i = 0; i < positions.size(); i++) {
+                if (rng.genrand_int32() % 4 != 0) continue;
+
+                /* Small steps around the current position, a few of them leave the region */
+                Vector2D position({ positions[i][0] + static_cast<Real_t>(rng.genrand_real1() * 40 - 20), positions[i][1] + static_cast<Real_t>(rng.genrand_real1() * 40 - 20) });
+                position = Vector2D({ std::max(std::min(position[0], Real_t(110)), Real_t(-110)), std::max(std::min(position[1], Real_t(110)), Real_t(-110)) });
+                if (!inside(positions[i]) && inside(position)) left_and_returned++;
+
+                ok = ok && moved.Move(positions[i], position, i) == inside(position);
+                reinserted.Remove(positions[i], i);
+                reinserted.Insert(position, i);
+                positions[i] = position;
+            }
+
+            for (int q = 0; q < 50 && ok; q++) {
+                Real_t x = static_cast<Real_t>(rng.genrand_real1() * 200 - 100), y = static_cast<Real_t>(rng.genrand_real1() * 200 - 100);
+                math::AABox<2> box(Vector2D({ x, y }), Vector2D({ x + 40, y + 40 }));
+
+                std::vector<size_t> found_moved, found_reinserted, expected;
+                moved.QueryRange(box, found_moved);
+                reinserted.QueryRange(box, found_reinserted);
+                for (size_t i = 0; i < positions.size(); i++) {
+                    const Vector2D& p = positions[i];
+                    if (inside(p) && p[0] >= x && p[0] <= x + 40 && p[1] >= y && p[1] <= y + 40) expected.push_back(i);
+                }
+                std::sort(found_moved.begin(), found_moved.end());
+                std::sort(found_reinserted.begin(), found_reinserted.end());
+                ok = found_moved == expected && found_reinserted == expected;
+            }
+        }
+        size_t expected_size = std::count_if(positions.begin(), positions.end(), inside);
+        ok = ok && moved.Size() == expected_size && reinserted.Size() == expected_size && left_and_returned > 0;
+
+        if (!ok) dt::Console(dt::CRITICAL, "QuadTreeFlat::Move is wrong");
+        else dt::Console("QuadTreeFlat::Move OK, objects that left the region and came back: " + std::to_string(left_and_returned));
+    }
+
+    {
+        /* Decode binary PPM and PGM images on the decoder threads, and compare the pixels with the ones written */
+        std::vector<std::string> paths;
+        std::vector<std::vector<unsigned char>> written;
+        for (int i = 0; i < 8; i++) {
+            int width = 13 + 7 * i, height = 5 + 3 * i, channels = (i % 2 == 0) ? 3 : 1;
+            std::vector<unsigned char> pixels(width * height * channels);
+            for (size_t p = 0; p < pixels.size(); p++) pixels[p] = static_cast<unsigned char>(p * 31 + i);
+
+            std::string path = "utility_test_image_" + std::to_string(i) + ((channels == 3) ? ".ppm" : ".pgm");
+            std::string header = ((channels == 3) ? "P6\n" : "P5\n") + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+            FILE * file = fopen(path.c_str(), "wb");
+            fwrite(header.data(), 1, header.size(), file);
+            fwrite(pixels.data(), 1, pixels.size(), file);
+            fclose(file);
+
+            paths.push_back(path);
+            written.push_back(pixels);
+        }
+
+        game_engine::graphics::TextureDecoder decoder;
+        decoder.Init(2);
+        for (size_t i = 0; i < paths.size(); i++) decoder.Schedule(paths[i]);
+        decoder.Schedule("utility_test_image_missing.png");
+
+        bool ok = true;
+        size_t decoded = 0, errors = 0;
+        game_engine::graphics::DecodedImage_t image;
+        while (decoder.Wait(image)) {
+            size_t i = std::find(paths.begin(), paths.end(), image.path_) - paths.begin();
+            if (image.error_ != 0) {
+                errors++;
+                ok = ok && i == paths.size() && image.data_ == nullptr;
+                continue;
+            }
+            decoded++;
+            size_t size = static_cast<size_t>(image.width_) * image.height_ * image.channels_;
+            ok = ok && i < paths.size() && size == written[i].size() && std::equal(written[i].begin(), written[i].end(), image.data_);
+            game_engine::graphics::TextureDecoder::Free(image);
+        }
+        ok = ok && decoded == paths.size() && errors == 1 && decoder.GetNumberOfPending() == 0;
+        decoder.Destroy();
+        for (size_t i = 0; i < paths.size(); i++) remove(paths[i].c_str());
+
+        if (!ok) dt::Console(dt::CRITICAL, "TextureDecoder is wrong");
+        else dt::Console("TextureDecoder OK, images: " + std::to_string(decoded));
+    }
+
 #ifdef _WIN32
     system("pause");
 #endif
@@ -27,6 +27,12 @@ macro(SetupEnvironment)
 	)
 	find_package(OpenGL REQUIRED)
 	
+	### MEMORY ###
+	option(GAME_ENGINE_MEMORY_HEAP_COUNTER "Count the heap allocations, by replacing the global operator new" OFF)
+	if(GAME_ENGINE_MEMORY_HEAP_COUNTER)
+		add_definitions(-DGAME_ENGINE_MEMORY_HEAP_COUNTER)
+	endif()
+	
 	if(MSVC)
 		#Prepare the building environment for Windows Visual Studio
 		ADD_DEFINITIONS(-D_WIN32_WINNT=0x0501)
@@ -21,6 +21,11 @@ namespace game_engine {
         return visible_window_;
     }
 
+    size_t ConfigurationFile::GetShadowCascadeInterval()
+    {
+        return shadow_cascade_interval_;
+    }
+
     ConfigurationFile::ConfigurationFile() {
         /* Read configuration file */
         std::string file_name = "config.txt";
@@ -35,6 +40,7 @@ namespace game_engine {
             if (line_split[0] == "rendering_method") rendering_method = std::stoi(line_split[1]);
             if (line_split[0] == "ssao") ssao_ = static_cast<bool>(std::stoi(line_split[1]));
             if (line_split[0] == "visible_window") visible_window_ = static_cast<bool>(std::stoi(line_split[1]));
+            if (line_split[0] == "shadow_cascade_interval") shadow_cascade_interval_ = static_cast<size_t>(std::stoi(line_split[1]));
         }
     }
 
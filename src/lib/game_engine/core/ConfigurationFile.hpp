@@ -21,12 +21,15 @@ namespace game_engine {
 
         bool UseVisibleWindow();
 
+        size_t GetShadowCascadeInterval();
+
     private:
         ConfigurationFile();
 
         int rendering_method = 0;
         bool ssao_ = false;
         bool visible_window_ = false;
+        size_t shadow_cascade_interval_ = 1;
     };
 
 }
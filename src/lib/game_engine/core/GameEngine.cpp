@@ -3,6 +3,7 @@
 #include "ErrorCodes.hpp"
 #include "game_engine/graphics/AssetManager.hpp"
 #include "game_engine/memory/MemoryManager.hpp"
+#include "game_engine/memory/FrameAllocator.hpp"
 
 #include "debug_tools/Console.hpp"
 #include "debug_tools/CodeReminder.hpp"
@@ -58,6 +59,8 @@ namespace game_engine {
         /* Init other systems */
         frame_regulator_.Init(config_.frame_rate_, 10);
         debugger_->Init(renderer_);
+        job_system_.Init();
+        asset_manager_creation_instance.InitTextureLoading();
 
         /* Initialize standard library random numbers */
         srand(static_cast<unsigned int>(time(NULL)));
@@ -73,9 +76,11 @@ namespace game_engine {
             return last_error_;
         }
 
+        graphics::AssetManager::GetInstance().DestroyTextureLoading();
         renderer_->Destroy();
         debugger_->Destroy();
         frame_regulator_.Destroy();
+        job_system_.Destroy();
 
         is_inited_ = false;
         last_error_ = 0;
@@ -96,6 +101,9 @@ namespace game_engine {
 
         renderer_->StartFrame();
 
+        /* Upload some of the textures decoded in the background */
+        graphics::AssetManager::GetInstance().UpdateTextures();
+
         MeasureFPS(1000.0f * delta_time);
 
         /* Get some camera info, to be used to calculate the visible window */
@@ -111,10 +119,17 @@ namespace game_engine {
         /* Render a welcome overlay and the frame counter */
         renderer_->Draw2DText("Welcome!", 60, 60, 0.5f, glm::vec3(1.0f, 0.0f, 0.0f));
         renderer_->Draw2DText(std::to_string(fps_), config_.context_params_.window_width_ - 80, config_.context_params_.window_height_ - 50, 0.5f, glm::vec3(1, 0, 0));
+        renderer_->Draw2DText(std::to_string(heap_allocations_frame_), config_.context_params_.window_width_ - 80, config_.context_params_.window_height_ - 80, 0.5f, glm::vec3(1, 0, 0));
 
         /* End the frame */
         renderer_->EndFrame();
 
+        /* Free the temporary memory of the frame, and count the heap allocations made */
+        memory::FrameAllocator::ResetAll();
+        size_t heap_allocations = memory::FrameAllocator::GetHeapAllocations();
+        heap_allocations_frame_ = heap_allocations - heap_allocations_total_;
+        heap_allocations_total_ = heap_allocations;
+
         frame_regulator_.FrameEnd();
     }
 
@@ -155,9 +170,14 @@ namespace game_engine {
             return last_error_;
         }
         sector_ = world;
+        sector_->job_system_ = &job_system_;
         return 0;
     }
 
+    size_t GameEngine::GetHeapAllocationsPerFrame() {
+        return heap_allocations_frame_;
+    }
+
     Debugger * GameEngine::GetDebugger() {
         return debugger_;
     }
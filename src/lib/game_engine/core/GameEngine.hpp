@@ -7,6 +7,7 @@
 #include "game_engine/graphics/opengl/OpenGLCamera.hpp"
 #include "game_engine/graphics/Renderer.hpp"
 #include "game_engine/math/Types.hpp"
+#include "game_engine/utility/JobSystem.hpp"
 
 #include "FrameRateRegulator.hpp"
 #include "Controls.hpp"
@@ -106,6 +107,12 @@ namespace game_engine {
         */
         graphics::Renderer * GetRenderer();
 
+        /**
+            Get the number of heap allocations made during the last frame, by all threads
+            @return The number of allocations, 0 if GAME_ENGINE_MEMORY_HEAP_COUNTER is not defined
+        */
+        size_t GetHeapAllocationsPerFrame();
+
         /**
             Get the last error occured, 0 = No error
             @return The last error
@@ -121,6 +128,9 @@ namespace game_engine {
         bool is_inited_;
         int last_error_;
         size_t fps_;
+        /* Heap allocations made during the last frame, and the total at the end of it */
+        size_t heap_allocations_frame_ = 0;
+        size_t heap_allocations_total_ = 0;
 
         /* Engine configuration values */
         GameEngineConfig_t config_;
@@ -129,6 +139,7 @@ namespace game_engine {
         
         /* Instances from other parts of the system */
         FrameRateRegulator frame_regulator_;
+        utility::JobSystem job_system_;
         Debugger * debugger_ = nullptr;
         WorldSector * sector_;
         
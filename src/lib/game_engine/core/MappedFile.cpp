@@ -0,0 +1,112 @@
+#include "MappedFile.hpp"
+
+#include "ErrorCodes.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace game_engine {
+
+    MappedFile::MappedFile() {
+        is_inited_ = false;
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    MappedFile::~MappedFile() {
+        Destroy();
+    }
+
+    int MappedFile::Init(std::string file_path) {
+        if (is_inited_) return -1;
+
+#ifdef _WIN32
+        HANDLE file = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (file == INVALID_HANDLE_VALUE) return Error::ERROR_ASSET_NOT_FOUND;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+            CloseHandle(file);
+            return Error::ERROR_ASSET_NOT_FOUND;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping == NULL) {
+            CloseHandle(file);
+            return Error::ERROR_ASSET_NOT_FOUND;
+        }
+
+        void * data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (data == NULL) {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return Error::ERROR_ASSET_NOT_FOUND;
+        }
+
+        file_ = file;
+        mapping_ = mapping;
+        size_ = static_cast<size_t>(size.QuadPart);
+#else
+        int file = open(file_path.c_str(), O_RDONLY);
+        if (file == -1) return Error::ERROR_ASSET_NOT_FOUND;
+
+        struct stat file_stat;
+        if (fstat(file, &file_stat) == -1 || file_stat.st_size == 0) {
+            close(file);
+            return Error::ERROR_ASSET_NOT_FOUND;
+        }
+
+        void * data = mmap(NULL, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        if (data == MAP_FAILED) {
+            close(file);
+            return Error::ERROR_ASSET_NOT_FOUND;
+        }
+        /* The whole file is read once, front to back */
+        madvise(data, static_cast<size_t>(file_stat.st_size), MADV_SEQUENTIAL);
+
+        file_ = file;
+        size_ = static_cast<size_t>(file_stat.st_size);
+#endif
+        data_ = static_cast<const char *>(data);
+
+        is_inited_ = true;
+        return 0;
+    }
+
+    int MappedFile::Destroy() {
+        if (!is_inited_) return -1;
+
+#ifdef _WIN32
+        UnmapViewOfFile(data_);
+        CloseHandle(mapping_);
+        CloseHandle(file_);
+#else
+        munmap(const_cast<char *>(data_), size_);
+        close(file_);
+#endif
+        data_ = nullptr;
+        size_ = 0;
+
+        is_inited_ = false;
+        return 0;
+    }
+
+    bool MappedFile::IsInited() {
+        return is_inited_;
+    }
+
+    const char * MappedFile::GetData() {
+        return data_;
+    }
+
+    size_t MappedFile::GetSize() {
+        return size_;
+    }
+
+}
@@ -0,0 +1,62 @@
+#ifndef __MappedFile_hpp__
+#define __MappedFile_hpp__
+
+#include <string>
+
+namespace game_engine {
+
+    /**
+        A read only file mapped in memory. The operating system pages the file in when it is accessed, so the
+        contents can be used in place without reading them into a buffer first
+    */
+    class MappedFile {
+    public:
+        MappedFile();
+
+        ~MappedFile();
+
+        /**
+            Map a file in memory
+            @param file_path The path of the file
+            @return 0=OK, -1=Already initialised, else see ErrorCodes.hpp
+        */
+        int Init(std::string file_path);
+
+        /**
+            Unmap the file
+            @return 0=OK, -1=Not initialised
+        */
+        int Destroy();
+
+        bool IsInited();
+
+        /**
+            Get the contents of the file, valid until Destroy()
+            @return A pointer to the first byte
+        */
+        const char * GetData();
+
+        /**
+            Get the size of the file
+            @return The size in bytes
+        */
+        size_t GetSize();
+
+    private:
+        bool is_inited_;
+        const char * data_;
+        size_t size_;
+#ifdef _WIN32
+        void * file_;
+        void * mapping_;
+#else
+        int file_;
+#endif
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+    };
+
+}
+
+#endif
@@ -48,6 +48,9 @@ namespace game_engine {
     int WorldObject::Destroy() {
         
         if (!is_inited_) return Error::ERROR_GEN_NOT_INIT;
+
+        /* Destroy after the parallel step, graphics resources are released here */
+        if (world_sector_ != nullptr && world_sector_->DeferCommand({ WorldSector::WorldCommand_t::DESTROY_OBJECT, this, 0, 0, 0, false })) return 0;
         
         GraphicsObject::Destroy();
 
@@ -90,6 +93,9 @@ namespace game_engine {
         /* Maybe not assertion but return something */
         _assert(world_sector_ != nullptr);
 
+        /* During a parallel step, the world is read only, move the object after the step */
+        if (world_sector_->DeferCommand({ WorldSector::WorldCommand_t::SET_POSITION, this, pos_x, pos_y, pos_z, collision_check })) return;
+
         math::Vector2D new_pos(pos_x, pos_y);
         if (collision_check){
             new_pos = world_sector_->GetPhysicsEngine()->CheckCollision(this, new_pos);
@@ -97,7 +103,7 @@ namespace game_engine {
         }
 
         /* Update the object's position inside the world sector */
-        world_sector_->UpdateObjectInWorldStructure(this, GetX(), GetY(), new_pos[0], new_pos[1]);
+        world_sector_->UpdateObjectInWorldStructure(this, new_pos[0], new_pos[1]);
         
         /* Set the position in the physics layer */
         
@@ -107,6 +113,10 @@ namespace game_engine {
         GraphicsObject::SetPosition(new_pos[0], new_pos[1], pos_z);
     }
 
+    void WorldObject::SetParallelStep(bool parallel_step) {
+        parallel_step_ = parallel_step;
+    }
+
     void WorldObject::Scale(Real_t scale_x, Real_t scale_y, Real_t scale_z) {
         if (!(math::Equal(scale_x, scale_y) && math::Equal(scale_y, scale_z))) dt::Console(dt::WARNING, "Non uniform scale");
         
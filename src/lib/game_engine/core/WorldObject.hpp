@@ -11,6 +11,7 @@
 #include "game_engine/physics/PhysicsObject.hpp"
 #include "game_engine/memory/ArrayAllocator.hpp"
 #include "game_engine/memory/PoolAllocator.hpp"
+#include "game_engine/memory/ConcurrentPoolAllocator.hpp"
 
 #include "debug_tools/Console.hpp"
 
@@ -25,6 +26,8 @@ namespace game_engine {
     class WorldObject : public physics::PhysicsObject, public graphics::GraphicsObject {
         friend WorldSector;
     public:
+        /* The value of the world cell, when the object is not stored in a world sector */
+        static const size_t WORLD_CELL_NONE = static_cast<size_t>(-1);
 
         /**
             Does nothing in particular. Call Init()
@@ -81,6 +84,33 @@ namespace game_engine {
             return address;
         }
 
+        /**
+            Custom sequential allocation from a pool shared by many threads
+        */
+        void * operator new(size_t size, memory::ConcurrentPoolAllocator * pool_objects) {
+
+            if (pool_objects->GetBlockSize() < size) {
+
+                debug_tools::ConsoleInfoL(debug_tools::FATAL,
+                    "WorldObject memory allocation, failed, size does not fit inside the block used",
+                    "Requested size: ", size);
+
+                throw std::bad_alloc();
+            }
+
+            void * address = pool_objects->Allocate();
+            if (address == nullptr) {
+
+                debug_tools::ConsoleInfoL(debug_tools::FATAL,
+                    "WorldObject memory allocation, ConcurrentPoolAllocator::Allocate() failed, out of memory",
+                    "Requested size: ", size);
+
+                throw std::bad_alloc();
+            }
+
+            return address;
+        }
+
         void operator delete(void * ptr) {
             debug_tools::Console(debug_tools::FATAL, "WorldObject simple memory allocation failed");
             delete ptr;
@@ -94,6 +124,10 @@ namespace game_engine {
             debug_tools::Console(debug_tools::FATAL, "WorldObject pool allocation failed");
         }
 
+        void operator delete(void * ptr, memory::ConcurrentPoolAllocator * pool_objects) {
+            debug_tools::Console(debug_tools::FATAL, "WorldObject pool allocation failed");
+        }
+
         /**
             Initialize the object. Sets the OpenGL model and texture of the object. Sets the initial position
             @return 0=OK, else see ErrorCodes.hpp
@@ -119,7 +153,9 @@ namespace game_engine {
 
         /**
             Function that should be overriden for custom step behaviour. Step() is called,
-            and then Draw() is called
+            and then Draw() is called. Step() runs in parallel with the Step() of other objects if the object
+            opts in, see SetParallelStep(). Changes to the world, i.e. SetPosition(), are then applied after all 
+            objects have stepped
         */
         virtual void Step(double delta_time);
 
@@ -137,6 +173,15 @@ namespace game_engine {
         */
         void SetPosition(Real_t pos_x, Real_t pos_y, Real_t pos_z, bool collision_check = true);
 
+        /**
+            Set whether the object can be stepped in parallel with other objects. Only objects whose Step() 
+            changes the world through SetPosition(), Destroy(), WorldSector::AddObject() and 
+            WorldSector::RemoveObject(), which are deferred, and doesn't change any other shared state, should. 
+            Default is false
+            @param parallel_step Parallel step or not
+        */
+        void SetParallelStep(bool parallel_step);
+
         /**
             Scale the object, sets the scale matrix. Collision detection is NOT changed TODO
             @param Scale amount in axis x
@@ -158,6 +203,13 @@ namespace game_engine {
     private:
 
         bool is_inited_;
+
+        /* The cell of the world sector grid that holds this object, and the slot inside that cell */
+        size_t world_cell_ = WORLD_CELL_NONE;
+        size_t world_slot_ = 0;
+
+        /* Can the object be stepped in parallel with other objects */
+        bool parallel_step_ = false;
     };
 
 }
@@ -19,6 +19,8 @@ namespace gr = game_engine::graphics;
 
 namespace game_engine {
 
+    thread_local std::vector<WorldSector::WorldCommand_t> * WorldSector::deferred_commands_ = nullptr;
+
     WorldSector::WorldSector() {
         physics_engine_ = new physics::PhysicsEngine();
         is_inited_ = false;
@@ -45,11 +47,11 @@ namespace game_engine {
         world_window_ = AABox<2>(Vector2D(x_margin_start, y_margin_start), Vector2D(x_margin_end, y_margin_end));
 
         /* Initialize the world grid */
-        world_ = new utility::UniformGrid<std::deque<WorldObject *>, 2>({ grid_rows_, grid_columns_});
-        visible_world_ = std::vector<WorldObject *>(650, nullptr);
+        world_ = std::vector<std::vector<WorldObject *>>(grid_rows_ * grid_columns_);
+        visible_world_.reserve(elements);
 
         /* Initialize point lights data structure */
-        world_point_lights_ = new utility::QuadTree<graphics::PointLight *>(math::Vector2D(x_margin_start_, y_margin_start_), std::max(y_margin_end_ - y_margin_start_, x_margin_end_ - x_margin_start_));
+        world_point_lights_ = new utility::QuadTreeFlat<graphics::PointLight *>(math::Vector2D(x_margin_start_, y_margin_start_), std::max(y_margin_end_ - y_margin_start_, x_margin_end_ - x_margin_start_));
 
         /* Initialize physics engine */
         physics_engine_->Init(AABox<2>(Vector2D(x_margin_start_, y_margin_start), Vector2D(x_margin_end_, y_margin_end)), 500);
@@ -68,7 +70,7 @@ namespace game_engine {
             Real_t max_y = std::max(std::abs(y_margin_start_), std::abs(y_margin_end_));
             Real_t max = std::max(max_x, max_y);
             /* Initialize acceleration data structure for ray casting */
-            interaction_tree_ = new utility::QuadTreeBoxes<Interactablebject *>(math::Vector2D(-max), 2 * max);
+            interaction_tree_ = new utility::QuadTreeBoxes<Interactablebject *, 1, 13, memory::FrameVector<Interactablebject *>>(math::Vector2D(-max), 2 * max);
         }
 
         is_inited_ = true;
@@ -79,7 +81,8 @@ namespace game_engine {
         
         CodeReminder("Iterate through the world objects, and call their Destroy()");
         
-        delete world_;
+        world_.clear();
+        visible_world_.clear();
          
         is_inited_ = false;
         return 0;
@@ -114,11 +117,11 @@ namespace game_engine {
         else
             nof = GetObjectsWindow(world_window_, visible_world_);
 
+        /* Find the pairs of objects that can collide this frame */
+        physics_engine_->Step();
+
         /* Step all the objects one frame */
-        for (size_t i = 0; i < nof; i++) {
-            WorldObject * visible_object = visible_world_[i];
-            visible_object->Step(delta_time);
-        }
+        StepObjects(delta_time, nof);
         if (directional_light_ != nullptr) directional_light_->StepLight(delta_time);
 
         /* Draw visible world */
@@ -137,8 +140,8 @@ namespace game_engine {
         /* (2 * width) whould be exactly inside the camera view, 4* gives us a little bigger rectangle */
         math::AABox<2> camera_view_lights_box = math::AABox<2>(Vector2D(camera_position.x(), camera_position.y()), { 1.4f * width * camera_ratio, 1.4f * width });
 
-        /* Get all point lights within the visible world */
-        std::vector<graphics::PointLight *> lights_;
+        /* Get all point lights within the visible world, in memory freed at the end of the frame */
+        memory::FrameVector<graphics::PointLight *> lights_;
         if (use_visible_world_window_)
             world_point_lights_->QueryRange(camera_view_lights_box, lights_);
         else
@@ -155,6 +158,8 @@ namespace game_engine {
 
     int WorldSector::AddObject(WorldObject * object, Real_t x, Real_t y, Real_t z) {
 
+        if (DeferCommand({ WorldCommand_t::ADD_OBJECT, object, x, y, z, false })) return 0;
+
         InsertObjectToWorldStructure(object, x, y, z);
 
         /* Set the position in the graphics layer */
@@ -170,6 +175,8 @@ namespace game_engine {
         
         _assert(0 == 1);
 
+        if (DeferCommand({ WorldCommand_t::REMOVE_OBJECT, object, 0, 0, 0, false })) return 0;
+
         /* Remove from world structure */
         RemoveObjectFromWorldStructure(object);
 
@@ -183,7 +190,7 @@ namespace game_engine {
     }
 
     int WorldSector::RemovePointLight(graphics::PointLight * light, math::Vector2D& point) {
-        world_point_lights_->Remove(point);
+        world_point_lights_->Remove(point, light);
         return 0;
     }
 
@@ -200,7 +207,7 @@ namespace game_engine {
     }
 
     Interactablebject * WorldSector::RayCast(math::Ray2D ray) {
-        std::vector<Interactablebject *> results;
+        memory::FrameVector<Interactablebject *> results;
         bool ret = interaction_tree_->RayCast(ray, results);
         
         /* Return the first result */
@@ -229,20 +236,14 @@ namespace game_engine {
         if (col_start < 0) col_start = 0;
         if (col_end >= grid_columns_) col_end = grid_columns_ - 1;
 
-        size_t index = 0;
+        objects.clear();
         for (int i = row_start; i <= row_end; i++) {
-            for (int j = col_start; j <= col_end; j++) {
-                for (std::deque<WorldObject*>::iterator itr = world_->at(i, j).begin(); itr != world_->at(i, j).end(); ++itr) {
-                    if (index > objects.size() - 1) {
-                        dt::Console(dt::WARNING, "WorldSector::GetObjetcsWindow() Objects overflow");
-                        return index;
-                    }
-                    objects[index++] = *itr;
-                }
-
+            /* The cells of a row are sequential */
+            for (size_t cell = i * grid_columns_ + col_start; cell <= i * grid_columns_ + col_end; cell++) {
+                objects.insert(objects.end(), world_[cell].begin(), world_[cell].end());
             }
         }
-        return index;
+        return objects.size();
     }
 
     physics::PhysicsEngine * WorldSector::GetPhysicsEngine() {
@@ -269,57 +270,63 @@ namespace game_engine {
         return static_cast<int>(std::round(index));
     }
 
+    size_t WorldSector::GetCell(Real_t x_coordinate, Real_t y_coordinate) {
+        int row = std::min(std::max(GetRow(y_coordinate), 0), (int)grid_rows_ - 1);
+        int column = std::min(std::max(GetColumn(x_coordinate), 0), (int)grid_columns_ - 1);
+        return row * grid_columns_ + column;
+    }
+
+    void WorldSector::PushObjectToCell(WorldObject * object, size_t cell) {
+        std::vector<WorldObject *> & objects = world_[cell];
+        object->world_cell_ = cell;
+        object->world_slot_ = objects.size();
+        objects.push_back(object);
+    }
+
+    void WorldSector::PopObjectFromCell(WorldObject * object) {
+        std::vector<WorldObject *> & objects = world_[object->world_cell_];
+        _assert(objects[object->world_slot_] == object);
+
+        /* Move the last object of the cell to the empty slot */
+        WorldObject * last = objects.back();
+        objects[object->world_slot_] = last;
+        last->world_slot_ = object->world_slot_;
+        objects.pop_back();
+
+        object->world_cell_ = WorldObject::WORLD_CELL_NONE;
+    }
 
     int WorldSector::InsertObjectToWorldStructure(WorldObject * object, Real_t x, Real_t y, Real_t z) {
         if (!is_inited_) return Error::ERROR_GEN_NOT_INIT;
 
-        size_t index_row = GetRow(y);
-        size_t index_col = GetColumn(x);
+        /* Inserting an object twice moves it */
+        if (object->world_sector_ == this && object->world_cell_ != WorldObject::WORLD_CELL_NONE) PopObjectFromCell(object);
 
-        world_->at(index_row, index_col).push_back(object);
+        PushObjectToCell(object, GetCell(x, y));
         object->world_sector_ = this;
 
         return 0;
     }
 
-    void WorldSector::UpdateObjectInWorldStructure(WorldObject * object, Real_t old_pos_x, Real_t old_pos_y, Real_t new_pos_x, Real_t new_pos_y) {
+    void WorldSector::UpdateObjectInWorldStructure(WorldObject * object, Real_t new_pos_x, Real_t new_pos_y) {
 
-        /* TODO Do some checkig on the object */
+        if (object->world_cell_ == WorldObject::WORLD_CELL_NONE) {
+            dt::Console(dt::WARNING, "WorldSector::UpdateObjectInWorldStructure(): Object is not in the world");
+            return;
+        }
 
-        /* Find the old and new position */
-        size_t old_pos_index_row = GetRow(old_pos_y);
-        size_t old_pos_index_col = GetColumn(old_pos_x);
-        size_t new_pos_index_row = GetRow(new_pos_y);
-        size_t new_pos_index_col = GetColumn(new_pos_x);
         /* If no moving is required then leave */
+        size_t new_cell = GetCell(new_pos_x, new_pos_y);
+        if (new_cell == object->world_cell_) return;
 
-        if ((old_pos_index_row == new_pos_index_row) && (old_pos_index_col == new_pos_index_col)) return;
-
-        /* Remove from the old position */
-        std::deque<WorldObject *> & objects = world_->at(old_pos_index_row, old_pos_index_col);
-        for (std::deque<WorldObject *>::iterator itr = objects.begin(); itr != objects.end(); ++itr) {
-            if (*itr == object) {
-                objects.erase(itr);
-                break;
-            }
-        }
-
-        /* Add to new position */
-        world_->at(new_pos_index_row, new_pos_index_col).push_back(object);
+        PopObjectFromCell(object);
+        PushObjectToCell(object, new_cell);
     }
 
     void WorldSector::RemoveObjectFromWorldStructure(WorldObject * object) {
-        size_t index_row = GetRow(object->GetY());
-        size_t index_col = GetColumn(object->GetX());
-
-        std::deque<WorldObject *> & objects = world_->at(index_row, index_col);
-        for (std::deque<WorldObject *>::iterator itr = objects.begin(); itr != objects.end(); ++itr) {
-            if (*itr == object) {
-                objects.erase(itr);
-                break;
-            }
-        }
+        if (object->world_cell_ == WorldObject::WORLD_CELL_NONE) return;
 
+        PopObjectFromCell(object);
     }
 
     void WorldSector::DeleteObj(WorldObject * object) {
@@ -344,5 +351,74 @@ namespace game_engine {
 
     }
 
-}
+    void WorldSector::StepObjects(double delta_time, size_t number_of_objects) {
 
+        /* Parallel step is opt in, don't start jobs if no visible object asked for it */
+        bool parallel_step = false;
+        for (size_t i = 0; i < number_of_objects && !parallel_step; i++) parallel_step = visible_world_[i]->parallel_step_;
+
+        if (job_system_ == nullptr || !job_system_->IsInited() || !parallel_step) {
+            for (size_t i = 0; i < number_of_objects; i++) {
+                visible_world_[i]->Step(delta_time);
+            }
+            return;
+        }
+
+        size_t number_of_batches = (number_of_objects + WORLD_SECTOR_STEP_BATCH_SIZE - 1) / WORLD_SECTOR_STEP_BATCH_SIZE;
+        if (step_commands_.size() < number_of_batches) step_commands_.resize(number_of_batches);
+
+        /* 
+            Step the objects in parallel. The world is read only during this, every change an object makes in the
+            world is stored in the command buffer of its batch
+        */
+        job_system_->ParallelFor(number_of_objects, WORLD_SECTOR_STEP_BATCH_SIZE, [&](size_t batch, size_t start, size_t end) {
+            std::vector<WorldCommand_t> & commands = step_commands_[batch];
+            commands.clear();
+
+            deferred_commands_ = &commands;
+            for (size_t i = start; i < end; i++) {
+                WorldObject * visible_object = visible_world_[i];
+                if (visible_object->parallel_step_) visible_object->Step(delta_time);
+            }
+            deferred_commands_ = nullptr;
+        });
+
+        /* Sync point, apply the changes in the order of the objects, the same order as a serial step */
+        for (size_t batch = 0; batch < number_of_batches; batch++) {
+            std::vector<WorldCommand_t> & commands = step_commands_[batch];
+            for (size_t i = 0; i < commands.size(); i++) ApplyCommand(commands[i]);
+        }
+
+        /* Objects that need to see their changes immediately are stepped serially */
+        for (size_t i = 0; i < number_of_objects; i++) {
+            WorldObject * visible_object = visible_world_[i];
+            if (!visible_object->parallel_step_) visible_object->Step(delta_time);
+        }
+    }
+
+    bool WorldSector::DeferCommand(WorldCommand_t command) {
+        if (deferred_commands_ == nullptr) return false;
+
+        deferred_commands_->push_back(command);
+        return true;
+    }
+
+    void WorldSector::ApplyCommand(WorldCommand_t& command) {
+        switch (command.type_)
+        {
+        case WorldCommand_t::SET_POSITION:
+            command.object_->SetPosition(command.x_, command.y_, command.z_, command.collision_check_);
+            break;
+        case WorldCommand_t::ADD_OBJECT:
+            AddObject(command.object_, command.x_, command.y_, command.z_);
+            break;
+        case WorldCommand_t::REMOVE_OBJECT:
+            RemoveObject(command.object_);
+            break;
+        case WorldCommand_t::DESTROY_OBJECT:
+            command.object_->Destroy();
+            break;
+        }
+    }
+
+}
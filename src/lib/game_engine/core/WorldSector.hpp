@@ -2,13 +2,14 @@
 #define __WorldSector_hpp__
 
 #include <vector>
-#include <deque>
 
 #include "game_engine/memory/MemoryManager.hpp"
+#include "game_engine/memory/FrameAllocator.hpp"
 #include "game_engine/utility/CircularBuffer.hpp"
 #include "game_engine/utility/QuadTree.hpp"
-#include "game_engine/utility/UniformGrid.hpp"
+#include "game_engine/utility/QuadTreeFlat.hpp"
 #include "game_engine/utility/QuadTreeBoxes.hpp"
+#include "game_engine/utility/JobSystem.hpp"
 #include "game_engine/physics/PhysicsEngine.hpp"
 #include "game_engine/graphics/Renderer.hpp"
 #include "game_engine/math/Types.hpp"
@@ -17,6 +18,9 @@
 #include "WorldObject.hpp"
 #include "InteractableObject.hpp"
 
+/* Number of objects stepped by a single job. The batches must not depend on the number of threads */
+#define WORLD_SECTOR_STEP_BATCH_SIZE 128
+
 namespace game_engine {
     
     /**
@@ -90,17 +94,19 @@ namespace game_engine {
         }
 
         /**
-            Steps the world  
+            Steps the world. Objects are stepped in parallel batches, if a job system is set. The changes they make 
+            in the world are deferred, and applied after all batches have finished, in the order of the objects. 
+            Then the objects that don't allow a parallel step are stepped, and all objects are drawn
         */
         void Step(double delta_time, graphics::Renderer * renderer, math::Vector3D camera_position, math::Vector3D camera_direction, Real_t camera_ratio, Real_t camera_angle);
 
         /**
-            Add an object in the world
+            Add an object in the world. Deferred if called during a parallel step
         */
         int AddObject(WorldObject * object, Real_t x, Real_t y, Real_t z);
 
         /**
-            Remove an object from the world
+            Remove an object from the world. Deferred if called during a parallel step
         */
         int RemoveObject(WorldObject * object);
 
@@ -135,11 +141,11 @@ namespace game_engine {
         Interactablebject * RayCast(math::Ray2D ray);
 
         /**
-            Get a window of object in the world. Objects are assigned sequentially to the visible world 
-            vector. Does not allocate any new memory
+            Get a window of object in the world. The objects vector is cleared, and the objects are appended 
+            cell by cell. The vector grows if needed, reuse it between calls to avoid allocations
             @param rect The rectangle-window to get the objects. The MUST be in Axis aligned - ABCD correct form
-            @param[out] visible_world The vector with pointers to the objects window
-            @return The number of objects assigned to the visible_world vector
+            @param[out] objects The vector with pointers to the objects window
+            @return The number of objects assigned to the objects vector
         */
         size_t GetObjectsWindow(math::AABox<2> rect, std::vector<WorldObject *> & objects);
 
@@ -150,24 +156,38 @@ namespace game_engine {
         physics::PhysicsEngine * GetPhysicsEngine();
 
     private:
+        /* A change in the world requested by an object during a parallel step */
+        struct WorldCommand_t {
+            enum Type {
+                SET_POSITION,
+                ADD_OBJECT,
+                REMOVE_OBJECT,
+                DESTROY_OBJECT,
+            };
+            Type type_;
+            WorldObject * object_;
+            Real_t x_, y_, z_;
+            bool collision_check_;
+        };
+
         bool is_inited_;
         Real_t x_margin_start_, x_margin_end_, y_margin_start_, y_margin_end_;
 
         /* 
-            A 2x2 uniform grid that resembles the world. Holds pointers to actual objects that are stored 
-            sequentially
+            A 2D uniform grid that resembles the world, stored row by row. Every cell holds the pointers to its 
+            objects sequentially. Every object knows its cell and its slot inside the cell
         */
-        utility::UniformGrid<std::deque<WorldObject *>, 2> * world_;
+        std::vector<std::vector<WorldObject *>> world_;
         size_t grid_rows_, grid_columns_;
         /* Holds the AABox of the 2D world */
         math::AABox<2> world_window_;
         /* Use the whole world, or the visible part only for rendering? */
         bool use_visible_world_window_ = false;
-        /* A vector that holds the visible objects, updated during every frame */
+        /* A vector that holds the visible objects, updated during every frame, grows as needed */
         std::vector<WorldObject *> visible_world_;
         
         /* A struct that holds the world's lights */
-        utility::QuadTree<graphics::PointLight *> * world_point_lights_;
+        utility::QuadTreeFlat<graphics::PointLight *> * world_point_lights_;
         /* The directional light of the world */
         graphics::DirectionalLight * directional_light_ = nullptr;
 
@@ -177,7 +197,14 @@ namespace game_engine {
         physics::PhysicsEngine * physics_engine_;
         
         /* Acceleration data structure for ray casting */
-        utility::QuadTreeBoxes<Interactablebject *> * interaction_tree_;
+        utility::QuadTreeBoxes<Interactablebject *, 1, 13, memory::FrameVector<Interactablebject *>> * interaction_tree_;
+
+        /* The job system used to step the objects, set by the GameEngine. If nullptr, objects are stepped serially */
+        utility::JobSystem * job_system_ = nullptr;
+        /* The commands deferred by every batch of the parallel step */
+        std::vector<std::vector<WorldCommand_t>> step_commands_;
+        /* The command buffer of the batch that the calling thread steps, nullptr outside of the parallel step */
+        static thread_local std::vector<WorldCommand_t> * deferred_commands_;
 
         /**
             Get the row in the world based in the vertical coordiate
@@ -193,6 +220,27 @@ namespace game_engine {
         */
         int GetColumn(Real_t x_coordinate);
 
+        /**
+            Get the cell of the world grid for a position
+            @param x_coordinate The horizontal coordinate
+            @param y_coordinate The vertical coordinate
+            @return The index of the cell in the world_ grid
+        */
+        size_t GetCell(Real_t x_coordinate, Real_t y_coordinate);
+
+        /**
+            Append an object in a cell of the world grid, and set its cell and slot
+            @param object The object
+            @param cell The cell
+        */
+        void PushObjectToCell(WorldObject * object, size_t cell);
+
+        /**
+            Remove an object from its cell in constant time. The last object of the cell takes its slot
+            @param object The object
+        */
+        void PopObjectFromCell(WorldObject * object);
+
         /**
             Inserts a new object to the world.
             @param object A pointer to the object to insert
@@ -206,12 +254,10 @@ namespace game_engine {
         /**
             Updates the position of an object in the world
             @param object The object
-            @param old_pos_x The old position x coordinate
-            @param old_pos_y The old position y coordinate
             @param new_pos_x The new position x coordinate
             @param new_pos_y The new position y coordinate
         */
-        void UpdateObjectInWorldStructure(WorldObject * object, Real_t old_pos_x, Real_t old_pos_y, Real_t new_pos_x, Real_t new_pos_y);
+        void UpdateObjectInWorldStructure(WorldObject * object, Real_t new_pos_x, Real_t new_pos_y);
 
         /**
             Remove the object from the world
@@ -229,6 +275,26 @@ namespace game_engine {
         */
         void FlushObjectDelete();
 
+        /**
+            Step the visible objects one frame
+            @param delta_time The frame delta time
+            @param number_of_objects The number of objects in the visible_world_ vector
+        */
+        void StepObjects(double delta_time, size_t number_of_objects);
+
+        /**
+            Store a command for later, if the calling thread is stepping objects in parallel
+            @param command The command
+            @return true = Deferred, false = Not in a parallel step, the caller must execute it now
+        */
+        bool DeferCommand(WorldCommand_t command);
+
+        /**
+            Execute a deferred command
+            @param command The command
+        */
+        void ApplyCommand(WorldCommand_t& command);
+
     };
 
 }
@@ -1,5 +1,10 @@
 #include "AssetManager.hpp"
 
+#include <cstdio>
+#include <limits>
+
+#include "game_engine/core/ErrorCodes.hpp"
+
 #include "debug_tools/Console.hpp"
 namespace dt = debug_tools;
 namespace utl = game_engine::utility;
@@ -11,6 +16,8 @@ namespace graphics {
     size_t MODELS_NUMBER = 512;
     size_t TEXTURES_NUMBER = 512;
     size_t MATERIALS_NUMBER = 512;
+    size_t TEXTURE_DECODER_THREADS = GAME_ENGINE_TEXTURE_DECODER_THREADS;
+    size_t TEXTURE_UPLOAD_BYTES_PER_FRAME = 4 * 1024 * 1024;
 
     AssetManager::AssetManager() {
 
@@ -77,22 +84,87 @@ namespace graphics {
         
         /* Try to find if it was previously inserted */
         gl::OpenGLTexture * previously_allocated_texture = FindTexture(name);
+        if (previously_allocated_texture) return previously_allocated_texture;
 
         /* Else initialize it and insert it */
         int ret = 0;
-        if (!previously_allocated_texture) {
-            previously_allocated_texture = new gl::OpenGLTexture();
-            ret = previously_allocated_texture->Init(name, type);
-        
-            if (!ret) InsertTexture(name, previously_allocated_texture);
-            else {
-                dt::Console(dt::WARNING, "Can't find texture: " + name);
+        previously_allocated_texture = new gl::OpenGLTexture();
+        if (texture_decoder_.IsInited()) {
+            /* Only check that the file exists here, and decode it on the decoder threads */
+            FILE * file = fopen(name.c_str(), "rb");
+            if (file != NULL) {
+                fclose(file);
+                previously_allocated_texture->InitPlaceholder(type);
+                texture_decoder_.Schedule(name);
+            } else {
+                ret = Error::ERROR_ASSET_NOT_FOUND;
             }
+        } else {
+            ret = previously_allocated_texture->Init(name, type);
+        }
+
+        if (!ret) {
+            InsertTexture(name, previously_allocated_texture);
+            return previously_allocated_texture;
         }
 
-        if (!ret) return previously_allocated_texture;
-        else return nullptr;
+        dt::Console(dt::WARNING, "Can't find texture: " + name);
+        delete previously_allocated_texture;
+        return nullptr;
+    }
+
+    int AssetManager::InitTextureLoading() {
+        if (texture_decoder_.IsInited()) return -1;
+
+        texture_decoder_.Init(TEXTURE_DECODER_THREADS);
+        texture_uploader_.Init();
+        return 0;
+    }
+
+    int AssetManager::DestroyTextureLoading() {
+        if (!texture_decoder_.IsInited()) return -1;
+
+        texture_decoder_.Destroy();
+        texture_uploader_.Destroy();
+        textures_loaded_.clear();
+        return 0;
+    }
+
+    size_t AssetManager::UpdateTextures() {
+        textures_loaded_.clear();
+        if (!texture_decoder_.IsInited()) return 0;
+
+        DecodedImage_t image;
+        while (texture_decoder_.Poll(image)) UploadTexture(image);
+
+        return texture_uploader_.Update(TEXTURE_UPLOAD_BYTES_PER_FRAME, textures_loaded_);
+    }
+
+    size_t AssetManager::WaitTextures() {
+        textures_loaded_.clear();
+        if (!texture_decoder_.IsInited()) return 0;
+
+        DecodedImage_t image;
+        while (texture_decoder_.Wait(image)) UploadTexture(image);
+
+        return texture_uploader_.Update(std::numeric_limits<size_t>::max(), textures_loaded_);
+    }
+
+    size_t AssetManager::GetNumberOfLoadingTextures() {
+        return texture_decoder_.GetNumberOfPending() + texture_uploader_.GetNumberOfQueued();
+    }
+
+    const std::vector<std::string>& AssetManager::GetLoadedTextures() {
+        return textures_loaded_;
+    }
+
+    void AssetManager::UploadTexture(const DecodedImage_t& image) {
+        if (image.error_ != 0) {
+            dt::Console(dt::WARNING, "Can't decode texture: " + image.path_);
+            return;
+        }
 
+        texture_uploader_.Schedule(FindTexture(image.path_), image);
     }
 
     Material * AssetManager::FindMaterial(std::string name) {
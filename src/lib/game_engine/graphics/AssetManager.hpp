@@ -2,11 +2,14 @@
 #define __AssetManager_hpp__
 
 #include <string>
+#include <vector>
 
 #include "game_engine/utility/HashTable.hpp"
 #include "game_engine/graphics/Model.hpp"
 #include "game_engine/graphics/Material.hpp"
+#include "game_engine/graphics/TextureDecoder.hpp"
 #include "game_engine/graphics/opengl/OpenGLTexture.hpp"
+#include "game_engine/graphics/opengl/OpenGLTextureUploader.hpp"
 #include "game_engine/graphics/opengl/OpenGLShaders.hpp"
 
 
@@ -15,6 +18,9 @@ namespace graphics {
 
     extern size_t MODELS_NUMBER;
     extern size_t TEXTURES_NUMBER;
+    /* The threads that decode textures, and the bytes of textures uploaded per frame, see InitTextureLoading() */
+    extern size_t TEXTURE_DECODER_THREADS;
+    extern size_t TEXTURE_UPLOAD_BYTES_PER_FRAME;
 
     /**
         A signleton class to manage game assets. Quick search for an asset,
@@ -65,13 +71,52 @@ namespace graphics {
         void InsertTexture(std::string name, opengl::OpenGLTexture * texture);
 
         /**
-            Try to find a shader, if not found, initialize, insert, and return a pointer to it
+            Try to find a texture, if not found, initialize, insert, and return a pointer to it. If texture loading
+            is initialised, the texture shows a placeholder until its image is decoded and uploaded, see UpdateTextures()
             @param name The name of the texture
             @param type The type of the texture. Used only if initializing
             @return A pointer to the texture, nullptr if not found, and can't initialize it 
         */
         opengl::OpenGLTexture * GetTexture(std::string name, int type);
 
+        /**
+            Start loading the new textures asynchronously. Their files are decoded on TEXTURE_DECODER_THREADS threads,
+            and uploaded during UpdateTextures(). Needs an OpenGL context
+            @return 0=OK, -1=Already initialised
+        */
+        int InitTextureLoading();
+
+        /**
+            Stop loading textures asynchronously. The textures not loaded yet keep their placeholder
+            @return 0=OK, -1=Not initialised
+        */
+        int DestroyTextureLoading();
+
+        /**
+            Upload the decoded textures, up to TEXTURE_UPLOAD_BYTES_PER_FRAME bytes. Call once per frame, on the
+            thread of the OpenGL context
+            @return The number of textures that finished loading, see GetLoadedTextures()
+        */
+        size_t UpdateTextures();
+
+        /**
+            Wait for all the textures being loaded, and upload them regardless of the bytes per frame
+            @return The number of textures that finished loading, see GetLoadedTextures()
+        */
+        size_t WaitTextures();
+
+        /**
+            Get the number of textures that show a placeholder, and are still being loaded
+            @return The number of textures
+        */
+        size_t GetNumberOfLoadingTextures();
+
+        /**
+            Get the names of the textures that finished loading during the last UpdateTextures() or WaitTextures()
+            @return The names
+        */
+        const std::vector<std::string>& GetLoadedTextures();
+
         /**
             Search for a material, based on an ID
             @param name The ID of the material
@@ -95,10 +140,21 @@ namespace graphics {
         /* Holds the material */
         utility::HashTable<std::string, Material *> * materials_;
 
+        /* Asynchronous texture loading */
+        TextureDecoder texture_decoder_;
+        opengl::OpenGLTextureUploader texture_uploader_;
+        std::vector<std::string> textures_loaded_;
+
         /**
             Does nothing in particular. Call Init()
         */
         AssetManager();
+
+        /**
+            Schedule the upload of a decoded texture, or report the error
+            @param image The decoded image
+        */
+        void UploadTexture(const DecodedImage_t& image);
     };
 
 }
@@ -15,7 +15,22 @@ namespace graphics{
 
         std::string directory = FileSystem::GetInstance().GetDirectoryAssets();
         std::string full_path = directory + "/" + file_path;
-
+        std::string cache_path = full_path + GAME_ENGINE_MESH_CACHE_EXTENSION;
+
+        /* Create the meshes straight from the cache, if it was written from the current source files */
+        uint64_t source_hash = 0;
+        bool has_hash = MeshCache::HashSource(full_path, source_hash) == 0;
+        MeshCache cache;
+        if (has_hash && cache.Init(cache_path, source_hash) == 0) {
+            for (size_t i = 0; i < cache.GetNumberOfMeshes(); i++) {
+                const MeshCacheMesh_t& mesh = cache.GetMesh(i);
+                glm::vec3 bounding_box[2] = { glm::vec3(mesh.min_[0], mesh.min_[1], mesh.min_[2]), glm::vec3(mesh.max_[0], mesh.max_[1], mesh.max_[2]) };
+                out_meshes.push_back(CreateMesh(cache.GetVertices(i), mesh.number_of_vertices_, cache.GetIndices(i), mesh.number_of_indices_, bounding_box, cache.GetMaterial(i), directory));
+            }
+            cache.Destroy();
+            return 0;
+        }
+    
         /* Use assimp to load the model */
         Assimp::Importer importer;
         const aiScene * scene = importer.ReadFile(full_path, aiProcess_Triangulate | aiProcess_FlipUVs);
@@ -24,31 +39,43 @@ namespace graphics{
             return -1;
         }
     
-        ProcessNode(scene->mRootNode, scene, directory, out_meshes);
+        std::vector<MeshData_t> meshes;
+        ProcessNode(scene->mRootNode, scene, meshes);
+
+        for (size_t i = 0; i < meshes.size(); i++) {
+            const MeshData_t& mesh = meshes[i];
+            glm::vec3 bounding_box[2] = { mesh.min_, mesh.max_ };
+            out_meshes.push_back(CreateMesh(mesh.vertices_.data(), mesh.vertices_.size(), mesh.indices_.data(), mesh.indices_.size(), bounding_box, mesh.material_, directory));
+        }
+
+        if (has_hash && MeshCache::Write(cache_path, source_hash, meshes)) {
+            dt::Console(dt::WARNING, "LoadModel(): Can't write mesh cache: " + cache_path);
+        }
     
         return 0;
     }
     
-    int ProcessNode(aiNode * node, const aiScene * scene, std::string directory, std::vector<AssimpData_t>& out_meshes) {
+    int ProcessNode(aiNode * node, const aiScene * scene, std::vector<MeshData_t>& out_meshes) {
         /* process all the node's meshes (if any) */
         for (unsigned int i = 0; i < node->mNumMeshes; i++) {
             aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
     
-            out_meshes.push_back(ProcessMesh(mesh, scene, directory));
+            out_meshes.push_back(MeshData_t());
+            ProcessMesh(mesh, scene, out_meshes.back());
         }
         /* then do the same for each of its children */
         for (unsigned int i = 0; i < node->mNumChildren; i++) {
-            ProcessNode(node->mChildren[i], scene, directory, out_meshes);
+            ProcessNode(node->mChildren[i], scene, out_meshes);
         }
     
         return 0;
     }
     
-    AssimpData_t ProcessMesh(aiMesh *mesh, const aiScene *scene, std::string directory) {
-        std::vector<Vertex_t> vertices;
-        std::vector<unsigned int> indices;
-        std::vector<Texture_t> textures;
+    void ProcessMesh(aiMesh *mesh, const aiScene *scene, MeshData_t& out_mesh) {
+        std::vector<Vertex_t>& vertices = out_mesh.vertices_;
+        std::vector<unsigned int>& indices = out_mesh.indices_;
     
+        vertices.reserve(mesh->mNumVertices);
         for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
             Vertex_t vertex;
             /* Process vertex position */
@@ -66,9 +93,18 @@ namespace graphics{
     
             vertices.push_back(vertex);
         }
-        /* Process indices */
+
+        /* Process the bounding box */
+        out_mesh.min_ = out_mesh.max_ = (vertices.size() > 0) ? vertices[0].position_ : glm::vec3(0.0f);
+        for (size_t i = 0; i < vertices.size(); i++) {
+            out_mesh.min_ = glm::min(out_mesh.min_, vertices[i].position_);
+            out_mesh.max_ = glm::max(out_mesh.max_, vertices[i].position_);
+        }
+
+        /* Process indices, the faces are triangles after aiProcess_Triangulate */
+        indices.reserve(3 * mesh->mNumFaces);
         for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
-            aiFace face = mesh->mFaces[i];
+            const aiFace& face = mesh->mFaces[i];
             for (unsigned int j = 0; j < face.mNumIndices; j++)
                 indices.push_back(face.mIndices[j]);
         }
@@ -91,36 +127,32 @@ namespace graphics{
             material->Get(AI_MATKEY_COLOR_SPECULAR, color_specular);
             material->Get(AI_MATKEY_SHININESS, shininess);
     
-            diffuseMaps = LoadMaterialTextures(material, aiTextureType_DIFFUSE, GAME_ENGINE_TEXTURE_TYPE_DIFFUSE_MAP, directory);
-            if (diffuseMaps.size() == 0) diffuseMaps.push_back(Texture_t(directory + std::string("/textures/spec_map_empty.png"), GAME_ENGINE_TEXTURE_TYPE_DIFFUSE_MAP));
+            diffuseMaps = LoadMaterialTextures(material, aiTextureType_DIFFUSE, GAME_ENGINE_TEXTURE_TYPE_DIFFUSE_MAP);
+            if (diffuseMaps.size() == 0) diffuseMaps.push_back(Texture_t(std::string("textures/spec_map_empty.png"), GAME_ENGINE_TEXTURE_TYPE_DIFFUSE_MAP));
     
-            specularMaps = LoadMaterialTextures(material, aiTextureType_SPECULAR, GAME_ENGINE_TEXTURE_TYPE_SPECULAR_MAP, directory);
-            if (specularMaps.size() == 0) specularMaps.push_back(Texture_t(directory + std::string("/textures/spec_map_empty.png"), GAME_ENGINE_TEXTURE_TYPE_SPECULAR_MAP));
+            specularMaps = LoadMaterialTextures(material, aiTextureType_SPECULAR, GAME_ENGINE_TEXTURE_TYPE_SPECULAR_MAP);
+            if (specularMaps.size() == 0) specularMaps.push_back(Texture_t(std::string("textures/spec_map_empty.png"), GAME_ENGINE_TEXTURE_TYPE_SPECULAR_MAP));
 
             /* Not imported currently. They have to be set explicitly when seting a material for a mesh */
-            normalMaps = LoadMaterialTextures(material, aiTextureType_NORMALS, GAME_ENGINE_TEXTURE_TYPE_NORMAL_MAP, directory);
-            displMaps = LoadMaterialTextures(material, aiTextureType_DISPLACEMENT, GAME_ENGINE_TEXTURE_TYPE_DISPLACEMENT_MAP, directory);
+            normalMaps = LoadMaterialTextures(material, aiTextureType_NORMALS, GAME_ENGINE_TEXTURE_TYPE_NORMAL_MAP);
+            displMaps = LoadMaterialTextures(material, aiTextureType_DISPLACEMENT, GAME_ENGINE_TEXTURE_TYPE_DISPLACEMENT_MAP);
         }
            
-        /* Create a default material */
-        math::Vector3D diffuse_color(color_diffuse.r, color_diffuse.g, color_diffuse.b);
-        math::Vector3D specular_color(color_specular.r, color_specular.g, color_specular.b);
-        MaterialDeferredStandard * material_default = new MaterialDeferredStandard(diffuse_color, specular_color, diffuseMaps[0].path_, specularMaps[0].path_);
-
-        Mesh * temp_mesh = new Mesh();
-        temp_mesh->Init(vertices, indices);
-    
-        return AssimpData_t(temp_mesh, material_default);
+        /* The parameters of the default material */
+        out_mesh.material_.diffuse_ = glm::vec3(color_diffuse.r, color_diffuse.g, color_diffuse.b);
+        out_mesh.material_.specular_ = glm::vec3(color_specular.r, color_specular.g, color_specular.b);
+        out_mesh.material_.texture_diffuse_ = diffuseMaps[0].path_;
+        out_mesh.material_.texture_specular_ = specularMaps[0].path_;
     }
     
-    std::vector<Texture_t> LoadMaterialTextures(aiMaterial * mat, aiTextureType type, int texture_type, std::string directory) {
+    std::vector<Texture_t> LoadMaterialTextures(aiMaterial * mat, aiTextureType type, int texture_type) {
     
         std::vector<Texture_t> textures;
         for (unsigned int i = 0; i < mat->GetTextureCount(type); i++) {
             aiString str;
             mat->GetTexture(type, i, &str);
             Texture_t texture;
-            texture.path_ = directory + "/" + std::string(str.C_Str());
+            texture.path_ = std::string(str.C_Str());
             texture.type_ = texture_type;
             textures.push_back(texture);
         }
@@ -128,22 +160,23 @@ namespace graphics{
     
     }
 
-    int ProcessObjectAtlas(std::string file_path, std::vector<AssimpData_t>& out_meshes) {
+    AssimpData_t CreateMesh(const Vertex_t * vertices, size_t number_of_vertices, const unsigned int * indices, size_t number_of_indices, const glm::vec3 * bounding_box, const MeshMaterial_t& material, std::string directory) {
 
-        std::string directory = FileSystem::GetInstance().GetDirectoryAssets();
-        std::string full_path = directory + "/" + file_path;
+        /* Create a default material */
+        math::Vector3D diffuse_color(material.diffuse_);
+        math::Vector3D specular_color(material.specular_);
+        MaterialDeferredStandard * material_default = new MaterialDeferredStandard(diffuse_color, specular_color, directory + "/" + material.texture_diffuse_, directory + "/" + material.texture_specular_);
 
-        /* Use assimp to load the model */
-        Assimp::Importer importer;
-        const aiScene * scene = importer.ReadFile(full_path, aiProcess_Triangulate | aiProcess_FlipUVs);
-        if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
-            dt::ConsoleInfoL(dt::WARNING, "Assimp::ReadFile error", "error", importer.GetErrorString());
-            return -1;
-        }
+        Mesh * temp_mesh = new Mesh();
+        temp_mesh->Init(vertices, number_of_vertices, indices, number_of_indices, bounding_box);
+
+        return AssimpData_t(temp_mesh, material_default);
+    }
 
-        ProcessNode(scene->mRootNode, scene, directory, out_meshes);
+    int ProcessObjectAtlas(std::string file_path, std::vector<AssimpData_t>& out_meshes) {
 
-        return 0;
+        /* The same as a model, one mesh for each object of the atlas */
+        return LoadModel(file_path, out_meshes);
     }
 
 }
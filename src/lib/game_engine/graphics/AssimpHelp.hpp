@@ -6,6 +6,7 @@
 
 #include "Mesh.hpp"
 #include "Material.hpp"
+#include "MeshCache.hpp"
 
 #include "assimp/scene.h"
 #include "assimp/Importer.hpp"
@@ -21,13 +22,37 @@ namespace graphics {
         AssimpData_t(Mesh * mesh, Material * material) : mesh_(mesh), material_(material) {};
     };
 
+    /**
+        Load the meshes of a model, and create a default material for each one. The meshes are read from the mesh cache
+        of the model when it is up to date, else the model is imported with Assimp, and the cache is written
+        @param file_path The path of the model, relative to the assets directory
+        @param[out] out_meshes The meshes and their materials
+        @return 0=OK, -1=Import error, else see ErrorCodes.hpp
+    */
     int LoadModel(std::string file_path, std::vector<AssimpData_t>& out_meshes);
 
-    int ProcessNode(aiNode *node, const aiScene *scene, std::string directory, std::vector<AssimpData_t>& out_meshes);
-
-    AssimpData_t ProcessMesh(aiMesh *mesh, const aiScene *scene, std::string directory);
-
-    std::vector<Texture_t> LoadMaterialTextures(aiMaterial *mat, aiTextureType type, int texture_type, std::string directory);
+    int ProcessNode(aiNode *node, const aiScene *scene, std::vector<MeshData_t>& out_meshes);
+
+    void ProcessMesh(aiMesh *mesh, const aiScene *scene, MeshData_t& out_mesh);
+
+    /**
+        Get the textures of a material
+        @return The textures, with paths relative to the assets directory
+    */
+    std::vector<Texture_t> LoadMaterialTextures(aiMaterial *mat, aiTextureType type, int texture_type);
+
+    /**
+        Create a mesh, and its default material
+        @param vertices The vertices
+        @param number_of_vertices The number of vertices
+        @param indices The triangle indices
+        @param number_of_indices The number of indices
+        @param bounding_box The min and the max of the vertices
+        @param material The parameters of the material, with paths relative to directory
+        @param directory The assets directory
+        @return The mesh and the material
+    */
+    AssimpData_t CreateMesh(const Vertex_t * vertices, size_t number_of_vertices, const unsigned int * indices, size_t number_of_indices, const glm::vec3 * bounding_box, const MeshMaterial_t& material, std::string directory);
 
     int ProcessObjectAtlas(std::string file_path, std::vector<AssimpData_t>& out_meshes);
 
@@ -0,0 +1,166 @@
+#include "FrustumCulling.hpp"
+
+#include <cmath>
+
+#if defined(GAME_ENGINE_MATH_SIMD) && defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+namespace game_engine {
+namespace graphics {
+
+    void CullingBoxes_t::Clear() {
+        min_x_.clear();
+        min_y_.clear();
+        min_z_.clear();
+        max_x_.clear();
+        max_y_.clear();
+        max_z_.clear();
+    }
+
+    void CullingBoxes_t::Add(const glm::vec3& min, const glm::vec3& max) {
+        min_x_.push_back(min.x);
+        min_y_.push_back(min.y);
+        min_z_.push_back(min.z);
+        max_x_.push_back(max.x);
+        max_y_.push_back(max.y);
+        max_z_.push_back(max.z);
+    }
+
+    size_t CullingBoxes_t::Size() const {
+        return min_x_.size();
+    }
+
+    void ExtractFrustumPlanes(const glm::mat4& view_projection, FrustumPlanes_t& planes) {
+        glm::vec4 p[6];
+        ExtractFrustumPlanes(view_projection, p);
+        SetFrustumPlanes(p, planes);
+    }
+
+    void SetFrustumPlanes(const glm::vec4 * planes, FrustumPlanes_t& frustum_planes) {
+        for (size_t i = 0; i < 6; i++) {
+            frustum_planes.a_[i] = planes[i].x;
+            frustum_planes.b_[i] = planes[i].y;
+            frustum_planes.c_[i] = planes[i].z;
+            frustum_planes.d_[i] = planes[i].w;
+        }
+    }
+
+    void ExtractFrustumPlanes(const glm::mat4& view_projection, glm::vec4 * planes) {
+        /* glm is column major, m[column][row] */
+        const glm::mat4& m = view_projection;
+        glm::vec4 row_x(m[0][0], m[1][0], m[2][0], m[3][0]);
+        glm::vec4 row_y(m[0][1], m[1][1], m[2][1], m[3][1]);
+        glm::vec4 row_z(m[0][2], m[1][2], m[2][2], m[3][2]);
+        glm::vec4 row_w(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+        planes[0] = row_w + row_x;
+        planes[1] = row_w - row_x;
+        planes[2] = row_w + row_y;
+        planes[3] = row_w - row_y;
+        planes[4] = row_w + row_z;
+        planes[5] = row_w - row_z;
+        for (size_t i = 0; i < 6; i++) {
+            float length = std::sqrt(planes[i].x * planes[i].x + planes[i].y * planes[i].y + planes[i].z * planes[i].z);
+            if (length > 0) planes[i] /= length;
+        }
+    }
+
+    void TransformBox(const glm::vec3& min, const glm::vec3& max, const glm::mat4& model_matrix, glm::vec3& world_min, glm::vec3& world_max) {
+        glm::vec3 center = 0.5f * (min + max);
+        glm::vec3 extent = 0.5f * (max - min);
+
+        glm::vec3 world_center = glm::vec3(model_matrix * glm::vec4(center, 1.0f));
+        glm::vec3 world_extent;
+        for (int row = 0; row < 3; row++) {
+            world_extent[row] = std::abs(model_matrix[0][row]) * extent.x + std::abs(model_matrix[1][row]) * extent.y + std::abs(model_matrix[2][row]) * extent.z;
+        }
+
+        world_min = world_center - world_extent;
+        world_max = world_center + world_extent;
+    }
+
+    /**
+        The coordinate arrays of the vertex furthest along the normal of each plane. The sign of a normal is the same
+        for all the boxes, so the vertex is selected once per plane instead of once per box
+    */
+    struct PositiveVertices_t {
+        const float * x_[6];
+        const float * y_[6];
+        const float * z_[6];
+    };
+
+    static void GetPositiveVertices(const FrustumPlanes_t& planes, const CullingBoxes_t& boxes, PositiveVertices_t& vertices) {
+        for (size_t p = 0; p < 6; p++) {
+            vertices.x_[p] = (planes.a_[p] >= 0) ? boxes.max_x_.data() : boxes.min_x_.data();
+            vertices.y_[p] = (planes.b_[p] >= 0) ? boxes.max_y_.data() : boxes.min_y_.data();
+            vertices.z_[p] = (planes.c_[p] >= 0) ? boxes.max_z_.data() : boxes.min_z_.data();
+        }
+    }
+
+    static void CullRange(const FrustumPlanes_t& planes, const PositiveVertices_t& vertices, size_t start, size_t end, std::vector<uint32_t>& visible) {
+        for (size_t i = start; i < end; i++) {
+            bool outside = false;
+            for (size_t p = 0; p < 6 && !outside; p++) {
+                float distance = planes.a_[p] * vertices.x_[p][i] + planes.b_[p] * vertices.y_[p][i] + planes.c_[p] * vertices.z_[p][i] + planes.d_[p];
+                outside = distance < 0;
+            }
+            if (!outside) visible.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    void CullBoxesScalar(const FrustumPlanes_t& planes, const CullingBoxes_t& boxes, std::vector<uint32_t>& visible) {
+        PositiveVertices_t vertices;
+        GetPositiveVertices(planes, boxes, vertices);
+        CullRange(planes, vertices, 0, boxes.Size(), visible);
+    }
+
+    void CullBoxes(const FrustumPlanes_t& planes, const CullingBoxes_t& boxes, std::vector<uint32_t>& visible) {
+        PositiveVertices_t vertices;
+        GetPositiveVertices(planes, boxes, vertices);
+
+        size_t n = boxes.Size();
+        size_t i = 0;
+#if defined(GAME_ENGINE_MATH_SIMD) && defined(__AVX__)
+        for (; i + 8 <= n; i += 8) {
+            __m256 outside = _mm256_setzero_ps();
+            for (size_t p = 0; p < 6; p++) {
+                __m256 distance = _mm256_add_ps(
+                    _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(planes.a_[p]), _mm256_loadu_ps(vertices.x_[p] + i)), _mm256_mul_ps(_mm256_set1_ps(planes.b_[p]), _mm256_loadu_ps(vertices.y_[p] + i))),
+                    _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(planes.c_[p]), _mm256_loadu_ps(vertices.z_[p] + i)), _mm256_set1_ps(planes.d_[p])));
+                outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_LT_OQ));
+                if (_mm256_movemask_ps(outside) == 0xFF) break;
+            }
+
+            int inside = ~_mm256_movemask_ps(outside) & 0xFF;
+            while (inside != 0) {
+                int bit = 0;
+                while (((inside >> bit) & 1) == 0) bit++;
+                visible.push_back(static_cast<uint32_t>(i + bit));
+                inside &= inside - 1;
+            }
+        }
+#elif defined(GAME_ENGINE_MATH_SIMD)
+        for (; i + 4 <= n; i += 4) {
+            __m128 outside = _mm_setzero_ps();
+            for (size_t p = 0; p < 6; p++) {
+                __m128 distance = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes.a_[p]), _mm_loadu_ps(vertices.x_[p] + i)), _mm_mul_ps(_mm_set1_ps(planes.b_[p]), _mm_loadu_ps(vertices.y_[p] + i))),
+                    _mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes.c_[p]), _mm_loadu_ps(vertices.z_[p] + i)), _mm_set1_ps(planes.d_[p])));
+                outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, _mm_setzero_ps()));
+                if (_mm_movemask_ps(outside) == 0xF) break;
+            }
+
+            int inside = ~_mm_movemask_ps(outside) & 0xF;
+            if (inside & 0x1) visible.push_back(static_cast<uint32_t>(i));
+            if (inside & 0x2) visible.push_back(static_cast<uint32_t>(i + 1));
+            if (inside & 0x4) visible.push_back(static_cast<uint32_t>(i + 2));
+            if (inside & 0x8) visible.push_back(static_cast<uint32_t>(i + 3));
+        }
+#endif
+        /* The boxes left, less than a register */
+        CullRange(planes, vertices, i, n, visible);
+    }
+
+}
+}
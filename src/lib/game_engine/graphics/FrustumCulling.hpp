@@ -0,0 +1,107 @@
+#ifndef __FrustumCulling_hpp__
+#define __FrustumCulling_hpp__
+
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "game_engine/math/Vector.hpp"
+
+namespace game_engine {
+namespace graphics {
+
+    /**
+        The six planes of a view frustum, stored as arrays of coefficients. A point p is inside plane i when
+        a_[i] * p.x + b_[i] * p.y + c_[i] * p.z + d_[i] >= 0
+    */
+    struct FrustumPlanes_t {
+        float a_[6];
+        float b_[6];
+        float c_[6];
+        float d_[6];
+    };
+
+    /**
+        Axis aligned boxes stored as a structure of arrays, so that a number of boxes can be loaded in a SIMD register
+        with a single read per coordinate
+    */
+    struct CullingBoxes_t {
+        std::vector<float> min_x_;
+        std::vector<float> min_y_;
+        std::vector<float> min_z_;
+        std::vector<float> max_x_;
+        std::vector<float> max_y_;
+        std::vector<float> max_z_;
+
+        /**
+            Remove all the boxes, keep the memory
+        */
+        void Clear();
+
+        /**
+            Add a box
+            @param min The minimum point
+            @param max The maximum point
+        */
+        void Add(const glm::vec3& min, const glm::vec3& max);
+
+        /**
+            Get the number of boxes
+            @return The number of boxes
+        */
+        size_t Size() const;
+    };
+
+    /**
+        Extract the normalised frustum planes from a view projection matrix
+        @param view_projection The projection matrix multiplied with the view matrix
+        @param[out] planes The planes
+    */
+    void ExtractFrustumPlanes(const glm::mat4& view_projection, FrustumPlanes_t& planes);
+
+    /**
+        Extract the normalised frustum planes from a view projection matrix, as (a, b, c, d) vectors in the order left,
+        right, bottom, top, near, far
+        @param view_projection The projection matrix multiplied with the view matrix
+        @param[out] planes The six planes
+    */
+    void ExtractFrustumPlanes(const glm::mat4& view_projection, glm::vec4 * planes);
+
+    /**
+        Store planes as arrays of coefficients
+        @param planes The six planes, as (a, b, c, d) vectors
+        @param[out] frustum_planes The planes
+    */
+    void SetFrustumPlanes(const glm::vec4 * planes, FrustumPlanes_t& frustum_planes);
+
+    /**
+        Transform a local space bounding box to a world space axis aligned bounding box. The center is transformed
+        with the matrix and the extent with the absolute values of the matrix, so rotations and scaling are included
+        @param min The minimum point of the local box
+        @param max The maximum point of the local box
+        @param model_matrix The model matrix
+        @param[out] world_min The minimum point of the world box
+        @param[out] world_max The maximum point of the world box
+    */
+    void TransformBox(const glm::vec3& min, const glm::vec3& max, const glm::mat4& model_matrix, glm::vec3& world_min, glm::vec3& world_max);
+
+    /**
+        Test boxes against a frustum, and append the indices of the ones not completely outside of it. With AVX eight
+        boxes are tested per iteration, with SSE four, otherwise one. A box is outside when its vertex furthest along
+        the normal of a plane is behind the plane, boxes that cross the corners of the frustum may be kept
+        @param planes The frustum planes
+        @param boxes The boxes
+        @param[out] visible The indices of the visible boxes are appended, in increasing order
+    */
+    void CullBoxes(const FrustumPlanes_t& planes, const CullingBoxes_t& boxes, std::vector<uint32_t>& visible);
+
+    /**
+        Same as CullBoxes(), one box at a time
+    */
+    void CullBoxesScalar(const FrustumPlanes_t& planes, const CullingBoxes_t& boxes, std::vector<uint32_t>& visible);
+
+}
+}
+
+#endif
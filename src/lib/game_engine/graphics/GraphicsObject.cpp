@@ -40,10 +40,6 @@ namespace graphics {
 
         model_materials_ = std::vector<Material *>(model_->GetNumberOfMeshes(), nullptr);
 
-        glGenBuffers(1, &model_vbo_);
-        glBindBuffer(GL_ARRAY_BUFFER, model_vbo_);
-        glBufferData(GL_ARRAY_BUFFER, 1 * sizeof(glm::mat4), &model_matrix_, GL_DYNAMIC_DRAW);
-
         is_inited_ = true;
         return 0;
     }
@@ -66,6 +62,34 @@ namespace graphics {
         return 0;
     }
 
+    int GraphicsObject::InitObjectAtlas(MapBundle& bundle, std::string file_name) {
+        if (!bundle.IsInited()) return -1;
+
+        std::string directory = FileSystem::GetInstance().GetDirectoryAssets();
+        std::string file_path = directory + file_name.substr(0, file_name.find_last_of("."));
+
+        /* All the regions share the textures of the map */
+        Material * material = new MaterialDeferredStandard(math::Vector3D(0.0f), math::Vector3D(0.0f), directory + "/" + bundle.GetTextureDiffuse(), directory + "/" + bundle.GetTextureSpecular());
+
+        AssetManager& asset_manager = AssetManager::GetInstance();
+        for (size_t i = 0; i < bundle.GetNumberOfRegions(); i++) {
+            const MapBundleRegion_t& region = bundle.GetRegion(i);
+
+            glm::vec3 bounding_box[2] = { glm::vec3(region.min_[0], region.min_[1], region.min_[2]), glm::vec3(region.max_[0], region.max_[1], region.max_[2]) };
+            Mesh * mesh = new Mesh();
+            if (mesh->Init(bundle.GetVertices(i), region.number_of_vertices_, bundle.GetIndices(i), region.number_of_indices_, bounding_box)) {
+                delete mesh;
+                continue;
+            }
+
+            Model * new_model = new Model();
+            new_model->Init({ mesh }, { material });
+            asset_manager.InsertModel(file_path + "_" + std::to_string(i) + ".obj", new_model);
+        }
+
+        return 0;
+    }
+
     int GraphicsObject::Destroy() {
 
         /* DONT Destroy or delete model_, It stil might be used by other objects */
@@ -122,9 +146,6 @@ namespace graphics {
 
     void GraphicsObject::SetModelMatrix() {
         model_matrix_ = translation_matrix_ * rotation_matrix_ * scale_matrix_;
-
-        glBindBuffer(GL_ARRAY_BUFFER, model_vbo_);
-        glBufferData(GL_ARRAY_BUFFER, 1 * sizeof(glm::mat4), &model_matrix_, GL_DYNAMIC_DRAW);
     }
 
 
@@ -7,6 +7,7 @@
 #include "GraphicsTypes.hpp"
 #include "Material.hpp"
 #include "Model.hpp"
+#include "MapBundle.hpp"
 
 namespace game_engine {
 namespace graphics {
@@ -32,6 +33,15 @@ namespace graphics {
 
         static int InitObjectAtlas(std::string file_name);
 
+        /**
+            Create the models of the regions of a map bundle, named like the meshes of the .obj that
+            InitObjectAtlas(file_name) would load, file_name without the extension + "_" + region index
+            @param bundle A map bundle, it can be destroyed after the call
+            @param file_name The name of the .obj of the map
+            @return 0=OK, -1=Bundle not initialised
+        */
+        static int InitObjectAtlas(MapBundle& bundle, std::string file_name);
+
         int Destroy();
 
         bool IsInited();
@@ -85,12 +95,11 @@ namespace graphics {
         glm::mat4 rotation_matrix_;
         glm::mat4 scale_matrix_;
         glm::mat4 model_matrix_;
-        GLuint model_vbo_;
 
         std::vector<Material *> model_materials_;
 
         /**
-            Set the model matrix
+            Calculate the model matrix. The renderer uploads it with the rest of the model matrices of the frame
         */
         void SetModelMatrix();
     };
@@ -1,5 +1,8 @@
 #include "Instancing.hpp"
 #include "Renderer.hpp"
+#include "FrustumCulling.hpp"
+
+#include <algorithm>
 
 namespace game_engine { namespace graphics {
 
@@ -9,60 +12,226 @@ namespace game_engine { namespace graphics {
     }
 
     int Instancing::Init() {
+        if (is_inited_) return -1;
 
-        instances_ = new utility::HashTable<Mesh *, utility::HashTable<Material *, std::vector<glm::mat4>> *>(50, 1);
+        batch_indices_ = new utility::HashTable<Mesh *, utility::HashTable<Material *, size_t> *>(50, 1);
+        free_slots_ = GAME_ENGINE_INSTANCE_NONE;
 
         is_inited_ = true;
         return 0;
     }
 
-    void Instancing::AddInstance(Mesh * mesh, Material * material, glm::mat4& model_matrix) {
+    int Instancing::Destroy() {
+        if (!is_inited_) return -1;
+
+        for (auto mesh_itr = batch_indices_->begin(); mesh_itr != batch_indices_->end(); ++mesh_itr) {
+            delete mesh_itr.GetValue();
+        }
+        delete batch_indices_;
+        batch_indices_ = nullptr;
+
+        for (size_t i = 0; i < batches_.size(); i++) {
+            if (batches_[i]->buffer_ != 0) glDeleteBuffers(1, &batches_[i]->buffer_);
+            delete batches_[i];
+        }
+        batches_.clear();
+        slots_.clear();
+        tree_.Destroy();
+        tree_built_instances_ = 0;
+        tree_changed_ = false;
+
+        is_inited_ = false;
+        return 0;
+    }
+
+    bool Instancing::IsInited() {
+        return is_inited_;
+    }
+
+    InstanceId_t Instancing::AddInstance(Mesh * mesh, Material * material, glm::mat4& model_matrix) {
+        if (!is_inited_) return GAME_ENGINE_INSTANCE_NONE;
+
+        size_t batch_index = GetBatch(mesh, material);
+        InstanceBatch_t * batch = batches_[batch_index];
+
+        /* Reuse a free slot for the id */
+        InstanceId_t id;
+        if (free_slots_ != GAME_ENGINE_INSTANCE_NONE) {
+            id = free_slots_;
+            free_slots_ = slots_[id].index_;
+        } else {
+            id = static_cast<InstanceId_t>(slots_.size());
+            slots_.push_back(InstanceSlot_t());
+        }
+        InstanceBounds_t bounds = GetBounds(mesh, model_matrix);
+        slots_[id].batch_ = static_cast<uint32_t>(batch_index);
+        slots_[id].index_ = static_cast<uint32_t>(batch->model_matrices_.size());
+        slots_[id].tree_id_ = tree_.Insert(bounds.min_, bounds.max_, id);
+        tree_changed_ = true;
+
+        batch->model_matrices_.push_back(model_matrix);
+        batch->ids_.push_back(id);
+        SetDirty(batch, batch->model_matrices_.size() - 1);
+
+        return id;
+    }
+
+    int Instancing::RemoveInstance(InstanceId_t id) {
+        if (!is_inited_) return -1;
+        if (id >= slots_.size() || slots_[id].batch_ == GAME_ENGINE_INSTANCE_NONE) return -1;
+
+        InstanceBatch_t * batch = batches_[slots_[id].batch_];
+        size_t index = slots_[id].index_;
+        size_t last = batch->model_matrices_.size() - 1;
+
+        /* Move the last instance in the place of the removed one */
+        if (index != last) {
+            batch->model_matrices_[index] = batch->model_matrices_[last];
+            batch->ids_[index] = batch->ids_[last];
+            slots_[batch->ids_[index]].index_ = static_cast<uint32_t>(index);
+            SetDirty(batch, index);
+        }
+        batch->model_matrices_.pop_back();
+        batch->ids_.pop_back();
+
+        tree_.Remove(slots_[id].tree_id_);
+        tree_changed_ = true;
+
+        slots_[id].batch_ = GAME_ENGINE_INSTANCE_NONE;
+        slots_[id].index_ = free_slots_;
+        free_slots_ = id;
+
+        return 0;
+    }
+
+    int Instancing::UpdateInstance(InstanceId_t id, glm::mat4& model_matrix) {
+        if (!is_inited_) return -1;
+        if (id >= slots_.size() || slots_[id].batch_ == GAME_ENGINE_INSTANCE_NONE) return -1;
+
+        InstanceBatch_t * batch = batches_[slots_[id].batch_];
+        size_t index = slots_[id].index_;
+
+        batch->model_matrices_[index] = model_matrix;
+        InstanceBounds_t bounds = GetBounds(batch->mesh_, model_matrix);
+        tree_.Move(slots_[id].tree_id_, bounds.min_, bounds.max_);
+        tree_changed_ = true;
+        SetDirty(batch, index);
+
+        return 0;
+    }
+
+    void Instancing::UpdateBuffers() {
         if (!is_inited_) return;
 
-        auto mesh_itr = instances_->Find(mesh);
-        if (mesh_itr != instances_->end()) {
-            utility::HashTable<Material *, std::vector<glm::mat4>> * materials = mesh_itr.GetValue();
-            auto material_itr = materials->Find(material);
-            if (material_itr != materials->end()) {
-                material_itr.GetValue().push_back(model_matrix);
+        for (size_t i = 0; i < batches_.size(); i++) {
+            InstanceBatch_t * batch = batches_[i];
+            size_t instances = batch->model_matrices_.size();
+
+            if (instances > batch->buffer_capacity_) {
+                /* Grow, and upload everything */
+                if (batch->buffer_ == 0) glGenBuffers(1, &batch->buffer_);
+                batch->buffer_capacity_ = std::max(instances, 2 * batch->buffer_capacity_);
+                glBindBuffer(GL_ARRAY_BUFFER, batch->buffer_);
+                glBufferData(GL_ARRAY_BUFFER, batch->buffer_capacity_ * sizeof(glm::mat4), NULL, GL_DYNAMIC_DRAW);
+                glBufferSubData(GL_ARRAY_BUFFER, 0, instances * sizeof(glm::mat4), &batch->model_matrices_[0]);
             } else {
-                materials->Insert(material, { model_matrix });
+                /* Removed instances can leave the range past the end */
+                size_t end = std::min(batch->dirty_end_, instances);
+                if (batch->dirty_begin_ < end) {
+                    glBindBuffer(GL_ARRAY_BUFFER, batch->buffer_);
+                    glBufferSubData(GL_ARRAY_BUFFER, batch->dirty_begin_ * sizeof(glm::mat4), (end - batch->dirty_begin_) * sizeof(glm::mat4), &batch->model_matrices_[batch->dirty_begin_]);
+                }
             }
-        } else {
-            utility::HashTable<Material *, std::vector<glm::mat4>> * temp = new utility::HashTable<Material *, std::vector<glm::mat4>>(50, 1);
-            temp->Insert(material, { model_matrix });
-            instances_->Insert(mesh, temp);
+
+            /* Reset the range even if nothing was uploaded, a stale range would widen the next ones */
+            batch->dirty_begin_ = 0;
+            batch->dirty_end_ = 0;
         }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
 
+    void Instancing::UpdateTree() {
+        if (!is_inited_ || !tree_changed_) return;
+        tree_changed_ = false;
+
+        /* Inserted one by one the tree is worse than built at once, rebuild when it has grown a lot or got more expensive */
+        size_t instances = tree_.Size();
+        if (instances > 2 * tree_built_instances_ || tree_.GetCost() > 1.5f * tree_built_cost_) {
+            tree_.Rebuild();
+            tree_built_instances_ = instances;
+            tree_built_cost_ = tree_.GetCost();
+        }
     }
 
-    void Instancing::PrepareBuffers()
-    {
-        for (auto mesh_itr = instances_->begin(); mesh_itr != instances_->end(); ++mesh_itr) {
-            utility::HashTable<Material *, std::vector<glm::mat4>> * materials = mesh_itr.GetValue();
-            for (auto mat_itr = materials->begin(); mat_itr != materials->end(); ++mat_itr) {
-                Mesh * mesh = mesh_itr.GetKey();
-                Material * material = mat_itr.GetKey();
-                std::vector<glm::mat4> models = mat_itr.GetValue();
-
-                unsigned int models_buffer;
-                glGenBuffers(1, &models_buffer);
-                glBindBuffer(GL_ARRAY_BUFFER, models_buffer);
-                glBufferData(GL_ARRAY_BUFFER, models.size() * sizeof(glm::mat4), &models[0], GL_STATIC_DRAW);
-                model_matrices_.push_back(models);
-
-                InstanceDrawCall data;
-                data.amount_ = models.size();
-                data.material_ = material;
-                data.mesh_ = mesh;
-                data.model_matrices_ = &model_matrices_.back()[0];
-                data.model_matrices_buffer_ = models_buffer;
-                instanced_draws_.push_back(data);
-            }
+    void Instancing::CullInstances(const glm::vec4 * planes, size_t number_of_planes) {
+        for (size_t i = 0; i < batches_.size(); i++) batches_[i]->visible_.clear();
+        if (!is_inited_) return;
+
+        tree_result_.clear();
+        tree_.QueryFrustum(planes, number_of_planes, tree_result_);
+        for (size_t i = 0; i < tree_result_.size(); i++) {
+            InstanceSlot_t& slot = slots_[tree_result_[i]];
+            batches_[slot.batch_]->visible_.push_back(slot.index_);
         }
+    }
+
+    void Instancing::QueryBox(const glm::vec3& min, const glm::vec3& max, std::vector<InstanceId_t>& result) {
+        if (!is_inited_) return;
+        tree_.QueryBox(min, max, result);
+    }
+
+    InstanceId_t Instancing::RayCast(const glm::vec3& origin, const glm::vec3& direction, float max_distance, float& distance) {
+        if (!is_inited_) return GAME_ENGINE_INSTANCE_NONE;
 
-        buffers_prepared_ = true;
+        InstanceId_t id;
+        if (!tree_.RayCast(origin, direction, max_distance, id, distance)) return GAME_ENGINE_INSTANCE_NONE;
+        return id;
     }
 
+    size_t Instancing::GetNumberOfInstances() {
+        size_t instances = 0;
+        for (size_t i = 0; i < batches_.size(); i++) instances += batches_[i]->model_matrices_.size();
+        return instances;
+    }
+
+    size_t Instancing::GetBatch(Mesh * mesh, Material * material) {
+        utility::HashTable<Material *, size_t> * materials;
+
+        auto mesh_itr = batch_indices_->Find(mesh);
+        if (mesh_itr != batch_indices_->end()) {
+            materials = mesh_itr.GetValue();
+            auto material_itr = materials->Find(material);
+            if (material_itr != materials->end()) return material_itr.GetValue();
+        } else {
+            materials = new utility::HashTable<Material *, size_t>(50, 1);
+            batch_indices_->Insert(mesh, materials);
+        }
+
+        InstanceBatch_t * batch = new InstanceBatch_t();
+        batch->mesh_ = mesh;
+        batch->material_ = material;
+        batches_.push_back(batch);
+
+        materials->Insert(material, batches_.size() - 1);
+        return batches_.size() - 1;
+    }
+
+    Instancing::InstanceBounds_t Instancing::GetBounds(Mesh * mesh, glm::mat4& model_matrix) {
+        opengl::OpenGLObject& object = mesh->opengl_object_;
+        InstanceBounds_t bounds;
+        TransformBox(glm::vec3(object.min_x_, object.min_y_, object.min_z_), glm::vec3(object.max_x_, object.max_y_, object.max_z_), model_matrix, bounds.min_, bounds.max_);
+        return bounds;
+    }
+
+    void Instancing::SetDirty(InstanceBatch_t * batch, size_t index) {
+        if (batch->dirty_begin_ >= batch->dirty_end_) {
+            batch->dirty_begin_ = index;
+            batch->dirty_end_ = index + 1;
+            return;
+        }
+        batch->dirty_begin_ = std::min(batch->dirty_begin_, index);
+        batch->dirty_end_ = std::max(batch->dirty_end_, index + 1);
+    }
+
+}
 }
-}
\ No newline at end of file
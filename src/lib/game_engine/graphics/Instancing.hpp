@@ -1,17 +1,30 @@
 #ifndef __Instancing_hpp__
 #define __Instancing_hpp__
 
+#include <cstdint>
+#include <vector>
+
 #include "glm/glm.hpp"
 
 #include "Material.hpp"
 #include "Mesh.hpp"
 
 #include "game_engine/utility/HashTable.hpp"
+#include "game_engine/utility/BVH.hpp"
 
 namespace game_engine { namespace graphics {
 
-    class Instance;
+    /* Id of an instance, returned from Instancing::AddInstance() */
+    typedef uint32_t InstanceId_t;
+    /* An id that points to no instance */
+#define GAME_ENGINE_INSTANCE_NONE 0xFFFFFFFF
 
+    /**
+        Stores instances of meshes, grouped in batches of the same mesh and material. Every batch has its own buffer
+        with the model matrices. Instances can be added, removed and updated at any time, the changed range of each
+        batch is uploaded with UpdateBuffers(). The world space boxes of all the instances are kept in a bounding
+        volume hierarchy, used to cull, pick and query the instances
+    */
     class Instancing {
         friend class Renderer;
     public:
@@ -19,31 +32,145 @@ namespace game_engine { namespace graphics {
 
         int Init();
 
-        void AddInstance(Mesh * mesh, Material * material, glm::mat4& model_matrix);
+        int Destroy();
+
+        bool IsInited();
+
+        /**
+            Add an instance of a mesh
+            @param mesh The mesh
+            @param material The material
+            @param model_matrix The model matrix of the instance
+            @return The id of the instance, GAME_ENGINE_INSTANCE_NONE if not initialised
+        */
+        InstanceId_t AddInstance(Mesh * mesh, Material * material, glm::mat4& model_matrix);
+
+        /**
+            Remove an instance. The last instance of the batch takes its place
+            @param id The id of the instance
+            @return 0 = OK, -1 = No such instance
+        */
+        int RemoveInstance(InstanceId_t id);
+
+        /**
+            Change the model matrix of an instance
+            @param id The id of the instance
+            @param model_matrix The new model matrix
+            @return 0 = OK, -1 = No such instance
+        */
+        int UpdateInstance(InstanceId_t id, glm::mat4& model_matrix);
+
+        /**
+            Upload the model matrices changed since the last call. The buffer of a batch is reallocated only when its
+            instances don't fit anymore, otherwise only the changed range is written
+        */
+        void UpdateBuffers();
 
-        void PrepareBuffers();
+        /**
+            Rebuild the bounding volume hierarchy of the instances if it has degraded, after many instances were added,
+            or moved since the last build
+        */
+        void UpdateTree();
+
+        /**
+            Find the instances inside a set of planes, and keep the indices of the visible instances of each batch
+            @param planes The planes, a point p is inside plane i when dot(planes[i], vec4(p, 1)) >= 0
+            @param number_of_planes Number of planes
+        */
+        void CullInstances(const glm::vec4 * planes, size_t number_of_planes);
+
+        /**
+            Find the instances with world space boxes that overlap a box
+            @param min The minimum point of the box
+            @param max The maximum point of the box
+            @param[out] result The ids of the instances are appended here
+        */
+        void QueryBox(const glm::vec3& min, const glm::vec3& max, std::vector<InstanceId_t>& result);
+
+        /**
+            Find the first instance with a world space box hit by a ray
+            @param origin The origin of the ray
+            @param direction The direction of the ray
+            @param max_distance The maximum distance along the direction
+            @param[out] distance The distance to the box of the instance hit
+            @return The id of the instance, GAME_ENGINE_INSTANCE_NONE if nothing was hit
+        */
+        InstanceId_t RayCast(const glm::vec3& origin, const glm::vec3& direction, float max_distance, float& distance);
+
+        /**
+            Get the number of instances in all the batches
+            @return The number of instances
+        */
+        size_t GetNumberOfInstances();
 
     private:
-        bool is_inited_ = false;
-        bool buffers_prepared_ = false;
+        /* The world space bounding box of an instance */
+        struct InstanceBounds_t {
+            glm::vec3 min_;
+            glm::vec3 max_;
+        };
 
-        utility::HashTable<Mesh *, utility::HashTable<Material *, std::vector<glm::mat4>> *> * instances_;
-        
-        struct InstanceDrawCall {
-            Material * material_;
+        /* Instances of the same mesh and material */
+        struct InstanceBatch_t {
             Mesh * mesh_;
-            glm::mat4 * model_matrices_;
-            GLuint model_matrices_buffer_;
-            size_t amount_;
+            Material * material_;
+            std::vector<glm::mat4> model_matrices_;
+            std::vector<InstanceId_t> ids_;
+            /* The indices of the instances found by the last CullInstances() */
+            std::vector<uint32_t> visible_;
+            /* The buffer with the model matrices, and the number of matrices it fits */
+            GLuint buffer_ = 0;
+            size_t buffer_capacity_ = 0;
+            /* The range of instances changed since the last upload, [begin, end) */
+            size_t dirty_begin_ = 0;
+            size_t dirty_end_ = 0;
         };
 
-        std::vector<InstanceDrawCall> instanced_draws_;
-        /* list of model matrixes per instanced draw call */
-        std::vector<std::vector<glm::mat4>> model_matrices_;
+        /* Where an instance is stored, and its id in the tree. For free slots, index_ is the next free slot */
+        struct InstanceSlot_t {
+            uint32_t batch_;
+            uint32_t index_;
+            int32_t tree_id_;
+        };
+
+        bool is_inited_ = false;
+
+        /* The index of the batch of a mesh and a material */
+        utility::HashTable<Mesh *, utility::HashTable<Material *, size_t> *> * batch_indices_ = nullptr;
+        std::vector<InstanceBatch_t *> batches_;
+
+        std::vector<InstanceSlot_t> slots_;
+        uint32_t free_slots_;
+
+        /* The world space boxes of the instances, with their ids */
+        utility::BVH<InstanceId_t> tree_;
+        /* The number of instances and the cost of the tree at the last rebuild, and whether it changed since */
+        size_t tree_built_instances_ = 0;
+        float tree_built_cost_ = 0;
+        bool tree_changed_ = false;
+        std::vector<InstanceId_t> tree_result_;
+
+        /**
+            Get the batch of a mesh and a material, create it if it doesn't exist
+            @return The index of the batch
+        */
+        size_t GetBatch(Mesh * mesh, Material * material);
+
+        /**
+            Calculate the world space bounding box of a mesh
+            @param mesh The mesh
+            @param model_matrix The model matrix
+            @return The bounding box
+        */
+        InstanceBounds_t GetBounds(Mesh * mesh, glm::mat4& model_matrix);
 
+        /**
+            Add an instance to the changed range of its batch
+        */
+        void SetDirty(InstanceBatch_t * batch, size_t index);
     };
 
 }
 }
 
-#endif
\ No newline at end of file
+#endif
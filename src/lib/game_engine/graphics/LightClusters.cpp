@@ -0,0 +1,210 @@
+#include "LightClusters.hpp"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+namespace game_engine {
+namespace graphics {
+
+    LightClusters::LightClusters() {
+        is_inited_ = false;
+    }
+
+    int LightClusters::Init(size_t tile_size, size_t slices) {
+        if (is_inited_) return -1;
+        if (tile_size == 0 || slices == 0) return -1;
+
+        tile_size_ = tile_size;
+        slices_ = slices;
+        SetView(tile_size, tile_size, 0.1f, 100.0f);
+
+        is_inited_ = true;
+        return 0;
+    }
+
+    int LightClusters::Destroy() {
+        if (!is_inited_) return -1;
+
+        clusters_.clear();
+        light_indices_.clear();
+        ranges_.clear();
+
+        is_inited_ = false;
+        return 0;
+    }
+
+    bool LightClusters::IsInited() {
+        return is_inited_;
+    }
+
+    void LightClusters::SetView(size_t width, size_t height, float z_near, float z_far) {
+        width_ = std::max(width, static_cast<size_t>(1));
+        height_ = std::max(height, static_cast<size_t>(1));
+        tiles_x_ = (width_ + tile_size_ - 1) / tile_size_;
+        tiles_y_ = (height_ + tile_size_ - 1) / tile_size_;
+
+        z_near_ = std::max(z_near, std::numeric_limits<float>::min());
+        z_far_ = std::max(z_far, 2 * z_near_);
+        float range = std::log(z_far_ / z_near_);
+        slice_scale_ = slices_ / range;
+        slice_bias_ = -(slices_ * std::log(z_near_)) / range;
+    }
+
+    void LightClusters::Build(const glm::mat4& view_matrix, const glm::mat4& projection_matrix, const glm::vec4 * lights, size_t number_of_lights) {
+        clusters_.assign(2 * GetNumberOfClusters(), 0);
+        light_indices_.clear();
+        ranges_.clear();
+        if (!is_inited_) return;
+
+        /* Find the tiles of each slice that the sphere of a light overlaps, and count the lights of each cluster */
+        for (size_t i = 0; i < number_of_lights; i++) {
+            glm::vec3 center = glm::vec3(view_matrix * glm::vec4(glm::vec3(lights[i]), 1.0f));
+            float radius = lights[i].w;
+            float depth = -center.z;
+            if (depth + radius < z_near_ || depth - radius > z_far_) continue;
+
+            bool everywhere = radius >= std::numeric_limits<float>::max();
+            size_t slice_first = GetSlice(std::max(depth - radius, z_near_));
+            size_t slice_last = GetSlice(std::min(depth + radius, z_far_));
+            for (size_t s = slice_first; s <= slice_last; s++) {
+                ClusterRange_t range;
+                if (everywhere) {
+                    range.x_min_ = 0;
+                    range.x_max_ = static_cast<uint32_t>(tiles_x_ - 1);
+                    range.y_min_ = 0;
+                    range.y_max_ = static_cast<uint32_t>(tiles_y_ - 1);
+                } else {
+                    /* The part of the sphere in the slice is inside a box, as wide as the section closest to the center */
+                    float slice_near = std::max(GetSliceDepth(s), depth - radius);
+                    float slice_far = std::min(GetSliceDepth(s + 1), depth + radius);
+                    float distance = (depth < slice_near) ? (slice_near - depth) : ((depth > slice_far) ? (depth - slice_far) : 0.0f);
+                    float section = std::sqrt(std::max(radius * radius - distance * distance, 0.0f));
+
+                    glm::vec3 min(center.x - section, center.y - section, -slice_far);
+                    glm::vec3 max(center.x + section, center.y + section, -slice_near);
+                    if (!GetTiles(projection_matrix, min, max, range)) continue;
+                }
+                range.light_ = static_cast<uint32_t>(i);
+                range.slice_ = static_cast<uint32_t>(s);
+                ranges_.push_back(range);
+
+                for (uint32_t y = range.y_min_; y <= range.y_max_; y++) {
+                    for (uint32_t x = range.x_min_; x <= range.x_max_; x++) {
+                        clusters_[2 * GetClusterIndex(x, y, s) + 1]++;
+                    }
+                }
+            }
+        }
+
+        /* Offsets of the clusters, then write the indices in light order */
+        uint32_t offset = 0;
+        for (size_t c = 0; c < clusters_.size(); c += 2) {
+            clusters_[c] = offset;
+            offset += clusters_[c + 1];
+            clusters_[c + 1] = 0;
+        }
+        light_indices_.resize(offset);
+
+        for (size_t r = 0; r < ranges_.size(); r++) {
+            ClusterRange_t& range = ranges_[r];
+            for (uint32_t y = range.y_min_; y <= range.y_max_; y++) {
+                for (uint32_t x = range.x_min_; x <= range.x_max_; x++) {
+                    size_t c = 2 * GetClusterIndex(x, y, range.slice_);
+                    light_indices_[clusters_[c] + clusters_[c + 1]] = range.light_;
+                    clusters_[c + 1]++;
+                }
+            }
+        }
+    }
+
+    size_t LightClusters::GetClusterIndex(size_t x, size_t y, size_t slice) {
+        return x + tiles_x_ * (y + tiles_y_ * slice);
+    }
+
+    size_t LightClusters::GetSlice(float depth) {
+        if (depth <= z_near_) return 0;
+
+        float slice = std::log(depth) * slice_scale_ + slice_bias_;
+        if (slice <= 0) return 0;
+        return std::min(static_cast<size_t>(slice), slices_ - 1);
+    }
+
+    float LightClusters::GetSliceDepth(size_t slice) {
+        return z_near_ * std::pow(z_far_ / z_near_, static_cast<float>(slice) / slices_);
+    }
+
+    float LightClusters::GetSliceScale() {
+        return slice_scale_;
+    }
+
+    float LightClusters::GetSliceBias() {
+        return slice_bias_;
+    }
+
+    size_t LightClusters::GetTileSize() {
+        return tile_size_;
+    }
+
+    size_t LightClusters::GetTilesX() {
+        return tiles_x_;
+    }
+
+    size_t LightClusters::GetTilesY() {
+        return tiles_y_;
+    }
+
+    size_t LightClusters::GetSlices() {
+        return slices_;
+    }
+
+    size_t LightClusters::GetNumberOfClusters() {
+        return tiles_x_ * tiles_y_ * slices_;
+    }
+
+    const std::vector<uint32_t>& LightClusters::GetClusters() {
+        return clusters_;
+    }
+
+    const std::vector<uint32_t>& LightClusters::GetLightIndices() {
+        return light_indices_;
+    }
+
+    float LightClusters::GetLightRadius(float constant, float linear, float quadratic, float intensity) {
+        /* Solve quadratic * d^2 + linear * d + constant = intensity / cutoff */
+        float target = intensity / GAME_ENGINE_LIGHT_CLUSTERS_CUTOFF;
+        if (target <= constant) return 0;
+
+        if (quadratic > 0) return (-linear + std::sqrt(linear * linear + 4 * quadratic * (target - constant))) / (2 * quadratic);
+        if (linear > 0) return (target - constant) / linear;
+        return std::numeric_limits<float>::max();
+    }
+
+    bool LightClusters::GetTiles(const glm::mat4& projection_matrix, const glm::vec3& min, const glm::vec3& max, ClusterRange_t& range) {
+        /* The box is in front of the near plane, so the projection of its corners bounds it on the screen */
+        glm::vec2 ndc_min(std::numeric_limits<float>::max());
+        glm::vec2 ndc_max(-std::numeric_limits<float>::max());
+        for (int i = 0; i < 8; i++) {
+            glm::vec4 corner((i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z, 1.0f);
+            glm::vec4 clip = projection_matrix * corner;
+            glm::vec2 ndc = glm::vec2(clip) / clip.w;
+            ndc_min = glm::min(ndc_min, ndc);
+            ndc_max = glm::max(ndc_max, ndc);
+        }
+        if (ndc_max.x < -1 || ndc_min.x > 1 || ndc_max.y < -1 || ndc_min.y > 1) return false;
+
+        float tile_size = static_cast<float>(tile_size_);
+        float x_min = std::floor((ndc_min.x * 0.5f + 0.5f) * width_ / tile_size);
+        float x_max = std::floor((ndc_max.x * 0.5f + 0.5f) * width_ / tile_size);
+        float y_min = std::floor((ndc_min.y * 0.5f + 0.5f) * height_ / tile_size);
+        float y_max = std::floor((ndc_max.y * 0.5f + 0.5f) * height_ / tile_size);
+
+        range.x_min_ = static_cast<uint32_t>(std::max(x_min, 0.0f));
+        range.x_max_ = static_cast<uint32_t>(std::min(x_max, static_cast<float>(tiles_x_ - 1)));
+        range.y_min_ = static_cast<uint32_t>(std::max(y_min, 0.0f));
+        range.y_max_ = static_cast<uint32_t>(std::min(y_max, static_cast<float>(tiles_y_ - 1)));
+        return true;
+    }
+
+}
+}
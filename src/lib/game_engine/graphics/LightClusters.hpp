@@ -0,0 +1,154 @@
+#ifndef __LightClusters_hpp__
+#define __LightClusters_hpp__
+
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+namespace game_engine {
+namespace graphics {
+
+    /* The light intensity below which a point light is ignored, used to calculate its radius */
+#define GAME_ENGINE_LIGHT_CLUSTERS_CUTOFF (1.0f / 256.0f)
+
+    /**
+        Bins point lights into clusters, screen tiles times depth slices, so that a pixel only evaluates the lights of
+        its cluster. The slices are exponential in view space depth, between the near and the far plane of the camera.
+        The clusters are stored in x, y, slice order, each one is an offset and a count in the light indices. Runs on
+        the CPU only, the results are uploaded by the renderer
+    */
+    class LightClusters {
+    public:
+        LightClusters();
+
+        /**
+            @param tile_size The size of a screen tile in pixels
+            @param slices The number of depth slices
+            @return -1 = Already initialised, or zero sizes, 0 = OK
+        */
+        int Init(size_t tile_size, size_t slices);
+
+        int Destroy();
+
+        bool IsInited();
+
+        /**
+            Set the size of the screen, and the depth range of the camera. Changes the number of tiles
+            @param width The width of the screen in pixels
+            @param height The height of the screen in pixels
+            @param z_near The distance of the near plane of the camera
+            @param z_far The distance of the far plane of the camera
+        */
+        void SetView(size_t width, size_t height, float z_near, float z_far);
+
+        /**
+            Bin the lights into the clusters. A light is added to every cluster that its sphere may overlap
+            @param view_matrix The view matrix of the camera
+            @param projection_matrix The projection matrix of the camera
+            @param lights The world space position of each light, and its radius in w
+            @param number_of_lights The number of lights
+        */
+        void Build(const glm::mat4& view_matrix, const glm::mat4& projection_matrix, const glm::vec4 * lights, size_t number_of_lights);
+
+        /**
+            Get the index of a cluster
+            @param x The horizontal tile
+            @param y The vertical tile
+            @param slice The depth slice
+            @return The index
+        */
+        size_t GetClusterIndex(size_t x, size_t y, size_t slice);
+
+        /**
+            Get the depth slice of a view space distance, log(depth) * GetSliceScale() + GetSliceBias()
+            @param depth The distance along the view direction
+            @return The slice, clamped to the slices
+        */
+        size_t GetSlice(float depth);
+
+        /**
+            Get the distance where a depth slice starts
+            @param slice The slice, GetSlices() is the far plane
+            @return The distance along the view direction
+        */
+        float GetSliceDepth(size_t slice);
+
+        float GetSliceScale();
+
+        float GetSliceBias();
+
+        size_t GetTileSize();
+
+        size_t GetTilesX();
+
+        size_t GetTilesY();
+
+        size_t GetSlices();
+
+        size_t GetNumberOfClusters();
+
+        /**
+            Get the clusters, an offset in the light indices and a number of lights for each cluster
+            @return The clusters, two values per cluster
+        */
+        const std::vector<uint32_t>& GetClusters();
+
+        /**
+            Get the indices of the lights of all the clusters
+            @return The indices, in the order of the lights passed to Build()
+        */
+        const std::vector<uint32_t>& GetLightIndices();
+
+        /**
+            Calculate the distance where the attenuated intensity of a point light drops below
+            GAME_ENGINE_LIGHT_CLUSTERS_CUTOFF, for an attenuation of 1 / (constant + linear * d + quadratic * d^2)
+            @param constant The constant attenuation
+            @param linear The linear attenuation
+            @param quadratic The quadratic attenuation
+            @param intensity The highest color component of the light
+            @return The radius, the largest float if the light is not attenuated
+        */
+        static float GetLightRadius(float constant, float linear, float quadratic, float intensity);
+
+    private:
+        /* The tiles a light overlaps in a slice, inclusive */
+        struct ClusterRange_t {
+            uint32_t light_;
+            uint32_t slice_;
+            uint32_t x_min_, x_max_;
+            uint32_t y_min_, y_max_;
+        };
+
+        bool is_inited_ = false;
+
+        size_t tile_size_ = 0;
+        size_t slices_ = 0;
+        size_t width_ = 0;
+        size_t height_ = 0;
+        size_t tiles_x_ = 0;
+        size_t tiles_y_ = 0;
+        float z_near_ = 0;
+        float z_far_ = 0;
+        float slice_scale_ = 0;
+        float slice_bias_ = 0;
+
+        std::vector<uint32_t> clusters_;
+        std::vector<uint32_t> light_indices_;
+        std::vector<ClusterRange_t> ranges_;
+
+        /**
+            Find the tiles covered by a view space box, with all of it in front of the near plane
+            @param projection_matrix The projection matrix
+            @param min The minimum point of the box
+            @param max The maximum point of the box
+            @param[out] range The tiles
+            @return false = The box is outside of the screen, true = OK
+        */
+        bool GetTiles(const glm::mat4& projection_matrix, const glm::vec3& min, const glm::vec3& max, ClusterRange_t& range);
+    };
+
+}
+}
+
+#endif
@@ -0,0 +1,197 @@
+#include "MapBundle.hpp"
+
+#include <cstring>
+
+#include "game_engine/core/ErrorCodes.hpp"
+
+namespace game_engine {
+namespace graphics {
+
+    static uint64_t AlignOffset(uint64_t offset) {
+        return (offset + GAME_ENGINE_MAP_BUNDLE_ALIGNMENT - 1) & ~static_cast<uint64_t>(GAME_ENGINE_MAP_BUNDLE_ALIGNMENT - 1);
+    }
+
+    static bool IsBlobValid(uint64_t offset, uint64_t size, uint64_t file_size) {
+        if (offset % GAME_ENGINE_MAP_BUNDLE_ALIGNMENT != 0) return false;
+        return offset <= file_size && size <= file_size - offset;
+    }
+
+    MapBundle::MapBundle() {
+        is_inited_ = false;
+        header_ = nullptr;
+        regions_ = nullptr;
+    }
+
+    int MapBundle::Init(std::string file_path) {
+        if (is_inited_) return -1;
+
+        int ret = file_.Init(file_path);
+        if (ret) return ret;
+
+        /* Check the header, and that every blob is inside the file, before anything points in it */
+        uint64_t file_size = file_.GetSize();
+        const MapBundleHeader_t * header = reinterpret_cast<const MapBundleHeader_t *>(file_.GetData());
+        bool valid = file_size >= sizeof(MapBundleHeader_t)
+            && header->magic_ == GAME_ENGINE_MAP_BUNDLE_MAGIC
+            && header->version_ == GAME_ENGINE_MAP_BUNDLE_VERSION
+            && header->vertex_size_ == sizeof(Vertex_t)
+            && header->file_size_ == file_size
+            && header->texture_diffuse_[GAME_ENGINE_MAP_BUNDLE_PATH_SIZE - 1] == 0
+            && header->texture_specular_[GAME_ENGINE_MAP_BUNDLE_PATH_SIZE - 1] == 0
+            && IsBlobValid(header->regions_offset_, static_cast<uint64_t>(header->number_of_regions_) * sizeof(MapBundleRegion_t), file_size);
+
+        const MapBundleRegion_t * regions = valid ? reinterpret_cast<const MapBundleRegion_t *>(file_.GetData() + header->regions_offset_) : nullptr;
+        for (uint32_t i = 0; valid && i < header->number_of_regions_; i++) {
+            const MapBundleRegion_t& region = regions[i];
+            valid = IsBlobValid(region.vertices_offset_, static_cast<uint64_t>(region.number_of_vertices_) * sizeof(Vertex_t), file_size)
+                && IsBlobValid(region.indices_offset_, static_cast<uint64_t>(region.number_of_indices_) * sizeof(unsigned int), file_size);
+
+            /* The indices are uploaded as they are, one out of range would read past the vertex buffer */
+            const unsigned int * indices = valid ? reinterpret_cast<const unsigned int *>(file_.GetData() + region.indices_offset_) : nullptr;
+            for (uint32_t j = 0; valid && j < region.number_of_indices_; j++) valid = indices[j] < region.number_of_vertices_;
+        }
+
+        if (!valid) {
+            dt::Console(dt::WARNING, "MapBundle::Init(): Invalid map bundle: " + file_path);
+            file_.Destroy();
+            return Error::ERROR_OBJECT_PARSE;
+        }
+
+        header_ = header;
+        regions_ = regions;
+
+        is_inited_ = true;
+        return 0;
+    }
+
+    int MapBundle::Destroy() {
+        if (!is_inited_) return -1;
+
+        file_.Destroy();
+        header_ = nullptr;
+        regions_ = nullptr;
+
+        is_inited_ = false;
+        return 0;
+    }
+
+    bool MapBundle::IsInited() {
+        return is_inited_;
+    }
+
+    size_t MapBundle::GetNumberOfRegions() {
+        if (!is_inited_) return 0;
+        return header_->number_of_regions_;
+    }
+
+    const MapBundleRegion_t& MapBundle::GetRegion(size_t index) {
+        return regions_[index];
+    }
+
+    const Vertex_t * MapBundle::GetVertices(size_t index) {
+        return reinterpret_cast<const Vertex_t *>(file_.GetData() + regions_[index].vertices_offset_);
+    }
+
+    const unsigned int * MapBundle::GetIndices(size_t index) {
+        return reinterpret_cast<const unsigned int *>(file_.GetData() + regions_[index].indices_offset_);
+    }
+
+    std::string MapBundle::GetTextureDiffuse() {
+        return std::string(header_->texture_diffuse_);
+    }
+
+    std::string MapBundle::GetTextureSpecular() {
+        return std::string(header_->texture_specular_);
+    }
+
+    MapBundleWriter::MapBundleWriter() {
+        is_inited_ = false;
+        offset_ = 0;
+    }
+
+    MapBundleWriter::~MapBundleWriter() {
+        Destroy();
+    }
+
+    int MapBundleWriter::Init(std::string file_path, std::string texture_diffuse, std::string texture_specular) {
+        if (is_inited_) return -1;
+        if (texture_diffuse.size() >= GAME_ENGINE_MAP_BUNDLE_PATH_SIZE || texture_specular.size() >= GAME_ENGINE_MAP_BUNDLE_PATH_SIZE) return -1;
+
+        file_.open(file_path, std::ios::binary | std::ios::trunc);
+        if (!file_.is_open()) return -1;
+
+        std::memset(&header_, 0, sizeof(header_));
+        header_.magic_ = GAME_ENGINE_MAP_BUNDLE_MAGIC;
+        header_.version_ = GAME_ENGINE_MAP_BUNDLE_VERSION;
+        header_.vertex_size_ = sizeof(Vertex_t);
+        std::memcpy(header_.texture_diffuse_, texture_diffuse.c_str(), texture_diffuse.size());
+        std::memcpy(header_.texture_specular_, texture_specular.c_str(), texture_specular.size());
+
+        /* The header is written again when the number of regions is known */
+        file_.write(reinterpret_cast<const char *>(&header_), sizeof(header_));
+        offset_ = sizeof(header_);
+        regions_.clear();
+
+        is_inited_ = true;
+        return 0;
+    }
+
+    int MapBundleWriter::AddRegion(glm::vec3 position, const Vertex_t * vertices, size_t number_of_vertices, const unsigned int * indices, size_t number_of_indices) {
+        if (!is_inited_) return -1;
+
+        MapBundleRegion_t region;
+        std::memset(&region, 0, sizeof(region));
+
+        glm::vec3 min(0), max(0);
+        if (number_of_vertices > 0) min = max = vertices[0].position_;
+        for (size_t v = 0; v < number_of_vertices; v++) {
+            min = glm::min(min, vertices[v].position_);
+            max = glm::max(max, vertices[v].position_);
+        }
+        for (int c = 0; c < 3; c++) {
+            region.position_[c] = position[c];
+            region.min_[c] = min[c];
+            region.max_[c] = max[c];
+        }
+
+        region.number_of_vertices_ = static_cast<uint32_t>(number_of_vertices);
+        region.number_of_indices_ = static_cast<uint32_t>(number_of_indices);
+        region.vertices_offset_ = WriteAligned(vertices, number_of_vertices * sizeof(Vertex_t));
+        region.indices_offset_ = WriteAligned(indices, number_of_indices * sizeof(unsigned int));
+        regions_.push_back(region);
+
+        return 0;
+    }
+
+    int MapBundleWriter::Destroy() {
+        if (!is_inited_) return -1;
+
+        header_.number_of_regions_ = static_cast<uint32_t>(regions_.size());
+        header_.regions_offset_ = WriteAligned(regions_.data(), regions_.size() * sizeof(MapBundleRegion_t));
+        header_.file_size_ = offset_;
+
+        file_.seekp(0);
+        file_.write(reinterpret_cast<const char *>(&header_), sizeof(header_));
+        bool good = file_.good();
+        file_.close();
+        regions_.clear();
+
+        is_inited_ = false;
+        return good ? 0 : -1;
+    }
+
+    bool MapBundleWriter::IsInited() {
+        return is_inited_;
+    }
+
+    uint64_t MapBundleWriter::WriteAligned(const void * data, size_t size) {
+        const char zeros[GAME_ENGINE_MAP_BUNDLE_ALIGNMENT] = { 0 };
+        uint64_t aligned = AlignOffset(offset_);
+        file_.write(zeros, static_cast<std::streamsize>(aligned - offset_));
+        if (size > 0) file_.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+        offset_ = aligned + size;
+        return aligned;
+    }
+
+}
+}
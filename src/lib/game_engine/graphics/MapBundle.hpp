@@ -0,0 +1,173 @@
+#ifndef __MapBundle_hpp__
+#define __MapBundle_hpp__
+
+#include <cstdint>
+#include <string>
+#include <fstream>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "game_engine/core/MappedFile.hpp"
+
+#include "GraphicsTypes.hpp"
+
+namespace game_engine {
+namespace graphics {
+
+    /* "BMAP" in a little endian file */
+#define GAME_ENGINE_MAP_BUNDLE_MAGIC 0x50414D42
+    /* Increase when the layout of the file changes, older bundles are rejected */
+#define GAME_ENGINE_MAP_BUNDLE_VERSION 1
+    /* The alignment of the vertex and index blobs inside the file */
+#define GAME_ENGINE_MAP_BUNDLE_ALIGNMENT 16
+    /* The size of a texture path, including the terminating zero */
+#define GAME_ENGINE_MAP_BUNDLE_PATH_SIZE 128
+
+    /* The header at the start of a map bundle */
+    struct MapBundleHeader_t {
+        uint32_t magic_;
+        uint32_t version_;
+        /* sizeof(Vertex_t) of the tool that wrote the file */
+        uint32_t vertex_size_;
+        uint32_t number_of_regions_;
+        /* Offset of the region table */
+        uint64_t regions_offset_;
+        uint64_t file_size_;
+        /* Paths of the textures of the map, relative to the assets directory */
+        char texture_diffuse_[GAME_ENGINE_MAP_BUNDLE_PATH_SIZE];
+        char texture_specular_[GAME_ENGINE_MAP_BUNDLE_PATH_SIZE];
+    };
+    static_assert(sizeof(MapBundleHeader_t) == 288, "MapBundleHeader_t layout");
+
+    /* An entry of the region table, one packed mesh of the map */
+    struct MapBundleRegion_t {
+        /* The position of the region in the world */
+        float position_[3];
+        /* The bounding box of the vertices, relative to the position */
+        float min_[3];
+        float max_[3];
+        uint32_t number_of_vertices_;
+        uint32_t number_of_indices_;
+        uint32_t padding_;
+        /* Offsets of the Vertex_t and the unsigned int index blobs */
+        uint64_t vertices_offset_;
+        uint64_t indices_offset_;
+    };
+    static_assert(sizeof(MapBundleRegion_t) == 64, "MapBundleRegion_t layout");
+
+    /**
+        A binary file with the packed regions of a map, written by prepare_map_files. It holds a header, a table of the
+        regions, and the vertices and indices of each region in the layout that is uploaded to the GPU. The file is
+        mapped in memory, and the meshes are created straight from it
+    */
+    class MapBundle {
+    public:
+        MapBundle();
+
+        /**
+            Map a bundle and validate its header, its region table, and that the indices of every region are in the
+            range of its vertices
+            @param file_path The path of the bundle
+            @return 0=OK, -1=Already initialised, else see ErrorCodes.hpp
+        */
+        int Init(std::string file_path);
+
+        /**
+            Unmap the bundle, the pointers returned are no longer valid
+            @return 0=OK, -1=Not initialised
+        */
+        int Destroy();
+
+        bool IsInited();
+
+        size_t GetNumberOfRegions();
+
+        const MapBundleRegion_t& GetRegion(size_t index);
+
+        /**
+            Get the vertices of a region, they point inside the mapped file
+            @param index The region
+            @return GetRegion(index).number_of_vertices_ vertices
+        */
+        const Vertex_t * GetVertices(size_t index);
+
+        /**
+            Get the indices of a region, they point inside the mapped file
+            @param index The region
+            @return GetRegion(index).number_of_indices_ indices
+        */
+        const unsigned int * GetIndices(size_t index);
+
+        std::string GetTextureDiffuse();
+
+        std::string GetTextureSpecular();
+
+    private:
+        bool is_inited_;
+        MappedFile file_;
+        const MapBundleHeader_t * header_;
+        const MapBundleRegion_t * regions_;
+    };
+
+    /**
+        Writes a map bundle one region at a time, so that the regions don't have to be kept in memory. The blobs are
+        written as the regions are added, and the region table goes at the end of the file
+    */
+    class MapBundleWriter {
+    public:
+        MapBundleWriter();
+
+        /**
+            Calls Destroy()
+        */
+        ~MapBundleWriter();
+
+        /**
+            Create the file
+            @param file_path The path of the bundle
+            @param texture_diffuse The diffuse texture of the map, relative to the assets directory
+            @param texture_specular The specular texture of the map, relative to the assets directory
+            @return 0=OK, -1=Already initialised, can't open the file, or a path is too long
+        */
+        int Init(std::string file_path, std::string texture_diffuse, std::string texture_specular);
+
+        /**
+            Write a region at the end of the file
+            @param position The position of the region in the world
+            @param vertices The vertices of the region
+            @param number_of_vertices The number of vertices
+            @param indices The triangle indices
+            @param number_of_indices The number of indices
+            @return 0=OK, -1=Not initialised
+        */
+        int AddRegion(glm::vec3 position, const Vertex_t * vertices, size_t number_of_vertices, const unsigned int * indices, size_t number_of_indices);
+
+        /**
+            Write the region table and the header, and close the file
+            @return 0=OK, -1=Not initialised, or writing the file failed
+        */
+        int Destroy();
+
+        bool IsInited();
+
+    private:
+        bool is_inited_;
+        std::ofstream file_;
+        uint64_t offset_;
+        MapBundleHeader_t header_;
+        std::vector<MapBundleRegion_t> regions_;
+
+        /**
+            Write at the end of the file, after zeros up to an aligned offset
+            @param data The data
+            @param size The size of the data in bytes
+            @return The offset of the data in the file
+        */
+        uint64_t WriteAligned(const void * data, size_t size);
+    };
+
+}
+}
+
+#endif
@@ -1,5 +1,8 @@
 #include "Material.hpp"
 
+#include <map>
+#include <tuple>
+
 #include "AssetManager.hpp"
 
 namespace game_engine { namespace graphics {
@@ -10,6 +13,33 @@ namespace game_engine { namespace graphics {
         2 = Overlay
     */
 
+    /* Next material id */
+    static uint32_t material_ids_ = 0;
+    /* Ids of the sets of textures used by the materials so far */
+    static std::map<std::tuple<GLuint, GLuint, GLuint>, uint32_t> texture_set_ids_;
+
+    Material::Material() {
+        material_id_ = material_ids_++;
+        SetSortKey(MATERIAL_SHADER_NONE);
+    }
+
+    uint32_t Material::GetSortKey() {
+        return sort_key_;
+    }
+
+    void Material::SetSortKey(MaterialShader shader, opengl::OpenGLTexture * texture_1, opengl::OpenGLTexture * texture_2, opengl::OpenGLTexture * texture_3) {
+        std::tuple<GLuint, GLuint, GLuint> textures(
+            (texture_1 != nullptr) ? texture_1->GetID() : 0,
+            (texture_2 != nullptr) ? texture_2->GetID() : 0,
+            (texture_3 != nullptr) ? texture_3->GetID() : 0);
+
+        /* Materials that use the same textures share the id */
+        auto itr = texture_set_ids_.find(textures);
+        if (itr == texture_set_ids_.end()) itr = texture_set_ids_.insert({ textures, static_cast<uint32_t>(texture_set_ids_.size()) }).first;
+
+        sort_key_ = ((static_cast<uint32_t>(shader) & 0x3F) << 26) | ((itr->second & 0x3FFF) << 12) | (material_id_ & 0xFFF);
+    }
+
     MaterialDeferredStandard::MaterialDeferredStandard(game_engine::math::Vector3D diffuse, game_engine::math::Vector3D specular, std::string texture_diffuse, std::string texture_specular)
     {
         diffuse_ = diffuse;
@@ -20,12 +50,14 @@ namespace game_engine { namespace graphics {
         texture_specular_ = instance.GetTexture(texture_specular, GAME_ENGINE_TEXTURE_TYPE_SPECULAR_MAP);
 
         rendering_queue_ = 0;
+        instancing_ = true;
+        SetSortKey(MATERIAL_SHADER_GBUFFER_STANDARD, texture_diffuse_, texture_specular_);
     }
-    void MaterialDeferredStandard::Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount) {
-        renderer->DrawGBufferStandard(object, models_buffer, amount, diffuse_.ToGlm(), specular_.ToGlm(), texture_diffuse_, texture_specular_);
+    void MaterialDeferredStandard::Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount) {
+        renderer->DrawGBufferStandard(object, models_buffer, models_offset, amount, diffuse_.ToGlm(), specular_.ToGlm(), texture_diffuse_, texture_specular_);
     }
-    void MaterialDeferredStandard::RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount) {
-        renderer->DrawShadowMap(object, models_buffer, amount);
+    void MaterialDeferredStandard::RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount) {
+        renderer->DrawShadowMap(object, models_buffer, models_offset, amount);
     }
 
 
@@ -42,15 +74,17 @@ namespace game_engine { namespace graphics {
         texture_specular_ = instance.GetTexture(texture_specular, GAME_ENGINE_TEXTURE_TYPE_SPECULAR_MAP);
 
         rendering_queue_ = 1;
+        instancing_ = true;
+        SetSortKey(MATERIAL_SHADER_STANDARD, texture_diffuse_, texture_specular_);
     }
-    void MaterialForwardStandard::Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount)
+    void MaterialForwardStandard::Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount)
     {
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        renderer->DrawStandard(object, models_buffer, amount, ambient_.ToGlm(), diffuse_.ToGlm(), specular_.ToGlm(), shininess_, texture_diffuse_, texture_specular_);
+        renderer->DrawStandard(object, models_buffer, models_offset, amount, ambient_.ToGlm(), diffuse_.ToGlm(), specular_.ToGlm(), shininess_, texture_diffuse_, texture_specular_);
         glDisable(GL_BLEND);
     }
-    void MaterialForwardStandard::RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount)
+    void MaterialForwardStandard::RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount)
     {
         /* TODO objects rendered in a forward pass don't cast shadows currently */
     }
@@ -66,12 +100,13 @@ namespace game_engine { namespace graphics {
         texture_diffuse_ = instance.GetTexture(texture_diffuse, GAME_ENGINE_TEXTURE_TYPE_DIFFUSE_MAP);
 
         rendering_queue_ = 0;
+        SetSortKey(MATERIAL_SHADER_GBUFFER_DISPLACEMENT, texture_displacement_, texture_diffuse_);
     }
-    void MaterialDeferredDisplacement::Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount)
+    void MaterialDeferredDisplacement::Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount)
     {
         renderer->DrawGBufferDisplacement(object, *model_matrix, specular_intensity_, texture_displacement_, displacement_intensity_, texture_diffuse_);
     }
-    void MaterialDeferredDisplacement::RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount)
+    void MaterialDeferredDisplacement::RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount)
     {
         /* TODO Objects rendered with a displacement map don't cast shadows currently */
         return;
@@ -82,12 +117,13 @@ namespace game_engine { namespace graphics {
     MaterialForwardDrawNormals::MaterialForwardDrawNormals(game_engine::math::Vector3D color){
         color_ = color;
         rendering_queue_ = 1;
+        SetSortKey(MATERIAL_SHADER_DRAW_NORMALS);
     }
-    void MaterialForwardDrawNormals::Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount)
+    void MaterialForwardDrawNormals::Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount)
     {
         renderer->DrawNormals(object, *model_matrix, color_.ToGlm());
     }
-    void MaterialForwardDrawNormals::RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount)
+    void MaterialForwardDrawNormals::RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount)
     {
         /* Does not cast shadow */
     }
@@ -98,15 +134,16 @@ namespace game_engine { namespace graphics {
     {
         color_ = color;
         rendering_queue_ = 1;
+        SetSortKey(MATERIAL_SHADER_COLOR);
     }
-    void MaterialForwardColor::Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount)
+    void MaterialForwardColor::Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount)
     {
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
         renderer->DrawColor(object, *model_matrix, color_.ToGlm(), alpha_);
         glDisable(GL_BLEND);
     }
-    void MaterialForwardColor::RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount)
+    void MaterialForwardColor::RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount)
     {
         /* Does not cast shadow */
         /* empty */
@@ -122,12 +159,13 @@ namespace game_engine { namespace graphics {
         texture_displacement_ = instance.GetTexture(texture_displacement, GAME_ENGINE_TEXTURE_TYPE_DISPLACEMENT_MAP);
 
         rendering_queue_ = 1;
+        SetSortKey(MATERIAL_SHADER_DISPLACEMENT_NORMALS, texture_displacement_);
     }
-    void MaterialForwardDisplacementDrawNormals::Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount)
+    void MaterialForwardDisplacementDrawNormals::Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount)
     {
         renderer->DrawDisplacementNormals(object, *model_matrix, texture_displacement_, displacement_intensity_, normal_color_.ToGlm());
     }
-    void MaterialForwardDisplacementDrawNormals::RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount)
+    void MaterialForwardDisplacementDrawNormals::RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount)
     {
         /* Does not cast shadow */
     }
@@ -147,15 +185,16 @@ namespace game_engine { namespace graphics {
         texture_bump_ = instance.GetTexture(texture_bump, GAME_ENGINE_TEXTURE_TYPE_NORMAL_MAP);
 
         rendering_queue_ = 1;
+        SetSortKey(MATERIAL_SHADER_WATER, texture_diffuse_, texture_specular_, texture_bump_);
     }
-    void MaterialForwardWater::Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount)
+    void MaterialForwardWater::Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount)
     {
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
         renderer->DrawWater(object, *model_matrix, ambient_.ToGlm(), diffuse_.ToGlm(), specular_.ToGlm(), shininess_, texture_diffuse_, texture_specular_, texture_bump_, waves_);
         glDisable(GL_BLEND);
     }
-    void MaterialForwardWater::RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount)
+    void MaterialForwardWater::RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount)
     {
         /* Water does not cast shadow */
     }
@@ -167,11 +206,11 @@ namespace game_engine { namespace graphics {
         texture_cubemap_ = new opengl::OpenGLCubemap();
         texture_cubemap_->Init(faces);
     }
-    void MaterialSkybox::Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount)
+    void MaterialSkybox::Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount)
     {
 
     }
-    void MaterialSkybox::RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount)
+    void MaterialSkybox::RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount)
     {
         /* skybox does not cast shadow */
     }
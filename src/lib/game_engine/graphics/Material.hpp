@@ -2,6 +2,7 @@
 #define __Material_hpp__
 
 #include <string>
+#include <cstdint>
 
 #include "opengl/OpenGLRenderer.hpp"
 #include "opengl/OpenGLObject.hpp"
@@ -13,15 +14,56 @@
 
 namespace game_engine { namespace graphics {
 
+    /**
+        Shaders used by the materials, part of the sort key of a draw call
+    */
+    enum MaterialShader {
+        MATERIAL_SHADER_NONE,
+        MATERIAL_SHADER_GBUFFER_STANDARD,
+        MATERIAL_SHADER_GBUFFER_DISPLACEMENT,
+        MATERIAL_SHADER_STANDARD,
+        MATERIAL_SHADER_DISPLACEMENT_NORMALS,
+        MATERIAL_SHADER_DRAW_NORMALS,
+        MATERIAL_SHADER_COLOR,
+        MATERIAL_SHADER_WATER,
+    };
+
     /* Base material */
     class Material {
         friend class Renderer;
     public:
+        /**
+            Assigns a new material id
+        */
+        Material();
         
-        virtual void Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount) = 0;
-        virtual void RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount) = 0;
+        virtual void Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount) = 0;
+        virtual void RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount) = 0;
+
+        /**
+            Get the part of the sort key of a draw call that comes from the material. Materials with the same shader and
+            the same textures get sorted next to each other
+            @return The shader in bits 26-31, the set of textures in bits 12-25, the material id in bits 0-11
+        */
+        uint32_t GetSortKey();
 
         size_t rendering_queue_;
+        /* The material reads the model matrices from the models buffer, its draw calls can be instanced */
+        bool instancing_ = false;
+
+    protected:
+        /**
+            Set the shader and the textures used by the material, for the sort key
+            @param shader The shader
+            @param texture_1 The first texture used, nullptr for none
+            @param texture_2 The second texture used, nullptr for none
+            @param texture_3 The third texture used, nullptr for none
+        */
+        void SetSortKey(MaterialShader shader, opengl::OpenGLTexture * texture_1 = nullptr, opengl::OpenGLTexture * texture_2 = nullptr, opengl::OpenGLTexture * texture_3 = nullptr);
+
+    private:
+        uint32_t material_id_;
+        uint32_t sort_key_;
     };
 
 
@@ -32,8 +74,8 @@ namespace game_engine { namespace graphics {
     public:
         MaterialDeferredStandard(game_engine::math::Vector3D diffuse, game_engine::math::Vector3D specular, std::string texture_diffuse, std::string texture_specular);
 
-        void Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount) override;
-        void RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount) override;
+        void Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount) override;
+        void RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount) override;
 
         game_engine::math::Vector3D diffuse_;
         game_engine::math::Vector3D specular_;
@@ -48,8 +90,8 @@ namespace game_engine { namespace graphics {
     public:
         MaterialForwardStandard(game_engine::math::Vector3D ambient, game_engine::math::Vector3D diffuse, game_engine::math::Vector3D specular, Real_t shininess, std::string texture_diffuse, std::string texture_specular);
 
-        void Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount) override;
-        void RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount) override;
+        void Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount) override;
+        void RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount) override;
 
         game_engine::math::Vector3D ambient_;
         game_engine::math::Vector3D diffuse_;
@@ -66,8 +108,8 @@ namespace game_engine { namespace graphics {
     public:
         MaterialDeferredDisplacement(Real_t specular_intensity, std::string texture_displacement, std::string texture_diffuse);
 
-        void Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount) override;
-        void RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount) override;
+        void Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount) override;
+        void RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount) override;
 
         Real_t specular_intensity_;
         opengl::OpenGLTexture * texture_displacement_;
@@ -82,8 +124,8 @@ namespace game_engine { namespace graphics {
     public:
         MaterialForwardDisplacementDrawNormals (game_engine::math::Vector3D normal_color, std::string texture_displacement);
 
-        void Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount) override;
-        void RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount) override;
+        void Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount) override;
+        void RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount) override;
 
         game_engine::math::Vector3D normal_color_;
         opengl::OpenGLTexture * texture_displacement_;
@@ -97,8 +139,8 @@ namespace game_engine { namespace graphics {
     public:
         MaterialForwardDrawNormals(game_engine::math::Vector3D color);
 
-        void Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount) override;
-        void RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount) override;
+        void Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount) override;
+        void RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount) override;
 
         game_engine::math::Vector3D color_;
     };
@@ -110,8 +152,8 @@ namespace game_engine { namespace graphics {
     public:
         MaterialForwardColor(game_engine::math::Vector3D color);
 
-        void Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount) override;
-        void RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount) override;
+        void Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount) override;
+        void RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount) override;
 
         Real_t alpha_ = 1;
         game_engine::math::Vector3D color_;
@@ -123,8 +165,8 @@ namespace game_engine { namespace graphics {
 
         MaterialForwardWater(game_engine::math::Vector3D ambient, game_engine::math::Vector3D diffuse, game_engine::math::Vector3D specular, Real_t shininess, std::string texture_diffuse, std::string texture_specular, std::string texture_bump);
 
-        void Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount) override;
-        void RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount) override;
+        void Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount) override;
+        void RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount) override;
 
         game_engine::math::Vector3D ambient_;
         game_engine::math::Vector3D diffuse_;
@@ -141,8 +183,8 @@ namespace game_engine { namespace graphics {
     public:
         MaterialSkybox(std::vector<std::string> faces);
 
-        void Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount) override;
-        void RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, size_t amount) override;
+        void Render(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount) override;
+        void RenderShadow(opengl::OpenGLRenderer * renderer, opengl::OpenGLObject & object, glm::mat4 * model_matrix, GLuint models_buffer, GLintptr models_offset, size_t amount) override;
 
         opengl::OpenGLCubemap * texture_cubemap_;
     };
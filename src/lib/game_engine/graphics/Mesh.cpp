@@ -26,6 +26,15 @@ namespace graphics {
         return 0;
     }
 
+    int Mesh::Init(const Vertex_t * vertices, size_t number_of_vertices, const unsigned int * indices, size_t number_of_indices, const glm::vec3 * bounding_box) {
+
+        int ret = opengl_object_.Init(vertices, number_of_vertices, indices, number_of_indices, true, bounding_box);
+        if (ret) return ret;
+
+        is_inited_ = true;
+        return 0;
+    }
+
     int Mesh::Destroy() {
 
         if (!is_inited_) return -1;
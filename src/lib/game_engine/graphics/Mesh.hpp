@@ -15,6 +15,7 @@ namespace graphics {
 
     class Mesh {
         friend class Renderer;
+        friend class Instancing;
     public:
         Mesh();
 
@@ -22,6 +23,18 @@ namespace graphics {
             std::vector<unsigned int> & indices
         );
 
+        /**
+            Initialize the mesh from arrays that are only read during the call, e.g. inside a mapped file. The vertices
+            and the indices are not kept on the CPU side
+            @param vertices The vertices
+            @param number_of_vertices The number of vertices
+            @param indices The triangle indices
+            @param number_of_indices The number of indices
+            @param bounding_box The min and the max of the vertices, calculated if nullptr
+            @return 0=OK, -1=Already initialised, or no vertices
+        */
+        int Init(const Vertex_t * vertices, size_t number_of_vertices, const unsigned int * indices, size_t number_of_indices, const glm::vec3 * bounding_box = nullptr);
+
         int Destroy();
 
         bool IsInited();
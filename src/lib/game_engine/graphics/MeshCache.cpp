@@ -0,0 +1,211 @@
+#include "MeshCache.hpp"
+
+#include <cstring>
+#include <fstream>
+
+#include "game_engine/core/ErrorCodes.hpp"
+#include "game_engine/utility/HashTable.hpp"
+
+namespace game_engine {
+namespace graphics {
+
+    static uint64_t AlignOffset(uint64_t offset) {
+        return (offset + GAME_ENGINE_MESH_CACHE_ALIGNMENT - 1) & ~static_cast<uint64_t>(GAME_ENGINE_MESH_CACHE_ALIGNMENT - 1);
+    }
+
+    static bool IsBlobValid(uint64_t offset, uint64_t size, uint64_t file_size, uint64_t alignment) {
+        if (offset % alignment != 0) return false;
+        return offset <= file_size && size <= file_size - offset;
+    }
+
+    MeshCache::MeshCache() {
+        is_inited_ = false;
+        header_ = nullptr;
+        meshes_ = nullptr;
+    }
+
+    int MeshCache::Init(std::string file_path, uint64_t source_hash) {
+        if (is_inited_) return -1;
+
+        int ret = file_.Init(file_path);
+        if (ret) return ret;
+
+        /* A cache of other sources, or of another version, is stale. Then check that every blob is inside the file */
+        uint64_t file_size = file_.GetSize();
+        const MeshCacheHeader_t * header = reinterpret_cast<const MeshCacheHeader_t *>(file_.GetData());
+        if (file_size < sizeof(MeshCacheHeader_t) || header->magic_ != GAME_ENGINE_MESH_CACHE_MAGIC || header->version_ != GAME_ENGINE_MESH_CACHE_VERSION
+            || header->vertex_size_ != sizeof(Vertex_t) || header->source_hash_ != source_hash) {
+            file_.Destroy();
+            return -1;
+        }
+
+        bool valid = header->file_size_ == file_size
+            && IsBlobValid(header->meshes_offset_, static_cast<uint64_t>(header->number_of_meshes_) * sizeof(MeshCacheMesh_t), file_size, GAME_ENGINE_MESH_CACHE_ALIGNMENT);
+        const MeshCacheMesh_t * meshes = valid ? reinterpret_cast<const MeshCacheMesh_t *>(file_.GetData() + header->meshes_offset_) : nullptr;
+        for (uint32_t i = 0; valid && i < header->number_of_meshes_; i++) {
+            const MeshCacheMesh_t& mesh = meshes[i];
+            valid = IsBlobValid(mesh.vertices_offset_, static_cast<uint64_t>(mesh.number_of_vertices_) * sizeof(Vertex_t), file_size, GAME_ENGINE_MESH_CACHE_ALIGNMENT)
+                && IsBlobValid(mesh.indices_offset_, static_cast<uint64_t>(mesh.number_of_indices_) * sizeof(unsigned int), file_size, GAME_ENGINE_MESH_CACHE_ALIGNMENT)
+                && IsBlobValid(mesh.texture_diffuse_offset_, mesh.texture_diffuse_size_, file_size, 1)
+                && IsBlobValid(mesh.texture_specular_offset_, mesh.texture_specular_size_, file_size, 1);
+        }
+
+        if (!valid) {
+            dt::Console(dt::WARNING, "MeshCache::Init(): Invalid mesh cache: " + file_path);
+            file_.Destroy();
+            return Error::ERROR_OBJECT_PARSE;
+        }
+
+        header_ = header;
+        meshes_ = meshes;
+
+        is_inited_ = true;
+        return 0;
+    }
+
+    int MeshCache::Destroy() {
+        if (!is_inited_) return -1;
+
+        file_.Destroy();
+        header_ = nullptr;
+        meshes_ = nullptr;
+
+        is_inited_ = false;
+        return 0;
+    }
+
+    bool MeshCache::IsInited() {
+        return is_inited_;
+    }
+
+    size_t MeshCache::GetNumberOfMeshes() {
+        if (!is_inited_) return 0;
+        return header_->number_of_meshes_;
+    }
+
+    const MeshCacheMesh_t& MeshCache::GetMesh(size_t index) {
+        return meshes_[index];
+    }
+
+    const Vertex_t * MeshCache::GetVertices(size_t index) {
+        return reinterpret_cast<const Vertex_t *>(file_.GetData() + meshes_[index].vertices_offset_);
+    }
+
+    const unsigned int * MeshCache::GetIndices(size_t index) {
+        return reinterpret_cast<const unsigned int *>(file_.GetData() + meshes_[index].indices_offset_);
+    }
+
+    MeshMaterial_t MeshCache::GetMaterial(size_t index) {
+        const MeshCacheMesh_t& mesh = meshes_[index];
+
+        MeshMaterial_t material;
+        material.diffuse_ = glm::vec3(mesh.diffuse_[0], mesh.diffuse_[1], mesh.diffuse_[2]);
+        material.specular_ = glm::vec3(mesh.specular_[0], mesh.specular_[1], mesh.specular_[2]);
+        material.texture_diffuse_ = std::string(file_.GetData() + mesh.texture_diffuse_offset_, mesh.texture_diffuse_size_);
+        material.texture_specular_ = std::string(file_.GetData() + mesh.texture_specular_offset_, mesh.texture_specular_size_);
+        return material;
+    }
+
+    int MeshCache::Write(std::string file_path, uint64_t source_hash, const std::vector<MeshData_t>& meshes) {
+
+        MeshCacheHeader_t header;
+        std::memset(&header, 0, sizeof(header));
+        header.magic_ = GAME_ENGINE_MESH_CACHE_MAGIC;
+        header.version_ = GAME_ENGINE_MESH_CACHE_VERSION;
+        header.vertex_size_ = sizeof(Vertex_t);
+        header.number_of_meshes_ = static_cast<uint32_t>(meshes.size());
+        header.source_hash_ = source_hash;
+        header.meshes_offset_ = AlignOffset(sizeof(MeshCacheHeader_t));
+
+        /* Lay out the blobs of every mesh after the mesh table, the vertices and the indices aligned */
+        std::vector<MeshCacheMesh_t> table(meshes.size());
+        uint64_t offset = header.meshes_offset_ + meshes.size() * sizeof(MeshCacheMesh_t);
+        for (size_t i = 0; i < meshes.size(); i++) {
+            const MeshData_t& data = meshes[i];
+            MeshCacheMesh_t& mesh = table[i];
+            std::memset(&mesh, 0, sizeof(mesh));
+
+            for (int c = 0; c < 3; c++) {
+                mesh.min_[c] = data.min_[c];
+                mesh.max_[c] = data.max_[c];
+                mesh.diffuse_[c] = data.material_.diffuse_[c];
+                mesh.specular_[c] = data.material_.specular_[c];
+            }
+            mesh.number_of_vertices_ = static_cast<uint32_t>(data.vertices_.size());
+            mesh.number_of_indices_ = static_cast<uint32_t>(data.indices_.size());
+            mesh.texture_diffuse_size_ = static_cast<uint32_t>(data.material_.texture_diffuse_.size());
+            mesh.texture_specular_size_ = static_cast<uint32_t>(data.material_.texture_specular_.size());
+
+            mesh.vertices_offset_ = AlignOffset(offset);
+            offset = mesh.vertices_offset_ + data.vertices_.size() * sizeof(Vertex_t);
+            mesh.indices_offset_ = AlignOffset(offset);
+            offset = mesh.indices_offset_ + data.indices_.size() * sizeof(unsigned int);
+            mesh.texture_diffuse_offset_ = offset;
+            offset += mesh.texture_diffuse_size_;
+            mesh.texture_specular_offset_ = offset;
+            offset += mesh.texture_specular_size_;
+        }
+        header.file_size_ = offset;
+
+        /* Gather the file in memory, and write it with one call */
+        std::vector<char> file_data(static_cast<size_t>(header.file_size_), 0);
+        std::memcpy(&file_data[0], &header, sizeof(header));
+        if (table.size() > 0) std::memcpy(&file_data[header.meshes_offset_], table.data(), table.size() * sizeof(MeshCacheMesh_t));
+        for (size_t i = 0; i < meshes.size(); i++) {
+            const MeshData_t& data = meshes[i];
+            const MeshCacheMesh_t& mesh = table[i];
+            if (data.vertices_.size() > 0) std::memcpy(&file_data[mesh.vertices_offset_], data.vertices_.data(), data.vertices_.size() * sizeof(Vertex_t));
+            if (data.indices_.size() > 0) std::memcpy(&file_data[mesh.indices_offset_], data.indices_.data(), data.indices_.size() * sizeof(unsigned int));
+            if (mesh.texture_diffuse_size_ > 0) std::memcpy(&file_data[mesh.texture_diffuse_offset_], data.material_.texture_diffuse_.data(), mesh.texture_diffuse_size_);
+            if (mesh.texture_specular_size_ > 0) std::memcpy(&file_data[mesh.texture_specular_offset_], data.material_.texture_specular_.data(), mesh.texture_specular_size_);
+        }
+
+        std::ofstream file(file_path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return -1;
+        file.write(&file_data[0], static_cast<std::streamsize>(file_data.size()));
+        if (!file.good()) return -1;
+
+        return 0;
+    }
+
+    int MeshCache::HashSource(std::string file_path, uint64_t& hash) {
+
+        MappedFile file;
+        int ret = file.Init(file_path);
+        if (ret) return ret;
+
+        const char * data = file.GetData();
+        size_t size = file.GetSize();
+        hash = utility::HashTableBytes(data, size);
+
+        /* The materials of the meshes come from the mtllib files, relative to the directory of the .obj */
+        std::string directory = file_path.substr(0, file_path.find_last_of("/\\") + 1);
+        size_t line = 0;
+        while (line < size) {
+            size_t line_end = line;
+            while (line_end < size && data[line_end] != '\n') line_end++;
+
+            size_t c = line;
+            while (c < line_end && (data[c] == ' ' || data[c] == '\t')) c++;
+            if (line_end - c > 7 && std::strncmp(data + c, "mtllib", 6) == 0 && (data[c + 6] == ' ' || data[c + 6] == '\t')) {
+                size_t name = c + 7;
+                size_t name_end = line_end;
+                while (name < name_end && (data[name] == ' ' || data[name] == '\t')) name++;
+                while (name_end > name && (data[name_end - 1] == ' ' || data[name_end - 1] == '\t' || data[name_end - 1] == '\r')) name_end--;
+
+                MappedFile material_file;
+                uint64_t material_hash = 0;
+                if (material_file.Init(directory + std::string(data + name, name_end - name)) == 0) {
+                    material_hash = utility::HashTableBytes(material_file.GetData(), material_file.GetSize());
+                }
+                hash = utility::HashTableMix(hash ^ material_hash) ^ (hash >> 29);
+            }
+
+            line = line_end + 1;
+        }
+
+        return 0;
+    }
+
+}
+}
@@ -0,0 +1,155 @@
+#ifndef __MeshCache_hpp__
+#define __MeshCache_hpp__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "game_engine/core/MappedFile.hpp"
+
+#include "GraphicsTypes.hpp"
+
+namespace game_engine {
+namespace graphics {
+
+    /* "MESH" in a little endian file */
+#define GAME_ENGINE_MESH_CACHE_MAGIC 0x4853454D
+    /* Increase when the layout of the file, or the post processing of the import changes */
+#define GAME_ENGINE_MESH_CACHE_VERSION 1
+    /* The alignment of the vertex and index blobs inside the file */
+#define GAME_ENGINE_MESH_CACHE_ALIGNMENT 16
+    /* Appended to the path of a model to get the path of its cache */
+#define GAME_ENGINE_MESH_CACHE_EXTENSION ".meshcache"
+
+    /* The parameters of the default material of an imported mesh */
+    struct MeshMaterial_t {
+        glm::vec3 diffuse_;
+        glm::vec3 specular_;
+        /* Paths relative to the assets directory */
+        std::string texture_diffuse_;
+        std::string texture_specular_;
+    };
+
+    /* An imported mesh, after the post processing */
+    struct MeshData_t {
+        std::vector<Vertex_t> vertices_;
+        std::vector<unsigned int> indices_;
+        /* The bounding box of the vertices */
+        glm::vec3 min_;
+        glm::vec3 max_;
+        MeshMaterial_t material_;
+    };
+
+    /* The header at the start of a mesh cache */
+    struct MeshCacheHeader_t {
+        uint32_t magic_;
+        uint32_t version_;
+        /* sizeof(Vertex_t) of the program that wrote the file */
+        uint32_t vertex_size_;
+        uint32_t number_of_meshes_;
+        /* The hash of the source files the meshes were imported from */
+        uint64_t source_hash_;
+        /* Offset of the mesh table */
+        uint64_t meshes_offset_;
+        uint64_t file_size_;
+    };
+    static_assert(sizeof(MeshCacheHeader_t) == 40, "MeshCacheHeader_t layout");
+
+    /* An entry of the mesh table */
+    struct MeshCacheMesh_t {
+        uint32_t number_of_vertices_;
+        uint32_t number_of_indices_;
+        float min_[3];
+        float max_[3];
+        float diffuse_[3];
+        float specular_[3];
+        uint32_t texture_diffuse_size_;
+        uint32_t texture_specular_size_;
+        /* Offsets of the Vertex_t and the unsigned int blobs, and of the texture paths */
+        uint64_t vertices_offset_;
+        uint64_t indices_offset_;
+        uint64_t texture_diffuse_offset_;
+        uint64_t texture_specular_offset_;
+    };
+    static_assert(sizeof(MeshCacheMesh_t) == 96, "MeshCacheMesh_t layout");
+
+    /**
+        A binary file with the meshes of a model, as they are after the import, so that the model can be loaded without
+        importing it again. The file is mapped in memory, and the meshes are created straight from it. It holds the
+        hash of the source files of the model, and it is used only while the hash matches
+    */
+    class MeshCache {
+    public:
+        MeshCache();
+
+        /**
+            Map a cache and validate it
+            @param file_path The path of the cache
+            @param source_hash The current hash of the source files, see HashSource()
+            @return 0=OK, -1=Already initialised, or the cache is stale, else see ErrorCodes.hpp
+        */
+        int Init(std::string file_path, uint64_t source_hash);
+
+        /**
+            Unmap the cache, the pointers returned are no longer valid
+            @return 0=OK, -1=Not initialised
+        */
+        int Destroy();
+
+        bool IsInited();
+
+        size_t GetNumberOfMeshes();
+
+        const MeshCacheMesh_t& GetMesh(size_t index);
+
+        /**
+            Get the vertices of a mesh, they point inside the mapped file
+            @param index The mesh
+            @return GetMesh(index).number_of_vertices_ vertices
+        */
+        const Vertex_t * GetVertices(size_t index);
+
+        /**
+            Get the indices of a mesh, they point inside the mapped file
+            @param index The mesh
+            @return GetMesh(index).number_of_indices_ indices
+        */
+        const unsigned int * GetIndices(size_t index);
+
+        /**
+            Get the material parameters of a mesh
+            @param index The mesh
+            @return The parameters
+        */
+        MeshMaterial_t GetMaterial(size_t index);
+
+        /**
+            Write a mesh cache
+            @param file_path The path of the cache
+            @param source_hash The hash of the source files of the meshes
+            @param meshes The meshes
+            @return 0=OK, -1=Can't write the file
+        */
+        static int Write(std::string file_path, uint64_t source_hash, const std::vector<MeshData_t>& meshes);
+
+        /**
+            Hash the contents of a wavefront .obj, and of the material libraries it uses
+            @param file_path The path of the .obj
+            @param[out] hash The hash
+            @return 0=OK, else see ErrorCodes.hpp
+        */
+        static int HashSource(std::string file_path, uint64_t& hash);
+
+    private:
+        bool is_inited_;
+        MappedFile file_;
+        const MeshCacheHeader_t * header_;
+        const MeshCacheMesh_t * meshes_;
+    };
+
+}
+}
+
+#endif
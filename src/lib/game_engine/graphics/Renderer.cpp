@@ -1,5 +1,7 @@
 #include "Renderer.hpp"
 
+#include <algorithm>
+
 #include <glm/glm.hpp>
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/gtc/type_ptr.hpp"
@@ -11,7 +13,7 @@
 #include "game_engine/math/Matrices.hpp"
 #include "opengl/OpenGLIncludes.hpp"
 
-#include "game_engine/graphics/Frustum.hpp"
+#include "FrustumCulling.hpp"
 
 namespace math = game_engine::math;
 namespace gl = game_engine::graphics::opengl;
@@ -37,9 +39,19 @@ namespace graphics {
 
         /* Init render queues */
         point_lights_to_draw_.Init(GAME_ENGINE_GL_RENDERER_MAX_POINT_LIGHTS);
-        rendering_queues_ = std::vector<utility::CircularBuffer<MESH_DRAW_t>>(2);
-        rendering_queues_[0].Init(GAME_ENGINE_RENDERER_MAX_OBJECTS);
-        rendering_queues_[1].Init(GAME_ENGINE_RENDERER_MAX_OBJECTS);
+        rendering_queues_ = std::vector<std::vector<MESH_DRAW_t>>(2);
+        rendering_order_ = std::vector<std::vector<utility::SortKey_t>>(2);
+        draw_lists_ = std::vector<std::vector<MESH_DRAW_t>>(2);
+        shadow_draws_ = std::vector<std::vector<MESH_DRAW_t>>(renderer_->shadow_maps_->GetNCascades());
+        renderer_->shadow_maps_->SetUpdateInterval(ConfigurationFile::GetInstance().GetShadowCascadeInterval());
+        for (size_t i = 0; i < rendering_queues_.size(); i++) {
+            rendering_queues_[i].reserve(GAME_ENGINE_RENDERER_MAX_OBJECTS);
+            rendering_order_[i].reserve(GAME_ENGINE_RENDERER_MAX_OBJECTS);
+            draw_lists_[i].reserve(GAME_ENGINE_RENDERER_MAX_OBJECTS);
+        }
+        sort_scratch_.reserve(GAME_ENGINE_RENDERER_MAX_OBJECTS);
+        instance_matrices_.reserve(GAME_ENGINE_RENDERER_MAX_OBJECTS);
+        instance_buffer_.Init(GAME_ENGINE_RENDERER_INSTANCE_BUFFER_SIZE);
         text_to_draw_.Init(512);
 
         instancing_.Init();
@@ -63,9 +75,6 @@ namespace graphics {
 
     void Renderer::StartFrame() {
         context_->ClearColor();
-        
-        renderer_->shadow_maps_->ClearDepth();
-        renderer_->shadow_maps_->Unbind();
 
         renderer_->g_buffer_->Bind();
         // Light blue
@@ -76,8 +85,8 @@ namespace graphics {
         renderer_->g_buffer_->UnBind();
 
         point_lights_to_draw_.Clear();
-        rendering_queues_[0].Clear();
-        rendering_queues_[1].Clear();
+        rendering_queues_[0].clear();
+        rendering_queues_[1].clear();
         text_to_draw_.Clear();
     }
 
@@ -116,55 +125,54 @@ namespace graphics {
 
         /* Get the meshes of the object to draw, and put them in their respective queues */
 
+        rendering_object->SetModelMatrix();
+
         std::vector<Mesh *>& meshes = rendering_object->model_->meshes_;
         for (size_t j = 0; j < meshes.size(); j++) {
             Mesh * mesh = meshes[j];
             // If the material of  the mesh has been overriden, use the new, otherwise, use the base model material
             Material * material = (rendering_object->model_materials_[j] != nullptr) ? rendering_object->model_materials_[j] : rendering_object->model_->materials_[j];
 
-            utility::CircularBuffer<MESH_DRAW_t>& queue = rendering_queues_[material->rendering_queue_];
+            std::vector<MESH_DRAW_t>& queue = rendering_queues_[material->rendering_queue_];
 
-            if (queue.IsFull()) {
+            if (queue.size() >= GAME_ENGINE_RENDERER_MAX_OBJECTS) {
                 dt::Console(dt::CRITICAL, "Rendering queue: " + std::to_string(material->rendering_queue_) + "is full");
                 return -1;
             }
-            rendering_object->SetModelMatrix();
-            queue.Push(MESH_DRAW_t(mesh, material, &rendering_object->model_matrix_, rendering_object->model_vbo_, 1));
+            /* The model matrix is uploaded in BatchDrawCalls() */
+            queue.push_back(MESH_DRAW_t(mesh, material, &rendering_object->model_matrix_, 0, 1));
         }
 
         return 0;
     }
 
     int Renderer::DrawTriangle(glm::vec3 v1, glm::vec3 v2, glm::vec3 v3, glm::vec3 color) {
+        if (!renderer_->IsInited()) return -1;
 
-        renderer_->g_buffer_->Bind();
-        renderer_->DrawGBufferTriangle(v1, v2, v3, color);
-        renderer_->g_buffer_->UnBind();
+        renderer_->AddDebugTriangle(v1, v2, v3, color);
 
         return 0;
     }
 
     int Renderer::DrawLine(math::Vector3D start, math::Vector3D stop, float size, glm::vec3 color) {
+        if (!renderer_->IsInited()) return -1;
 
-        renderer_->g_buffer_->Bind();
-        renderer_->DrawLine(start.ToGlm(), stop.ToGlm(), color);
-        renderer_->g_buffer_->UnBind();
+        renderer_->AddDebugLine(start.ToGlm(), stop.ToGlm(), color);
 
         return 0;
     }
 
     int Renderer::DrawRectangleXY(math::Rectangle2D rect, float z_height, float size, glm::vec3 color) {
-
         if (!renderer_->IsInited()) return -1;
 
-        renderer_->g_buffer_->Bind();
-        
-        renderer_->DrawLine(glm::vec3(rect.A_.x(), rect.A_.y(), z_height), glm::vec3(rect.B_.x(), rect.B_.y(), z_height));
-        renderer_->DrawLine(glm::vec3(rect.B_.x(), rect.B_.y(), z_height), glm::vec3(rect.C_.x(), rect.C_.y(), z_height));
-        renderer_->DrawLine(glm::vec3(rect.C_.x(), rect.C_.y(), z_height), glm::vec3(rect.D_.x(), rect.D_.y(), z_height));
-        renderer_->DrawLine(glm::vec3(rect.D_.x(), rect.D_.y(), z_height), glm::vec3(rect.A_.x(), rect.A_.y(), z_height));
-
-        renderer_->g_buffer_->UnBind();
+        glm::vec3 a(rect.A_.x(), rect.A_.y(), z_height);
+        glm::vec3 b(rect.B_.x(), rect.B_.y(), z_height);
+        glm::vec3 c(rect.C_.x(), rect.C_.y(), z_height);
+        glm::vec3 d(rect.D_.x(), rect.D_.y(), z_height);
+        renderer_->AddDebugLine(a, b, color);
+        renderer_->AddDebugLine(b, c, color);
+        renderer_->AddDebugLine(c, d, color);
+        renderer_->AddDebugLine(d, a, color);
 
         return 0;
     }
@@ -189,9 +197,28 @@ namespace graphics {
         return 0;
     }
 
-    void Renderer::AddInstance(Material * material, Mesh * mesh, glm::mat4 & position)
+    InstanceId_t Renderer::AddInstance(Material * material, Mesh * mesh, glm::mat4 & position)
+    {
+        return instancing_.AddInstance(mesh, material, position);
+    }
+
+    int Renderer::RemoveInstance(InstanceId_t id)
     {
-        instancing_.AddInstance(mesh, material, position);
+        return instancing_.RemoveInstance(id);
+    }
+
+    int Renderer::UpdateInstance(InstanceId_t id, glm::mat4 & position)
+    {
+        return instancing_.UpdateInstance(id, position);
+    }
+
+    InstanceId_t Renderer::RayCastInstances(glm::vec3 origin, glm::vec3 direction, float max_distance) {
+        float distance;
+        return instancing_.RayCast(origin, direction, max_distance, distance);
+    }
+
+    void Renderer::QueryInstances(glm::vec3 min, glm::vec3 max, std::vector<InstanceId_t>& result) {
+        instancing_.QueryBox(min, max, result);
     }
 
     int Renderer::SetCamera(gl::OpenGLCamera * camera) {
@@ -205,50 +232,197 @@ namespace graphics {
     }
 
     int Renderer::RenderGBuffer(MESH_DRAW_t& draw_call) {
-        frr_render_mode = static_cast<RENDER_MODE>(ConfigurationFile::GetInstance().GetRenderingMethod());
-        switch (frr_render_mode)
-        {
-        case RENDER_MODE::REGULAR:
-        {
-                Mesh * mesh = draw_call.mesh_;
-                draw_call.material_->Render(renderer_, mesh->opengl_object_, draw_call.model_matrix_, draw_call.model_matrix_vbo_, draw_call.amount_);
-                draw_calls_++;
-            break;
-        }
-        case RENDER_MODE::VIEW_FRUSTUM_CULLING:
-        {
-            /* Initialize camera frustum */
-            Frustum f;
-            float * p = (float*)glm::value_ptr(camera_->GetProjectionMatrix());
-            float * v = (float*)glm::value_ptr(camera_->GetViewMatrix());
-            float m[16];
-            MultMat(m, v, p);
-            f.SetFrustum(m);
+        Mesh * mesh = draw_call.mesh_;
+        draw_call.material_->Render(renderer_, mesh->opengl_object_, draw_call.model_matrix_, draw_call.model_matrix_vbo_, draw_call.model_matrix_offset_, draw_call.amount_);
+        draw_calls_++;
 
-            Mesh * mesh = draw_call.mesh_;
+        return 0;
+    }
+
+    uint64_t Renderer::GetSortKey(MESH_DRAW_t& draw_call, glm::vec3& camera_position) {
+        uint64_t queue = draw_call.material_->rendering_queue_ & 0x3;
+        uint64_t material = draw_call.material_->GetSortKey();
+        uint64_t mesh = draw_call.mesh_->opengl_object_.GetVertexArrayID() & 0x3FFF;
+
+        /* Instanced draw calls are spread around, they don't have a depth */
+        uint64_t depth = 0;
+        if (draw_call.amount_ == 1) {
             glm::mat4& model_matrix = *draw_call.model_matrix_;
+            float distance = glm::length(glm::vec3(model_matrix[3]) - camera_position);
+            depth = static_cast<uint64_t>(std::min(distance / GAME_ENGINE_RENDERER_DEPTH_BUCKET_SIZE, 65535.0f));
+        }
+
+        if (queue == 0) return (queue << 62) | (material << 30) | (mesh << 16) | depth;
+        return (queue << 62) | ((0xFFFF - depth) << 46) | (material << 14) | mesh;
+    }
+
+    void Renderer::SortRenderingQueues() {
+        glm::vec3 camera_position = camera_->GetPositionVector();
+
+        for (size_t q = 0; q < rendering_queues_.size(); q++) {
+            std::vector<MESH_DRAW_t>& queue = rendering_queues_[q];
+            std::vector<utility::SortKey_t>& order = rendering_order_[q];
+
+            order.resize(queue.size());
+            for (size_t i = 0; i < queue.size(); i++) {
+                queue[i].sort_key_ = GetSortKey(queue[i], camera_position);
+                order[i] = { queue[i].sort_key_, static_cast<uint32_t>(i) };
+            }
+
+            utility::RadixSort(order, sort_scratch_);
+        }
+    }
 
-            /* Get object position */
-            float x_offset = model_matrix[3][0];
-            float y_offset = model_matrix[3][1];
-            float z_offset = model_matrix[3][2];
-
-            /* Get aabox */
-            opengl::OpenGLObject & gl_object = mesh->opengl_object_;
-            Vector3D min({ gl_object.min_x_ + x_offset, gl_object.min_y_ + y_offset, gl_object.min_z_ + z_offset });
-            Vector3D max({ gl_object.max_x_ + x_offset, gl_object.max_y_ + y_offset, gl_object.max_z_ + z_offset });
-            AABox<3> box(min, max);
-            int ret = f.BoxInFrustum(box);
-            if (ret != Frustum::OUTSIDE) {
-                draw_call.material_->Render(renderer_, mesh->opengl_object_, draw_call.model_matrix_, draw_call.model_matrix_vbo_, draw_call.amount_);
-                draw_calls_++;
+    void Renderer::BatchDrawCalls() {
+        GLuint instance_buffer = instance_buffer_.GetID();
+        instance_matrices_.clear();
+
+        for (size_t q = 0; q < rendering_queues_.size(); q++) {
+            std::vector<MESH_DRAW_t>& queue = rendering_queues_[q];
+            std::vector<utility::SortKey_t>& order = rendering_order_[q];
+            std::vector<MESH_DRAW_t>& draws = draw_lists_[q];
+            draws.clear();
+
+            for (size_t i = 0; i < order.size(); i++) {
+                MESH_DRAW_t& draw_call = queue[order[i].index_];
+                if (draw_call.batch_ != nullptr || draw_call.amount_ != 1 || !draw_call.material_->instancing_) {
+                    draws.push_back(draw_call);
+                    continue;
+                }
+
+                /* The matrices of the last draw call are the last ones written, add this one after them */
+                if (q == 0 && !draws.empty()) {
+                    MESH_DRAW_t& last = draws.back();
+                    if (last.model_matrix_vbo_ == instance_buffer && last.mesh_ == draw_call.mesh_ && last.material_ == draw_call.material_) {
+                        instance_matrices_.push_back(*draw_call.model_matrix_);
+                        last.amount_++;
+                        continue;
+                    }
+                }
+
+                draws.push_back(draw_call);
+                MESH_DRAW_t& draw = draws.back();
+                draw.model_matrix_vbo_ = instance_buffer;
+                draw.model_matrix_offset_ = instance_matrices_.size() * sizeof(glm::mat4);
+                instance_matrices_.push_back(*draw_call.model_matrix_);
             }
+        }
+
+    }
+
+    void Renderer::CullDrawCalls() {
+        GLuint instance_buffer = instance_buffer_.GetID();
 
-            break;
+        /* The frustum and the rendering mode are the same for all the draw calls of the frame */
+        frr_render_mode = static_cast<RENDER_MODE>(ConfigurationFile::GetInstance().GetRenderingMethod());
+        bool cull_draw_calls = frr_render_mode == RENDER_MODE::VIEW_FRUSTUM_CULLING;
+        glm::vec4 planes[6];
+        ExtractFrustumPlanes(camera_->GetProjectionMatrix() * camera_->GetViewMatrix(), planes);
+        SetFrustumPlanes(planes, frustum_planes_);
+
+        /* Gather the world space boxes of the draw calls that are not instance batches, in the order of the draw calls */
+        std::vector<MESH_DRAW_t>& draws = draw_lists_[0];
+        culling_boxes_.Clear();
+        for (size_t i = 0; i < draws.size(); i++) {
+            MESH_DRAW_t& draw_call = draws[i];
+            if (draw_call.batch_ != nullptr) continue;
+
+            opengl::OpenGLObject& gl_object = draw_call.mesh_->opengl_object_;
+            glm::vec3 min(gl_object.min_x_, gl_object.min_y_, gl_object.min_z_);
+            glm::vec3 max(gl_object.max_x_, gl_object.max_y_, gl_object.max_z_);
+            /* Merged draw calls keep their matrices in the instance matrices, the pointer is set after the upload */
+            glm::mat4 * model_matrices = draw_call.model_matrix_;
+            if (draw_call.model_matrix_vbo_ == instance_buffer) model_matrices = &instance_matrices_[draw_call.model_matrix_offset_ / sizeof(glm::mat4)];
+            for (size_t j = 0; j < draw_call.amount_; j++) {
+                glm::vec3 world_min, world_max;
+                TransformBox(min, max, model_matrices[j], world_min, world_max);
+                culling_boxes_.Add(world_min, world_max);
+            }
         }
+
+        /* The instances are culled with their tree, whole subtrees outside of the frustum are skipped */
+        instancing_.CullInstances(planes, 6);
+        culling_visible_.clear();
+        if (cull_draw_calls) CullBoxes(frustum_planes_, culling_boxes_, culling_visible_);
+        CompactDrawCalls(cull_draw_calls, gbuffer_draws_);
+    }
+
+    void Renderer::CullShadowCasters() {
+        opengl::OpenGLCShadowMaps * shadow_maps = renderer_->shadow_maps_;
+        for (size_t i = 0; i < shadow_draws_.size(); i++) {
+            shadow_draws_[i].clear();
+            if (!shadow_maps->NeedsUpdate(i)) continue;
+
+            /* Objects between the light and the cascade cast shadows in it, so the near plane is dropped. A plane with a zero normal keeps everything */
+            glm::vec4 planes[6];
+            ExtractFrustumPlanes(shadow_maps->GetLightspaceMatrix(i), planes);
+            planes[4] = glm::vec4(0, 0, 0, 1);
+            FrustumPlanes_t cascade_planes;
+            SetFrustumPlanes(planes, cascade_planes);
+
+            instancing_.CullInstances(planes, 6);
+            culling_visible_.clear();
+            CullBoxes(cascade_planes, culling_boxes_, culling_visible_);
+            CompactDrawCalls(true, shadow_draws_[i]);
         }
+    }
 
-        return 0;
+    void Renderer::CompactDrawCalls(bool cull_draw_calls, std::vector<MESH_DRAW_t>& visible_draws) {
+        GLuint instance_buffer = instance_buffer_.GetID();
+        std::vector<MESH_DRAW_t>& draws = draw_lists_[0];
+
+        /* The visible boxes are in increasing order, so the boxes of each draw call are next to each other */
+        visible_draws.clear();
+        size_t box_start = 0;
+        size_t v = 0;
+        for (size_t i = 0; i < draws.size(); i++) {
+            MESH_DRAW_t& draw_call = draws[i];
+
+            /* A batch is drawn with its visible instances only */
+            if (draw_call.batch_ != nullptr) {
+                Instancing::InstanceBatch_t * batch = draw_call.batch_;
+                size_t visible = batch->visible_.size();
+                if (visible == batch->model_matrices_.size()) {
+                    visible_draws.push_back(draw_call);
+                } else if (visible > 0) {
+                    MESH_DRAW_t culled_draw_call = draw_call;
+                    culled_draw_call.model_matrix_vbo_ = instance_buffer;
+                    culled_draw_call.model_matrix_offset_ = instance_matrices_.size() * sizeof(glm::mat4);
+                    culled_draw_call.amount_ = visible;
+                    for (size_t j = 0; j < visible; j++) instance_matrices_.push_back(batch->model_matrices_[batch->visible_[j]]);
+                    visible_draws.push_back(culled_draw_call);
+                }
+                continue;
+            }
+
+            if (!cull_draw_calls) {
+                visible_draws.push_back(draw_call);
+                continue;
+            }
+
+            /* An instanced draw call is drawn if any of its instances is inside */
+            size_t first_visible = v;
+            while (v < culling_visible_.size() && culling_visible_[v] < box_start + draw_call.amount_) v++;
+            if (v > first_visible) visible_draws.push_back(draw_call);
+            box_start += draw_call.amount_;
+        }
+    }
+
+    void Renderer::UploadInstanceMatrices() {
+        GLuint instance_buffer = instance_buffer_.GetID();
+
+        /* Upload all the matrices at once, and move the offsets to where they were written */
+        GLintptr offset = instance_buffer_.Upload(instance_matrices_.data(), instance_matrices_.size() * sizeof(glm::mat4));
+        auto move_offsets = [&](std::vector<MESH_DRAW_t>& draws) {
+            for (size_t i = 0; i < draws.size(); i++) {
+                if (draws[i].model_matrix_vbo_ != instance_buffer) continue;
+                draws[i].model_matrix_ = &instance_matrices_[draws[i].model_matrix_offset_ / sizeof(glm::mat4)];
+                draws[i].model_matrix_offset_ += offset;
+            }
+        };
+        for (size_t q = 0; q < draw_lists_.size(); q++) move_offsets(draw_lists_[q]);
+        move_offsets(gbuffer_draws_);
+        for (size_t i = 0; i < shadow_draws_.size(); i++) move_offsets(shadow_draws_[i]);
     }
 
     int Renderer::AddPointLight(PointLight * light) {
@@ -261,51 +435,95 @@ namespace graphics {
         return 0;
     }
 
+    void Renderer::SetLights() {
+        size_t number_of_point_lights = point_lights_to_draw_.Items();
+        renderer_->SetPointLightsNumber(number_of_point_lights);
+        for (size_t i = 0; i < number_of_point_lights; i++) {
+            PointLight * light;
+            point_lights_to_draw_.Get(light);
+            renderer_->SetPointLight(i,
+                light->position_,
+                light->ambient_,
+                light->diffuse_,
+                light->specular_,
+                light->attenutation_.constant_,
+                light->attenutation_.linear_,
+                light->attenutation_.quadratic_
+            );
+        }
+        renderer_->UploadLights();
+    }
+
     void Renderer::FlushDrawCalls() {
 
-        /* If instanced data have not been prepared, prepare them, should happen only once */
-        if (!instancing_.buffers_prepared_) {
-            instancing_.PrepareBuffers();
-        }
-        /* Get instanced draw calls, and put them in their respective rendering queues */
-        for (size_t i = 0; i < instancing_.instanced_draws_.size(); i++) {
-            Instancing::InstanceDrawCall data = instancing_.instanced_draws_[i];
-            rendering_queues_[data.material_->rendering_queue_].Push(MESH_DRAW_t(data.mesh_, data.material_, data.model_matrices_, data.model_matrices_buffer_, data.amount_));
+        /* Upload the instances changed since the last frame, and put a draw call per batch in its rendering queue */
+        instancing_.UpdateBuffers();
+        instancing_.UpdateTree();
+        for (size_t i = 0; i < instancing_.batches_.size(); i++) {
+            Instancing::InstanceBatch_t * batch = instancing_.batches_[i];
+            if (batch->model_matrices_.empty()) continue;
+
+            MESH_DRAW_t draw_call(batch->mesh_, batch->material_, &batch->model_matrices_[0], batch->buffer_, batch->model_matrices_.size());
+            draw_call.batch_ = batch;
+            rendering_queues_[batch->material_->rendering_queue_].push_back(draw_call);
         }
 
-        draw_calls_ = 0;
-        draw_calls_shadows_ = 0;
+        /* Group the draw calls by their state, and instance the ones that share a mesh and a material */
+        SortRenderingQueues();
+        BatchDrawCalls();
 
         /* Check if shadows are enabled or not */
         ConsoleCommand command = ConsoleParser::GetInstance().GetLastCommand();
         if (command.type_ == COMMAND_SHADOW_MAPPING) shadows = static_cast<bool>(command.arg_1_);
         renderer_->use_shadows_ = shadows;
-        
-        if (shadows && light_shadows_ != nullptr) {
-            /* Calculate the cascaded shadow maps matrices */
+        bool draw_shadows = shadows && light_shadows_ != nullptr;
+
+        /* Calculate the cascaded shadow maps matrices. Shadow maps not drawn in the last frame are out of date */
+        if (draw_shadows) {
+            if (!shadows_drawn_) renderer_->shadow_maps_->Invalidate();
             renderer_->shadow_maps_->CalculateProjectionMatrices(light_shadows_->direction_, camera_);
+        }
+        shadows_drawn_ = draw_shadows;
+
+        /* Cull the gbuffer queue and the shadow casters of each cascade before any draw call, and upload the matrices of the frame at once */
+        CullDrawCalls();
+        if (draw_shadows) CullShadowCasters();
+        UploadInstanceMatrices();
+
+        draw_calls_ = 0;
+        draw_calls_shadows_ = 0;
+        renderer_->ResetStateChanges();
+
+        if (draw_shadows) {
+            /* Casters between the light and the near plane are clamped to it, instead of clipped */
+            glEnable(GL_DEPTH_CLAMP);
 
-            /* Render each shadow maps with all the objects in the GBuffer */
+            /* Render each shadow map that needs an update with its casters */
             size_t n_of_cascades = renderer_->shadow_maps_->GetNCascades();
             for (size_t i = 0; i < n_of_cascades; i++) {
+                if (!renderer_->shadow_maps_->NeedsUpdate(i)) continue;
+
                 renderer_->shadow_maps_->Bind(i);
                 renderer_->shadow_maps_->ConfigureViewport();
                 renderer_->EnableColorWriting(false);
                 renderer_->EnableDepthWriting(true);
+                glClear(GL_DEPTH_BUFFER_BIT);
                 renderer_->SetShadowMap(renderer_->shadow_maps_->GetLightspaceMatrix(i));
 
                 //glCullFace(GL_FRONT);
                 glDisable(GL_CULL_FACE);
 
-                /* Iterate the gbuffer queue */
-                utility::CircularBuffer<MESH_DRAW_t>& queue = rendering_queues_[0];
-                for (utility::CircularBuffer<MESH_DRAW_t>::iterator itr = queue.begin(); itr != queue.end(); ++itr) {
-                    MESH_DRAW_t& draw_call = *itr;
+                /* Iterate the casters of the cascade */
+                renderer_->ResetState();
+                std::vector<MESH_DRAW_t>& draws = shadow_draws_[i];
+                for (size_t j = 0; j < draws.size(); j++) {
+                    MESH_DRAW_t& draw_call = draws[j];
                     Mesh * mesh = draw_call.mesh_;
 
-                    draw_call.material_->RenderShadow(renderer_, mesh->opengl_object_, draw_call.model_matrix_, draw_call.model_matrix_vbo_, draw_call.amount_);
+                    draw_call.material_->RenderShadow(renderer_, mesh->opengl_object_, draw_call.model_matrix_, draw_call.model_matrix_vbo_, draw_call.model_matrix_offset_, draw_call.amount_);
                     draw_calls_shadows_++;
                 }
+                renderer_->ResetState();
 
                 //glCullFace(GL_BACK);
                 glEnable(GL_CULL_FACE);
@@ -313,6 +531,7 @@ namespace graphics {
             }
             renderer_->shadow_maps_->Unbind();
             renderer_->EnableColorWriting(true);
+            glDisable(GL_DEPTH_CLAMP);
         }
 
         command = ConsoleParser::GetInstance().GetLastCommand();
@@ -326,11 +545,11 @@ namespace graphics {
         glViewport(0, 0, context_->GetWindowWidth(), context_->GetWindowHeight());
         /* Bind the gbuffer, and draw the geometry */
         renderer_->g_buffer_->Bind();
-        utility::CircularBuffer<MESH_DRAW_t>& queue = rendering_queues_[0];
-        for (utility::CircularBuffer<MESH_DRAW_t>::iterator itr = queue.begin(); itr != queue.end(); ++itr) {
-            MESH_DRAW_t& draw_call = *itr;
-            RenderGBuffer(draw_call);
+        renderer_->ResetState();
+        for (size_t i = 0; i < gbuffer_draws_.size(); i++) {
+            RenderGBuffer(gbuffer_draws_[i]);
         }
+        renderer_->ResetState();
         renderer_->g_buffer_->UnBind();
         renderer_->DrawWireframe(false);
         
@@ -391,24 +610,7 @@ namespace graphics {
             }
             else {
                 /* Draw final scene, set point lights in the scene */
-                size_t number_of_point_lights_ = point_lights_to_draw_.Items();
-                renderer_->SetPointLightsNumber(number_of_point_lights_);
-                for (size_t i = 0; i < number_of_point_lights_; i++) {
-                    std::string index = std::to_string(i);
-
-                    PointLight * light;
-                    point_lights_to_draw_.Get(light);
-                    renderer_->SetPointLight(index,
-                        light->position_,
-                        light->ambient_,
-                        light->diffuse_,
-                        light->specular_,
-                        light->attenutation_.constant_,
-                        light->attenutation_.linear_,
-                        light->attenutation_.quadratic_
-                    );
-                }
-
+                SetLights();
                 renderer_->DrawFinalPass(ssao_texture);
             }
         } else {
@@ -417,23 +619,7 @@ namespace graphics {
             /* Clear the color of frame buffer to one, since this texture will be used as the ambient color texture */
             renderer_->frame_buffer_one_->ClearColor(1.0f, 1.0f, 1.0f, 1.0f);
 
-            size_t number_of_point_lights_ = point_lights_to_draw_.Items();
-            renderer_->SetPointLightsNumber(number_of_point_lights_);
-            for (size_t i = 0; i < number_of_point_lights_; i++) {
-                std::string index = std::to_string(i);
-
-                PointLight * light;
-                point_lights_to_draw_.Get(light);
-                renderer_->SetPointLight(index,
-                    light->position_,
-                    light->ambient_,
-                    light->diffuse_,
-                    light->specular_,
-                    light->attenutation_.constant_,
-                    light->attenutation_.linear_,
-                    light->attenutation_.quadratic_
-                );
-            }
+            SetLights();
             renderer_->DrawFinalPass(renderer_->frame_buffer_one_->output_texture_);
             draw_calls_++;
         }
@@ -441,14 +627,18 @@ namespace graphics {
         
         /* Render forward queue */
         renderer_->DrawWireframe(draw_wireframe_);
-        queue = rendering_queues_[1];
-        for (utility::CircularBuffer<MESH_DRAW_t>::iterator itr = queue.begin(); itr != queue.end(); ++itr) {
-            MESH_DRAW_t& draw_call = *itr;
+        renderer_->ResetState();
+        for (size_t i = 0; i < draw_lists_[1].size(); i++) {
+            MESH_DRAW_t& draw_call = draw_lists_[1][i];
             Mesh * mesh = draw_call.mesh_;
 
-            draw_call.material_->Render(renderer_, mesh->opengl_object_, draw_call.model_matrix_, draw_call.model_matrix_vbo_, draw_call.amount_);
+            draw_call.material_->Render(renderer_, mesh->opengl_object_, draw_call.model_matrix_, draw_call.model_matrix_vbo_, draw_call.model_matrix_offset_, draw_call.amount_);
             draw_calls_++;
         }
+        /* The debug lines and triangles of the frame */
+        int debug_draw_calls = renderer_->DrawDebugGeometry();
+        if (debug_draw_calls > 0) draw_calls_ += debug_draw_calls;
+        renderer_->ResetState();
         renderer_->DrawWireframe(false);
 
 
@@ -461,10 +651,14 @@ namespace graphics {
             TEXT_DRAW_t text;
             text_to_draw_.Get(text);
             renderer_->Draw2DText(text.text_, text.x, text.y, text.scale, text.color);
-            draw_calls_++;
         }
+        /* All the text is drawn with one draw call */
+        draw_calls_++;
         renderer_->Draw2DText("Draw calls: " + std::to_string(draw_calls_), 0.0f, context_->GetWindowHeight() - 50, 0.5, glm::vec3(1, 0, 0));
         renderer_->Draw2DText("Shadow draw calls: " + std::to_string(draw_calls_shadows_) , 0.0f, context_->GetWindowHeight() - 80, 0.5, glm::vec3(1, 0, 0));
+        state_changes_ = renderer_->GetStateChanges();
+        renderer_->Draw2DText("State changes: " + std::to_string(state_changes_), 0.0f, context_->GetWindowHeight() - 110, 0.5, glm::vec3(1, 0, 0));
+        renderer_->Draw2DTexts();
     }
 
 }
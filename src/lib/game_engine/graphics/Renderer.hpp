@@ -9,7 +9,9 @@
 #include "game_engine/graphics/opengl/OpenGLObject.hpp"
 #include "game_engine/graphics/opengl/OpenGLTexture.hpp"
 #include "game_engine/graphics/opengl/OpenGLCamera.hpp"
+#include "game_engine/graphics/opengl/OpenGLRingBuffer.hpp"
 #include "game_engine/utility/CircularBuffer.hpp"
+#include "game_engine/utility/RadixSort.hpp"
 
 #include "GraphicsTypes.hpp"
 #include "GraphicsObject.hpp"
@@ -18,6 +20,7 @@
 #include "Light.hpp"
 #include "Material.hpp"
 #include "Instancing.hpp"
+#include "FrustumCulling.hpp"
 
 namespace game_engine {
     
@@ -26,7 +29,11 @@ namespace game_engine {
 
 namespace graphics {
 
-#define GAME_ENGINE_RENDERER_MAX_OBJECTS 600
+#define GAME_ENGINE_RENDERER_MAX_OBJECTS 8192
+/* Initial size of the buffer for the model matrices of each frame, in bytes */
+#define GAME_ENGINE_RENDERER_INSTANCE_BUFFER_SIZE (4 * 1024 * 1024)
+/* Distance from the camera covered by a depth bucket of the sort key */
+#define GAME_ENGINE_RENDERER_DEPTH_BUCKET_SIZE 0.05f
 
     class Renderer {
         friend game_engine::GameEngine;
@@ -67,6 +74,11 @@ namespace graphics {
         */
         int Draw(GraphicsObject * rendering_object);
 
+        /**
+            Draws a triangle with a single color. Like the lines, it's batched with the debug geometry of the frame, and
+            drawn after the forward queue without lighting
+            @return 0 = OK, -1 = Not initialised
+        */
         int DrawTriangle(glm::vec3 v1, glm::vec3 v2, glm::vec3 v3, glm::vec3 = { 1, 1, 1 });
 
         /**
@@ -121,9 +133,46 @@ namespace graphics {
         int Draw2DText(std::string text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color);
 
         /**
-        
+            Add an instance of a mesh, drawn every frame until it's removed. Instances of the same mesh and material
+            are drawn with a single instanced draw call
+            @param material The material
+            @param mesh The mesh
+            @param position The model matrix of the instance
+            @return The id of the instance
+        */
+        InstanceId_t AddInstance(Material * material, Mesh * mesh, glm::mat4& position);
+
+        /**
+            Remove an instance added with AddInstance()
+            @param id The id of the instance
+            @return 0 = OK, -1 = No such instance
+        */
+        int RemoveInstance(InstanceId_t id);
+
+        /**
+            Change the model matrix of an instance added with AddInstance()
+            @param id The id of the instance
+            @param position The new model matrix
+            @return 0 = OK, -1 = No such instance
+        */
+        int UpdateInstance(InstanceId_t id, glm::mat4& position);
+
+        /**
+            Find the first instance hit by a ray, with the world space boxes of the instances
+            @param origin The origin of the ray
+            @param direction The direction of the ray
+            @param max_distance The maximum distance along the direction
+            @return The id of the instance, GAME_ENGINE_INSTANCE_NONE if nothing was hit
+        */
+        InstanceId_t RayCastInstances(glm::vec3 origin, glm::vec3 direction, float max_distance);
+
+        /**
+            Find the instances with world space boxes that overlap a box
+            @param min The minimum point of the box
+            @param max The maximum point of the box
+            @param[out] result The ids of the instances are appended here
         */
-        void AddInstance(Material * material, Mesh * mesh, glm::mat4& position);
+        void QueryInstances(glm::vec3 min, glm::vec3 max, std::vector<InstanceId_t>& result);
 
     private:
 
@@ -132,8 +181,14 @@ namespace graphics {
             Mesh * mesh_ = nullptr;
             Material * material_ = nullptr;
             GLuint model_matrix_vbo_;
+            /* Offset of the first model matrix in the model_matrix_vbo_ */
+            GLintptr model_matrix_offset_ = 0;
             glm::mat4 * model_matrix_;
             size_t amount_;
+            /* Order of the draw call in its queue, see GetSortKey() */
+            uint64_t sort_key_ = 0;
+            /* The instance batch drawn, culled per instance */
+            Instancing::InstanceBatch_t * batch_ = nullptr;
             MESH_DRAW_t() {};
             MESH_DRAW_t(Mesh * mesh, Material * material, glm::mat4 * model_matrix, GLuint model_matrix_vbo, size_t amount) : 
                 mesh_(mesh), material_(material), model_matrix_(model_matrix), model_matrix_vbo_(model_matrix_vbo), amount_(amount) {};
@@ -152,7 +207,23 @@ namespace graphics {
         /* Hold the point lights to draw per frame */
         utility::CircularBuffer<PointLight *> point_lights_to_draw_;
         /* Two rendering queues, first is gbuffer object, second is forward render object */
-        std::vector<utility::CircularBuffer<MESH_DRAW_t>> rendering_queues_;
+        std::vector<std::vector<MESH_DRAW_t>> rendering_queues_;
+        /* The order to draw each rendering queue, sorted by SortRenderingQueues() */
+        std::vector<std::vector<utility::SortKey_t>> rendering_order_;
+        std::vector<utility::SortKey_t> sort_scratch_;
+        /* The draw calls of each rendering queue, sorted and instanced by BatchDrawCalls() */
+        std::vector<std::vector<MESH_DRAW_t>> draw_lists_;
+        /* The model matrices of the draw calls instanced in this frame, and the buffer they are uploaded to */
+        std::vector<glm::mat4> instance_matrices_;
+        /* The view frustum of the frame, the world space boxes of the gbuffer draw calls, and the visible boxes */
+        FrustumPlanes_t frustum_planes_;
+        CullingBoxes_t culling_boxes_;
+        std::vector<uint32_t> culling_visible_;
+        /* The visible draw calls of the gbuffer queue, built by CullDrawCalls() */
+        std::vector<MESH_DRAW_t> gbuffer_draws_;
+        /* The shadow casters of each cascade, built by CullShadowCasters() */
+        std::vector<std::vector<MESH_DRAW_t>> shadow_draws_;
+        opengl::OpenGLRingBuffer instance_buffer_;
         /* Hold the text to draw */
         utility::CircularBuffer<TEXT_DRAW_t> text_to_draw_;
         /* */
@@ -177,6 +248,7 @@ namespace graphics {
         bool ssao_blur = true;
         bool draw_ssao_texture = false;
         bool shadows = false;
+        bool shadows_drawn_ = false;
         bool draw_wireframe_ = false;
 
         /**
@@ -192,14 +264,73 @@ namespace graphics {
         */
         int RenderGBuffer(MESH_DRAW_t& draw_call);
 
+        /**
+            Get the sort key of a draw call. For the gbuffer queue the key is, from the most significant bits, the
+            queue (2 bits), the material key (32 bits, see Material::GetSortKey()), the mesh (14 bits) and the depth
+            bucket (16 bits), so draw calls that share a shader, textures and mesh are drawn one after the other, front
+            to back. The forward queue is blended, so the inverted depth bucket comes right after the queue, to draw
+            back to front
+            @param draw_call The draw call
+            @param camera_position The position of the camera
+            @return The key
+        */
+        uint64_t GetSortKey(MESH_DRAW_t& draw_call, glm::vec3& camera_position);
+
+        /**
+            Calculate the sort keys of all the draw calls, and radix sort the order of each rendering queue
+        */
+        void SortRenderingQueues();
+
+        /**
+            Build the draw lists from the sorted rendering queues. The model matrices of the draw calls with materials
+            that support instancing are written in a single buffer. In the gbuffer queue, draw calls of the same mesh
+            and material are next to each other after sorting, and are merged into a single instanced draw call. The
+            forward queue is drawn in depth order, its draw calls are not merged
+        */
+        void BatchDrawCalls();
+
+        /**
+            Build the visible draw calls of the gbuffer queue. The frustum is extracted once, and the visible draw calls
+            are compacted to gbuffer_draws_. Instance batches are always culled per instance, with the tree of the
+            instances, and the model matrices of the visible instances of a partially visible batch are added to the
+            instance matrices. The world space boxes of the other draw calls are tested in a single pass, only in the
+            VIEW_FRUSTUM_CULLING rendering mode, and a draw call is drawn if any of its instances is visible
+        */
+        void CullDrawCalls();
+
+        /**
+            Build the shadow casters of each cascade that needs an update, from the gbuffer queue. The casters are culled
+            with the light space volume of the cascade without its near plane, so that objects between the light and the
+            cascade are kept. Uses the boxes gathered by CullDrawCalls()
+        */
+        void CullShadowCasters();
+
+        /**
+            Compact the visible draw calls of the gbuffer queue, after the instances and the boxes have been culled
+            @param cull_draw_calls Use the visible boxes for the draw calls that are not instance batches, or keep them all
+            @param[out] visible_draws The visible draw calls
+        */
+        void CompactDrawCalls(bool cull_draw_calls, std::vector<MESH_DRAW_t>& visible_draws);
+
+        /**
+            Upload the instance matrices of the frame, and point the draw calls that use them to where they were written
+        */
+        void UploadInstanceMatrices();
+
+        /**
+            Set the point lights of the frame, and upload all the lights once for the final pass and the forward shaders
+        */
+        void SetLights();
+
         /**
             Main rendering pipeline, Gbuffer rendering, AO calculation, final pass
         */
         void FlushDrawCalls();
 
-        /* Used to count the number of draw calls per frame */
+        /* Used to count the number of draw calls and state changes per frame */
         size_t draw_calls_;
         size_t draw_calls_shadows_;
+        size_t state_changes_;
     };
 
 }
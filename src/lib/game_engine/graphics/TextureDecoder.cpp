@@ -0,0 +1,133 @@
+#include "TextureDecoder.hpp"
+
+#include <algorithm>
+
+/* The failure reason is a global variable, written by the decoder threads at the same time */
+#define STBI_NO_FAILURE_STRINGS
+#define STB_IMAGE_IMPLEMENTATION
+#include "external/stb_image/stb_image.h"
+
+#include "game_engine/core/ErrorCodes.hpp"
+
+namespace game_engine {
+namespace graphics {
+
+    TextureDecoder::TextureDecoder() {
+        is_inited_ = false;
+    }
+
+    TextureDecoder::~TextureDecoder() {
+        Destroy();
+    }
+
+    int TextureDecoder::Init(size_t number_of_threads) {
+        if (is_inited_) return -1;
+
+        run_ = true;
+        pending_ = 0;
+        number_of_threads = std::max(number_of_threads, static_cast<size_t>(1));
+        for (size_t i = 0; i < number_of_threads; i++) threads_.push_back(std::thread(&TextureDecoder::run, this));
+
+        is_inited_ = true;
+        return 0;
+    }
+
+    int TextureDecoder::Destroy() {
+        if (!is_inited_) return -1;
+
+        {
+            std::unique_lock<std::mutex> l(lock_);
+            run_ = false;
+            requests_.clear();
+        }
+        request_condition_.notify_all();
+        for (size_t i = 0; i < threads_.size(); i++) threads_[i].join();
+        threads_.clear();
+
+        for (size_t i = 0; i < decoded_.size(); i++) Free(decoded_[i]);
+        decoded_.clear();
+        pending_ = 0;
+
+        is_inited_ = false;
+        return 0;
+    }
+
+    bool TextureDecoder::IsInited() {
+        return is_inited_;
+    }
+
+    int TextureDecoder::Schedule(const std::string& file_path) {
+        if (!is_inited_) return -1;
+
+        {
+            std::unique_lock<std::mutex> l(lock_);
+            requests_.push_back(file_path);
+            pending_++;
+        }
+        request_condition_.notify_one();
+        return 0;
+    }
+
+    bool TextureDecoder::Poll(DecodedImage_t& image) {
+        std::unique_lock<std::mutex> l(lock_);
+        if (decoded_.empty()) return false;
+
+        image = decoded_.front();
+        decoded_.pop_front();
+        pending_--;
+        return true;
+    }
+
+    bool TextureDecoder::Wait(DecodedImage_t& image) {
+        std::unique_lock<std::mutex> l(lock_);
+        decoded_condition_.wait(l, [&]() { return !decoded_.empty() || pending_ == 0; });
+        if (decoded_.empty()) return false;
+
+        image = decoded_.front();
+        decoded_.pop_front();
+        pending_--;
+        return true;
+    }
+
+    size_t TextureDecoder::GetNumberOfPending() {
+        std::unique_lock<std::mutex> l(lock_);
+        return pending_;
+    }
+
+    int TextureDecoder::Decode(const std::string& file_path, DecodedImage_t& image) {
+        image.path_ = file_path;
+        image.data_ = stbi_load(file_path.c_str(), &image.width_, &image.height_, &image.channels_, 0);
+        image.error_ = (image.data_ != nullptr) ? 0 : Error::ERROR_ASSET_NOT_FOUND;
+        return image.error_;
+    }
+
+    void TextureDecoder::Free(DecodedImage_t& image) {
+        if (image.data_ != nullptr) stbi_image_free(image.data_);
+        image.data_ = nullptr;
+    }
+
+    void TextureDecoder::run() {
+        while (1) {
+            std::string file_path;
+            {
+                std::unique_lock<std::mutex> l(lock_);
+                request_condition_.wait(l, [&]() { return !requests_.empty() || !run_; });
+                if (!run_) break;
+
+                file_path = requests_.front();
+                requests_.pop_front();
+            }
+
+            DecodedImage_t image;
+            Decode(file_path, image);
+
+            {
+                std::unique_lock<std::mutex> l(lock_);
+                decoded_.push_back(image);
+            }
+            decoded_condition_.notify_all();
+        }
+    }
+
+}
+}
@@ -0,0 +1,120 @@
+#ifndef __TextureDecoder_hpp__
+#define __TextureDecoder_hpp__
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace game_engine {
+namespace graphics {
+
+    /* The default number of decoding threads */
+#define GAME_ENGINE_TEXTURE_DECODER_THREADS 2
+
+    /* The pixels of an image file, 8 bits per channel, rows from top to bottom */
+    struct DecodedImage_t {
+        std::string path_;
+        int width_ = 0;
+        int height_ = 0;
+        int channels_ = 0;
+        /* Allocated by the decoder, free with TextureDecoder::Free() */
+        unsigned char * data_ = nullptr;
+        /* 0=OK, else see ErrorCodes.hpp */
+        int error_ = 0;
+    };
+
+    /**
+        Decodes image files on worker threads. Files are decoded in the order they are scheduled, and the images are
+        taken with Poll() in the order they finish. Doesn't use OpenGL, the pixels are uploaded by the caller
+    */
+    class TextureDecoder {
+    public:
+        /**
+            Does nothing explicit. See Init()
+        */
+        TextureDecoder();
+
+        /**
+            Calls Destroy()
+        */
+        ~TextureDecoder();
+
+        /**
+            Start the worker threads
+            @param number_of_threads The number of threads, at least one
+            @return 0=OK, -1=Already initialised
+        */
+        int Init(size_t number_of_threads = GAME_ENGINE_TEXTURE_DECODER_THREADS);
+
+        /**
+            Stop the worker threads. The files not decoded yet are dropped, and the images not taken are freed
+            @return 0=OK, -1=Not initialised
+        */
+        int Destroy();
+
+        bool IsInited();
+
+        /**
+            Schedule a file to be decoded. Returns immediately
+            @param file_path The path of the image file
+            @return 0=OK, -1=Not initialised
+        */
+        int Schedule(const std::string& file_path);
+
+        /**
+            Take a decoded image, if there is one. Doesn't block
+            @param[out] image The image, owned by the caller afterwards
+            @return true = An image was taken, false = None is decoded yet
+        */
+        bool Poll(DecodedImage_t& image);
+
+        /**
+            Take a decoded image, waiting for one if none is decoded yet
+            @param[out] image The image, owned by the caller afterwards
+            @return true = An image was taken, false = No files are scheduled
+        */
+        bool Wait(DecodedImage_t& image);
+
+        /**
+            Get the number of files scheduled, whose images haven't been taken yet
+            @return The number of files
+        */
+        size_t GetNumberOfPending();
+
+        /**
+            Decode an image file on the calling thread
+            @param file_path The path of the image file
+            @param[out] image The image. On error, the data is nullptr
+            @return 0=OK, else see ErrorCodes.hpp
+        */
+        static int Decode(const std::string& file_path, DecodedImage_t& image);
+
+        /**
+            Free the pixels of an image
+            @param image The image
+        */
+        static void Free(DecodedImage_t& image);
+
+    private:
+        bool is_inited_;
+        bool run_;
+        std::vector<std::thread> threads_;
+
+        std::mutex lock_;
+        std::condition_variable request_condition_;
+        std::condition_variable decoded_condition_;
+        std::deque<std::string> requests_;
+        std::deque<DecodedImage_t> decoded_;
+        /* Scheduled files, whose images haven't been taken */
+        size_t pending_;
+
+        void run();
+    };
+
+}
+}
+
+#endif
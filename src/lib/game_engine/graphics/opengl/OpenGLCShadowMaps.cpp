@@ -5,6 +5,7 @@
 
 #include <limits>
 #include <algorithm>
+#include <cmath>
 
 #include "debug_tools/Console.hpp"
 namespace dt = debug_tools;
@@ -144,6 +145,23 @@ namespace game_engine { namespace graphics { namespace opengl {
             float y = glm::ceil(glm::dot(frustum_bs_center, light_side) * (width_ / 2) / frustum_bs_radius) * frustum_bs_radius / (width_ / 2);
             frustum_bs_center = light_up * x + light_side * y + light_direction * glm::dot(frustum_bs_center, light_direction);
 
+            /* Distant cascades keep their shadow map until their turn comes, or the light or the camera move too much */
+            bool update = true;
+            if (i >= GAME_ENGINE_SHADOW_MAPS_FIRST_CACHED_CASCADE && update_interval_ > 1 && cascade_valid_[i]) {
+                float tolerance = GAME_ENGINE_SHADOW_MAPS_CACHE_TOLERANCE * frustum_bs_radius;
+                bool scheduled = (frame_ + i) % update_interval_ == 0;
+                bool moved = glm::distance(frustum_bs_center, cascade_centers_[i]) > tolerance || std::abs(frustum_bs_radius - cascade_radii_[i]) > tolerance;
+                bool turned = glm::dot(light_direction, cascade_light_directions_[i]) < GAME_ENGINE_SHADOW_MAPS_CACHE_LIGHT_TOLERANCE;
+                update = scheduled || moved || turned;
+            }
+            needs_update_[i] = update;
+            if (!update) continue;
+
+            cascade_valid_[i] = true;
+            cascade_centers_[i] = frustum_bs_center;
+            cascade_radii_[i] = frustum_bs_radius;
+            cascade_light_directions_[i] = light_direction;
+
             /* Calculate view and projection matrices */
             view_matrices_[i] = glm::lookAt(
                 frustum_bs_center - light_direction * frustum_bs_radius,
@@ -154,6 +172,19 @@ namespace game_engine { namespace graphics { namespace opengl {
             
             lightspace_[i] = projection_matrices_[i] * view_matrices_[i];
         }
+        frame_++;
+    }
+
+    void OpenGLCShadowMaps::SetUpdateInterval(size_t interval) {
+        update_interval_ = std::max<size_t>(interval, 1);
+    }
+
+    bool OpenGLCShadowMaps::NeedsUpdate(size_t index) {
+        return needs_update_[index];
+    }
+
+    void OpenGLCShadowMaps::Invalidate() {
+        for (size_t i = 0; i < n_shadow_maps_; i++) cascade_valid_[i] = false;
     }
 
     void OpenGLCShadowMaps::ActivateTextures(size_t index)
@@ -11,8 +11,16 @@
 
 namespace game_engine { namespace graphics { namespace opengl {
 
+/* The first cascade that can be cached, the closer ones are updated every frame */
+#define GAME_ENGINE_SHADOW_MAPS_FIRST_CACHED_CASCADE 2
+/* How far the center of a cached cascade can move, relative to its radius, before it's updated */
+#define GAME_ENGINE_SHADOW_MAPS_CACHE_TOLERANCE 0.05f
+/* Minimum cosine of the angle between the light direction of a cached cascade and the current one */
+#define GAME_ENGINE_SHADOW_MAPS_CACHE_LIGHT_TOLERANCE 0.9995f
+
     /*
-        Cascaded shadow maps, with 4 cascades
+        Cascaded shadow maps, with 4 cascades. The distant cascades can be updated every few frames, and keep their
+        shadow map and matrices in between, as long as the light and the camera don't move much
     */
     class OpenGLCShadowMaps {
     public:
@@ -42,6 +50,25 @@ namespace game_engine { namespace graphics { namespace opengl {
         */
         void CalculateProjectionMatrices(glm::vec3 light_direction, OpenGLCamera * camera);
 
+        /**
+            Set how often the distant cascades are updated. Each one is updated in a different frame
+            @param interval Update the distant cascades every interval frames, 1 = every frame
+        */
+        void SetUpdateInterval(size_t interval);
+
+        /**
+            Check if a cascade has to be drawn this frame, after CalculateProjectionMatrices(). Cascades that don't,
+            keep their previous shadow map and matrices
+            @param index The cascade
+            @return true = Draw it, false = Keep the previous one
+        */
+        bool NeedsUpdate(size_t index);
+
+        /**
+            Force all the cascades to be updated in the next frame, when the shadow maps are out of date
+        */
+        void Invalidate();
+
         /**
             Activate all cascades for reading, at GL_TEXTURE0 + index, index+1, index+2
             @param index The start of the texture ids to activate, added to GL_TEXTURE0
@@ -83,6 +110,15 @@ namespace game_engine { namespace graphics { namespace opengl {
         glm::mat4 projection_matrices_[4];
         glm::mat4 lightspace_[4];
         GLfloat cascade_limits_[5];
+
+        /* Cascade caching, the center, radius and light direction of the last update of each cascade */
+        size_t update_interval_ = 1;
+        size_t frame_ = 0;
+        bool needs_update_[4] = { true, true, true, true };
+        bool cascade_valid_[4] = { false, false, false, false };
+        glm::vec3 cascade_centers_[4];
+        float cascade_radii_[4];
+        glm::vec3 cascade_light_directions_[4];
     };
 
 }
@@ -79,6 +79,7 @@ namespace game_engine { namespace graphics { namespace opengl {
         ret += shader_displacement_draw_normals_.Init(shaders_dir + "/Terrain/VertexShaderTessellation.glsl", shaders_dir + "/Terrain/FragmentShaderDisplacementDrawNormals.glsl", shaders_dir + "/Terrain/TessellationControlShaderDisplacement.glsl", shaders_dir + "/Terrain/TessellationEvaluationShaderDisplacementDrawNormals.glsl", shaders_dir + "/Terrain/GeometryShaderDisplacementDrawNormals.glsl");
         ret += shader_water_.Init(shaders_dir + "/Terrain/VertexShaderTessellation.glsl", shaders_dir + "/Terrain/FragmentShaderWater.glsl", shaders_dir + "/Terrain/TessellationControlShaderDisplacement.glsl", shaders_dir + "/Terrain/TessellationEvaluationShaderWater.glsl");
         ret += shader_skybox_.Init(shaders_dir + "/VertexShaderSkybox.glsl", shaders_dir + "/FragmentShaderSkybox.glsl");
+        ret += shader_debug_.Init(shaders_dir + "/VertexShaderDebug.glsl", shaders_dir + "/FragmentShaderDebug.glsl");
         if (ret) dt::Console(dt::CRITICAL, "Shaders compilation failed");
         
         is_inited_ = true;
@@ -118,6 +118,7 @@ namespace game_engine { namespace graphics { namespace opengl {
         OpenGLShaderDisplacementDrawNormals shader_displacement_draw_normals_;
         OpenGLShaderWater shader_water_;
         OpenGLShaderSkybox shader_skybox_;
+        OpenGLShaderDebug shader_debug_;
 
         GLFWwindow * glfw_window_ = nullptr;
     };
@@ -14,22 +14,27 @@ namespace game_engine { namespace graphics { namespace opengl {
     }
     
     int OpenGLObject::Init(std::vector<Vertex_t> & vertices, std::vector<unsigned int> & indices, bool generate_bbox_info) {
+        return Init(vertices.data(), vertices.size(), indices.data(), indices.size(), generate_bbox_info);
+    }
+
+    int OpenGLObject::Init(const Vertex_t * vertices, size_t number_of_vertices, const unsigned int * indices, size_t number_of_indices, bool generate_bbox_info, const glm::vec3 * bounding_box) {
         if (is_inited_) return -1;
+        if (number_of_vertices == 0) return -1;
     
         glGenVertexArrays(1, &VAO_);
         glBindVertexArray(VAO_);
     
         glGenBuffers(1, &vertex_buffer_);
         glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex_t), &vertices[0], GL_STATIC_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, number_of_vertices * sizeof(Vertex_t), vertices, GL_STATIC_DRAW);
     
         glGenBuffers(1, &element_buffer_);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, element_buffer_);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
-        total_indices_ = indices.size();
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, number_of_indices * sizeof(unsigned int), indices, GL_STATIC_DRAW);
+        total_indices_ = number_of_indices;
     
         /* Generate geometry for the bounding box */
-        if (generate_bbox_info) GenerateBoundingBox(vertices);
+        if (generate_bbox_info) GenerateBoundingBox(vertices, number_of_vertices, bounding_box);
     
         is_inited_ = true;
         return 0;
@@ -145,6 +150,10 @@ namespace game_engine { namespace graphics { namespace opengl {
         return is_inited_;
     }
 
+    GLuint OpenGLObject::GetVertexArrayID() {
+        return VAO_;
+    }
+
     GLuint OpenGLObject::GetVertexBufferID() {
         return vertex_buffer_;
     }
@@ -163,7 +172,7 @@ namespace game_engine { namespace graphics { namespace opengl {
         return std::abs(max_x_ - min_x_) * std::abs(max_y_ - min_y_) * std::abs(max_z_ - min_z_);
     }
     
-    void OpenGLObject::GenerateBoundingBox(std::vector<game_engine::graphics::Vertex_t>& vertices) {
+    void OpenGLObject::GenerateBoundingBox(const game_engine::graphics::Vertex_t * vertices, size_t number_of_vertices, const glm::vec3 * bounding_box) {
     
         /* VAO_bbox_ holds the VAO for a bounding box without faces */
         glGenVertexArrays(1, &VAO_bbox_);
@@ -226,17 +235,26 @@ namespace game_engine { namespace graphics { namespace opengl {
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cube_elements_faces), cube_elements_faces, GL_STATIC_DRAW);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     
-        /* Calculate bbox sizes */
-        min_x_ = max_x_ = vertices[0].position_.x;
-        min_y_ = max_y_ = vertices[0].position_.y;
-        min_z_ = max_z_ = vertices[0].position_.z;
-        for (size_t i = 0; i < vertices.size(); i++) {
-            if (vertices[i].position_.x < min_x_) min_x_ = vertices[i].position_.x;
-            if (vertices[i].position_.x > max_x_) max_x_ = vertices[i].position_.x;
-            if (vertices[i].position_.y < min_y_) min_y_ = vertices[i].position_.y;
-            if (vertices[i].position_.y > max_y_) max_y_ = vertices[i].position_.y;
-            if (vertices[i].position_.z < min_z_) min_z_ = vertices[i].position_.z;
-            if (vertices[i].position_.z > max_z_) max_z_ = vertices[i].position_.z;
+        /* Calculate bbox sizes, unless they are given */
+        if (bounding_box != nullptr) {
+            min_x_ = bounding_box[0].x;
+            min_y_ = bounding_box[0].y;
+            min_z_ = bounding_box[0].z;
+            max_x_ = bounding_box[1].x;
+            max_y_ = bounding_box[1].y;
+            max_z_ = bounding_box[1].z;
+        } else {
+            min_x_ = max_x_ = vertices[0].position_.x;
+            min_y_ = max_y_ = vertices[0].position_.y;
+            min_z_ = max_z_ = vertices[0].position_.z;
+            for (size_t i = 0; i < number_of_vertices; i++) {
+                if (vertices[i].position_.x < min_x_) min_x_ = vertices[i].position_.x;
+                if (vertices[i].position_.x > max_x_) max_x_ = vertices[i].position_.x;
+                if (vertices[i].position_.y < min_y_) min_y_ = vertices[i].position_.y;
+                if (vertices[i].position_.y > max_y_) max_y_ = vertices[i].position_.y;
+                if (vertices[i].position_.z < min_z_) min_z_ = vertices[i].position_.z;
+                if (vertices[i].position_.z > max_z_) max_z_ = vertices[i].position_.z;
+            }
         }
         glm::vec3 size = glm::vec3(max_x_ - min_x_, max_y_ - min_y_, max_z_ - min_z_);
         glm::vec3 center = glm::vec3((min_x_ + max_x_) / 2, (min_y_ + max_y_) / 2, (min_z_ + max_z_) / 2);
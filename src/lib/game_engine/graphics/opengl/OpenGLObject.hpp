@@ -34,6 +34,18 @@ namespace opengl {
         */
         int Init(std::vector<game_engine::graphics::Vertex_t> & vertices, std::vector<unsigned int> & indices, bool generate_bbox_info = true);
 
+        /**
+            Initialize OpenGL VAO and VBO from arrays, e.g. inside a mapped file
+            @param vertices Object vertices, uvs, normals
+            @param number_of_vertices The number of vertices
+            @param indices Triangle indices
+            @param number_of_indices The number of indices
+            @param generate_bbox_info Calculate bounding box?
+            @param bounding_box The min and the max of the vertices if they are known, else nullptr
+            @return 0=OK, -1=Already initialised, or no vertices
+        */
+        int Init(const game_engine::graphics::Vertex_t * vertices, size_t number_of_vertices, const unsigned int * indices, size_t number_of_indices, bool generate_bbox_info = true, const glm::vec3 * bounding_box = nullptr);
+
         void SetVertices(std::vector<game_engine::graphics::Vertex_t> & vertices);
 
         /* Setup shaders parameters */
@@ -60,6 +72,12 @@ namespace opengl {
         */
         bool IsInited();
 
+        /**
+            Get the vertex array OpenGL ID
+            @return The id
+        */
+        GLuint GetVertexArrayID();
+
         /**
             Get the vertex buffer OpenGL ID
             @return The id
@@ -95,7 +113,7 @@ namespace opengl {
         GLuint VAO_bbox_, VAO_bbox_faces_, vertex_buffer_bbox_, element_buffer_bbox_, element_buffer_bbox_faces_;
         glm::mat4 bbox_transform_;
 
-        void GenerateBoundingBox(std::vector<game_engine::graphics::Vertex_t>& vertices);
+        void GenerateBoundingBox(const game_engine::graphics::Vertex_t * vertices, size_t number_of_vertices, const glm::vec3 * bounding_box);
     };
 
 
@@ -1,5 +1,7 @@
 #include "OpenGLRenderer.hpp"
 
+#include <cstddef>
+
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "game_engine/core/ConsoleParser.hpp"
@@ -24,7 +26,9 @@ namespace game_engine { namespace graphics { namespace opengl {
         frame_buffer_one_ = new OpenGLFrameBufferTexture();
         frame_buffer_two_ = new OpenGLFrameBufferTexture();
         shadow_maps_ = new OpenGLCShadowMaps();
-    
+
+        for (size_t i = 0; i < GAME_ENGINE_GL_RENDERER_STATE_TEXTURE_UNITS; i++) state_textures_[i] = GL_STATE_UNKNOWN;
+        lights_ = LightsBlock_t();
     }
     
     int OpenGLRenderer::Init(OpenGLContext * context) {
@@ -49,15 +53,16 @@ namespace game_engine { namespace graphics { namespace opengl {
             /* The G buffer shader */
             shader_gbuffer_ = context_->shader_gbuffer_;
             shader_gbuffer_.Use();
-            shader_gbuffer_.SetUniformInt(shader_gbuffer_.GetUniformLocation("object_material.texture_diffuse"), 0);
-            shader_gbuffer_.SetUniformInt(shader_gbuffer_.GetUniformLocation("object_material.texture_specular"), 1);
+            shader_gbuffer_.SetUniformInt(shader_gbuffer_.uni_material_texture_diffuse_, 0);
+            shader_gbuffer_.SetUniformInt(shader_gbuffer_.uni_material_texture_specular_, 1);
         }
 
         {
             shader_standard_ = context_->shader_standard_;
             shader_standard_.Use();
-            shader_standard_.SetUniformInt(shader_standard_.GetUniformLocation("object_material.texture_diffuse"), 0);
-            shader_standard_.SetUniformInt(shader_standard_.GetUniformLocation("object_material.texture_specular"), 1);
+            shader_standard_.SetUniformInt(shader_standard_.uni_material_texture_diffuse_, 0);
+            shader_standard_.SetUniformInt(shader_standard_.uni_material_texture_specular_, 1);
+            shader_standard_.SetUniformBlockBinding(shader_lights_block, GAME_ENGINE_GL_RENDERER_LIGHTS_BINDING);
         }
     
         {
@@ -164,6 +169,9 @@ namespace game_engine { namespace graphics { namespace opengl {
             shader_final_pass_.SetUniformInt(shader_final_pass_.uni_shadow_map_1_, 5);
             shader_final_pass_.SetUniformInt(shader_final_pass_.uni_shadow_map_2_, 6);
             shader_final_pass_.SetUniformInt(shader_final_pass_.uni_shadow_map_3_, 7);
+            shader_final_pass_.SetUniformInt(shader_final_pass_.uni_light_clusters_, 8);
+            shader_final_pass_.SetUniformInt(shader_final_pass_.uni_light_cluster_indices_, 9);
+            shader_final_pass_.SetUniformBlockBinding(shader_lights_block, GAME_ENGINE_GL_RENDERER_LIGHTS_BINDING);
         }
 
         {
@@ -186,11 +194,12 @@ namespace game_engine { namespace graphics { namespace opengl {
         {
             shader_water_ = context->shader_water_;
             shader_water_.Use();
-            shader_water_.SetUniformInt(shader_water_.GetUniformLocation("object_material.texture_diffuse"), 0);
-            shader_water_.SetUniformInt(shader_water_.GetUniformLocation("object_material.texture_specular"), 1);
+            shader_water_.SetUniformInt(shader_water_.uni_material_texture_diffuse_, 0);
+            shader_water_.SetUniformInt(shader_water_.uni_material_texture_specular_, 1);
             shader_water_.SetUniformInt(shader_water_.uni_texture_bump_, 2);
             shader_water_.SetUniformInt(shader_water_.uni_texture_depth_, 3);
             shader_water_.SetUniformInt(shader_water_.uni_texture_cubemap_, 4);
+            shader_water_.SetUniformBlockBinding(shader_lights_block, GAME_ENGINE_GL_RENDERER_LIGHTS_BINDING);
         }
 
         {
@@ -199,6 +208,30 @@ namespace game_engine { namespace graphics { namespace opengl {
             shader_skybox_.SetUniformInt(shader_skybox_.uni_texture_cubemap_, 0);
         }
 
+        shader_debug_ = context->shader_debug_;
+
+        /* The lights uniform buffer, written with UploadLights() */
+        glGenBuffers(1, &lights_buffer_);
+        glBindBuffer(GL_UNIFORM_BUFFER, lights_buffer_);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(LightsBlock_t), &lights_, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, GAME_ENGINE_GL_RENDERER_LIGHTS_BINDING, lights_buffer_);
+        lights_changed_ = false;
+
+        /* The light clusters, an offset and a count per cluster, and the light indices, as buffer textures */
+        light_clusters_.Init(GAME_ENGINE_GL_RENDERER_CLUSTER_TILE_SIZE, GAME_ENGINE_GL_RENDERER_CLUSTER_SLICES);
+        glGenBuffers(1, &clusters_buffer_);
+        glGenBuffers(1, &cluster_indices_buffer_);
+        UploadBufferTexture(clusters_buffer_, light_clusters_.GetClusters());
+        UploadBufferTexture(cluster_indices_buffer_, light_clusters_.GetLightIndices());
+        glGenTextures(1, &clusters_texture_);
+        glBindTexture(GL_TEXTURE_BUFFER, clusters_texture_);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32UI, clusters_buffer_);
+        glGenTextures(1, &cluster_indices_texture_);
+        glBindTexture(GL_TEXTURE_BUFFER, cluster_indices_texture_);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, cluster_indices_buffer_);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+
         /* Init GBuffer */
         g_buffer_->Init(context_);
         /* Init other frame buffers */
@@ -234,6 +267,14 @@ namespace game_engine { namespace graphics { namespace opengl {
         skybox_cube_ = new OpenGLSkyboxCube();
         skybox_cube_->Init();
 
+        /* The debug geometry VAO, the attribute pointers are set on every draw, at the offset of the upload */
+        debug_buffer_.Init(GAME_ENGINE_GL_RENDERER_DEBUG_BUFFER_SIZE);
+        glGenVertexArrays(1, &debug_VAO_);
+        glBindVertexArray(debug_VAO_);
+        glEnableVertexAttribArray(shader_debug_.attr_vertex_position_);
+        glEnableVertexAttribArray(shader_debug_.attr_vertex_color_);
+        glBindVertexArray(0);
+
         /* Initialize an empty texture, used in several places */
         AssetManager& instance = AssetManager::GetInstance();
         texture_empty_ = instance.GetTexture(FileSystem::GetInstance().GetDirectoryAssets() + "/textures/spec_map_empty.png", GAME_ENGINE_TEXTURE_TYPE_EMPTY);
@@ -248,6 +289,16 @@ namespace game_engine { namespace graphics { namespace opengl {
     
         glDeleteBuffers(1, &VBO_Quad_);
         glDeleteVertexArrays(1, &VAO_Quad_);
+        glDeleteBuffers(1, &lights_buffer_);
+        lights_buffer_ = 0;
+        glDeleteTextures(1, &clusters_texture_);
+        glDeleteTextures(1, &cluster_indices_texture_);
+        glDeleteBuffers(1, &clusters_buffer_);
+        glDeleteBuffers(1, &cluster_indices_buffer_);
+        light_clusters_.Destroy();
+        debug_buffer_.Destroy();
+        glDeleteVertexArrays(1, &debug_VAO_);
+        debug_VAO_ = 0;
     
         is_inited_ = false;
         return 0;
@@ -290,6 +341,10 @@ namespace game_engine { namespace graphics { namespace opengl {
         shader_vertices_color_.SetUniformMat4(shader_vertices_color_.uni_View_, camera->view_matrix_);
         shader_vertices_color_.SetUniformMat4(shader_vertices_color_.uni_Projection_, camera->projection_matrix_);
     
+        shader_debug_.Use();
+        shader_debug_.SetUniformMat4(shader_debug_.uni_View_, camera->view_matrix_);
+        shader_debug_.SetUniformMat4(shader_debug_.uni_Projection_, camera->projection_matrix_);
+    
         shader_gbuffer_.Use();
         shader_gbuffer_.SetUniformMat4(shader_gbuffer_.uni_View_, camera->view_matrix_);
         shader_gbuffer_.SetUniformMat4(shader_gbuffer_.uni_Projection_, camera->projection_matrix_);
@@ -332,41 +387,37 @@ namespace game_engine { namespace graphics { namespace opengl {
         shader_skybox_.SetUniformMat4(shader_skybox_.uni_Projection_, camera->projection_matrix_);
     }
 
-    int OpenGLRenderer::DrawGBufferStandard(OpenGLObject & object, GLuint models_buffer, size_t amount, glm::vec3 diffuse, glm::vec3 specular, OpenGLTexture * diffuse_texture, OpenGLTexture * specular_texture)
+    int OpenGLRenderer::DrawGBufferStandard(OpenGLObject & object, GLuint models_buffer, GLintptr models_offset, size_t amount, glm::vec3 diffuse, glm::vec3 specular, OpenGLTexture * diffuse_texture, OpenGLTexture * specular_texture)
     {
         if (!is_inited_) return -1;
         if (!object.IsInited()) return -1;
 
-        glBindVertexArray(object.VAO_);
+        bool vao_changed = BindVertexArray(object.VAO_);
 
         /* TODO commented components not used */
-        shader_gbuffer_.Use();
+        bool program_changed = UseShader(shader_gbuffer_);
         /* Set the model uniform */
         //shader_gbuffer_.SetUniformVec3(shader_gbuffer_.GetUniformLocation("object_material.ambient"), mtl.ambient_);
-        shader_gbuffer_.SetUniformVec3(shader_gbuffer_.GetUniformLocation("object_material.diffuse"), diffuse);
-        shader_gbuffer_.SetUniformVec3(shader_gbuffer_.GetUniformLocation("object_material.specular"), specular);
+        shader_gbuffer_.SetUniformVec3(shader_gbuffer_.uni_material_diffuse_, diffuse);
+        shader_gbuffer_.SetUniformVec3(shader_gbuffer_.uni_material_specular_, specular);
         //shader_gbuffer_.SetUniformFloat(shader_gbuffer_.GetUniformLocation("object_material.shininess"), mtl.shininess_);
 
-        /* Setup shader attributes */
-        object.SetupAttributes(&shader_gbuffer_);
-        SetModelMatrixAttribute(3, models_buffer);
+        /* Setup shader attributes, the vertex attributes stay in the VAO since the last draw with the same shader */
+        if (vao_changed || program_changed) object.SetupAttributes(&shader_gbuffer_);
+        SetModelMatrixAttribute(3, models_buffer, models_offset);
 
         /* Activate textures */
-        diffuse_texture->ActivateTexture(0);
-        specular_texture->ActivateTexture(1);
+        BindTexture(0, diffuse_texture->GetID());
+        BindTexture(1, specular_texture->GetID());
 
         object.Render(amount);
 
-        /* Unbind */
-        glBindTexture(GL_TEXTURE_2D, 0);
-        glBindVertexArray(0);
-
         return 0;
     }
 
     int OpenGLRenderer::DrawGBufferDisplacement(OpenGLObject & object, glm::mat4 & model, float specular_intensity, OpenGLTexture * displacement_texture, float displacement_mult, OpenGLTexture * diffuse_texture)
     {
-        glBindVertexArray(object.VAO_);
+        BindVertexArray(object.VAO_);
         glPatchParameteri(GL_PATCH_VERTICES, 3);
 
         ConsoleCommand command = ConsoleParser::GetInstance().GetLastCommand();
@@ -377,7 +428,7 @@ namespace game_engine { namespace graphics { namespace opengl {
         glm::vec3 camera_position;
         camera_->GetPositionVector(camera_position.x, camera_position.y, camera_position.z);
 
-        shader_displacement_.Use();
+        UseShader(shader_displacement_);
         shader_displacement_.SetUniformMat4(shader_displacement_.uni_Model_, model);
         shader_displacement_.SetUniformVec3(shader_displacement_.uni_camera_world_position_, camera_position);
         shader_displacement_.SetUniformFloat(shader_displacement_.uni_displacement_intensity_, displacement_mult);
@@ -387,20 +438,19 @@ namespace game_engine { namespace graphics { namespace opengl {
 
         object.SetupAttributes(&shader_displacement_);
 
-        displacement_texture->ActivateTexture(0);
-        diffuse_texture->ActivateTexture(1);
+        BindTexture(0, displacement_texture->GetID());
+        BindTexture(1, diffuse_texture->GetID());
 
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, object.element_buffer_);
         glDrawElements(GL_PATCHES, object.total_indices_, GL_UNSIGNED_INT, 0);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
-        glBindVertexArray(0);
         return 0;
     }
 
     int OpenGLRenderer::DrawDisplacementNormals(OpenGLObject & object, glm::mat4 & model, OpenGLTexture * displacement_texture, float displacement_mult, glm::vec3 color)
     {
-        glBindVertexArray(object.VAO_);
+        BindVertexArray(object.VAO_);
         glPatchParameteri(GL_PATCH_VERTICES, 3);
 
         ConsoleCommand command = ConsoleParser::GetInstance().GetLastCommand();
@@ -411,7 +461,7 @@ namespace game_engine { namespace graphics { namespace opengl {
         glm::vec3 camera_position;
         camera_->GetPositionVector(camera_position.x, camera_position.y, camera_position.z);
 
-        shader_displacement_draw_normals_.Use();
+        UseShader(shader_displacement_draw_normals_);
         shader_displacement_draw_normals_.SetUniformMat4(shader_displacement_draw_normals_.uni_Model_, model);
         shader_displacement_draw_normals_.SetUniformVec3(shader_displacement_draw_normals_.uni_camera_world_position_, camera_position);
         shader_displacement_draw_normals_.SetUniformFloat(shader_displacement_draw_normals_.uni_displacement_intensity_, displacement_mult);
@@ -420,50 +470,45 @@ namespace game_engine { namespace graphics { namespace opengl {
 
         object.SetupAttributes(&shader_displacement_);
 
-        displacement_texture->ActivateTexture(0);
+        BindTexture(0, displacement_texture->GetID());
 
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, object.element_buffer_);
         glDrawElements(GL_PATCHES, object.total_indices_, GL_UNSIGNED_INT, 0);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
-        glBindVertexArray(0);
         return 0;
     }
 
-    int OpenGLRenderer::DrawStandard(OpenGLObject & object, GLuint models_buffer, size_t amount, glm::vec3 ambient, glm::vec3 diffuse, glm::vec3 specular, float shininess, OpenGLTexture * diffuse_texture, OpenGLTexture * specular_texture)
+    int OpenGLRenderer::DrawStandard(OpenGLObject & object, GLuint models_buffer, GLintptr models_offset, size_t amount, glm::vec3 ambient, glm::vec3 diffuse, glm::vec3 specular, float shininess, OpenGLTexture * diffuse_texture, OpenGLTexture * specular_texture)
     {
 
         if (!is_inited_) return -1;
         if (!object.IsInited()) return -1;
 
         /* TODO commented components not used */
-        shader_standard_.Use();
+        bool program_changed = UseShader(shader_standard_);
         /* Set the model uniform */
         //shader_standard_.SetUniformMat4(shader_standard_.uni_Model_, model);
-        shader_standard_.SetUniformVec3(shader_standard_.GetUniformLocation("object_material.ambient"), ambient);
-        shader_standard_.SetUniformVec3(shader_standard_.GetUniformLocation("object_material.diffuse"), diffuse);
-        shader_standard_.SetUniformVec3(shader_standard_.GetUniformLocation("object_material.specular"), specular);
-        shader_standard_.SetUniformFloat(shader_standard_.GetUniformLocation("object_material.shininess"), shininess);
+        shader_standard_.SetUniformVec3(shader_standard_.uni_material_ambient_, ambient);
+        shader_standard_.SetUniformVec3(shader_standard_.uni_material_diffuse_, diffuse);
+        shader_standard_.SetUniformVec3(shader_standard_.uni_material_specular_, specular);
+        shader_standard_.SetUniformFloat(shader_standard_.uni_material_shininess_, shininess);
 
-        glBindVertexArray(object.VAO_);
-        object.SetupAttributes(&shader_gbuffer_);
-        SetModelMatrixAttribute(3, models_buffer);
+        bool vao_changed = BindVertexArray(object.VAO_);
+        if (vao_changed || program_changed) object.SetupAttributes(&shader_gbuffer_);
+        SetModelMatrixAttribute(3, models_buffer, models_offset);
 
-        diffuse_texture->ActivateTexture(0);
-        specular_texture->ActivateTexture(1);
+        BindTexture(0, diffuse_texture->GetID());
+        BindTexture(1, specular_texture->GetID());
 
-        object.Render();
-
-        /* Unbind */
-        glBindTexture(GL_TEXTURE_2D, 0);
-        glBindVertexArray(0);
+        object.Render(amount);
 
         return 0;
     }
 
     int OpenGLRenderer::DrawWater(OpenGLObject & object, glm::mat4 model, glm::vec3 ambient, glm::vec3 diffuse, glm::vec3 specular, float shininess, OpenGLTexture * diffuse_texture, OpenGLTexture * specular_texture, OpenGLTexture * bump_texture, std::vector<Wave_t>& waves)
     {
-        glBindVertexArray(object.VAO_);
+        BindVertexArray(object.VAO_);
         glPatchParameteri(GL_PATCH_VERTICES, 3);
 
         ConsoleCommand command = ConsoleParser::GetInstance().GetLastCommand();
@@ -478,99 +523,56 @@ namespace game_engine { namespace graphics { namespace opengl {
         camera_->GetPositionVector(camera_position.x, camera_position.y, camera_position.z);
         float time = glfwGetTime();
 
-        shader_water_.Use();
+        UseShader(shader_water_);
         shader_water_.SetUniformMat4(shader_water_.uni_Model_, model);
         shader_water_.SetUniformVec3(shader_water_.uni_camera_world_position_, camera_position);
         shader_water_.SetUniformBool(shader_water_.uni_constant_tessellation_, constant_tessellation_);
         shader_water_.SetUniformFloat(shader_water_.uni_time_, time);
-        shader_water_.SetUniformVec3(shader_water_.GetUniformLocation("object_material.ambient"), ambient);
-        shader_water_.SetUniformVec3(shader_water_.GetUniformLocation("object_material.diffuse"), diffuse);
-        shader_water_.SetUniformVec3(shader_water_.GetUniformLocation("object_material.specular"), specular);
-        shader_water_.SetUniformFloat(shader_water_.GetUniformLocation("object_material.shininess"), shininess);
+        shader_water_.SetUniformVec3(shader_water_.uni_material_ambient_, ambient);
+        shader_water_.SetUniformVec3(shader_water_.uni_material_diffuse_, diffuse);
+        shader_water_.SetUniformVec3(shader_water_.uni_material_specular_, specular);
+        shader_water_.SetUniformFloat(shader_water_.uni_material_shininess_, shininess);
 
-        size_t nr_waves = std::min(waves.size(), 4u);
-        shader_water_.SetUniformUInt(shader_water_.GetUniformLocation("number_of_waves"), nr_waves);
+        size_t nr_waves = std::min(waves.size(), static_cast<size_t>(GAME_ENGINE_GL_SHADER_MAX_WAVES));
+        shader_water_.SetUniformUInt(shader_water_.uni_number_of_waves_, nr_waves);
         for (size_t i = 0; i < nr_waves; i++) {
-            std::string shader_name = "waves[" + std::to_string(i) + "]";
-            shader_water_.SetUniformVec3(shader_water_.GetUniformLocation(shader_name + ".direction"), glm::normalize(waves[i].direction_));
-            shader_water_.SetUniformFloat(shader_water_.GetUniformLocation(shader_name + ".wavelength"), waves[i].wavelength_);
-            shader_water_.SetUniformFloat(shader_water_.GetUniformLocation(shader_name + ".amplitude"), waves[i].amplitude_);
+            glm::vec3 direction = glm::normalize(waves[i].direction_);
+            shader_water_.SetUniformVec3(shader_water_.uni_waves_direction_[i], direction);
+            shader_water_.SetUniformFloat(shader_water_.uni_waves_wavelength_[i], waves[i].wavelength_);
+            shader_water_.SetUniformFloat(shader_water_.uni_waves_amplitude_[i], waves[i].amplitude_);
         }
         shader_water_.SetUniformFloat(shader_water_.uni_environment_reflectance_, water_reflectance);
 
         object.SetupAttributes(&shader_displacement_);
 
-        diffuse_texture->ActivateTexture(0);
-        specular_texture->ActivateTexture(1);
-        bump_texture->ActivateTexture(2);
-        glActiveTexture(GL_TEXTURE3);
-        glBindTexture(GL_TEXTURE_2D, g_buffer_->depth_texture_);
+        BindTexture(0, diffuse_texture->GetID());
+        BindTexture(1, specular_texture->GetID());
+        BindTexture(2, bump_texture->GetID());
+        BindTexture(3, g_buffer_->depth_texture_);
+        /* The cubemap target is not remembered by the state cache */
         skybox_->ActivateTexture(4);
 
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, object.element_buffer_);
         glDrawElements(GL_PATCHES, object.total_indices_, GL_UNSIGNED_INT, 0);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
-        glBindVertexArray(0);
-        return 0;
-    }
-
-    int OpenGLRenderer::DrawGBufferTriangle(glm::vec3 v1, glm::vec3 v2, glm::vec3 v3, glm::vec3 color) {
-        if (!is_inited_) return -1;
-    
-        OpenGLTriangle t;
-        t.Init(v1, v2, v3);
-    
-        if (!t.IsInited()) return -1;
-    
-        glDisable(GL_CULL_FACE);
-    
-        shader_gbuffer_.Use();
-        /* Set the model uniform */
-        //shader_gbuffer_.SetUniformMat4(shader_gbuffer_.uni_Model_, glm::mat4(1.0f));
-        //shader_gbuffer_.SetUniformVec3(shader_gbuffer_.GetUniformLocation("object_material.ambient"), mtl.ambient_);
-        shader_gbuffer_.SetUniformVec3(shader_gbuffer_.GetUniformLocation("object_material.diffuse"), color);
-        shader_gbuffer_.SetUniformVec3(shader_gbuffer_.GetUniformLocation("object_material.specular"), color);
-        //shader_gbuffer_.SetUniformFloat(shader_gbuffer_.GetUniformLocation("object_material.shininess"), mtl.shininess_);
-    
-        glBindVertexArray(t.VAO_);
-    
-        t.SetupAttributes(&shader_gbuffer_);
-    
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture_empty_->GetID());
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, texture_empty_->GetID());
-    
-        t.Render();
-    
-        /* Unbind */
-        glBindTexture(GL_TEXTURE_2D, 0);
-        glBindVertexArray(0);
-    
-        t.Destroy();
-        glEnable(GL_CULL_FACE);
-    
         return 0;
     }
 
-    int OpenGLRenderer::DrawShadowMap(OpenGLObject & object, GLuint models_buffer, size_t amount) {
+    int OpenGLRenderer::DrawShadowMap(OpenGLObject & object, GLuint models_buffer, GLintptr models_offset, size_t amount) {
     
         if (!is_inited_) return -1;
         if (!object.IsInited()) return -1;
     
-        glBindVertexArray(object.VAO_);
+        bool vao_changed = BindVertexArray(object.VAO_);
 
-        shader_shadow_map_.Use();
+        bool program_changed = UseShader(shader_shadow_map_);
 
         /* Setup shader attributes */
-        object.SetupAttributes(&shader_shadow_map_);
-        SetModelMatrixAttribute(1, models_buffer);
+        if (vao_changed || program_changed) object.SetupAttributes(&shader_shadow_map_);
+        SetModelMatrixAttribute(1, models_buffer, models_offset);
 
         object.Render(amount);
-        
-        /* Unbind */
-        glBindVertexArray(0);
     
         return 0;
     }
@@ -691,7 +693,15 @@ namespace game_engine { namespace graphics { namespace opengl {
         shader_final_pass_.SetUniformFloat(shader_final_pass_.uni_shadow_cascade_1_, shadow_maps_->GetCascadeEnd(1));
         shader_final_pass_.SetUniformFloat(shader_final_pass_.uni_shadow_cascade_2_, shadow_maps_->GetCascadeEnd(2));
         shader_final_pass_.SetUniformFloat(shader_final_pass_.uni_shadow_cascade_3_, shadow_maps_->GetCascadeEnd(3));
-        shader_final_pass_.SetUniformBool(shader_final_pass_.GetUniformLocation("show_cascades"), show_shadow_cascades_);
+        shader_final_pass_.SetUniformBool(shader_final_pass_.uni_show_cascades_, show_shadow_cascades_);
+
+        glm::uvec3 clusters_size(light_clusters_.GetTilesX(), light_clusters_.GetTilesY(), light_clusters_.GetSlices());
+        float tile_size = static_cast<float>(light_clusters_.GetTileSize());
+        glm::vec2 clusters_tile_scale(context_->GetWindowWidth() / tile_size, context_->GetWindowHeight() / tile_size);
+        glm::vec2 clusters_slice(light_clusters_.GetSliceScale(), light_clusters_.GetSliceBias());
+        shader_final_pass_.SetUniformUVec3(shader_final_pass_.uni_light_clusters_size_, clusters_size);
+        shader_final_pass_.SetUniformVec2(shader_final_pass_.uni_light_clusters_tile_scale_, clusters_tile_scale);
+        shader_final_pass_.SetUniformVec2(shader_final_pass_.uni_light_clusters_slice_, clusters_slice);
 
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, g_buffer_->g_position_texture_);
@@ -702,6 +712,10 @@ namespace game_engine { namespace graphics { namespace opengl {
         glActiveTexture(GL_TEXTURE3);
         glBindTexture(GL_TEXTURE_2D, ssao_texture);
         shadow_maps_->ActivateTextures(4);
+        glActiveTexture(GL_TEXTURE8);
+        glBindTexture(GL_TEXTURE_BUFFER, clusters_texture_);
+        glActiveTexture(GL_TEXTURE9);
+        glBindTexture(GL_TEXTURE_BUFFER, cluster_indices_texture_);
         
         RenderQuad();
     
@@ -739,91 +753,101 @@ namespace game_engine { namespace graphics { namespace opengl {
         return 0;
     }
     
-    int OpenGLRenderer::DrawLine(glm::vec3 start, glm::vec3 end, glm::vec3 color) {
-        
-        shader_vertices_color_.Use();
-        shader_vertices_color_.SetUniformMat4(shader_vertices_color_.uni_Model_, glm::mat4(1.0));
-        shader_vertices_color_.SetUniformVec3(shader_vertices_color_.uni_fragment_color_, color);
-    
-        GLuint vao, vbo, ebo;
-        glGenVertexArrays(1, &vao);
-        glBindVertexArray(vao);
-    
-        GLfloat line_vertices[] = {
-          start.x, start.y, start.z, 
-          end.x, end.y, end.z,
-        };
-        glGenBuffers(1, &vbo);
-        glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(line_vertices), line_vertices, GL_STATIC_DRAW);
-    
-        GLushort line_elements[] = {
-          0, 1
-        };
-        glGenBuffers(1, &ebo);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(line_elements), line_elements, GL_STATIC_DRAW);
-    
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(shader_vertices_color_.GetAttributeLocation(shader_vertex_position), 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-    
-        glDrawElements(GL_LINE_LOOP, 2, GL_UNSIGNED_SHORT, 0);
-        // I commened this line when i was working on the particle springs
-        //glDrawElements(GL_LINES, 2, GL_UNSIGNED_SHORT, (GLvoid*)(8 * sizeof(GLushort)));
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    
-        glDeleteBuffers(1, &vbo);
-        glDeleteBuffers(1, &ebo);
-        glDeleteVertexArrays(1, &vao);
-    
-        return 0;
+    void OpenGLRenderer::AddDebugLine(glm::vec3 start, glm::vec3 end, glm::vec3 color) {
+        DebugVertex_t vertex;
+        vertex.color_ = color;
+
+        vertex.position_ = start;
+        debug_lines_.push_back(vertex);
+        vertex.position_ = end;
+        debug_lines_.push_back(vertex);
+    }
+
+    void OpenGLRenderer::AddDebugTriangle(glm::vec3 v1, glm::vec3 v2, glm::vec3 v3, glm::vec3 color) {
+        DebugVertex_t vertex;
+        vertex.color_ = color;
+
+        vertex.position_ = v1;
+        debug_triangles_.push_back(vertex);
+        vertex.position_ = v2;
+        debug_triangles_.push_back(vertex);
+        vertex.position_ = v3;
+        debug_triangles_.push_back(vertex);
+    }
+
+    int OpenGLRenderer::DrawDebugGeometry() {
+        if (!is_inited_) return -1;
+        if (debug_lines_.empty() && debug_triangles_.empty()) return 0;
+
+        /* Lines first and triangles after them, so that both are written with one upload */
+        GLint lines = static_cast<GLint>(debug_lines_.size());
+        GLint triangles = static_cast<GLint>(debug_triangles_.size());
+        debug_lines_.insert(debug_lines_.end(), debug_triangles_.begin(), debug_triangles_.end());
+        GLintptr offset = debug_buffer_.Upload(debug_lines_.data(), debug_lines_.size() * sizeof(DebugVertex_t));
+        debug_lines_.clear();
+        debug_triangles_.clear();
+
+        UseShader(shader_debug_);
+        BindVertexArray(debug_VAO_);
+        glBindBuffer(GL_ARRAY_BUFFER, debug_buffer_.GetID());
+        glVertexAttribPointer(shader_debug_.attr_vertex_position_, 3, GL_FLOAT, GL_FALSE, sizeof(DebugVertex_t), (void*)(offset + offsetof(DebugVertex_t, position_)));
+        glVertexAttribPointer(shader_debug_.attr_vertex_color_, 3, GL_FLOAT, GL_FALSE, sizeof(DebugVertex_t), (void*)(offset + offsetof(DebugVertex_t, color_)));
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        int draw_calls = 0;
+        if (lines > 0) {
+            glDrawArrays(GL_LINES, 0, lines);
+            draw_calls++;
+        }
+        if (triangles > 0) {
+            glDisable(GL_CULL_FACE);
+            glDrawArrays(GL_TRIANGLES, lines, triangles);
+            glEnable(GL_CULL_FACE);
+            draw_calls++;
+        }
+
+        return draw_calls;
     }
     
     int OpenGLRenderer::SetPointLightsNumber(unsigned int number) {
-    
-        shader_final_pass_.Use();
-        shader_final_pass_.SetUniformUInt(shader_final_pass_.GetUniformLocation("number_of_point_lights"), number);
-    
+        if (number > GAME_ENGINE_GL_RENDERER_MAX_POINT_LIGHTS) return -1;
+
+        lights_.number_of_point_lights_ = number;
+        lights_changed_ = true;
         return 0;
     }
     
-    int OpenGLRenderer::SetPointLight(std::string index, glm::vec3 position, glm::vec3 color_ambient, glm::vec3 color_diffuse, glm::vec3 color_specular,
+    int OpenGLRenderer::SetPointLight(size_t index, glm::vec3 position, glm::vec3 color_ambient, glm::vec3 color_diffuse, glm::vec3 color_specular,
         float attenuation_constant, float attenuation_linear, float attenuation_quadratic)
     {
-        std::string shader_name = "point_light[" + index + "]";
-    
-        shader_final_pass_.Use();
-        shader_final_pass_.SetUniformVec3(shader_final_pass_.GetUniformLocation(shader_name + ".position"), position);
-        shader_final_pass_.SetUniformVec3(shader_final_pass_.GetUniformLocation(shader_name + ".ambient"), color_ambient);
-        shader_final_pass_.SetUniformVec3(shader_final_pass_.GetUniformLocation(shader_name + ".diffuse"), color_diffuse);
-        shader_final_pass_.SetUniformVec3(shader_final_pass_.GetUniformLocation(shader_name + ".specular"), color_specular);
-    
-        shader_final_pass_.SetUniformFloat(shader_final_pass_.GetUniformLocation(shader_name + ".constant"), attenuation_constant);
-        shader_final_pass_.SetUniformFloat(shader_final_pass_.GetUniformLocation(shader_name + ".linear"), attenuation_linear);
-        shader_final_pass_.SetUniformFloat(shader_final_pass_.GetUniformLocation(shader_name + ".quadratic"), attenuation_quadratic);
-    
+        if (index >= GAME_ENGINE_GL_RENDERER_MAX_POINT_LIGHTS) return -1;
+
+        PointLightBlock_t& light = lights_.point_lights_[index];
+        light.position_ = position;
+        light.ambient_ = color_ambient;
+        light.diffuse_ = color_diffuse;
+        light.specular_ = color_specular;
+        light.constant_ = attenuation_constant;
+        light.linear_ = attenuation_linear;
+        light.quadratic_ = attenuation_quadratic;
+        lights_changed_ = true;
+
+        /* The light reaches as far as its brightest color component */
+        glm::vec3 color = color_ambient + color_diffuse + color_specular;
+        float intensity = std::max(color.r, std::max(color.g, color.b));
+        cluster_lights_[index] = glm::vec4(position, LightClusters::GetLightRadius(attenuation_constant, attenuation_linear, attenuation_quadratic, intensity));
+
         return 0;
     }
 
     int OpenGLRenderer::SetDirectionalLight(glm::vec3 direction, glm::vec3 color_ambient, glm::vec3 color_diffuse, glm::vec3 color_specular) {
     
-        shader_final_pass_.Use();
-        shader_final_pass_.SetUniformVec3(shader_final_pass_.GetUniformLocation("directional_light.direction"), direction);
-        shader_final_pass_.SetUniformVec3(shader_final_pass_.GetUniformLocation("directional_light.ambient"), color_ambient);
-        shader_final_pass_.SetUniformVec3(shader_final_pass_.GetUniformLocation("directional_light.diffuse"), color_diffuse);
-        shader_final_pass_.SetUniformVec3(shader_final_pass_.GetUniformLocation("directional_light.specular"), color_specular);
-        
-        shader_standard_.Use();
-        shader_standard_.SetUniformVec3(shader_standard_.GetUniformLocation("directional_light.direction"), direction);
-        shader_standard_.SetUniformVec3(shader_standard_.GetUniformLocation("directional_light.ambient"), color_ambient);
-        shader_standard_.SetUniformVec3(shader_standard_.GetUniformLocation("directional_light.diffuse"), color_diffuse);
-        shader_standard_.SetUniformVec3(shader_standard_.GetUniformLocation("directional_light.specular"), color_specular);
-
-        shader_water_.Use();
-        shader_water_.SetUniformVec3(shader_water_.GetUniformLocation("directional_light.direction"), direction);
-        shader_water_.SetUniformVec3(shader_water_.GetUniformLocation("directional_light.ambient"), color_ambient);
-        shader_water_.SetUniformVec3(shader_water_.GetUniformLocation("directional_light.diffuse"), color_diffuse);
-        shader_water_.SetUniformVec3(shader_water_.GetUniformLocation("directional_light.specular"), color_specular);
+        DirectionalLightBlock_t& light = lights_.directional_light_;
+        light.direction_ = direction;
+        light.ambient_ = color_ambient;
+        light.diffuse_ = color_diffuse;
+        light.specular_ = color_specular;
+        lights_changed_ = true;
 
         return 0;
     }
@@ -832,32 +856,73 @@ namespace game_engine { namespace graphics { namespace opengl {
         glm::vec3 color_ambient, glm::vec3 color_diffuse, glm::vec3 color_specular,
         float attenuation_constant, float attenuation_linear, float attenuation_quadratic)
     {
-        shader_final_pass_.Use();
-        shader_final_pass_.SetUniformVec3(shader_final_pass_.GetUniformLocation("cast_light.position"), position);
-        shader_final_pass_.SetUniformVec3(shader_final_pass_.GetUniformLocation("cast_light.direction"), direction);
-        shader_final_pass_.SetUniformFloat(shader_final_pass_.GetUniformLocation("cast_light.inner_radius_cosine"), cos(inner_radius));
-        shader_final_pass_.SetUniformFloat(shader_final_pass_.GetUniformLocation("cast_light.outer_radius_cosine"), cos(outer_radius));
-    
-        shader_final_pass_.SetUniformVec3(shader_final_pass_.GetUniformLocation("cast_light.ambient"), color_ambient);
-        shader_final_pass_.SetUniformVec3(shader_final_pass_.GetUniformLocation("cast_light.diffuse"), color_diffuse);
-        shader_final_pass_.SetUniformVec3(shader_final_pass_.GetUniformLocation("cast_light.specular"), color_specular);
-    
-        shader_final_pass_.SetUniformFloat(shader_final_pass_.GetUniformLocation("cast_light.constant"), attenuation_constant);
-        shader_final_pass_.SetUniformFloat(shader_final_pass_.GetUniformLocation("cast_light.linear"), attenuation_linear);
-        shader_final_pass_.SetUniformFloat(shader_final_pass_.GetUniformLocation("cast_light.quadratic"), attenuation_quadratic);
-    
+        SpotLightBlock_t& light = lights_.spot_light_;
+        light.position_ = position;
+        light.direction_ = direction;
+        light.inner_radius_cosine_ = cos(inner_radius);
+        light.outer_radius_cosine_ = cos(outer_radius);
+        light.ambient_ = color_ambient;
+        light.diffuse_ = color_diffuse;
+        light.specular_ = color_specular;
+        light.constant_ = attenuation_constant;
+        light.linear_ = attenuation_linear;
+        light.quadratic_ = attenuation_quadratic;
+        lights_changed_ = true;
+
         return 0;
     }
+
+    void OpenGLRenderer::UploadLights() {
+        if (!is_inited_) return;
+
+        if (lights_changed_) {
+            /* The point lights not set are skipped, the rest of the block comes after the whole array */
+            GLintptr rest_offset = offsetof(LightsBlock_t, directional_light_);
+            GLsizeiptr point_lights_size = lights_.number_of_point_lights_ * sizeof(PointLightBlock_t);
+
+            glBindBuffer(GL_UNIFORM_BUFFER, lights_buffer_);
+            if (point_lights_size > 0) glBufferSubData(GL_UNIFORM_BUFFER, 0, point_lights_size, &lights_.point_lights_[0]);
+            glBufferSubData(GL_UNIFORM_BUFFER, rest_offset, sizeof(LightsBlock_t) - rest_offset, &lights_.directional_light_);
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+            lights_changed_ = false;
+        }
+
+        /* The clusters change with the camera */
+        UploadLightClusters();
+    }
+
+    void OpenGLRenderer::UploadLightClusters() {
+        if (camera_ == nullptr) return;
+
+        light_clusters_.SetView(context_->GetWindowWidth(), context_->GetWindowHeight(), camera_->config_.z_near_, camera_->config_.z_far_);
+        light_clusters_.Build(camera_->view_matrix_, camera_->projection_matrix_, cluster_lights_, lights_.number_of_point_lights_);
+
+        UploadBufferTexture(clusters_buffer_, light_clusters_.GetClusters());
+        UploadBufferTexture(cluster_indices_buffer_, light_clusters_.GetLightIndices());
+    }
+
+    void OpenGLRenderer::UploadBufferTexture(GLuint buffer, const std::vector<uint32_t>& data) {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+        /* A buffer texture can't be empty */
+        if (data.empty()) glBufferData(GL_TEXTURE_BUFFER, 2 * sizeof(uint32_t), NULL, GL_STREAM_DRAW);
+        else glBufferData(GL_TEXTURE_BUFFER, data.size() * sizeof(uint32_t), &data[0], GL_STREAM_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
     
     int OpenGLRenderer::Draw2DText(std::string text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color) {
     
-        text_renderer_->Draw2DText(text, x, y, scale, color);
-        return 0;
+        return text_renderer_->Add2DText(text, x, y, scale, color);
+    }
+
+    int OpenGLRenderer::Draw2DTexts() {
+
+        return text_renderer_->Draw2DTexts();
     }
     
     int OpenGLRenderer::DrawTexture(GLuint texture_id, bool red_component) {
         shader_quad_.Use();
-        shader_quad_.SetUniformBool(shader_quad_.GetUniformLocation("red_component"), red_component);
+        shader_quad_.SetUniformBool(shader_quad_.uni_red_component_, red_component);
     
         glDisable(GL_DEPTH_TEST);
 
@@ -875,26 +940,23 @@ namespace game_engine { namespace graphics { namespace opengl {
         if (!is_inited_) return -1;
         if (!object.IsInited()) return -1;
 
-        shader_draw_normals_.Use();
+        UseShader(shader_draw_normals_);
         shader_draw_normals_.SetUniformMat4(shader_draw_normals_.uni_Model_, model);
         shader_draw_normals_.SetUniformVec3(shader_draw_normals_.uni_color_, color);
 
-        glBindVertexArray(object.VAO_);
+        BindVertexArray(object.VAO_);
 
         object.SetupAttributes(&shader_draw_normals_);
         object.Render();
 
-        /* Unbind */
-        glBindVertexArray(0);
-
         return 0;
     }
 
     int OpenGLRenderer::DrawColor(OpenGLObject & object, glm::mat4 & model, glm::vec3 color, float alpha)
     {
-        glBindVertexArray(object.VAO_);
+        BindVertexArray(object.VAO_);
 
-        shader_vertices_color_.Use();
+        UseShader(shader_vertices_color_);
         shader_vertices_color_.SetUniformMat4(shader_vertices_color_.uni_Model_, model);
         shader_vertices_color_.SetUniformVec3(shader_vertices_color_.uni_fragment_color_, color);
         shader_vertices_color_.SetUniformFloat(shader_vertices_color_.uni_fragment_alpha_, alpha);
@@ -902,10 +964,25 @@ namespace game_engine { namespace graphics { namespace opengl {
 
         object.Render();
 
-        glBindVertexArray(0);
         return 0;
     }
     
+    void OpenGLRenderer::ResetState() {
+        glBindVertexArray(0);
+
+        state_program_ = GL_STATE_UNKNOWN;
+        state_vao_ = 0;
+        for (size_t i = 0; i < GAME_ENGINE_GL_RENDERER_STATE_TEXTURE_UNITS; i++) state_textures_[i] = GL_STATE_UNKNOWN;
+    }
+
+    size_t OpenGLRenderer::GetStateChanges() {
+        return state_changes_;
+    }
+
+    void OpenGLRenderer::ResetStateChanges() {
+        state_changes_ = 0;
+    }
+
     void OpenGLRenderer::RenderQuad() {
         
         glBindVertexArray(VAO_Quad_);
@@ -913,24 +990,52 @@ namespace game_engine { namespace graphics { namespace opengl {
         glBindVertexArray(0);
     }
 
-    void OpenGLRenderer::SetModelMatrixAttribute(GLuint position, GLuint buffer)
+    void OpenGLRenderer::SetModelMatrixAttribute(GLuint position, GLuint buffer, GLintptr offset)
     {
         glBindBuffer(GL_ARRAY_BUFFER, buffer);
         std::size_t vec4Size = sizeof(glm::vec4);
         glEnableVertexAttribArray(position);
-        glVertexAttribPointer(position, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void*)0);
+        glVertexAttribPointer(position, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void*)(offset));
         glVertexAttribDivisor(position, 1);
         glEnableVertexAttribArray(position + 1);
-        glVertexAttribPointer(position + 1, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void*)(1 * vec4Size));
+        glVertexAttribPointer(position + 1, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void*)(offset + 1 * vec4Size));
         glVertexAttribDivisor(position + 1, 1);
         glEnableVertexAttribArray(position + 2);
-        glVertexAttribPointer(position + 2, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void*)(2 * vec4Size));
+        glVertexAttribPointer(position + 2, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void*)(offset + 2 * vec4Size));
         glVertexAttribDivisor(position + 2, 1);
         glEnableVertexAttribArray(position + 3);
-        glVertexAttribPointer(position + 3, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void*)(3 * vec4Size));
+        glVertexAttribPointer(position + 3, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void*)(offset + 3 * vec4Size));
         glVertexAttribDivisor(position + 3, 1);
     }
 
+    bool OpenGLRenderer::UseShader(OpenGLShader & shader) {
+        GLuint program = shader.GetProgramID();
+        if (program == state_program_) return false;
+
+        glUseProgram(program);
+        state_program_ = program;
+        state_changes_++;
+        return true;
+    }
+
+    bool OpenGLRenderer::BindVertexArray(GLuint vao) {
+        if (vao == state_vao_) return false;
+
+        glBindVertexArray(vao);
+        state_vao_ = vao;
+        state_changes_++;
+        return true;
+    }
+
+    void OpenGLRenderer::BindTexture(GLuint unit, GLuint texture) {
+        if (texture == state_textures_[unit]) return;
+
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        state_textures_[unit] = texture;
+        state_changes_++;
+    }
+
+}
 }
 }
-}
\ No newline at end of file
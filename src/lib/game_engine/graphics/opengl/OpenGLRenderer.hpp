@@ -6,6 +6,7 @@
 #include "glm/glm.hpp"
 
 #include "game_engine/graphics/GraphicsTypes.hpp"
+#include "game_engine/graphics/LightClusters.hpp"
 
 #include "OpenGLIncludes.hpp"
 #include "OpenGLContext.hpp"
@@ -18,11 +19,86 @@
 #include "OpenGLFrameBufferTexture.hpp"
 #include "OpenGLCShadowMaps.hpp"
 #include "OpenGLCubemap.hpp"
+#include "OpenGLRingBuffer.hpp"
 
 namespace game_engine { namespace graphics { namespace opengl {
 
-    /* Maximum number of point lights allowed */
-#define GAME_ENGINE_GL_RENDERER_MAX_POINT_LIGHTS 36
+    /* Maximum number of point lights allowed, a pixel only evaluates the lights of its cluster */
+#define GAME_ENGINE_GL_RENDERER_MAX_POINT_LIGHTS 128
+    /* Number of texture units remembered by the state cache */
+#define GAME_ENGINE_GL_RENDERER_STATE_TEXTURE_UNITS 8
+    /* The uniform buffer binding point of the lights block */
+#define GAME_ENGINE_GL_RENDERER_LIGHTS_BINDING 0
+    /* The size in pixels of the screen tiles, and the number of depth slices, of the light clusters */
+#define GAME_ENGINE_GL_RENDERER_CLUSTER_TILE_SIZE 64
+#define GAME_ENGINE_GL_RENDERER_CLUSTER_SLICES 16
+    /* Initial size in bytes of the streaming buffer of the debug lines and triangles */
+#define GAME_ENGINE_GL_RENDERER_DEBUG_BUFFER_SIZE 65536
+
+    /*
+        The lights uniform block of the shaders, with the std140 layout. vec3 members are aligned to 16 bytes, and
+        a float that follows a vec3 fills its last 4 bytes
+    */
+    struct PointLightBlock_t {
+        glm::vec3 position_;
+        float padding_0_;
+        glm::vec3 ambient_;
+        float padding_1_;
+        glm::vec3 diffuse_;
+        float padding_2_;
+        glm::vec3 specular_;
+        float constant_;
+        float linear_;
+        float quadratic_;
+        float padding_3_[2];
+    };
+
+    struct DirectionalLightBlock_t {
+        glm::vec3 direction_;
+        float padding_0_;
+        glm::vec3 ambient_;
+        float padding_1_;
+        glm::vec3 diffuse_;
+        float padding_2_;
+        glm::vec3 specular_;
+        float padding_3_;
+    };
+
+    struct SpotLightBlock_t {
+        glm::vec3 position_;
+        float padding_0_;
+        glm::vec3 direction_;
+        float inner_radius_cosine_;
+        float outer_radius_cosine_;
+        float padding_1_[3];
+        glm::vec3 ambient_;
+        float padding_2_;
+        glm::vec3 diffuse_;
+        float padding_3_;
+        glm::vec3 specular_;
+        float constant_;
+        float linear_;
+        float quadratic_;
+        float padding_4_[2];
+    };
+
+    struct LightsBlock_t {
+        PointLightBlock_t point_lights_[GAME_ENGINE_GL_RENDERER_MAX_POINT_LIGHTS];
+        DirectionalLightBlock_t directional_light_;
+        SpotLightBlock_t spot_light_;
+        GLuint number_of_point_lights_;
+        GLuint padding_0_[3];
+    };
+
+    /* A vertex of the debug lines and triangles */
+    struct DebugVertex_t {
+        glm::vec3 position_;
+        glm::vec3 color_;
+    };
+
+    static_assert(sizeof(PointLightBlock_t) == 80, "Point light doesn't match the std140 layout");
+    static_assert(sizeof(DirectionalLightBlock_t) == 64, "Directional light doesn't match the std140 layout");
+    static_assert(sizeof(SpotLightBlock_t) == 112, "Spot light doesn't match the std140 layout");
 
     class OpenGLRenderer {
     public:
@@ -80,7 +156,7 @@ namespace game_engine { namespace graphics { namespace opengl {
             @param specular_texture The specular texture
             @return 0 = OK, -1 = Something is not initialized
         */
-        int DrawGBufferStandard(OpenGLObject & object, GLuint models_buffer, size_t amount, glm::vec3 diffuse, glm::vec3 specular, OpenGLTexture * diffuse_texture, OpenGLTexture * specular_texture);
+        int DrawGBufferStandard(OpenGLObject & object, GLuint models_buffer, GLintptr models_offset, size_t amount, glm::vec3 diffuse, glm::vec3 specular, OpenGLTexture * diffuse_texture, OpenGLTexture * specular_texture);
         
         /**
             Draw a mesh with displacement using the GBuffer
@@ -95,7 +171,7 @@ namespace game_engine { namespace graphics { namespace opengl {
         /**
             Draws an object using the standard shader, forward rendering, alpha value currently not processed, hardcoded as 1 in the shader 
         */
-        int DrawStandard(OpenGLObject & object, GLuint models_buffer, size_t amount, glm::vec3 ambient, glm::vec3 diffuse, glm::vec3 specular, float shininess, OpenGLTexture * diffuse_texture, OpenGLTexture * specular_texture);
+        int DrawStandard(OpenGLObject & object, GLuint models_buffer, GLintptr models_offset, size_t amount, glm::vec3 ambient, glm::vec3 diffuse, glm::vec3 specular, float shininess, OpenGLTexture * diffuse_texture, OpenGLTexture * specular_texture);
 
         /**
             Draws an object using the water shader, forward rendering
@@ -107,15 +183,10 @@ namespace game_engine { namespace graphics { namespace opengl {
         */
         int DrawColor(OpenGLObject & object, glm::mat4 & model, glm::vec3 color, float alpha);
 
-        /**
-            
-        */
-        int DrawGBufferTriangle(glm::vec3 v1, glm::vec3 v2, glm::vec3 v3, glm::vec3 color = { 1,1,1 });
-    
         /**
             Draws the objecet on the shadow map
         */
-        int DrawShadowMap(OpenGLObject & object, GLuint models_buffer, size_t amount);
+        int DrawShadowMap(OpenGLObject & object, GLuint models_buffer, GLintptr models_offset, size_t amount);
     
         /**
             Runs the SSAO algorithm
@@ -148,19 +219,42 @@ namespace game_engine { namespace graphics { namespace opengl {
         int DrawBoundingBox(OpenGLObject & object, glm::mat4 model, bool faces = true);
     
         /**
-            Draws a line
+            Add a line to the debug geometry of the frame, drawn with DrawDebugGeometry()
+            @param start The world space start
+            @param end The world space end
+            @param color The color
         */
-        int DrawLine(glm::vec3 start, glm::vec3 end, glm::vec3 color = glm::vec3(1, 1, 1));
+        void AddDebugLine(glm::vec3 start, glm::vec3 end, glm::vec3 color = glm::vec3(1, 1, 1));
+
+        /**
+            Add a triangle to the debug geometry of the frame, drawn with DrawDebugGeometry()
+            @param v1 The first world space vertex
+            @param v2 The second world space vertex
+            @param v3 The third world space vertex
+            @param color The color
+        */
+        void AddDebugTriangle(glm::vec3 v1, glm::vec3 v2, glm::vec3 v3, glm::vec3 color = glm::vec3(1, 1, 1));
+
+        /**
+            Draw the debug geometry added since the last call and clear it. The vertices are written to a streaming
+            buffer once, then all the lines are drawn with one draw call and all the triangles with another, forward
+            rendered without lighting, against the depth of the scene
+            @return -1 = Not initialised, else the number of draw calls, at most two
+        */
+        int DrawDebugGeometry();
     
         /**
-            Set the number of point lights
+            Set the number of point lights. The lights are stored, and sent to the shaders with UploadLights()
+            @return -1 = More than GAME_ENGINE_GL_RENDERER_MAX_POINT_LIGHTS, 0 = OK
         */
         int SetPointLightsNumber(unsigned int number);
     
         /**
             Set a point light
+            @param index The index of the light, less than GAME_ENGINE_GL_RENDERER_MAX_POINT_LIGHTS
+            @return -1 = Index out of range, 0 = OK
         */
-        int SetPointLight(std::string index, glm::vec3 position, glm::vec3 color_ambient, glm::vec3 color_diffuse, glm::vec3 color_specular,
+        int SetPointLight(size_t index, glm::vec3 position, glm::vec3 color_ambient, glm::vec3 color_diffuse, glm::vec3 color_specular,
             float attenuation_constant, float attenuation_linear, float attenuation_quadratic);
     
         /**
@@ -175,9 +269,16 @@ namespace game_engine { namespace graphics { namespace opengl {
         int SetSpotLight(glm::vec3 position, glm::vec3 direction, float inner_radius, float outer_radius,
             glm::vec3 color_ambient, glm::vec3 color_diffuse, glm::vec3 color_specular,
             float attenuation_constant, float attenuation_linear, float attenuation_quadratic);
+
+        /**
+            Write the lights to the uniform buffer, if they changed since the last upload. Only the point lights set
+            are written. The point lights are binned into the clusters of the camera set with SetView(), and the
+            clusters are uploaded every frame. Call once per frame, before the final pass
+        */
+        void UploadLights();
     
         /**
-            Draw a 2d text on a certain position on the screen, not in the world
+            Add a 2d text on a certain position on the screen, not in the world. The text is drawn with Draw2DTexts()
             @param text The text to draw
             @param x The horizontal position in screen coordinates
             @param y The vertical position in screen coordintates
@@ -186,6 +287,12 @@ namespace game_engine { namespace graphics { namespace opengl {
             @return 0=OK, -1=Font was not initialised
         */
         int Draw2DText(std::string text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color);
+
+        /**
+            Draw all the 2d text added since the last call, in one draw call
+            @return -1 = Font was not initialised, else the number of draw calls
+        */
+        int Draw2DTexts();
         
         /**
             Draws a texture
@@ -200,6 +307,24 @@ namespace game_engine { namespace graphics { namespace opengl {
             @param model The model matrix of the object
         */
         int DrawNormals(OpenGLObject & object, glm::mat4 model, glm::vec3 color);
+
+        /**
+            Forget the shader, VAO and textures remembered by the object draw calls, and unbind the VAO. Call before
+            drawing objects, when other OpenGL calls might have changed the bound state
+        */
+        void ResetState();
+
+        /**
+            Get the number of shader, VAO and texture binds issued by the object draw calls, since the last call to
+            ResetStateChanges()
+            @return The number of binds
+        */
+        size_t GetStateChanges();
+
+        /**
+            Set the number of binds returned by GetStateChanges() to zero
+        */
+        void ResetStateChanges();
     
         OpenGLGBuffer * g_buffer_;
         OpenGLFrameBufferTexture * frame_buffer_one_;
@@ -262,6 +387,8 @@ namespace game_engine { namespace graphics { namespace opengl {
         OpenGLShaderWater shader_water_;
         /* Shader used to draw the skybox */
         OpenGLShaderSkybox shader_skybox_;
+        /* Shader used to draw the debug geometry */
+        OpenGLShaderDebug shader_debug_;
 
         /* VAO and VBO for quad rendering */
         GLuint VAO_Quad_;
@@ -269,6 +396,25 @@ namespace game_engine { namespace graphics { namespace opengl {
     
         /* Textures */
         OpenGLTexture * texture_empty_ = nullptr;
+
+        /* The lights, and the uniform buffer bound to GAME_ENGINE_GL_RENDERER_LIGHTS_BINDING */
+        LightsBlock_t lights_;
+        GLuint lights_buffer_ = 0;
+        bool lights_changed_ = false;
+
+        /* The position and radius of each point light, binned into clusters, and the buffer textures of the clusters */
+        LightClusters light_clusters_;
+        glm::vec4 cluster_lights_[GAME_ENGINE_GL_RENDERER_MAX_POINT_LIGHTS];
+        GLuint clusters_buffer_ = 0;
+        GLuint clusters_texture_ = 0;
+        GLuint cluster_indices_buffer_ = 0;
+        GLuint cluster_indices_texture_ = 0;
+
+        /* The debug lines and triangles of the frame, two and three vertices each, and the buffer they are streamed to */
+        std::vector<DebugVertex_t> debug_lines_;
+        std::vector<DebugVertex_t> debug_triangles_;
+        OpenGLRingBuffer debug_buffer_;
+        GLuint debug_VAO_ = 0;
         
         /**
             Sends a quad geometry to the currently bound shader
@@ -280,8 +426,49 @@ namespace game_engine { namespace graphics { namespace opengl {
             Set the model matrix attribute for a shader, at a certain position
             @param position The shader attribute position
             @param buffer The ARRAY_BUFFER storing the model matrix data
+            @param offset The offset of the first model matrix in the buffer
+        */
+        void SetModelMatrixAttribute(GLuint position, GLuint buffer, GLintptr offset = 0);
+
+        /**
+            Bin the point lights into the clusters of the camera, and upload the clusters
+        */
+        void UploadLightClusters();
+
+        /**
+            Write data to a buffer texture, the buffer is reallocated every time
+            @param buffer The buffer
+            @param data The data
+        */
+        void UploadBufferTexture(GLuint buffer, const std::vector<uint32_t>& data);
+
+        /* State bound by the object draw calls, GL_STATE_UNKNOWN when it's not known */
+        static const GLuint GL_STATE_UNKNOWN = 0xFFFFFFFF;
+        GLuint state_program_ = GL_STATE_UNKNOWN;
+        GLuint state_vao_ = GL_STATE_UNKNOWN;
+        GLuint state_textures_[GAME_ENGINE_GL_RENDERER_STATE_TEXTURE_UNITS];
+        size_t state_changes_ = 0;
+
+        /**
+            Use a shader program, if it's not already in use
+            @param shader The shader
+            @return true = The program was changed, false = Already in use
+        */
+        bool UseShader(OpenGLShader & shader);
+
+        /**
+            Bind a VAO, if it's not already bound
+            @param vao The VAO
+            @return true = The VAO was changed, false = Already bound
+        */
+        bool BindVertexArray(GLuint vao);
+
+        /**
+            Bind a 2D texture to a texture unit, if it's not already bound there
+            @param unit The texture unit, less than GAME_ENGINE_GL_RENDERER_STATE_TEXTURE_UNITS
+            @param texture The OpenGL id of the texture
         */
-        void SetModelMatrixAttribute(GLuint position, GLuint buffer);
+        void BindTexture(GLuint unit, GLuint texture);
     };
 
 }
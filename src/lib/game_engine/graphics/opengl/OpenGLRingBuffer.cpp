@@ -0,0 +1,81 @@
+#include "OpenGLRingBuffer.hpp"
+
+#include <cstring>
+
+namespace game_engine {
+namespace graphics {
+namespace opengl {
+
+    /* Uploads start at offsets aligned to this */
+    static const size_t RING_BUFFER_ALIGNMENT = 256;
+
+    OpenGLRingBuffer::OpenGLRingBuffer() {
+        is_inited_ = false;
+    }
+
+    int OpenGLRingBuffer::Init(size_t size_bytes) {
+        if (is_inited_) return -1;
+
+        size_bytes_ = size_bytes;
+        head_ = 0;
+
+        glGenBuffers(1, &buffer_);
+        glBindBuffer(GL_ARRAY_BUFFER, buffer_);
+        glBufferData(GL_ARRAY_BUFFER, size_bytes_, NULL, GL_STREAM_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        is_inited_ = true;
+        return 0;
+    }
+
+    int OpenGLRingBuffer::Destroy() {
+        if (!is_inited_) return -1;
+
+        glDeleteBuffers(1, &buffer_);
+
+        is_inited_ = false;
+        return 0;
+    }
+
+    bool OpenGLRingBuffer::IsInited() {
+        return is_inited_;
+    }
+
+    GLintptr OpenGLRingBuffer::Upload(const void * data, size_t size_bytes) {
+        if (!is_inited_) return -1;
+        if (size_bytes == 0) return 0;
+
+        glBindBuffer(GL_ARRAY_BUFFER, buffer_);
+
+        if (size_bytes > size_bytes_) {
+            /* Grow, the old storage stays alive for the draws that still use it */
+            while (size_bytes_ < size_bytes) size_bytes_ *= 2;
+            glBufferData(GL_ARRAY_BUFFER, size_bytes_, NULL, GL_STREAM_DRAW);
+            head_ = 0;
+        } else if (head_ + size_bytes > size_bytes_) {
+            /* Orphan */
+            glBufferData(GL_ARRAY_BUFFER, size_bytes_, NULL, GL_STREAM_DRAW);
+            head_ = 0;
+        }
+
+        GLintptr offset = static_cast<GLintptr>(head_);
+        void * memory = glMapBufferRange(GL_ARRAY_BUFFER, offset, size_bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (memory != nullptr) {
+            memcpy(memory, data, size_bytes);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+        } else {
+            glBufferSubData(GL_ARRAY_BUFFER, offset, size_bytes, data);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        head_ = ((head_ + size_bytes + RING_BUFFER_ALIGNMENT - 1) / RING_BUFFER_ALIGNMENT) * RING_BUFFER_ALIGNMENT;
+        return offset;
+    }
+
+    GLuint OpenGLRingBuffer::GetID() {
+        return buffer_;
+    }
+
+}
+}
+}
@@ -0,0 +1,60 @@
+#ifndef __OpenGLRingBuffer_hpp__
+#define __OpenGLRingBuffer_hpp__
+
+#include "OpenGLIncludes.hpp"
+
+namespace game_engine {
+namespace graphics {
+namespace opengl {
+
+    /**
+        An ARRAY_BUFFER for data that changes every frame. Uploads are written one after the other, unsynchronized,
+        so the GPU can keep reading the previous ones. When an upload doesn't fit at the end of the buffer, the buffer
+        is orphaned, the driver gives it new storage, and writing starts again from the start
+    */
+    class OpenGLRingBuffer {
+    public:
+        OpenGLRingBuffer();
+
+        /**
+            Create the buffer
+            @param size_bytes The size of the buffer
+            @return 0=OK, -1=Already initialised
+        */
+        int Init(size_t size_bytes);
+
+        /**
+            Delete the buffer
+            @return 0=OK, -1=Not initialised
+        */
+        int Destroy();
+
+        bool IsInited();
+
+        /**
+            Write data to the buffer. If the data is larger than the whole buffer, the buffer grows
+            @param data The data
+            @param size_bytes The size of the data
+            @return The offset in the buffer where the data was written, -1 if not initialised
+        */
+        GLintptr Upload(const void * data, size_t size_bytes);
+
+        /**
+            Get the OpenGL id of the buffer
+            @return The id
+        */
+        GLuint GetID();
+
+    private:
+        bool is_inited_;
+
+        GLuint buffer_;
+        size_t size_bytes_;
+        size_t head_;
+    };
+
+}
+}
+}
+
+#endif
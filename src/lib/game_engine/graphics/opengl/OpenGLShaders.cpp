@@ -122,9 +122,44 @@ namespace game_engine { namespace graphics { namespace opengl {
         if (has_tess_evaluation_shader) glDeleteShader(tesselation_evaluation_shader_id);
     
         program_id_ = ProgramID;
+        CacheUniformLocations();
         return 0;
     }
 
+    void OpenGLShader::CacheUniformLocations() {
+        uniform_locations_.clear();
+
+        GLint number_of_uniforms = 0;
+        GLint max_name_length = 0;
+        glGetProgramiv(program_id_, GL_ACTIVE_UNIFORMS, &number_of_uniforms);
+        glGetProgramiv(program_id_, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_name_length);
+        if (max_name_length <= 0) return;
+
+        std::vector<GLchar> name(max_name_length + 1);
+        for (GLint i = 0; i < number_of_uniforms; i++) {
+            GLsizei name_length = 0;
+            GLint size = 0;
+            GLenum type;
+            glGetActiveUniform(program_id_, static_cast<GLuint>(i), max_name_length, &name_length, &size, &type, &name[0]);
+            std::string uniform_name(&name[0], name_length);
+
+            /* Uniforms inside blocks don't have a location */
+            GLint location = glGetUniformLocation(program_id_, uniform_name.c_str());
+            if (location == -1) continue;
+            uniform_locations_[uniform_name] = location;
+
+            /* Arrays are reported as their first element, store the name of the array and of each element */
+            if (name_length > 3 && uniform_name.compare(name_length - 3, 3, "[0]") == 0) {
+                std::string array_name = uniform_name.substr(0, name_length - 3);
+                uniform_locations_[array_name] = location;
+                for (GLint e = 1; e < size; e++) {
+                    std::string element_name = array_name + "[" + std::to_string(e) + "]";
+                    uniform_locations_[element_name] = glGetUniformLocation(program_id_, element_name.c_str());
+                }
+            }
+        }
+    }
+
     int OpenGLShader::CompileShader(std::string file_path, GLuint type, int& ret)
     {
         GLuint shader_id = glCreateShader(type);
@@ -171,6 +206,11 @@ namespace game_engine { namespace graphics { namespace opengl {
         return true;
     }
 
+    GLuint OpenGLShader::GetProgramID() {
+        if (!is_inited_) return 0;
+        return program_id_;
+    }
+
     GLint OpenGLShader::GetAttributeLocation(std::string attribute_name) {
         if (!is_inited_) return Error::ERROR_GEN_NOT_INIT;
 
@@ -183,14 +223,31 @@ namespace game_engine { namespace graphics { namespace opengl {
 
     GLint OpenGLShader::GetUniformLocation(std::string uniform_name) {
         if (!is_inited_) return Error::ERROR_GEN_NOT_INIT;
-    
+
+        std::unordered_map<std::string, GLint>::iterator itr = uniform_locations_.find(uniform_name);
+        if (itr != uniform_locations_.end()) return itr->second;
+
+        /* Not an active uniform, remember the miss too */
         GLint ret = glGetUniformLocation(program_id_, uniform_name.c_str());
 #ifdef _DEBUG
         if (ret == -1) dt::ConsoleInfoL(dt::CRITICAL, "Shader uniform not found", "name", uniform_name);
 #endif
+        uniform_locations_[uniform_name] = ret;
         return ret;
     }
 
+    int OpenGLShader::SetUniformBlockBinding(std::string block_name, GLuint binding) {
+        if (!is_inited_) return Error::ERROR_GEN_NOT_INIT;
+
+        GLuint index = glGetUniformBlockIndex(program_id_, block_name.c_str());
+        if (index == GL_INVALID_INDEX) {
+            dt::ConsoleInfoL(dt::CRITICAL, "Shader uniform block not found", "name", block_name);
+            return -1;
+        }
+        glUniformBlockBinding(program_id_, index, binding);
+        return 0;
+    }
+
     void OpenGLShader::SetUniformMat4(GLuint id, glm::mat4& model) {
         glUniformMatrix4fv(id, 1, GL_FALSE, &model[0][0]);
     }
@@ -199,6 +256,14 @@ namespace game_engine { namespace graphics { namespace opengl {
         glUniform3fv(id, 1, &vector[0]);
     }
     
+    void OpenGLShader::SetUniformVec2(GLuint id, glm::vec2& vector) {
+        glUniform2fv(id, 1, &vector[0]);
+    }
+
+    void OpenGLShader::SetUniformUVec3(GLuint id, glm::uvec3& vector) {
+        glUniform3uiv(id, 1, &vector[0]);
+    }
+    
     void OpenGLShader::SetUniformFloat(GLuint id, float value) {
         glUniform1fv(id, 1, &value);
     }
@@ -224,9 +289,9 @@ namespace game_engine { namespace graphics { namespace opengl {
         if (ret != 0) return ret;
     
         if ((attr_vertex_ = GetAttributeLocation(shader_text_name_vertex)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        if ((attr_vertex_color_ = GetAttributeLocation(shader_text_name_vertex_color)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
         if ((uni_Projection_ = GetUniformLocation(shader_uni_projection)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
         if ((uni_Texture_ = GetUniformLocation(shader_sampler_texture)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
-        if ((uni_Texture_color_ = GetUniformLocation(shader_text_name_uni_texture_color)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
     
         return 0;
     }
@@ -263,6 +328,10 @@ namespace game_engine { namespace graphics { namespace opengl {
         if ((attr_vertex_model_ = GetAttributeLocation(shader_uni_model)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
         if ((uni_View_ = GetUniformLocation(shader_uni_view)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
         if ((uni_Projection_ = GetUniformLocation(shader_uni_projection)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        if ((uni_material_diffuse_ = GetUniformLocation(shader_material_diffuse)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        if ((uni_material_specular_ = GetUniformLocation(shader_material_specular)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        if ((uni_material_texture_diffuse_ = GetUniformLocation(shader_material_texture_diffuse)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        if ((uni_material_texture_specular_ = GetUniformLocation(shader_material_texture_specular)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
     
         return 0;
     }
@@ -281,6 +350,12 @@ namespace game_engine { namespace graphics { namespace opengl {
         if ((attr_vertex_model_ = GetAttributeLocation(shader_uni_model)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
         if ((uni_View_ = GetUniformLocation(shader_uni_view)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
         if ((uni_Projection_ = GetUniformLocation(shader_uni_projection)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        if ((uni_material_ambient_ = GetUniformLocation(shader_material_ambient)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        if ((uni_material_diffuse_ = GetUniformLocation(shader_material_diffuse)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        if ((uni_material_specular_ = GetUniformLocation(shader_material_specular)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        if ((uni_material_shininess_ = GetUniformLocation(shader_material_shininess)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        if ((uni_material_texture_diffuse_ = GetUniformLocation(shader_material_texture_diffuse)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        if ((uni_material_texture_specular_ = GetUniformLocation(shader_material_texture_specular)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
 
         return 0;
     }
@@ -338,6 +413,12 @@ namespace game_engine { namespace graphics { namespace opengl {
         if ((uni_shadow_cascade_1_ = GetUniformLocation("shadow_cascades[1]")) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
         if ((uni_shadow_cascade_2_ = GetUniformLocation("shadow_cascades[2]")) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
         if ((uni_shadow_cascade_3_ = GetUniformLocation("shadow_cascades[3]")) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        if ((uni_show_cascades_ = GetUniformLocation("show_cascades")) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        if ((uni_light_clusters_ = GetUniformLocation("light_clusters")) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        if ((uni_light_cluster_indices_ = GetUniformLocation("light_cluster_indices")) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        if ((uni_light_clusters_size_ = GetUniformLocation("light_clusters_size")) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        if ((uni_light_clusters_tile_scale_ = GetUniformLocation("light_clusters_tile_scale")) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        if ((uni_light_clusters_slice_ = GetUniformLocation("light_clusters_slice")) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
 
         return 0;
     }
@@ -389,6 +470,7 @@ namespace game_engine { namespace graphics { namespace opengl {
         if ((attr_vertex_position_ = GetAttributeLocation(shader_vertex_position)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
         if ((attr_vertex_uv_ = GetAttributeLocation(shader_vertex_uv)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
         if ((uni_sampler_texture_= GetUniformLocation(shader_sampler_texture)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        if ((uni_red_component_ = GetUniformLocation("red_component")) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
 
         return 0;
     }
@@ -481,6 +563,19 @@ namespace game_engine { namespace graphics { namespace opengl {
         if ((uni_texture_bump_ = GetUniformLocation("bump_texture")) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
         if ((uni_texture_cubemap_ = GetUniformLocation(shader_skybox)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
         if ((uni_environment_reflectance_ = GetUniformLocation("environment_reflectance")) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        if ((uni_material_ambient_ = GetUniformLocation(shader_material_ambient)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        if ((uni_material_diffuse_ = GetUniformLocation(shader_material_diffuse)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        if ((uni_material_specular_ = GetUniformLocation(shader_material_specular)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        if ((uni_material_shininess_ = GetUniformLocation(shader_material_shininess)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        if ((uni_material_texture_diffuse_ = GetUniformLocation(shader_material_texture_diffuse)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        if ((uni_material_texture_specular_ = GetUniformLocation(shader_material_texture_specular)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        if ((uni_number_of_waves_ = GetUniformLocation("number_of_waves")) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        for (size_t i = 0; i < GAME_ENGINE_GL_SHADER_MAX_WAVES; i++) {
+            std::string wave_name = "waves[" + std::to_string(i) + "]";
+            if ((uni_waves_direction_[i] = GetUniformLocation(wave_name + ".direction")) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+            if ((uni_waves_wavelength_[i] = GetUniformLocation(wave_name + ".wavelength")) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+            if ((uni_waves_amplitude_[i] = GetUniformLocation(wave_name + ".amplitude")) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        }
 
         return 0;
     }
@@ -501,6 +596,20 @@ namespace game_engine { namespace graphics { namespace opengl {
         return 0;
     }
 
+    OpenGLShaderDebug::OpenGLShaderDebug() {
+    }
+    int OpenGLShaderDebug::Init(std::string vertex_shader_path, std::string fragment_shader_path) {
+        int ret = OpenGLShader::Init(vertex_shader_path, fragment_shader_path);
+        if (ret != 0) return ret;
+
+        if ((attr_vertex_position_ = GetAttributeLocation(shader_debug_vertex_position)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        if ((attr_vertex_color_ = GetAttributeLocation(shader_debug_vertex_color)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        if ((uni_View_ = GetUniformLocation(shader_uni_view)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+        if ((uni_Projection_ = GetUniformLocation(shader_uni_projection)) == -1) return Error::ERROR_SHADER_RES_NOT_FOUND;
+
+        return 0;
+    }
+
 }
 }
 }
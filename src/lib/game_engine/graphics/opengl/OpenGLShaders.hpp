@@ -2,6 +2,7 @@
 #define __OpenGLShaders_hpp__
 
 #include <string>
+#include <unordered_map>
 
 #include "glm/glm.hpp"
 
@@ -9,6 +10,9 @@
 
 namespace game_engine { namespace graphics { namespace opengl {
 
+    /* Number of waves in the water shader */
+#define GAME_ENGINE_GL_SHADER_MAX_WAVES 4
+
     /* Shader variables */
     /* Shader mesh attributes */
     static const std::string shader_vertex_position("vertex_position_modelspace");
@@ -32,11 +36,15 @@ namespace game_engine { namespace graphics { namespace opengl {
 
     /* Names of the text shader variables used */
     static const std::string shader_text_name_vertex("vertex");
-    static const std::string shader_text_name_uni_texture_color("texture_color");
+    static const std::string shader_text_name_vertex_color("vertex_color");
     
     /* Names of the vertices color shader variables used */
     static const std::string shader_vertices_color_uni_color("fragment_color");
     static const std::string shader_vertices_color_uni_alpha("alpha");
+
+    /* Names of the debug shader variables used */
+    static const std::string shader_debug_vertex_position("vertex_position_worldspace");
+    static const std::string shader_debug_vertex_color("vertex_color");
     
     /* Names of the g buffer shader variables used*/
     static const std::string shader_gbuffer_position("g_position");
@@ -56,6 +64,17 @@ namespace game_engine { namespace graphics { namespace opengl {
     /* Names for the terrain shader */
     static const std::string shader_uni_specular_intensity("specular_intensity");
 
+    /* Names of the material shader variables used */
+    static const std::string shader_material_ambient("object_material.ambient");
+    static const std::string shader_material_diffuse("object_material.diffuse");
+    static const std::string shader_material_specular("object_material.specular");
+    static const std::string shader_material_shininess("object_material.shininess");
+    static const std::string shader_material_texture_diffuse("object_material.texture_diffuse");
+    static const std::string shader_material_texture_specular("object_material.texture_specular");
+
+    /* Name of the uniform block with the lights */
+    static const std::string shader_lights_block("Lights");
+
     /**
         A shader class the encapsulates all shader fuctionality
     */
@@ -118,6 +137,12 @@ namespace game_engine { namespace graphics { namespace opengl {
             @return false = not initialised, true = OK
         */
         bool Use();
+
+        /**
+            Get the OpenGL id of the shader program
+            @return The id, 0 if not initialised
+        */
+        GLuint GetProgramID();
     
         /**
             Get the location in the shader of an attribute variable
@@ -127,15 +152,29 @@ namespace game_engine { namespace graphics { namespace opengl {
         GLint GetAttributeLocation(std::string attribute_name);
     
         /**
-            Get the location in the shader of a uniform variable
+            Get the location in the shader of a uniform variable. The locations of the active uniforms are cached when
+            the program is linked, so this doesn't call OpenGL. Prefer the locations stored in the shader classes
+            for uniforms set on every draw
             @param uniform_name The name of the uniform
             @return -1 = Not initialised, or not found, else the location
         */
         GLint GetUniformLocation(std::string uniform_name);
+
+        /**
+            Assign a binding point to a uniform block of the shader
+            @param block_name The name of the uniform block
+            @param binding The binding point, where the buffer with the block data is bound
+            @return -1 = Not initialised, or not found, 0 = OK
+        */
+        int SetUniformBlockBinding(std::string block_name, GLuint binding);
     
         void SetUniformMat4(GLuint id, glm::mat4 & model);
     
         void SetUniformVec3(GLuint id, glm::vec3 & vector);
+
+        void SetUniformVec2(GLuint id, glm::vec2 & vector);
+
+        void SetUniformUVec3(GLuint id, glm::uvec3 & vector);
     
         void SetUniformFloat(GLuint id, float value);
     
@@ -149,6 +188,14 @@ namespace game_engine { namespace graphics { namespace opengl {
         GLuint program_id_;
     private:
         bool is_inited_;
+        /* The location of each uniform name, filled when the program is linked */
+        std::unordered_map<std::string, GLint> uniform_locations_;
+
+        /**
+            Store the locations of all the active uniforms of the program. Array uniforms are stored with and without
+            the [0] suffix, and with the index of every element
+        */
+        void CacheUniformLocations();
     
         /**
             Compile and link a shader program
@@ -186,11 +233,11 @@ namespace game_engine { namespace graphics { namespace opengl {
         /* Varialbe locations for the shader varialbes used */
         /* Attributes */
         GLuint attr_vertex_;
+        GLuint attr_vertex_color_;
     
         /* Uniforms */
         GLuint uni_Projection_;
         GLuint uni_Texture_;
-        GLuint uni_Texture_color_;
     };
     
     /**
@@ -235,6 +282,10 @@ namespace game_engine { namespace graphics { namespace opengl {
         /* Uniforms */
         GLuint uni_View_;
         GLuint uni_Projection_;
+        GLuint uni_material_diffuse_;
+        GLuint uni_material_specular_;
+        GLuint uni_material_texture_diffuse_;
+        GLuint uni_material_texture_specular_;
     };
 
     /**
@@ -255,6 +306,12 @@ namespace game_engine { namespace graphics { namespace opengl {
         /* Uniforms */
         GLuint uni_View_;
         GLuint uni_Projection_;
+        GLuint uni_material_ambient_;
+        GLuint uni_material_diffuse_;
+        GLuint uni_material_specular_;
+        GLuint uni_material_shininess_;
+        GLuint uni_material_texture_diffuse_;
+        GLuint uni_material_texture_specular_;
     };
     
     /* Shader for shadow map pass */
@@ -284,6 +341,7 @@ namespace game_engine { namespace graphics { namespace opengl {
 
         /* Uniforms */
         GLuint uni_sampler_texture_;
+        GLuint uni_red_component_;
     };
 
     /* AO shader */
@@ -363,6 +421,13 @@ namespace game_engine { namespace graphics { namespace opengl {
         GLuint uni_shadow_cascade_1_;
         GLuint uni_shadow_cascade_2_;
         GLuint uni_shadow_cascade_3_;
+        GLuint uni_show_cascades_;
+
+        GLuint uni_light_clusters_;
+        GLuint uni_light_cluster_indices_;
+        GLuint uni_light_clusters_size_;
+        GLuint uni_light_clusters_tile_scale_;
+        GLuint uni_light_clusters_slice_;
     };
 
     /* A shader to draw the normals of a model */
@@ -450,6 +515,16 @@ namespace game_engine { namespace graphics { namespace opengl {
         GLuint uni_texture_depth_;
         GLuint uni_texture_cubemap_;
         GLuint uni_environment_reflectance_;
+        GLuint uni_material_ambient_;
+        GLuint uni_material_diffuse_;
+        GLuint uni_material_specular_;
+        GLuint uni_material_shininess_;
+        GLuint uni_material_texture_diffuse_;
+        GLuint uni_material_texture_specular_;
+        GLuint uni_number_of_waves_;
+        GLuint uni_waves_direction_[GAME_ENGINE_GL_SHADER_MAX_WAVES];
+        GLuint uni_waves_wavelength_[GAME_ENGINE_GL_SHADER_MAX_WAVES];
+        GLuint uni_waves_amplitude_[GAME_ENGINE_GL_SHADER_MAX_WAVES];
     };
 
     class OpenGLShaderSkybox : public OpenGLShader {
@@ -466,6 +541,23 @@ namespace game_engine { namespace graphics { namespace opengl {
         GLuint uni_texture_cubemap_;
     };
 
+    /**
+        Shader for the debug lines and triangles, world space positions with a color per vertex
+    */
+    class OpenGLShaderDebug : public OpenGLShader {
+    public:
+        OpenGLShaderDebug();
+
+        int Init(std::string vertex_shader_path, std::string fragment_shader_path);
+
+        /* Attributes */
+        GLuint attr_vertex_position_;
+        GLuint attr_vertex_color_;
+
+        GLuint uni_View_;
+        GLuint uni_Projection_;
+    };
+
 }
 }
 }
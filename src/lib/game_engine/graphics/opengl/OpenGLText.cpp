@@ -3,6 +3,10 @@
 #include "ft2build.h"
 #include FT_FREETYPE_H
 
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "game_engine/core/ErrorCodes.hpp"
@@ -11,6 +15,17 @@ namespace game_engine {
 namespace graphics {
 namespace opengl {
 
+    /* The pixel sizes the glyphs are rasterised at, small text uses the small ones */
+    static const unsigned int TEXT_PIXEL_SIZES[] = { 24, GAME_ENGINE_GL_TEXT_BASE_SIZE };
+    /* Empty pixels around each glyph in the atlas, so that filtering doesn't read the neighbours */
+    static const int TEXT_ATLAS_PADDING = 1;
+
+    /* A rasterised glyph, before it's copied to the atlas */
+    struct GlyphBitmap_t {
+        std::vector<unsigned char> pixels_;
+        int x_, y_;
+    };
+
     OpenGLText::OpenGLText() {
         is_inited_ = false;
     }
@@ -27,71 +42,125 @@ namespace opengl {
         if (FT_New_Face(ft, font_file_path.c_str() , 0, &face))
             return Error::ERROR_FREETYPE_FONT;
 
-        FT_Set_Pixel_Sizes(face, 0, 48);
+        /* Rasterise the characters of every size, and place them on shelves of the atlas, left to right */
+        std::vector<GlyphBitmap_t> bitmaps;
+        int shelf_x = TEXT_ATLAS_PADDING, shelf_y = TEXT_ATLAS_PADDING, shelf_height = 0;
+        for (unsigned int pixel_size : TEXT_PIXEL_SIZES) {
+            FT_Set_Pixel_Sizes(face, 0, pixel_size);
+            pixel_sizes_.push_back(pixel_size);
+            characters_.push_back(std::vector<OpenGLCharacter_t>(GAME_ENGINE_GL_TEXT_CHARACTERS));
+
+            for (GLubyte c = 0; c < GAME_ENGINE_GL_TEXT_CHARACTERS; c++) {
+                OpenGLCharacter_t& character = characters_.back()[c];
+                character = OpenGLCharacter_t();
+
+                /* Load character glyph  */
+                if (FT_Load_Char(face, c, FT_LOAD_RENDER)) {
+                    PrintError(Error::ERROR_FREETYPE_GLYPH);
+                    continue;
+                }
+                FT_GlyphSlot glyph = face->glyph;
+                int width = glyph->bitmap.width;
+                int rows = glyph->bitmap.rows;
+                character.size_ = glm::ivec2(width, rows);
+                character.bearing_ = glm::ivec2(glyph->bitmap_left, glyph->bitmap_top);
+                character.advance_ = glyph->advance.x;
+                if (width == 0 || rows == 0) continue;
+
+                if (shelf_x + width + TEXT_ATLAS_PADDING > GAME_ENGINE_GL_TEXT_ATLAS_WIDTH) {
+                    shelf_x = TEXT_ATLAS_PADDING;
+                    shelf_y += shelf_height + TEXT_ATLAS_PADDING;
+                    shelf_height = 0;
+                }
+
+                GlyphBitmap_t bitmap;
+                bitmap.x_ = shelf_x;
+                bitmap.y_ = shelf_y;
+                bitmap.pixels_.resize(width * rows);
+                for (int row = 0; row < rows; row++) {
+                    memcpy(&bitmap.pixels_[row * width], glyph->bitmap.buffer + row * glyph->bitmap.pitch, width);
+                }
+                bitmaps.push_back(bitmap);
+
+                /* The atlas height isn't known yet, the texture coordinates are in pixels until it is */
+                character.uv_min_ = glm::vec2(shelf_x, shelf_y);
+                character.uv_max_ = glm::vec2(shelf_x + width, shelf_y + rows);
+
+                shelf_x += width + TEXT_ATLAS_PADDING;
+                shelf_height = std::max(shelf_height, rows);
+            }
+        }
 
-        /* Disable byte-alignment restriction */
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        FT_Done_Face(face);
+        FT_Done_FreeType(ft);
 
-        /* Load first 128 characters of ASCII set */
-        for (GLubyte c = 0; c < 128; c++) {
-            /* Load character glyph  */
-            if (FT_Load_Char(face, c, FT_LOAD_RENDER)) {
-                PrintError(Error::ERROR_FREETYPE_GLYPH);
-                continue;
+        int atlas_height = 1;
+        while (atlas_height < shelf_y + shelf_height + TEXT_ATLAS_PADDING) atlas_height *= 2;
+
+        std::vector<unsigned char> atlas(GAME_ENGINE_GL_TEXT_ATLAS_WIDTH * atlas_height, 0);
+        size_t b = 0;
+        glm::vec2 atlas_size(GAME_ENGINE_GL_TEXT_ATLAS_WIDTH, atlas_height);
+        for (size_t s = 0; s < characters_.size(); s++) {
+            for (size_t c = 0; c < characters_[s].size(); c++) {
+                OpenGLCharacter_t& character = characters_[s][c];
+                if (character.size_.x == 0 || character.size_.y == 0) continue;
+
+                GlyphBitmap_t& bitmap = bitmaps[b++];
+                for (int row = 0; row < character.size_.y; row++) {
+                    memcpy(&atlas[(bitmap.y_ + row) * GAME_ENGINE_GL_TEXT_ATLAS_WIDTH + bitmap.x_], &bitmap.pixels_[row * character.size_.x], character.size_.x);
+                }
+                character.uv_min_ /= atlas_size;
+                character.uv_max_ /= atlas_size;
             }
-            /* Generate character texture */
-            GLuint texture;
-            glGenTextures(1, &texture);
-            glBindTexture(GL_TEXTURE_2D, texture);
-            glTexImage2D(
-                GL_TEXTURE_2D,
-                0,
-                GL_RED,
-                face->glyph->bitmap.width,
-                face->glyph->bitmap.rows,
-                0,
-                GL_RED,
-                GL_UNSIGNED_BYTE,
-                face->glyph->bitmap.buffer
-            );
-            /* Set texture options */
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-            OpenGLCharacter_t character = {
-                texture,
-                glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-                glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-                face->glyph->advance.x
-            };
-            characters.insert(std::pair<GLchar, OpenGLCharacter_t>(c, character));
         }
+
+        /* Disable byte-alignment restriction */
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+        glGenTextures(1, &atlas_texture_);
+        glBindTexture(GL_TEXTURE_2D, atlas_texture_);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, GAME_ENGINE_GL_TEXT_ATLAS_WIDTH, atlas_height, 0, GL_RED, GL_UNSIGNED_BYTE, &atlas[0]);
+        /* Set texture options */
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glBindTexture(GL_TEXTURE_2D, 0);
-        
-        FT_Done_Face(face);
-        FT_Done_FreeType(ft);
 
         shader_text_ = context->shader_text_;
 
+        /* The buffer grows in Draw2DTexts() */
+        vbo_capacity_ = 0;
         glGenVertexArrays(1, &VAO2DText_);
         glBindVertexArray(VAO2DText_);
         glGenBuffers(1, &VBO2DText_);
         glBindBuffer(GL_ARRAY_BUFFER, VBO2DText_);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), 0);
+        glEnableVertexAttribArray(shader_text_.attr_vertex_);
+        glVertexAttribPointer(shader_text_.attr_vertex_, 4, GL_FLOAT, GL_FALSE, sizeof(OpenGLTextVertex_t), (void*)offsetof(OpenGLTextVertex_t, vertex_));
+        glEnableVertexAttribArray(shader_text_.attr_vertex_color_);
+        glVertexAttribPointer(shader_text_.attr_vertex_color_, 3, GL_FLOAT, GL_FALSE, sizeof(OpenGLTextVertex_t), (void*)offsetof(OpenGLTextVertex_t, color_));
         glBindBuffer(GL_ARRAY_BUFFER, 0);
         glBindVertexArray(0);
         text_projection_matrix_ = glm::ortho(0.0f, static_cast<GLfloat>(context->GetWindowWidth()), 0.0f, static_cast<GLfloat>(context->GetWindowHeight()));
 
+        frame_ = 0;
+
         is_inited_ = true;
         return 0;
     }
 
     int OpenGLText::Destroy() {
-        characters.clear();
+        if (is_inited_) {
+            glDeleteTextures(1, &atlas_texture_);
+            glDeleteBuffers(1, &VBO2DText_);
+            glDeleteVertexArrays(1, &VAO2DText_);
+        }
+
+        pixel_sizes_.clear();
+        characters_.clear();
+        vertices_.clear();
+        uploaded_vertices_.clear();
+        layouts_.clear();
         is_inited_ = false;
         return 0;
     }
@@ -100,77 +169,126 @@ namespace opengl {
         return is_inited_;
     }
 
-    OpenGLCharacter_t OpenGLText::GetCharacter(GLchar character) {
-        
-        if (!is_inited_) {
-            debug_tools::Console(debug_tools::FATAL, "OpenGLFont::GetCharacter() - Object not initialised");
-            return OpenGLCharacter_t();
+    int OpenGLText::Add2DText(const std::string& text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color) {
+        if (!is_inited_) return -1;
+
+        /* The same text at the same scale has the same layout, only moved */
+        layout_key_.assign(text);
+        layout_key_.append(reinterpret_cast<const char *>(&scale), sizeof(scale));
+        auto itr = layouts_.find(layout_key_);
+        if (itr == layouts_.end()) {
+            itr = layouts_.insert(std::make_pair(layout_key_, TextLayout_t())).first;
+            CreateLayout(text, scale, itr->second.vertices_);
+        }
+        itr->second.frame_ = frame_;
+
+        const std::vector<OpenGLTextVertex_t>& layout = itr->second.vertices_;
+        glm::vec4 position(x, y, 0, 0);
+        for (size_t i = 0; i < layout.size(); i++) {
+            OpenGLTextVertex_t vertex;
+            vertex.vertex_ = layout[i].vertex_ + position;
+            vertex.color_ = color;
+            vertices_.push_back(vertex);
         }
 
-        return characters[character];
+        return 0;
     }
 
-    int OpenGLText::Draw2DText(std::string text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color) {
-
+    int OpenGLText::Draw2DTexts() {
         if (!is_inited_) return -1;
 
+        /* Forget the layouts of the texts that were not drawn in this frame */
+        for (auto itr = layouts_.begin(); itr != layouts_.end();) {
+            if (itr->second.frame_ != frame_) itr = layouts_.erase(itr);
+            else ++itr;
+        }
+        frame_++;
+
+        if (vertices_.empty()) return 0;
+
+        glBindBuffer(GL_ARRAY_BUFFER, VBO2DText_);
+        size_t size_bytes = vertices_.size() * sizeof(OpenGLTextVertex_t);
+        if (vertices_.size() > vbo_capacity_) {
+            vbo_capacity_ = std::max(vertices_.size(), 2 * vbo_capacity_);
+            glBufferData(GL_ARRAY_BUFFER, vbo_capacity_ * sizeof(OpenGLTextVertex_t), NULL, GL_DYNAMIC_DRAW);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, size_bytes, &vertices_[0]);
+        } else if (vertices_.size() != uploaded_vertices_.size() || memcmp(&vertices_[0], &uploaded_vertices_[0], size_bytes) != 0) {
+            glBufferSubData(GL_ARRAY_BUFFER, 0, size_bytes, &vertices_[0]);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
         glDisable(GL_DEPTH_TEST);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
         shader_text_.Use();
+        shader_text_.SetUniformMat4(shader_text_.uni_Projection_, text_projection_matrix_);
+        shader_text_.SetUniformInt(shader_text_.uni_Texture_, 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, atlas_texture_);
+
         glBindVertexArray(VAO2DText_);
+        glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(vertices_.size()));
+        glBindVertexArray(0);
+        glBindTexture(GL_TEXTURE_2D, 0);
 
-        glUniform3f(shader_text_.uni_Texture_color_, color.x, color.y, color.z);
-        glUniformMatrix4fv(shader_text_.uni_Projection_, 1, GL_FALSE, &(text_projection_matrix_[0][0]));
-        glActiveTexture(GL_TEXTURE0);
+        glDisable(GL_BLEND);
+        glEnable(GL_DEPTH_TEST);
 
-        /* Iterate through the text characters */
-        std::string::const_iterator c;
-        for (c = text.begin(); c != text.end(); c++) {
-            OpenGLCharacter_t ch = GetCharacter(*c);
-
-            GLfloat xpos = x + ch.bearing_.x * scale;
-            GLfloat ypos = y - (ch.size_.y - ch.bearing_.y) * scale;
-
-            GLfloat w = ch.size_.x * scale;
-            GLfloat h = ch.size_.y * scale;
-            /* Update text VBO for each character */
-            /* [0][1] view space position, [2][3] texture coordinates */
-            GLfloat vertices[6][4] = {
-                { xpos,     ypos + h,   0.0, 0.0 },
-                { xpos,     ypos,       0.0, 1.0 },
-                { xpos + w, ypos,       1.0, 1.0 },
-
-                { xpos,     ypos + h,   0.0, 0.0 },
-                { xpos + w, ypos,       1.0, 1.0 },
-                { xpos + w, ypos + h,   1.0, 0.0 }
-            };
-            glBindTexture(GL_TEXTURE_2D, ch.texture_id_);
-            /* Update text VBO */
-            glBindBuffer(GL_ARRAY_BUFFER, VBO2DText_);
-            glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices); // Be sure to use glBufferSubData and not glBufferData
-            glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-            /* Render text */
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-            glDrawArrays(GL_TRIANGLES, 0, 6);
-            glDisable(GL_BLEND);
+        uploaded_vertices_.swap(vertices_);
+        vertices_.clear();
+        return 1;
+    }
 
-            /* Now advance cursors for next glyph (note that advance is number of 1/64 pixels) */
-            /* Bitshift by 6 to get value in pixels (2^6 = 64 (divide amount of 1/64th pixels by 64 to get amount of pixels)) */
-            x += (ch.advance_ >> 6) * scale;
+    size_t OpenGLText::GetPixelSize(GLfloat scale) {
+        GLfloat size = scale * GAME_ENGINE_GL_TEXT_BASE_SIZE;
+        for (size_t i = 0; i < pixel_sizes_.size(); i++) {
+            if (pixel_sizes_[i] >= size) return i;
         }
+        return pixel_sizes_.size() - 1;
+    }
 
-        glBindTexture(GL_TEXTURE_2D, 0);
-        glBindVertexArray(0);
+    void OpenGLText::CreateLayout(const std::string& text, GLfloat scale, std::vector<OpenGLTextVertex_t>& vertices) {
+        size_t pixel_size = GetPixelSize(scale);
+        const std::vector<OpenGLCharacter_t>& characters = characters_[pixel_size];
+        /* The glyphs are scaled from their pixel size */
+        GLfloat glyph_scale = scale * GAME_ENGINE_GL_TEXT_BASE_SIZE / pixel_sizes_[pixel_size];
 
-        glEnable(GL_DEPTH_TEST);
+        GLfloat x = 0;
+        vertices.reserve(6 * text.size());
+        for (size_t i = 0; i < text.size(); i++) {
+            unsigned char c = static_cast<unsigned char>(text[i]);
+            if (c >= GAME_ENGINE_GL_TEXT_CHARACTERS) continue;
+            const OpenGLCharacter_t& ch = characters[c];
 
-        return 0;
-    }
+            GLfloat xpos = x + ch.bearing_.x * glyph_scale;
+            GLfloat ypos = -(ch.size_.y - ch.bearing_.y) * glyph_scale;
+            GLfloat w = ch.size_.x * glyph_scale;
+            GLfloat h = ch.size_.y * glyph_scale;
 
+            /* Now advance cursors for next glyph (note that advance is number of 1/64 pixels) */
+            x += (ch.advance_ >> 6) * glyph_scale;
+            if (w == 0 || h == 0) continue;
+
+            /* Two triangles, the top of the glyph is the first row of the atlas */
+            OpenGLTextVertex_t vertex;
+            vertex.color_ = glm::vec3(1);
+            vertex.vertex_ = glm::vec4(xpos, ypos + h, ch.uv_min_.x, ch.uv_min_.y);
+            vertices.push_back(vertex);
+            vertex.vertex_ = glm::vec4(xpos, ypos, ch.uv_min_.x, ch.uv_max_.y);
+            vertices.push_back(vertex);
+            vertex.vertex_ = glm::vec4(xpos + w, ypos, ch.uv_max_.x, ch.uv_max_.y);
+            vertices.push_back(vertex);
+
+            vertex.vertex_ = glm::vec4(xpos, ypos + h, ch.uv_min_.x, ch.uv_min_.y);
+            vertices.push_back(vertex);
+            vertex.vertex_ = glm::vec4(xpos + w, ypos, ch.uv_max_.x, ch.uv_max_.y);
+            vertices.push_back(vertex);
+            vertex.vertex_ = glm::vec4(xpos + w, ypos + h, ch.uv_max_.x, ch.uv_min_.y);
+            vertices.push_back(vertex);
+        }
+    }
 
 }
 }
-}
\ No newline at end of file
+}
@@ -1,7 +1,9 @@
 #ifndef __OpenGLFont_hpp__
 #define __OpenGLFont_hpp__
 
-#include <map>
+#include <string>
+#include <vector>
+#include <unordered_map>
 
 #include "OpenGLIncludes.hpp"
 #include "OpenGLContext.hpp"
@@ -13,10 +15,18 @@ namespace game_engine {
 namespace graphics {
 namespace opengl {
 
+    /* The number of characters loaded, the first ones of the ASCII set */
+#define GAME_ENGINE_GL_TEXT_CHARACTERS 128
+    /* The pixel size of the font at scale 1 */
+#define GAME_ENGINE_GL_TEXT_BASE_SIZE 48
+    /* The width of the glyph atlas, its height is the smallest power of two that fits all the glyphs */
+#define GAME_ENGINE_GL_TEXT_ATLAS_WIDTH 1024
+
     /* Struct represeting a renderable character */
     typedef struct {
-        /* Character texture */
-        GLuint texture_id_;
+        /* The corners of the character in the atlas */
+        glm::vec2 uv_min_;
+        glm::vec2 uv_max_;
         /* Size of the character */
         glm::ivec2 size_;
         /* Bearing of the character, offset from baseline to left/top of glyph */
@@ -25,13 +35,23 @@ namespace opengl {
         signed long advance_;
     } OpenGLCharacter_t;
 
-    /* A class to draw text */
+    /* A vertex of the text batch */
+    struct OpenGLTextVertex_t {
+        /* Screen position and texture coordinates, the vertex attribute of the text shader */
+        glm::vec4 vertex_;
+        glm::vec3 color_;
+    };
+
+    /**
+        A class to draw text. The glyphs of the font, rasterised at a few pixel sizes, are packed in a single atlas
+        texture. Text is added during the frame and drawn all at once with a single draw call
+    */
     class OpenGLText {
     public:
         OpenGLText();
 
-        /** 
-            Initialize the font using a .ttf file 
+        /**
+            Initialize the font using a .ttf file
             @param font_file_path A file path of a .ttf file
             @param context opengl context class
             @return 0=OK, -1=Already initialised, else see ErrorCodes.hpp
@@ -51,7 +71,7 @@ namespace opengl {
         bool IsInited();
 
         /**
-            Draw a 2d text on a certain position on the screen, not in the world
+            Add a 2d text on a certain position on the screen, not in the world, drawn with Draw2DTexts()
             @param text The text to draw
             @param x The horizontal position in screen coordinates
             @param y The vertical position in screen coordintates
@@ -59,25 +79,58 @@ namespace opengl {
             @param color The color of the text in RGB format
             @return 0=OK, -1=Font was not initialised
         */
-        int Draw2DText(std::string text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color);
+        int Add2DText(const std::string& text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color);
+
+        /**
+            Draw the text added since the last call with one draw call, and clear it. The vertices are not uploaded
+            again when they are the same as the ones of the last call
+            @return -1 = Not initialised, else the number of draw calls
+        */
+        int Draw2DTexts();
 
     private:
+        /* The vertices of a text at the origin, kept while the text is drawn every frame */
+        struct TextLayout_t {
+            std::vector<OpenGLTextVertex_t> vertices_;
+            size_t frame_;
+        };
+
         bool is_inited_;
-        std::map<GLchar, OpenGLCharacter_t> characters;
+        /* The characters of each pixel size */
+        std::vector<unsigned int> pixel_sizes_;
+        std::vector<std::vector<OpenGLCharacter_t>> characters_;
+        GLuint atlas_texture_;
 
-        GLuint VAO2DText_, VBO2DText_, VAO_Quad_;
+        GLuint VAO2DText_, VBO2DText_;
+        size_t vbo_capacity_;
         glm::mat4 text_projection_matrix_;
         OpenGLShaderText shader_text_;
 
+        /* The text of the frame, the vertices currently in the buffer, and the layouts of recent texts */
+        std::vector<OpenGLTextVertex_t> vertices_;
+        std::vector<OpenGLTextVertex_t> uploaded_vertices_;
+        std::unordered_map<std::string, TextLayout_t> layouts_;
+        std::string layout_key_;
+        size_t frame_;
+
         /**
-            Get a renderable character object
+            Get the pixel size that a text is drawn with, the smallest one not smaller than the text on the screen
+            @param scale The scale of the text
+            @return The index in pixel_sizes_
         */
-        OpenGLCharacter_t GetCharacter(GLchar character);
+        size_t GetPixelSize(GLfloat scale);
 
+        /**
+            Create the vertices of a text at the origin
+            @param text The text
+            @param scale The size of the text
+            @param[out] vertices The vertices, six per character
+        */
+        void CreateLayout(const std::string& text, GLfloat scale, std::vector<OpenGLTextVertex_t>& vertices);
     };
 
 }
 }
 }
 
-#endif
\ No newline at end of file
+#endif
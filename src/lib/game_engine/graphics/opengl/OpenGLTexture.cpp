@@ -3,9 +3,6 @@
 #include <cstdio>
 #include <cstring>
 
-#define STB_IMAGE_IMPLEMENTATION
-#include "external/stb_image/stb_image.h"
-
 #include "game_engine/core/ErrorCodes.hpp"
 #include "game_engine/graphics/GraphicsTypes.hpp"
 
@@ -22,18 +19,71 @@ namespace opengl {
 
     OpenGLTexture::OpenGLTexture() {
         is_inited_ = false;
+        is_loaded_ = false;
     }
 
     int OpenGLTexture::Init(std::string file_path, int type, GLuint filtering) {
         if (is_inited_) return -1;
 
+        DecodedImage_t image;
+        int ret = TextureDecoder::Decode(file_path, image);
+        if (ret != 0) return ret;
+
+        InitPlaceholder(type, filtering);
+        Upload(image.width_, image.height_, image.channels_, image.data_);
+        TextureDecoder::Free(image);
+
+        return 0;
+    }
+
+    int OpenGLTexture::InitPlaceholder(int type, GLuint filtering) {
+        if (is_inited_) return -1;
+
         filtering_ = filtering;
         type_ = type;
-        int ret = LoadSTB(file_path.c_str(), &texture_);
-        if (ret != 0) return ret;
 
+        /* A neutral value for the type: grey albedo, no specular, a flat normal, no displacement */
+        unsigned char texel[4] = { 0, 0, 0, 255 };
+        if (type == GAME_ENGINE_TEXTURE_TYPE_DIFFUSE_MAP) texel[0] = texel[1] = texel[2] = 128;
+        else if (type == GAME_ENGINE_TEXTURE_TYPE_NORMAL_MAP) {
+            texel[0] = texel[1] = 128;
+            texel[2] = 255;
+        }
+
+        glGenTextures(1, &texture_);
+        glBindTexture(GL_TEXTURE_2D, texture_);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, texel);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filtering_);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 
         is_inited_ = true;
+        is_loaded_ = false;
+        return 0;
+    }
+
+    int OpenGLTexture::Upload(int width, int height, int channels, const void * pixels) {
+        if (!is_inited_) return -1;
+
+        GLenum format;
+        if (channels == 1) format = GL_RED;
+        else if (channels == 2) format = GL_RG;
+        else if (channels == 3) format = GL_RGB;
+        else format = GL_RGBA;
+
+        /* Rows of 1 and 3 channel images are not aligned to 4 bytes */
+        glBindTexture(GL_TEXTURE_2D, texture_);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, pixels);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        /* Configure wrapping and zooming behaviour */
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, format == GL_RGBA ? GL_CLAMP_TO_EDGE : GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, format == GL_RGBA ? GL_CLAMP_TO_EDGE : GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filtering_);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+
+        is_loaded_ = true;
         return 0;
     }
 
@@ -42,6 +92,7 @@ namespace opengl {
         glDeleteTextures(1, &texture_);
 
         is_inited_ = false;
+        is_loaded_ = false;
         return 0;
     }
 
@@ -49,6 +100,10 @@ namespace opengl {
         return is_inited_;
     }
 
+    bool OpenGLTexture::IsLoaded() {
+        return is_loaded_;
+    }
+
     GLuint OpenGLTexture::GetID() {
         if (!is_inited_) return 0;
 
@@ -157,41 +212,6 @@ namespace opengl {
         return 0;
     }
 
-    int OpenGLTexture::LoadSTB(const char * imagepath, GLuint * texture_id) {
-
-        int width, height, channels;
-
-        unsigned char * data = stbi_load(imagepath, &width, &height, &channels, 0);
-        if (!data) {
-            stbi_image_free(data);
-            return Error::ERROR_ASSET_NOT_FOUND;
-        }
-        
-        GLenum format;
-        if (channels == 1) format = GL_RED;
-        else if (channels == 3) format = GL_RGB;
-        else if (channels == 4) format = GL_RGBA;
-        
-        GLuint textureID;
-        glGenTextures(1, &textureID);
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-        
-        /* Configure wrapping and zooming behaviour */
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, format == GL_RGBA ? GL_CLAMP_TO_EDGE : GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, format == GL_RGBA ? GL_CLAMP_TO_EDGE : GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filtering_);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        /* Generate the mipmaps */
-        
-        stbi_image_free(data);
-        
-        *texture_id = textureID;
-
-        return 0;
-    }
-
 }
 }
 }
@@ -4,6 +4,7 @@
 #include <string>
 
 #include "OpenGLIncludes.hpp"
+#include "game_engine/graphics/TextureDecoder.hpp"
 
 namespace game_engine {
 namespace graphics {
@@ -24,6 +25,24 @@ namespace opengl {
         */
         int Init(std::string file_path, int type, GLuint filtering = GL_NEAREST);
 
+        /**
+            Initializes an OpenGL texture with a single texel, shown until the image is uploaded with Upload()
+            @param type The type of the texture, sets the color of the texel
+            @param filtering The GL_TEXTURE_MAG_FILTER filtering option
+            @return 0=OK, -1=Already initialised
+        */
+        int InitPlaceholder(int type, GLuint filtering = GL_NEAREST);
+
+        /**
+            Replace the contents of the texture with an image, and generate the mipmaps. The id doesn't change
+            @param width The width of the image
+            @param height The height of the image
+            @param channels The number of 8 bit channels, 1 to 4
+            @param pixels The pixels, or the offset in the GL_PIXEL_UNPACK_BUFFER if one is bound
+            @return 0=OK, -1=Not initialised
+        */
+        int Upload(int width, int height, int channels, const void * pixels);
+
         /**
             Deletes allocated objects, needs Init to be called again. Never fails
             @return 0 = OK
@@ -36,6 +55,12 @@ namespace opengl {
         */
         bool IsInited();
 
+        /**
+            Return whether the image of the texture has been uploaded, or the placeholder is still used
+            @return true = Loaded, false = Placeholder
+        */
+        bool IsLoaded();
+
         /**
             Get the opengl tecture id
             @return The ID
@@ -56,6 +81,7 @@ namespace opengl {
 
     private:
         bool is_inited_;
+        bool is_loaded_;
         int type_;
         GLuint texture_;
         GLuint filtering_;
@@ -65,11 +91,6 @@ namespace opengl {
         */
         int LoadDDS(const char * imagepath, GLuint * texture_id);
 
-        /**
-            Load a BMP, JPG, PNG image and others, see proper documentation here https://github.com/nothings/stb/blob/master/stb_image.h
-        */
-        int LoadSTB(const char * imagepath, GLuint * texture_id);
-
     };
 }
 }
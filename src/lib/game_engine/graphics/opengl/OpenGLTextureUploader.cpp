@@ -0,0 +1,101 @@
+#include "OpenGLTextureUploader.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+namespace game_engine {
+namespace graphics {
+namespace opengl {
+
+    OpenGLTextureUploader::OpenGLTextureUploader() {
+        is_inited_ = false;
+    }
+
+    int OpenGLTextureUploader::Init() {
+        if (is_inited_) return -1;
+
+        glGenBuffers(1, &buffer_);
+
+        is_inited_ = true;
+        return 0;
+    }
+
+    int OpenGLTextureUploader::Destroy() {
+        if (!is_inited_) return -1;
+
+        for (size_t i = 0; i < uploads_.size(); i++) TextureDecoder::Free(uploads_[i].image_);
+        uploads_.clear();
+        glDeleteBuffers(1, &buffer_);
+
+        is_inited_ = false;
+        return 0;
+    }
+
+    bool OpenGLTextureUploader::IsInited() {
+        return is_inited_;
+    }
+
+    int OpenGLTextureUploader::Schedule(OpenGLTexture * texture, const DecodedImage_t& image) {
+        if (!is_inited_) return -1;
+
+        Upload_t upload;
+        upload.texture_ = texture;
+        upload.image_ = image;
+        upload.copied_ = 0;
+        uploads_.push_back(upload);
+        return 0;
+    }
+
+    size_t OpenGLTextureUploader::Update(size_t bytes, std::vector<std::string>& uploaded) {
+        if (!is_inited_ || uploads_.empty()) return 0;
+
+        size_t number_uploaded = 0;
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer_);
+        while (!uploads_.empty()) {
+            Upload_t& upload = uploads_.front();
+            DecodedImage_t& image = upload.image_;
+            size_t size = static_cast<size_t>(image.width_) * image.height_ * image.channels_;
+
+            if (upload.copied_ < size) {
+                if (bytes == 0) break;
+
+                /* New storage for every image, the previous one might still be read by the transfer to its texture */
+                if (upload.copied_ == 0) glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+
+                /* Nothing reads the buffer until the image is copied completely, no need to synchronize */
+                size_t chunk = std::min(bytes, size - upload.copied_);
+                GLintptr offset = static_cast<GLintptr>(upload.copied_);
+                void * memory = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, offset, chunk, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+                if (memory != nullptr) {
+                    memcpy(memory, image.data_ + upload.copied_, chunk);
+                    if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE) {
+                        /* The contents of the buffer were lost, start the image again */
+                        upload.copied_ = 0;
+                        break;
+                    }
+                } else {
+                    glBufferSubData(GL_PIXEL_UNPACK_BUFFER, offset, chunk, image.data_ + upload.copied_);
+                }
+                upload.copied_ += chunk;
+                bytes -= chunk;
+                if (upload.copied_ < size) break;
+            }
+
+            upload.texture_->Upload(image.width_, image.height_, image.channels_, nullptr);
+            uploaded.push_back(image.path_);
+            TextureDecoder::Free(image);
+            uploads_.pop_front();
+            number_uploaded++;
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        return number_uploaded;
+    }
+
+    size_t OpenGLTextureUploader::GetNumberOfQueued() {
+        return uploads_.size();
+    }
+
+}
+}
+}
@@ -0,0 +1,79 @@
+#ifndef __OpenGLTextureUploader_hpp__
+#define __OpenGLTextureUploader_hpp__
+
+#include <string>
+#include <vector>
+#include <deque>
+
+#include "OpenGLIncludes.hpp"
+#include "OpenGLTexture.hpp"
+#include "game_engine/graphics/TextureDecoder.hpp"
+
+namespace game_engine {
+namespace graphics {
+namespace opengl {
+
+    /**
+        Uploads decoded images to their textures through a pixel buffer object. The pixels of an image are copied in
+        the buffer over one or more calls to Update(), a number of bytes per call, and when all of them are in, the
+        texture is specified from the buffer. The transfer to the texture then happens asynchronously. Images are
+        uploaded in the order they are scheduled
+    */
+    class OpenGLTextureUploader {
+    public:
+        OpenGLTextureUploader();
+
+        /**
+            Create the pixel buffer
+            @return 0=OK, -1=Already initialised
+        */
+        int Init();
+
+        /**
+            Delete the pixel buffer, and free the images not uploaded yet
+            @return 0=OK, -1=Not initialised
+        */
+        int Destroy();
+
+        bool IsInited();
+
+        /**
+            Schedule an image to be uploaded to a texture
+            @param texture The texture, initialised
+            @param image The image, freed by the uploader once uploaded
+            @return 0=OK, -1=Not initialised
+        */
+        int Schedule(OpenGLTexture * texture, const DecodedImage_t& image);
+
+        /**
+            Copy pixels to the buffer, and upload the images that are copied completely
+            @param bytes The maximum number of bytes to copy
+            @param[out] uploaded The paths of the images uploaded are appended
+            @return The number of images uploaded
+        */
+        size_t Update(size_t bytes, std::vector<std::string>& uploaded);
+
+        /**
+            Get the number of images not uploaded yet
+            @return The number of images
+        */
+        size_t GetNumberOfQueued();
+
+    private:
+        struct Upload_t {
+            OpenGLTexture * texture_;
+            DecodedImage_t image_;
+            /* Bytes of the image copied to the buffer so far */
+            size_t copied_;
+        };
+
+        bool is_inited_;
+        GLuint buffer_;
+        std::deque<Upload_t> uploads_;
+    };
+
+}
+}
+}
+
+#endif
@@ -36,11 +36,11 @@ namespace game_engine { namespace math {
             }
         }
     
-        static bool Overlaps(AABox<K>& a, AABox<K>& b) {
+        static bool Overlaps(const AABox<K>& a, const AABox<K>& b) {
             return overlaping(a, b);
         }
     
-        bool Overlaps(AABox<K>& other) {
+        bool Overlaps(const AABox<K>& other) const {
             return overlaping(*this, other);
         }
     
@@ -60,22 +60,12 @@ namespace game_engine { namespace math {
     
     private:
     
-        static bool overlaping(AABox<1>& a, AABox<1>& b) {
-            if (a.max_[0] >= b.min_[0] && b.max_[0] >= a.min_[0]) return true;
-            return false;
-        }
-    
-        static bool overlaping(AABox<2>& a, AABox<2>& b) {
-            if (overlaping(AABox<1>(Vector<1>(a.min_[0]), Vector<1>(a.max_[0])), AABox<1>(Vector<1>(b.min_[0]), Vector<1>(b.max_[0])))
-                && overlaping(AABox<1>(Vector<1>(a.min_[1]), Vector<1>(a.max_[1])), AABox<1>(Vector<1>(b.min_[1]), Vector<1>(b.max_[1])))) return true;
-            return false;
-        }
-    
-        static bool overlaping(AABox<3>& a, AABox<3>& b) {
-            if (overlaping(AABox<1>(Vector<1>(a.min_[0]), Vector<1>(a.max_[0])), AABox<1>(Vector<1>(b.min_[0]), Vector<1>(b.max_[0])))
-                && overlaping(AABox<1>(Vector<1>(a.min_[1]), Vector<1>(a.max_[1])), AABox<1>(Vector<1>(b.min_[1]), Vector<1>(b.max_[1])))
-                && overlaping(AABox<1>(Vector<1>(a.min_[2]), Vector<1>(a.max_[2])), AABox<1>(Vector<1>(b.min_[2]), Vector<1>(b.max_[2])))) return true;
-            return false;
+        static bool overlaping(const AABox<K>& a, const AABox<K>& b) {
+            /* Boxes overlap when their projections overlap on every axis */
+            for (size_t i = 0; i < K; i++) {
+                if (a.max_[i] < b.min_[i] || b.max_[i] < a.min_[i]) return false;
+            }
+            return true;
         }
     
     };
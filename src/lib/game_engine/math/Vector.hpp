@@ -3,6 +3,8 @@
 
 #include <iostream>
 #include <vector>
+#include <initializer_list>
+#include <type_traits>
 
 #include "glm/glm.hpp"
 
@@ -12,32 +14,74 @@
 #include "debug_tools/Console.hpp"
 namespace dt = debug_tools;
 
+/*
+    Vector storage mode. By default the coordinates are stored inline in the object, and the arithmetic
+    is done with SSE when available. Define GAME_ENGINE_MATH_VECTOR_HEAP_STORAGE to use the old std::vector
+    storage, or GAME_ENGINE_MATH_NO_SIMD to keep the inline storage with plain scalar arithmetic
+*/
+#if !defined(GAME_ENGINE_MATH_VECTOR_HEAP_STORAGE) && !defined(GAME_ENGINE_MATH_NO_SIMD)
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define GAME_ENGINE_MATH_SIMD
+#include <xmmintrin.h>
+#endif
+#endif
+
+/* Number of floats stored per vector, SIMD storage is padded to a multiple of four */
+#ifdef GAME_ENGINE_MATH_SIMD
+#define GAME_ENGINE_MATH_VECTOR_STORAGE(K) ((((K) + 3) / 4) * 4)
+#else
+#define GAME_ENGINE_MATH_VECTOR_STORAGE(K) (K)
+#endif
 
 namespace game_engine {
 namespace math {
 
+#ifdef GAME_ENGINE_MATH_SIMD
+    static_assert(std::is_same<Real_t, float>::value, "SIMD vector arithmetic expects Real_t to be float, define GAME_ENGINE_MATH_NO_SIMD");
+
+    /**
+        Sum the four lanes of an SSE register
+        @param v The register
+        @return The sum
+    */
+    inline float SimdHorizontalSum(__m128 v) {
+        __m128 shuffled = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+        __m128 sums = _mm_add_ps(v, shuffled);
+        shuffled = _mm_movehl_ps(shuffled, sums);
+        sums = _mm_add_ss(sums, shuffled);
+        return _mm_cvtss_f32(sums);
+    }
+#endif
+
     /* A vector in K dimensional space */
     template<int K>
     class Vector {
     public:
         Vector() {
-            coordinates_ = std::vector<Real_t>(K, 0);
+            Fill(0);
         }
 
         Vector(Real_t a) {
-            coordinates_ = std::vector<Real_t>(K, a);
+            Fill(a);
         }
 
-        Vector(std::vector<Real_t>& coordinates) {
-            coordinates_ = coordinates;
+        Vector(const std::vector<Real_t>& coordinates) {
+            Fill(0);
+            for (size_t i = 0; i < K && i < coordinates.size(); i++) {
+                coordinates_[i] = coordinates[i];
+            }
         }
 
-        Real_t Norm() {
+        Real_t Norm() const {
+#ifdef GAME_ENGINE_MATH_SIMD
+            return std::sqrt(DotProduct(*this));
+#else
             Real_t a = 0;
             for (size_t i = 0; i < K; i++) {
-                a += std::pow<Real_t>(coordinates_[i], Real_t(2));
+                a += coordinates_[i] * coordinates_[i];
             }
-            return sqrt(a);
+            return std::sqrt(a);
+#endif
         }
 
         Vector& Normalise() {
@@ -48,37 +92,63 @@ namespace math {
             return *this;
         }
 
-        static Real_t Distance(Vector<K>& a, Vector<K>& b) {
+        static Real_t Distance(const Vector<K>& a, const Vector<K>& b) {
+#ifdef GAME_ENGINE_MATH_SIMD
+            __m128 sum = _mm_setzero_ps();
+            for (size_t i = 0; i < STORAGE; i += 4) {
+                __m128 d = _mm_sub_ps(_mm_loadu_ps(&a.coordinates_[i]), _mm_loadu_ps(&b.coordinates_[i]));
+                sum = _mm_add_ps(sum, _mm_mul_ps(d, d));
+            }
+            return std::sqrt(SimdHorizontalSum(sum));
+#else
             Real_t sum = 0;
             for (size_t i = 0; i < K; i++) {
-                sum += std::pow<Real_t>(a[i] - b[i], 2);
+                Real_t d = a.coordinates_[i] - b.coordinates_[i];
+                sum += d * d;
             }
             return std::sqrt(sum);
+#endif
         }
 
-        Real_t DotProduct(Vector<K>& a) {
+        Real_t DotProduct(const Vector<K>& a) const {
+#ifdef GAME_ENGINE_MATH_SIMD
+            __m128 sum = _mm_setzero_ps();
+            for (size_t i = 0; i < STORAGE; i += 4) {
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(&coordinates_[i]), _mm_loadu_ps(&a.coordinates_[i])));
+            }
+            return SimdHorizontalSum(sum);
+#else
             Real_t sum = 0;
             for (size_t i = 0; i < K; i++) {
                 sum += coordinates_[i] * a.coordinates_[i];
             }
             return sum;
+#endif
         }
 
         Vector& operator+=(const Vector& rhs) {
+#ifdef GAME_ENGINE_MATH_SIMD
+            for (size_t i = 0; i < STORAGE; i += 4)
+                _mm_storeu_ps(&coordinates_[i], _mm_add_ps(_mm_loadu_ps(&coordinates_[i]), _mm_loadu_ps(&rhs.coordinates_[i])));
+#else
             for (size_t i = 0; i < K; i++)
                 coordinates_[i] += rhs.coordinates_[i];
+#endif
             return *this;
         }
-        friend Vector operator+(const Vector& lhs, const Vector& rhs) {
-            Vector<K> temp;
-            for (size_t i = 0; i < K; i++)
-                temp[i] = lhs.coordinates_[i] + rhs.coordinates_[i];
-            return temp;
+        friend Vector operator+(Vector lhs, const Vector& rhs) {
+            lhs += rhs;
+            return lhs;
         }
 
         Vector& operator-=(const Vector& rhs) {
+#ifdef GAME_ENGINE_MATH_SIMD
+            for (size_t i = 0; i < STORAGE; i += 4)
+                _mm_storeu_ps(&coordinates_[i], _mm_sub_ps(_mm_loadu_ps(&coordinates_[i]), _mm_loadu_ps(&rhs.coordinates_[i])));
+#else
             for (size_t i = 0; i < K; i++)
                 coordinates_[i] -= rhs.coordinates_[i];
+#endif
             return *this;
         }
         friend Vector operator-(Vector lhs, const Vector& rhs) {
@@ -86,27 +156,34 @@ namespace math {
             return lhs;
         }
 
-        friend Vector operator*(Real_t v, const Vector& rhs) {
-            Vector temp = rhs;
+        Vector& operator*=(Real_t v) {
+#ifdef GAME_ENGINE_MATH_SIMD
+            __m128 scalar = _mm_set1_ps(v);
+            for (size_t i = 0; i < STORAGE; i += 4)
+                _mm_storeu_ps(&coordinates_[i], _mm_mul_ps(_mm_loadu_ps(&coordinates_[i]), scalar));
+#else
             for (size_t i = 0; i < K; i++)
-                temp.coordinates_[i] = temp.coordinates_[i] * v;
-            return temp;
+                coordinates_[i] = coordinates_[i] * v;
+#endif
+            return *this;
         }
-        friend Vector operator*(const Vector& lhs, Real_t v) {
-            Vector temp = lhs;
-            for (size_t i = 0; i < K; i++)
-                temp.coordinates_[i] = temp.coordinates_[i] * v;
-            return temp;
+        friend Vector operator*(Real_t v, Vector rhs) {
+            rhs *= v;
+            return rhs;
+        }
+        friend Vector operator*(Vector lhs, Real_t v) {
+            lhs *= v;
+            return lhs;
         }
 
-        friend Vector operator/(const Vector& lhs, Real_t v) {
-            Vector temp = lhs;
+        friend Vector operator/(Vector lhs, Real_t v) {
+            /* Scalar on purpose, dividing the zero padding lanes by zero would produce NaNs */
             for (size_t i = 0; i < K; i++)
-                temp.coordinates_[i] = temp.coordinates_[i] / v;
-            return temp;
+                lhs.coordinates_[i] = lhs.coordinates_[i] / v;
+            return lhs;
         }
 
-        bool operator==(const Vector& rhs) {
+        bool operator==(const Vector& rhs) const {
             bool ret = true;
             for (size_t i = 0; i < K; i++) {
                 ret = ret & Equal(coordinates_[i], rhs.coordinates_[i]);
@@ -118,6 +195,10 @@ namespace math {
             return coordinates_[i];
         }
 
+        const Real_t& operator[](size_t i) const {
+            return coordinates_[i];
+        }
+
         void Translate(std::vector<Real_t> translation) {
             for (size_t i = 0; i < K; i++) {
                 coordinates_[i] += translation[i];
@@ -134,8 +215,32 @@ namespace math {
         }
 
     protected:
+        /* Used by the 2D and 3D vectors, a base initializer list constructor makes AABox(center, { x, y }) ambiguous */
+        void Set(std::initializer_list<Real_t> coordinates) {
+            size_t i = 0;
+            for (std::initializer_list<Real_t>::const_iterator itr = coordinates.begin(); itr != coordinates.end() && i < K; ++itr) {
+                coordinates_[i++] = *itr;
+            }
+        }
+
+        static const size_t STORAGE = GAME_ENGINE_MATH_VECTOR_STORAGE(K);
+
+#ifdef GAME_ENGINE_MATH_VECTOR_HEAP_STORAGE
         std::vector<Real_t> coordinates_;
 
+        void Fill(Real_t a) {
+            coordinates_.assign(STORAGE, a);
+        }
+#else
+        /* The lanes after K are padding for the SIMD paths, and are always zero */
+        Real_t coordinates_[STORAGE];
+
+        void Fill(Real_t a) {
+            for (size_t i = 0; i < K; i++) coordinates_[i] = a;
+            for (size_t i = K; i < STORAGE; i++) coordinates_[i] = 0;
+        }
+#endif
+
     };
 
     /* A 2D vector for simplicity */
@@ -150,18 +255,21 @@ namespace math {
             coordinates_[1] = y;
         }
 
-        Vector2D(glm::vec2& v) : Vector() {
+        Vector2D(std::initializer_list<Real_t> coordinates) : Vector() {
+            Set(coordinates);
+        }
+
+        Vector2D(const glm::vec2& v) : Vector() {
             coordinates_[0] = v.x;
             coordinates_[1] = v.y;
         }
 
-        Vector2D(Vector<2>& v) : Vector() {
-            coordinates_[0] = v[0];
-            coordinates_[1] = v[1];
+        Vector2D(const Vector<2>& v) : Vector(v) {
         }
 
-        Vector2D& operator = (Vector<2>& v) {
-            return Vector2D(v[0], v[1]);
+        Vector2D& operator = (const Vector<2>& v) {
+            Vector<2>::operator=(v);
+            return *this;
         }
 
         Real_t& x() {
@@ -190,28 +298,30 @@ namespace math {
             coordinates_[2] = z;
         }
 
-        Vector3D(glm::vec3& v) : Vector() {
+        Vector3D(std::initializer_list<Real_t> coordinates) : Vector() {
+            Set(coordinates);
+        }
+
+        Vector3D(const glm::vec3& v) : Vector() {
             coordinates_[0] = v.x;
             coordinates_[1] = v.y;
             coordinates_[2] = v.z;
         }
 
-        Vector3D(Vector<3>& v) : Vector() {
-            coordinates_[0] = v[0];
-            coordinates_[1] = v[1];
-            coordinates_[2] = v[2];
+        Vector3D(const Vector<3>& v) : Vector(v) {
         }
 
         static Vector3D CrossProduct(Vector3D& a, Vector3D& b) {
             return Vector3D(
-                {a.y()*b.z() - a.z()*b.y(),
+                a.y()*b.z() - a.z()*b.y(),
                 a.z()*b.x() - a.x()*b.z(),
                 a.x()*b.y() - a.y()*b.x()
-                });
+                );
         }
 
-        Vector3D& operator = (Vector<3>& v) {
-            return Vector3D(v[0], v[1], v[2]);
+        Vector3D& operator = (const Vector<3>& v) {
+            Vector<3>::operator=(v);
+            return *this;
         }
 
         Real_t& x() {
@@ -1,6 +1,8 @@
 #include "ArrayAllocator.hpp"
 
 #include <cmath>
+#include <cstdint>
+#include <algorithm>
 
 #include "debug_tools/Console.hpp"
 #include "debug_tools/Assert.hpp"
@@ -18,13 +20,14 @@ namespace memory {
         Destroy();
     }
 
-    bool ArrayAllocator::Init(size_t bytes_size) {
+    bool ArrayAllocator::Init(size_t bytes_size, size_t page_size) {
         if (is_inited_) return false;
 
-        size_t number_of_pages = static_cast<size_t>(std::ceil(((double)bytes_size) / ((double)PAGE_SIZE)));
+        page_size_ = page_size;
+        size_t number_of_pages = std::max<size_t>(1, static_cast<size_t>(std::ceil(((double)bytes_size) / ((double)page_size_))));
         pages_ = std::vector<MemoryPage *>(number_of_pages);
         for (size_t i = 0; i < number_of_pages; i++)
-            pages_[i] = new MemoryPage(PAGE_SIZE);
+            pages_[i] = new MemoryPage(page_size_);
 
         page_offset_ = 0;
         current_page_ = 0;
@@ -55,7 +58,7 @@ namespace memory {
             current_page_++;
             page_offset_ = 0;
             if (current_page_ == pages_.size()) {
-                pages_.push_back(new MemoryPage(PAGE_SIZE));
+                pages_.push_back(new MemoryPage(page_size_));
             }
 
             address = pages_[current_page_]->Get(page_offset_, bytes);
@@ -68,25 +71,35 @@ namespace memory {
 
     BYTE * ArrayAllocator::AllocateAligned(size_t bytes, size_t alignment) {
         if (!is_inited_) return nullptr;
-        _assert(alignment == 2 || alignment == 4 || alignment == 16);
+        _assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
 
         size_t expanded_size = bytes + alignment;
         BYTE * unaligned_address = Allocate(expanded_size);
+        if (unaligned_address == nullptr) return nullptr;
 
         size_t mask = (alignment - 1);
-        size_t misalignment = unaligned_address && mask;
-        size_t adjustment = alignment - misalignment;
+        size_t misalignment = reinterpret_cast<uintptr_t>(unaligned_address) & mask;
+        size_t adjustment = (alignment - misalignment) & mask;
 
         BYTE * aligned_address = unaligned_address + adjustment;
         return aligned_address;
     }
 
     size_t ArrayAllocator::GetBytesAllocated() {
-        return pages_.size() * PAGE_SIZE;
+        return pages_.size() * page_size_;
     }
 
     size_t ArrayAllocator::GetBytesUsed() {
-        return current_page_ * PAGE_SIZE + page_offset_;
+        return current_page_ * page_size_ + page_offset_;
+    }
+
+    size_t ArrayAllocator::GetPageSize() {
+        return page_size_;
+    }
+
+    void ArrayAllocator::Reset() {
+        current_page_ = 0;
+        page_offset_ = 0;
     }
 
 
@@ -37,13 +37,14 @@ namespace memory {
         ArrayAllocator& operator=(ArrayAllocator&& other) = delete;
 
         /**
-            Initializes an array of pointers to MemoryPage objects of size PAGE_SIZE,
+            Initializes an array of pointers to MemoryPage objects of size page_size,
             so as to fit the bytes_size. Allocations will sequentially get memory from
             the currently allocated pages
             @param bytes_size The bytes to allocate
+            @param page_size The size of every page
             @return true = OK, false = NOT OK
         */
-        bool Init(size_t bytes_size);
+        bool Init(size_t bytes_size, size_t page_size = PAGE_SIZE);
 
         /**
             Deallocates all allocated MemoryPage objects, needs to call Init() afterwards
@@ -80,7 +81,8 @@ namespace memory {
             Get memory for {bytes} size with proper alignement, with the same logic applied to 
             Allocate() function
             @param bytes The size to allocate
-            @return alignment The alignment should be 2 or 4 or 16
+            @param alignment The alignment, a power of two
+            @return The memory address
         */
         BYTE * AllocateAligned(size_t bytes, size_t alignment);
 
@@ -111,8 +113,21 @@ namespace memory {
         */
         size_t GetBytesUsed();
 
+        /**
+            Get the size of a page
+            @return The page size
+        */
+        size_t GetPageSize();
+
+        /**
+            Start allocating from the first page again. The pages are kept, every address returned so far
+            will be reused
+        */
+        void Reset();
+
     private:
         bool is_inited_ = false;
+        size_t page_size_ = PAGE_SIZE;
         std::vector<MemoryPage *> pages_;
         size_t page_offset_;
         size_t current_page_;
@@ -0,0 +1,276 @@
+#include "ConcurrentPoolAllocator.hpp"
+
+#include <cstring>
+#include <new>
+#include <mutex>
+#include <algorithm>
+#include <vector>
+
+#include "debug_tools/Console.hpp"
+#include "debug_tools/Assert.hpp"
+namespace dt = debug_tools;
+
+
+namespace game_engine {
+namespace memory {
+
+    /*
+        Every thread that allocates takes a slot, and uses the cache with the same index in every allocator. When the
+        thread exits, its caches are given back to the freelists of all the initialised allocators, and the slot can
+        be taken by another thread
+    */
+    static std::mutex thread_slots_lock;
+    static bool thread_slots_used[CONCURRENT_POOL_ALLOCATOR_MAX_THREADS] = { false };
+    static std::vector<ConcurrentPoolAllocator *> thread_slots_allocators;
+
+    struct ConcurrentPoolAllocator::ThreadSlot {
+        /* -2 = Not assigned yet, -1 = No free slot */
+        int index_ = -2;
+
+        ~ThreadSlot() {
+            if (index_ < 0) return;
+
+            std::unique_lock<std::mutex> l(thread_slots_lock);
+            for (size_t i = 0; i < thread_slots_allocators.size(); i++) thread_slots_allocators[i]->FlushThreadCache(index_);
+            thread_slots_used[index_] = false;
+        }
+    };
+    thread_local ConcurrentPoolAllocator::ThreadSlot ConcurrentPoolAllocator::thread_slot_;
+
+    int ConcurrentPoolAllocator::GetThreadSlot() {
+        if (thread_slot_.index_ != -2) return thread_slot_.index_;
+
+        std::unique_lock<std::mutex> l(thread_slots_lock);
+        thread_slot_.index_ = -1;
+        for (int i = 0; i < CONCURRENT_POOL_ALLOCATOR_MAX_THREADS; i++) {
+            if (!thread_slots_used[i]) {
+                thread_slots_used[i] = true;
+                thread_slot_.index_ = i;
+                break;
+            }
+        }
+        return thread_slot_.index_;
+    }
+
+    void ConcurrentPoolAllocator::FlushThreadCache(int slot) {
+        ThreadCache& cache = thread_caches_[slot];
+        size_t size = cache.size_.load(std::memory_order_relaxed);
+        for (size_t start = 0; start < size; start += CONCURRENT_POOL_ALLOCATOR_MAGAZINE_SIZE) {
+            PushMagazine(&cache.blocks_[start], std::min<size_t>(CONCURRENT_POOL_ALLOCATOR_MAGAZINE_SIZE, size - start));
+        }
+        cache.size_.store(0, std::memory_order_relaxed);
+    }
+
+    ConcurrentPoolAllocator::ConcurrentPoolAllocator() {
+        is_inited_ = false;
+    }
+
+    ConcurrentPoolAllocator::~ConcurrentPoolAllocator() {
+        Destroy();
+    }
+
+    bool ConcurrentPoolAllocator::Init(size_t block_size_bytes, size_t number_of_blocks) {
+        if (is_inited_) return false;
+
+        if (number_of_blocks == 0 || number_of_blocks >= BLOCK_NONE) {
+            dt::ConsoleInfoL(dt::CRITICAL, "ConcurrentPoolAllocator::Init() invalid number of blocks",
+                "number_of_blocks", number_of_blocks);
+            return false;
+        }
+
+        block_size_bytes_ = block_size_bytes;
+        number_of_blocks_ = number_of_blocks;
+
+        page_ = new MemoryPage(number_of_blocks * block_size_bytes);
+        next_block_ = std::unique_ptr<uint32_t[]>(new uint32_t[number_of_blocks]);
+        next_magazine_ = std::unique_ptr<std::atomic<uint32_t>[]>(new std::atomic<uint32_t>[number_of_blocks]);
+        thread_caches_page_ = new MemoryPage(CONCURRENT_POOL_ALLOCATOR_MAX_THREADS * sizeof(ThreadCache) + CONCURRENT_POOL_ALLOCATOR_CACHE_LINE);
+        uintptr_t address = reinterpret_cast<uintptr_t>(thread_caches_page_->Get(0));
+        size_t offset = (CONCURRENT_POOL_ALLOCATOR_CACHE_LINE - address % CONCURRENT_POOL_ALLOCATOR_CACHE_LINE) % CONCURRENT_POOL_ALLOCATOR_CACHE_LINE;
+        thread_caches_ = reinterpret_cast<ThreadCache *>(thread_caches_page_->Get(offset));
+        for (size_t i = 0; i < CONCURRENT_POOL_ALLOCATOR_MAX_THREADS; i++) {
+            new (&thread_caches_[i]) ThreadCache();
+            thread_caches_[i].size_.store(0, std::memory_order_relaxed);
+        }
+
+        /* Split the blocks to magazines, pushed in reverse so that the first blocks are allocated first */
+        freelist_.store(0);
+        free_blocks_.store(0);
+        uint32_t blocks[CONCURRENT_POOL_ALLOCATOR_MAGAZINE_SIZE];
+        size_t magazines = (number_of_blocks + CONCURRENT_POOL_ALLOCATOR_MAGAZINE_SIZE - 1) / CONCURRENT_POOL_ALLOCATOR_MAGAZINE_SIZE;
+        for (size_t m = magazines; m > 0; m--) {
+            size_t start = (m - 1) * CONCURRENT_POOL_ALLOCATOR_MAGAZINE_SIZE;
+            size_t size = std::min<size_t>(CONCURRENT_POOL_ALLOCATOR_MAGAZINE_SIZE, number_of_blocks - start);
+            for (size_t i = 0; i < size; i++) blocks[i] = static_cast<uint32_t>(start + size - 1 - i);
+            PushMagazine(blocks, size);
+        }
+
+        {
+            std::unique_lock<std::mutex> l(thread_slots_lock);
+            thread_slots_allocators.push_back(this);
+        }
+
+        is_inited_ = true;
+        return is_inited_;
+    }
+
+    bool ConcurrentPoolAllocator::Destroy() {
+        if (!is_inited_) return false;
+
+        {
+            std::unique_lock<std::mutex> l(thread_slots_lock);
+            thread_slots_allocators.erase(std::find(thread_slots_allocators.begin(), thread_slots_allocators.end(), this));
+        }
+
+        delete page_;
+        page_ = nullptr;
+        next_block_.reset();
+        next_magazine_.reset();
+        for (size_t i = 0; i < CONCURRENT_POOL_ALLOCATOR_MAX_THREADS; i++) thread_caches_[i].~ThreadCache();
+        delete thread_caches_page_;
+        thread_caches_page_ = nullptr;
+        thread_caches_ = nullptr;
+        freelist_.store(0);
+        free_blocks_.store(0);
+
+        is_inited_ = false;
+        return true;
+    }
+
+    BYTE * ConcurrentPoolAllocator::Allocate() {
+        if (!is_inited_) return nullptr;
+
+        int slot = GetThreadSlot();
+        if (slot < 0) {
+            /* No cache, take a magazine, keep one block and give back the rest */
+            uint32_t blocks[CONCURRENT_POOL_ALLOCATOR_MAGAZINE_SIZE];
+            size_t size = PopMagazine(blocks);
+            if (size == 0) {
+                dt::Console(dt::FATAL, "ConcurrentPoolAllocator::Allocate() Out of free nodes");
+                return nullptr;
+            }
+            if (size > 1) PushMagazine(blocks, size - 1);
+            return GetBlockAddress(blocks[size - 1]);
+        }
+
+        ThreadCache& cache = thread_caches_[slot];
+        size_t size = cache.size_.load(std::memory_order_relaxed);
+        if (size == 0) {
+            size = PopMagazine(cache.blocks_);
+            if (size == 0) {
+                dt::Console(dt::FATAL, "ConcurrentPoolAllocator::Allocate() Out of free nodes");
+                return nullptr;
+            }
+        }
+
+        size--;
+        cache.size_.store(size, std::memory_order_relaxed);
+        return GetBlockAddress(cache.blocks_[size]);
+    }
+
+    bool ConcurrentPoolAllocator::Deallocate(void * address) {
+        if (!is_inited_) return false;
+
+        if (address == nullptr) return false;
+
+        _assert(IsAddressInside(address));
+        uint32_t block = GetBlockIndex(address);
+
+        int slot = GetThreadSlot();
+        if (slot < 0) {
+            PushMagazine(&block, 1);
+            return true;
+        }
+
+        /* Give back the upper magazine of the cache when full, keep the lower one for the next allocations */
+        ThreadCache& cache = thread_caches_[slot];
+        size_t size = cache.size_.load(std::memory_order_relaxed);
+        if (size == 2 * CONCURRENT_POOL_ALLOCATOR_MAGAZINE_SIZE) {
+            PushMagazine(&cache.blocks_[CONCURRENT_POOL_ALLOCATOR_MAGAZINE_SIZE], CONCURRENT_POOL_ALLOCATOR_MAGAZINE_SIZE);
+            size = CONCURRENT_POOL_ALLOCATOR_MAGAZINE_SIZE;
+        }
+
+        cache.blocks_[size] = block;
+        cache.size_.store(size + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool ConcurrentPoolAllocator::IsInited() {
+        return is_inited_;
+    }
+
+    size_t ConcurrentPoolAllocator::GetBlockSize() {
+        return block_size_bytes_;
+    }
+
+    size_t ConcurrentPoolAllocator::GetBytesAllocated() {
+        return block_size_bytes_ * number_of_blocks_;
+    }
+
+    size_t ConcurrentPoolAllocator::GetBytesUsed() {
+        if (!is_inited_) return 0;
+
+        size_t free_blocks = free_blocks_.load();
+        for (size_t i = 0; i < CONCURRENT_POOL_ALLOCATOR_MAX_THREADS; i++) free_blocks += thread_caches_[i].size_.load(std::memory_order_relaxed);
+
+        return (number_of_blocks_ - std::min(free_blocks, number_of_blocks_)) * block_size_bytes_;
+    }
+
+    bool ConcurrentPoolAllocator::IsAddressInside(void * address) {
+        if (address >= page_->Get(0) && address <= page_->Get((number_of_blocks_)*block_size_bytes_ - 1))
+            return true;
+
+        return false;
+    }
+
+    size_t ConcurrentPoolAllocator::PopMagazine(uint32_t * blocks) {
+        uint64_t head = freelist_.load(std::memory_order_acquire);
+        uint32_t first;
+        for (;;) {
+            uint32_t first_plus_one = static_cast<uint32_t>(head);
+            if (first_plus_one == 0) return 0;
+            first = first_plus_one - 1;
+
+            /* If another thread pops this magazine first, the counter changes, and the exchange fails */
+            uint64_t counter = (head >> 32) + 1;
+            uint64_t new_head = (counter << 32) | next_magazine_[first].load(std::memory_order_relaxed);
+            if (freelist_.compare_exchange_weak(head, new_head, std::memory_order_acquire, std::memory_order_acquire)) break;
+        }
+
+        size_t size = 0;
+        for (uint32_t block = first; block != BLOCK_NONE; block = next_block_[block]) blocks[size++] = block;
+        free_blocks_.fetch_sub(size, std::memory_order_relaxed);
+
+        return size;
+    }
+
+    void ConcurrentPoolAllocator::PushMagazine(uint32_t * blocks, size_t size) {
+        _assert(size > 0 && size <= CONCURRENT_POOL_ALLOCATOR_MAGAZINE_SIZE);
+
+        for (size_t i = 0; i + 1 < size; i++) next_block_[blocks[i]] = blocks[i + 1];
+        next_block_[blocks[size - 1]] = BLOCK_NONE;
+        free_blocks_.fetch_add(size, std::memory_order_relaxed);
+
+        uint32_t first = blocks[0];
+        uint64_t head = freelist_.load(std::memory_order_relaxed);
+        for (;;) {
+            next_magazine_[first].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+
+            uint64_t counter = (head >> 32) + 1;
+            uint64_t new_head = (counter << 32) | (static_cast<uint64_t>(first) + 1);
+            if (freelist_.compare_exchange_weak(head, new_head, std::memory_order_release, std::memory_order_relaxed)) break;
+        }
+    }
+
+    uint32_t ConcurrentPoolAllocator::GetBlockIndex(void * address) {
+        return static_cast<uint32_t>((reinterpret_cast<BYTE *>(address) - page_->Get(0)) / block_size_bytes_);
+    }
+
+    BYTE * ConcurrentPoolAllocator::GetBlockAddress(uint32_t block) {
+        BYTE * address = page_->Get(block * block_size_bytes_);
+        memset(address, 0, block_size_bytes_);
+        return address;
+    }
+
+}
+}
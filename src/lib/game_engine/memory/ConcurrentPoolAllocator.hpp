@@ -0,0 +1,204 @@
+#ifndef __ConcurrentPoolAllocator_hpp__
+#define __ConcurrentPoolAllocator_hpp__
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "MemoryPage.hpp"
+
+/* Number of blocks moved between a thread cache and the shared freelist at once */
+#define CONCURRENT_POOL_ALLOCATOR_MAGAZINE_SIZE 16
+/* Number of threads that get their own cache, threads after that use the shared freelist directly */
+#define CONCURRENT_POOL_ALLOCATOR_MAX_THREADS 64
+/* Size of a cache line, every thread cache starts on its own */
+#define CONCURRENT_POOL_ALLOCATOR_CACHE_LINE 64
+
+namespace game_engine {
+namespace memory {
+
+    /**
+        Allocate memory in blocks stored sequentially on the heap, from many threads
+        IS thread safe
+
+        Every thread keeps a cache of up to two magazines of free blocks, and allocates and frees from it without
+        synchronisation. When the cache is empty a full magazine is taken from the shared freelist, and when it's full
+        a magazine is given back. The shared freelist is a lock free stack of magazines, with a tagged head to avoid
+        the ABA problem. Blocks cached by other running threads are not available to the calling thread, Allocate() can
+        fail while up to (2 * MAGAZINE_SIZE) blocks per thread are free in other caches. The cache of a thread is given
+        back to the freelist when the thread exits
+    */
+    class ConcurrentPoolAllocator {
+    public:
+        /**
+            Does nothing in particular
+        */
+        ConcurrentPoolAllocator();
+
+        /**
+            Calls Destory()
+        */
+        ~ConcurrentPoolAllocator();
+
+        /* Delete all other constuctors available */
+        ConcurrentPoolAllocator(const ConcurrentPoolAllocator& other) = delete;
+        ConcurrentPoolAllocator(const ConcurrentPoolAllocator&& other) = delete;
+        ConcurrentPoolAllocator& operator=(const ConcurrentPoolAllocator& other) = delete;
+        ConcurrentPoolAllocator& operator=(ConcurrentPoolAllocator&& other) = delete;
+
+        /**
+            Initializes a single MemoryPage with size so as to fit number_of_blocks * blocks_size_bytes. Not thread safe
+            @param blocks_size_bytes The size of a single block of memory in bytes
+            @param number_of_blocks The total number of blocks
+            @return true = OK, false = not OK
+        */
+        bool Init(size_t block_size_bytes, size_t number_of_blocks);
+
+        /**
+            Destroys the memory page, needs to call Init() afterwards. Not thread safe
+            @return true = OK, false = NOT OK
+        */
+        bool Destroy();
+
+        /**
+            Get an available block of memory, cleared to zero
+            @return The address of the first byte of the block, null if not initialised or out of memory
+        */
+        BYTE * Allocate();
+
+        /**
+            Get an available block of memory, casted to the specified type
+            @return The address of the first byte of the block, null if not initialised or out of memory
+                or the type does not fit inside the block
+        */
+        template<typename T> T * Allocate() {
+            if (!is_inited_) return nullptr;
+
+            if (sizeof(T) > block_size_bytes_) return nullptr;
+
+            BYTE * address = Allocate();
+
+            return reinterpret_cast<T *>(address);
+        }
+
+        /**
+            Frees the block of memory that starts from the address. Same as PoolAllocator::Deallocate(), the address
+            must be returned from Allocate(), and not already free. Can be called from a different thread than the
+            one that allocated the block
+            @param address The first byte of the block, as returned from Allocate()
+            @return true = OK, false = NOT OK
+        */
+        bool Deallocate(void * address);
+
+        /**
+            Check if the object is initialised
+            @return true = initialised, false = not initialised
+        */
+        bool IsInited();
+
+        /**
+            Get the size of the block
+            @return The block size
+        */
+        size_t GetBlockSize();
+
+        /**
+            Get the number of bytes allocated, not the ones used, but the whole memory allocated
+            @return Memory allocated
+        */
+        size_t GetBytesAllocated();
+
+        /**
+            Get the number of bytes used. Exact only when no other thread allocates or deallocates at the same time
+            @return Memory used
+        */
+        size_t GetBytesUsed();
+
+        /**
+            Check if an address is inside the memory of the allocator
+            @param address The address
+            @return true = Inside, false = Not inside
+        */
+        bool IsAddressInside(void * address);
+
+    private:
+        /* Releases the cache slot of a thread when it exits, see the source file */
+        struct ThreadSlot;
+        static thread_local ThreadSlot thread_slot_;
+
+        /* Value of a block index that points nowhere */
+        static const uint32_t BLOCK_NONE = 0xFFFFFFFF;
+
+        /* The free blocks cached by a thread, on its own cache line */
+        struct alignas(CONCURRENT_POOL_ALLOCATOR_CACHE_LINE) ThreadCache {
+            uint32_t blocks_[2 * CONCURRENT_POOL_ALLOCATOR_MAGAZINE_SIZE];
+            /* Written only by the owning thread, read by GetBytesUsed() */
+            std::atomic<size_t> size_;
+        };
+
+        bool is_inited_;
+        size_t block_size_bytes_;
+        size_t number_of_blocks_;
+
+        MemoryPage * page_;
+
+        /* Index of the next block, inside a magazine */
+        std::unique_ptr<uint32_t[]> next_block_;
+        /* The low 32 bits of the freelist head to restore when the magazine that starts from a block is popped */
+        std::unique_ptr<std::atomic<uint32_t>[]> next_magazine_;
+        /* First block of the first magazine in the freelist plus one in the low 32 bits, zero if empty. A counter of
+        changes in the high 32 bits */
+        std::atomic<uint64_t> freelist_;
+        /* Number of blocks in the freelist */
+        std::atomic<size_t> free_blocks_;
+
+        /* The thread caches, constructed in a page at the first cache line boundary. Plain new doesn't respect the
+        alignment of ThreadCache before C++17 */
+        MemoryPage * thread_caches_page_;
+        ThreadCache * thread_caches_;
+
+        /**
+            Get the cache slot of the calling thread, assign one if it doesn't have one yet
+            @return The index of the slot, -1 if all the slots are taken
+        */
+        static int GetThreadSlot();
+
+        /**
+            Give back all the blocks in the cache of a slot to the freelist
+            @param slot The index of the slot
+        */
+        void FlushThreadCache(int slot);
+
+        /**
+            Pop a magazine from the freelist
+            @param blocks Array of at least MAGAZINE_SIZE elements, to store the blocks of the magazine
+            @return The number of blocks, 0 if the freelist is empty
+        */
+        size_t PopMagazine(uint32_t * blocks);
+
+        /**
+            Link a number of blocks to a magazine, and push it to the freelist
+            @param blocks The blocks
+            @param size The number of blocks, at most MAGAZINE_SIZE
+        */
+        void PushMagazine(uint32_t * blocks, size_t size);
+
+        /**
+            Get the index of a block
+            @param address The first byte of the block
+            @return The index
+        */
+        uint32_t GetBlockIndex(void * address);
+
+        /**
+            Get the address of a block, cleared to zero
+            @param block The index
+            @return The address
+        */
+        BYTE * GetBlockAddress(uint32_t block);
+    };
+
+}
+}
+
+#endif
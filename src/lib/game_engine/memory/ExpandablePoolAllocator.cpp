@@ -1,5 +1,12 @@
 #include "ExpandablePoolAllocator.hpp"
 
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
 #include "debug_tools/Console.hpp"
 #include "debug_tools/Assert.hpp"
 namespace dt = debug_tools;
@@ -8,13 +15,38 @@ namespace dt = debug_tools;
 namespace game_engine {
 namespace memory {
 
+    /* Offset of the first block after the pool header, keeps the blocks aligned */
+    static const size_t POOL_HEADER_ALIGNMENT = 64;
+
+    /**
+        Allocate memory aligned to its size
+        @param size The size, a power of two
+        @return The memory, nullptr if out of memory
+    */
+    static BYTE * AllocateSlab(size_t size) {
+#ifdef _WIN32
+        return reinterpret_cast<BYTE *>(_aligned_malloc(size, size));
+#else
+        void * address = nullptr;
+        if (posix_memalign(&address, size, size) != 0) return nullptr;
+        return reinterpret_cast<BYTE *>(address);
+#endif
+    }
+
+    /**
+        Free memory allocated with AllocateSlab()
+        @param address The memory
+    */
+    static void FreeSlab(BYTE * address) {
+#ifdef _WIN32
+        _aligned_free(address);
+#else
+        free(address);
+#endif
+    }
+
     ExpandablePoolAllocator::ExpandablePoolAllocator() {
         is_inited_ = false;
-        memory_blocks_ = std::vector<PoolAllocator *>(1, nullptr);
-
-        for (size_t i = 0; i < memory_blocks_.size(); i++) {
-            memory_blocks_[i] = new PoolAllocator();
-        }
     }
 
     ExpandablePoolAllocator::~ExpandablePoolAllocator() {
@@ -22,22 +54,39 @@ namespace memory {
     }
 
     bool ExpandablePoolAllocator::Init(size_t block_size_bytes) {
-        
+
         if (is_inited_) return false;
 
-        for (size_t i = 0; i < memory_blocks_.size(); i++) {
-            bool ret = memory_blocks_[i]->Init(block_size_bytes, BLOCKS_PER_POOL);
-            if (!ret) return false;
+        if (block_size_bytes < sizeof(void*)) {
+            dt::ConsoleInfoL(dt::CRITICAL, "ExpandablePoolAllocator::Init() block size is smaller than a pointer",
+                "block_size", block_size_bytes,
+                "pointer size", sizeof(void*));
+            return false;
         }
 
         block_size_bytes_ = block_size_bytes;
+
+        /* Smallest power of two that fits the header and the blocks, and then fit as many blocks as possible */
+        blocks_offset_ = ((sizeof(Pool) + POOL_HEADER_ALIGNMENT - 1) / POOL_HEADER_ALIGNMENT) * POOL_HEADER_ALIGNMENT;
+        slab_size_bytes_ = 4096;
+        while (slab_size_bytes_ < blocks_offset_ + BLOCKS_PER_POOL * block_size_bytes) slab_size_bytes_ *= 2;
+        blocks_per_slab_ = (slab_size_bytes_ - blocks_offset_) / block_size_bytes;
+
+        free_pools_ = nullptr;
+        free_pools_back_ = nullptr;
+        all_pools_ = nullptr;
+        number_of_pools_ = 0;
+        empty_pools_ = 0;
+        used_blocks_ = 0;
+
         is_inited_ = true;
         return true;
     }
 
-    bool ExpandablePoolAllocator::Init(size_t block_size_bytes, size_t blocks_per_pool) {
-        
+    bool ExpandablePoolAllocator::Init(size_t block_size_bytes, size_t blocks_per_pool, size_t max_empty_pools) {
+
         BLOCKS_PER_POOL = blocks_per_pool;
+        MAX_EMPTY_POOLS = max_empty_pools;
 
         return ExpandablePoolAllocator::Init(block_size_bytes);
     }
@@ -45,33 +94,53 @@ namespace memory {
     bool ExpandablePoolAllocator::Destroy() {
 
         if (!is_inited_) return false;
-        
-        for (size_t i = 0; i < memory_blocks_.size(); i++) {
-            memory_blocks_[i]->Destroy();
-            delete memory_blocks_[i];
+
+        if (used_blocks_ != 0) dt::ConsoleInfoL(dt::WARNING, "ExpandablePoolAllocator::Destroy() blocks still in use", "blocks", used_blocks_);
+
+        while (all_pools_ != nullptr) {
+            Pool * pool = all_pools_;
+            if (pool->in_list_) UnlinkPool(pool);
+            DestroyPool(pool);
         }
+        free_pools_ = nullptr;
+        free_pools_back_ = nullptr;
+        empty_pools_ = 0;
+        used_blocks_ = 0;
 
         is_inited_ = false;
         return true;
     }
 
     BYTE * ExpandablePoolAllocator::Allocate() {
-        
+
         if (!is_inited_) return nullptr;
 
-        BYTE * address = nullptr;
-        for (size_t i = 0; i < memory_blocks_.size(); i++) {
-            address = memory_blocks_[i]->Allocate();
-            if (address != nullptr) {
-                return address;
+        Pool * pool = free_pools_;
+        if (pool == nullptr) {
+            pool = CreatePool();
+            if (pool == nullptr) {
+                dt::Console(dt::FATAL, "ExpandablePoolAllocator::Allocate() Out of memory");
+                return nullptr;
             }
         }
 
-        PoolAllocator * pool_allocator = new PoolAllocator();
-        memory_blocks_.push_back(pool_allocator);
-        
-        pool_allocator->Init(block_size_bytes_, BLOCKS_PER_POOL);
-        address = pool_allocator->Allocate();
+        if (pool->free_blocks_ == blocks_per_slab_) empty_pools_--;
+
+        /* Reuse a freed block, or take the next one that was never used */
+        BYTE * address;
+        if (pool->freelist_ != nullptr) {
+            address = pool->freelist_;
+            pool->freelist_ = *reinterpret_cast<BYTE **>(address);
+        } else {
+            address = reinterpret_cast<BYTE *>(pool) + blocks_offset_ + pool->next_unused_ * block_size_bytes_;
+            pool->next_unused_++;
+        }
+
+        pool->free_blocks_--;
+        used_blocks_++;
+        if (pool->free_blocks_ == 0) UnlinkPool(pool);
+
+        memset(address, 0, block_size_bytes_);
         return address;
     }
 
@@ -81,16 +150,31 @@ namespace memory {
 
         _assert(address != nullptr);
 
-        for (size_t i = 0; i < memory_blocks_.size(); i++) {
-            PoolAllocator * pool_allocator = memory_blocks_[i];
-            if (pool_allocator->IsAddressInside(address)) {
-                pool_allocator->Deallocate(address);
-                return true;
-            }
+        Pool * pool = GetPool(address);
+        if (pool == nullptr) {
+            dt::Console(dt::CRITICAL, "ExpandablePoolAllocator::Deallocate(): Adress not in range");
+            return false;
+        }
+
+        BYTE * block = reinterpret_cast<BYTE *>(address);
+        *reinterpret_cast<BYTE **>(block) = pool->freelist_;
+        pool->freelist_ = block;
+        pool->free_blocks_++;
+        used_blocks_--;
+
+        /* A full pool has a free block again, use it first, to keep the emptier pools at the back */
+        if (!pool->in_list_) LinkPool(pool, true);
+
+        if (pool->free_blocks_ == blocks_per_slab_) {
+            empty_pools_++;
+            UnlinkPool(pool);
+            if (empty_pools_ > MAX_EMPTY_POOLS) {
+                empty_pools_--;
+                DestroyPool(pool);
+            } else LinkPool(pool, false);
         }
 
-        dt::Console(dt::CRITICAL, "PoolAllocator::Deallocate(): Adress not in range");
-        return false;
+        return true;
     }
 
     bool ExpandablePoolAllocator::IsInited() {
@@ -102,22 +186,95 @@ namespace memory {
     }
 
     size_t ExpandablePoolAllocator::GetBytesAllocated() {
-        size_t total_bytes_allocated_ = 0;
-        
-        for (size_t i = 0; i < memory_blocks_.size() - 1; i++)
-            total_bytes_allocated_ += memory_blocks_[i]->GetBytesAllocated();
-
-        return total_bytes_allocated_;
+        return number_of_pools_ * blocks_per_slab_ * block_size_bytes_;
     }
 
     size_t ExpandablePoolAllocator::GetBytesUsed() {
-        size_t total_bytes_used = 0;
+        return used_blocks_ * block_size_bytes_;
+    }
+
+    size_t ExpandablePoolAllocator::GetNumberOfPools() {
+        return number_of_pools_;
+    }
+
+    ExpandablePoolAllocator::Pool * ExpandablePoolAllocator::CreatePool() {
+        BYTE * slab = AllocateSlab(slab_size_bytes_);
+        if (slab == nullptr) return nullptr;
+
+        slabs_.insert(std::lower_bound(slabs_.begin(), slabs_.end(), slab), slab);
 
-        for (size_t i = 0; i < memory_blocks_.size() - 1; i++)
-            total_bytes_used += memory_blocks_[i]->GetBytesUsed();
+        Pool * pool = reinterpret_cast<Pool *>(slab);
+        pool->freelist_ = nullptr;
+        pool->next_unused_ = 0;
+        pool->free_blocks_ = blocks_per_slab_;
+        pool->in_list_ = false;
+        LinkPool(pool, true);
 
-        return total_bytes_used;
+        pool->all_prev_ = nullptr;
+        pool->all_next_ = all_pools_;
+        if (all_pools_ != nullptr) all_pools_->all_prev_ = pool;
+        all_pools_ = pool;
+
+        number_of_pools_++;
+        empty_pools_++;
+        return pool;
+    }
+
+    void ExpandablePoolAllocator::DestroyPool(Pool * pool) {
+        _assert(!pool->in_list_);
+
+        if (pool->all_prev_ != nullptr) pool->all_prev_->all_next_ = pool->all_next_;
+        else all_pools_ = pool->all_next_;
+        if (pool->all_next_ != nullptr) pool->all_next_->all_prev_ = pool->all_prev_;
+
+        BYTE * slab = reinterpret_cast<BYTE *>(pool);
+        slabs_.erase(std::lower_bound(slabs_.begin(), slabs_.end(), slab));
+        FreeSlab(slab);
+        number_of_pools_--;
     }
 
+    void ExpandablePoolAllocator::LinkPool(Pool * pool, bool front) {
+        _assert(!pool->in_list_);
+
+        if (front) {
+            pool->prev_ = nullptr;
+            pool->next_ = free_pools_;
+            if (free_pools_ != nullptr) free_pools_->prev_ = pool;
+            else free_pools_back_ = pool;
+            free_pools_ = pool;
+        } else {
+            pool->next_ = nullptr;
+            pool->prev_ = free_pools_back_;
+            if (free_pools_back_ != nullptr) free_pools_back_->next_ = pool;
+            else free_pools_ = pool;
+            free_pools_back_ = pool;
+        }
+        pool->in_list_ = true;
+    }
+
+    void ExpandablePoolAllocator::UnlinkPool(Pool * pool) {
+        _assert(pool->in_list_);
+
+        if (pool->prev_ != nullptr) pool->prev_->next_ = pool->next_;
+        else free_pools_ = pool->next_;
+        if (pool->next_ != nullptr) pool->next_->prev_ = pool->prev_;
+        else free_pools_back_ = pool->prev_;
+
+        pool->next_ = nullptr;
+        pool->prev_ = nullptr;
+        pool->in_list_ = false;
+    }
+
+    ExpandablePoolAllocator::Pool * ExpandablePoolAllocator::GetPool(void * address) {
+        uintptr_t offset = reinterpret_cast<uintptr_t>(address) & (static_cast<uintptr_t>(slab_size_bytes_) - 1);
+        BYTE * slab = reinterpret_cast<BYTE *>(address) - offset;
+
+        /* Check the slab is one of ours before reading its header */
+        if (!std::binary_search(slabs_.begin(), slabs_.end(), slab)) return nullptr;
+        if (offset < blocks_offset_ || offset >= blocks_offset_ + blocks_per_slab_ * block_size_bytes_) return nullptr;
+
+        return reinterpret_cast<Pool *>(slab);
+    }
+
+}
 }
-}
\ No newline at end of file
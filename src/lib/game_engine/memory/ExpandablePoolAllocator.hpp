@@ -1,20 +1,27 @@
 #ifndef __ExpandablePoolAllocator_hpp__
 #define __ExpandablePoolAllocator_hpp__
 
+#include <vector>
+
 #include "MemoryPage.hpp"
-#include "PoolAllocator.hpp"
 
 namespace game_engine {
 namespace memory {
 
     /**
-        Allocate memory in blocks stored sequentially on the heap
+        Allocate memory in blocks stored sequentially on the heap, in pools that are added when all the others are full
         IS NOT thread safe
+
+        Every pool lives in a slab aligned to its power of two size, with a header at the start, so the pool of a block
+        is found by masking its address. The slab is looked up in the sorted addresses of the live slabs before its
+        header is read, so that addresses from elsewhere are rejected. The pools that have free blocks are kept in a list, and allocation takes from
+        the first one. Pools that become empty are kept for reuse, up to a maximum number, and then freed
     */
     class ExpandablePoolAllocator {
     private:
 
         size_t BLOCKS_PER_POOL = 2048;
+        size_t MAX_EMPTY_POOLS = 1;
 
     public:
         ExpandablePoolAllocator();
@@ -31,15 +38,16 @@ namespace memory {
         /**
             Initialize the pool allocator for a certain block size, and a certain number of blocks per pool
             @param block_size_bytes The size of a block
-            @param blocks_per_pool The number of blocks per pool
+            @param blocks_per_pool The minimum number of blocks per pool, more blocks are used if they fit in the slab
+            @param max_empty_pools The number of empty pools to keep, instead of freeing them
             @return true = OK, false = NOT OK
         */
-        bool Init(size_t block_size_bytes, size_t blocks_per_pool);
+        bool Init(size_t block_size_bytes, size_t blocks_per_pool, size_t max_empty_pools = 1);
 
         /**
-               Destroys the pool allocator, needs to call Init() afterwards
-               @return true = OK, false = NOT OK
-           */
+            Destroys the pool allocator, needs to call Init() afterwards
+            @return true = OK, false = NOT OK
+        */
         bool Destroy();
 
         /**
@@ -99,10 +107,78 @@ namespace memory {
         */
         size_t GetBytesUsed();
 
+        /**
+            Get the number of pools currently allocated
+            @return The number of pools
+        */
+        size_t GetNumberOfPools();
+
     private:
-        std::vector<PoolAllocator *> memory_blocks_;
+        /* The header of a pool, stored at the start of its slab */
+        struct Pool {
+            /* The freed blocks, linked through their first bytes */
+            BYTE * freelist_;
+            /* Blocks after this one have never been allocated */
+            size_t next_unused_;
+            size_t free_blocks_;
+            /* The list of pools with free blocks */
+            Pool * next_;
+            Pool * prev_;
+            bool in_list_;
+            /* The list of all pools */
+            Pool * all_next_;
+            Pool * all_prev_;
+        };
+
         bool is_inited_;
         size_t block_size_bytes_;
+        /* Size and alignment of a slab, a power of two */
+        size_t slab_size_bytes_;
+        /* Offset of the first block from the start of the slab */
+        size_t blocks_offset_;
+        size_t blocks_per_slab_;
+
+        /* Pools with at least one free block, the ones that become empty are appended at the back */
+        Pool * free_pools_;
+        Pool * free_pools_back_;
+        Pool * all_pools_;
+        /* The start addresses of the live slabs, sorted */
+        std::vector<BYTE *> slabs_;
+        size_t number_of_pools_;
+        size_t empty_pools_;
+        size_t used_blocks_;
+
+        /**
+            Allocate a new slab and initialise its pool
+            @return The pool, nullptr if out of memory
+        */
+        Pool * CreatePool();
+
+        /**
+            Free the slab of a pool
+            @param pool The pool
+        */
+        void DestroyPool(Pool * pool);
+
+        /**
+            Add a pool in the list of pools with free blocks
+            @param pool The pool
+            @param front Add at the front, or at the back
+        */
+        void LinkPool(Pool * pool, bool front);
+
+        /**
+            Remove a pool from the list of pools with free blocks
+            @param pool The pool
+        */
+        void UnlinkPool(Pool * pool);
+
+        /**
+            Get the pool that holds an address
+            @param address The address
+            @return The pool, nullptr if the address is not in the blocks of a live slab
+        */
+        Pool * GetPool(void * address);
     };
 
 }
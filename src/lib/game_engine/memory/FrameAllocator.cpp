@@ -0,0 +1,105 @@
+#include "FrameAllocator.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+#include <new>
+
+#include "debug_tools/Console.hpp"
+#include "debug_tools/Assert.hpp"
+namespace dt = debug_tools;
+
+
+#ifdef GAME_ENGINE_MEMORY_HEAP_COUNTER
+
+/* Defined in the same file as the frame allocator, so that the linker always picks it up from the library */
+static std::atomic<size_t> heap_allocations(0);
+
+void * operator new(size_t size) {
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    void * address = malloc(size == 0 ? 1 : size);
+    if (address == nullptr) throw std::bad_alloc();
+    return address;
+}
+
+void operator delete(void * address) noexcept {
+    free(address);
+}
+
+#endif
+
+namespace game_engine {
+namespace memory {
+
+    /* All the frame allocators, one for every thread that used frame memory */
+    static std::mutex frame_allocators_lock;
+    static std::vector<FrameAllocator *> frame_allocators;
+
+    FrameAllocator & FrameAllocator::GetThreadInstance() {
+        static thread_local FrameAllocator instance;
+        return instance;
+    }
+
+    void FrameAllocator::ResetAll() {
+        std::unique_lock<std::mutex> l(frame_allocators_lock);
+        for (size_t i = 0; i < frame_allocators.size(); i++) frame_allocators[i]->Reset();
+    }
+
+    size_t FrameAllocator::GetHeapAllocations() {
+#ifdef GAME_ENGINE_MEMORY_HEAP_COUNTER
+        return heap_allocations.load(std::memory_order_relaxed);
+#else
+        return 0;
+#endif
+    }
+
+    FrameAllocator::FrameAllocator() {
+        pages_.Init(FRAME_ALLOCATOR_PAGE_SIZE, FRAME_ALLOCATOR_PAGE_SIZE);
+
+        std::unique_lock<std::mutex> l(frame_allocators_lock);
+        frame_allocators.push_back(this);
+    }
+
+    FrameAllocator::~FrameAllocator() {
+        {
+            std::unique_lock<std::mutex> l(frame_allocators_lock);
+            frame_allocators.erase(std::find(frame_allocators.begin(), frame_allocators.end(), this));
+        }
+
+        Reset();
+        pages_.Destroy();
+    }
+
+    BYTE * FrameAllocator::Allocate(size_t bytes, size_t alignment) {
+        _assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+        if (bytes + alignment > pages_.GetPageSize()) {
+            /* Operator new doesn't align beyond the standard types, allocate more and align inside */
+            BYTE * unaligned_address = new BYTE[bytes + alignment];
+            large_allocations_.push_back(unaligned_address);
+
+            size_t mask = (alignment - 1);
+            size_t misalignment = reinterpret_cast<uintptr_t>(unaligned_address) & mask;
+            size_t adjustment = (alignment - misalignment) & mask;
+            return unaligned_address + adjustment;
+        }
+
+        return pages_.AllocateAligned(bytes, alignment);
+    }
+
+    void FrameAllocator::Reset() {
+        for (size_t i = 0; i < large_allocations_.size(); i++) delete[] large_allocations_[i];
+        large_allocations_.clear();
+
+        pages_.Reset();
+    }
+
+    size_t FrameAllocator::GetBytesUsed() {
+        return pages_.GetBytesUsed();
+    }
+
+}
+}
@@ -0,0 +1,124 @@
+#ifndef __FrameAllocator_hpp__
+#define __FrameAllocator_hpp__
+
+#include <vector>
+#include <cstddef>
+
+#include "ArrayAllocator.hpp"
+
+/* Size of the pages of a frame allocator */
+#define FRAME_ALLOCATOR_PAGE_SIZE 65536
+
+/*
+    Define GAME_ENGINE_MEMORY_HEAP_COUNTER, the CMake option of the same name, to count the heap allocations by
+    replacing the global operator new. Off by default
+*/
+
+namespace game_engine {
+namespace memory {
+
+    /**
+        A linear allocator for temporary memory that lives until the end of the frame. Every thread has its own,
+        allocations bump an offset in the pages of an ArrayAllocator, and nothing is freed until ResetAll() is called.
+        The pages are kept, so after the first frames no heap allocations are made
+        IS NOT thread safe, use the instance of the calling thread
+    */
+    class FrameAllocator {
+    public:
+        /**
+            Get the frame allocator of the calling thread, created the first time it's called
+            @return The allocator
+        */
+        static FrameAllocator & GetThreadInstance();
+
+        /**
+            Reset the frame allocators of all the threads. No thread should be using frame memory at the time,
+            call it at the end of the frame
+        */
+        static void ResetAll();
+
+        /**
+            Get the number of heap allocations made since the start of the program, by any thread
+            @return The number of allocations, 0 if GAME_ENGINE_MEMORY_HEAP_COUNTER is not defined
+        */
+        static size_t GetHeapAllocations();
+
+        /**
+            Initializes the first page
+        */
+        FrameAllocator();
+
+        /**
+            Deallocates all pages
+        */
+        ~FrameAllocator();
+
+        FrameAllocator(const FrameAllocator& other) = delete;
+        FrameAllocator(const FrameAllocator&& other) = delete;
+        FrameAllocator& operator=(const FrameAllocator& other) = delete;
+        FrameAllocator& operator=(FrameAllocator&& other) = delete;
+
+        /**
+            Get memory until the next reset. Requests larger than a page are served from the heap, and freed on reset
+            @param bytes The size to allocate
+            @param alignment The alignment, a power of two
+            @return The memory address
+        */
+        BYTE * Allocate(size_t bytes, size_t alignment);
+
+        /**
+            Free all the memory allocated since the last reset, keep the pages
+        */
+        void Reset();
+
+        /**
+            Get the number of bytes used since the last reset, without the ones larger than a page
+            @return Memory used
+        */
+        size_t GetBytesUsed();
+
+    private:
+        ArrayAllocator pages_;
+        std::vector<BYTE *> large_allocations_;
+    };
+
+    /**
+        An STL allocator that takes memory from the frame allocator of the calling thread. Deallocation does nothing,
+        the memory is freed at the end of the frame. Containers that use it must not be kept across frames
+    */
+    template<typename T> class FrameStlAllocator {
+    public:
+        typedef T value_type;
+
+        template<typename U> struct rebind {
+            typedef FrameStlAllocator<U> other;
+        };
+
+        FrameStlAllocator() {};
+
+        template<typename U> FrameStlAllocator(const FrameStlAllocator<U>&) {};
+
+        T * allocate(size_t n) {
+            return reinterpret_cast<T *>(FrameAllocator::GetThreadInstance().Allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T *, size_t) {
+
+        }
+    };
+
+    template<typename T, typename U> bool operator==(const FrameStlAllocator<T>&, const FrameStlAllocator<U>&) {
+        return true;
+    }
+
+    template<typename T, typename U> bool operator!=(const FrameStlAllocator<T>&, const FrameStlAllocator<U>&) {
+        return false;
+    }
+
+    /* A vector in frame memory */
+    template<typename T> using FrameVector = std::vector<T, FrameStlAllocator<T>>;
+
+}
+}
+
+#endif
@@ -33,13 +33,13 @@ namespace memory {
         static_objects_memory_allocator_ = new ArrayAllocator();
         static_objects_memory_allocator_->Init(STATIC_OBJETCS_MEMORY_SIZE);
         
-        removable_objecs_memory_allocator_ = new PoolAllocator();
+        removable_objecs_memory_allocator_ = new ConcurrentPoolAllocator();
         removable_objecs_memory_allocator_->Init(REMOVABLE_OBJECTS_MEMORY_BLOCK_SIZE, REMOVABLE_OBJECTS_MEMORY_BLOCKS_NUMBER);
         
-        physics_objects_memory_allocator_ = new PoolAllocator();
+        physics_objects_memory_allocator_ = new ConcurrentPoolAllocator();
         physics_objects_memory_allocator_->Init(PHYSICS_OBJECTS_MEMORY_BLOCK_SIZE, PHYSICS_OBJECTS_MEMORY_BLOCKS_NUMBER);
 
-        world_lights_memory_allocator_ = new PoolAllocator();
+        world_lights_memory_allocator_ = new ConcurrentPoolAllocator();
         world_lights_memory_allocator_->Init(LIGHT_OBJECTS_MEMORY_BLOCKS_SIZE, LIGHT_OBJECTS_MEMORY_BLOCKS_NUMBER);
     }
 
@@ -54,15 +54,15 @@ namespace memory {
         return static_objects_memory_allocator_;
     }
 
-    PoolAllocator * MemoryManager::GetRemovableObjectsAllocator() {
+    ConcurrentPoolAllocator * MemoryManager::GetRemovableObjectsAllocator() {
         return removable_objecs_memory_allocator_;
     }
 
-    PoolAllocator * MemoryManager::GetPhysicsObjectsAllocator() {
+    ConcurrentPoolAllocator * MemoryManager::GetPhysicsObjectsAllocator() {
         return physics_objects_memory_allocator_;
     }
 
-    PoolAllocator * MemoryManager::GetWorldLightsAllocator() {
+    ConcurrentPoolAllocator * MemoryManager::GetWorldLightsAllocator() {
         return world_lights_memory_allocator_;
     }
 
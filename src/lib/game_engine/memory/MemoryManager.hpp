@@ -2,6 +2,7 @@
 #define __MemoryManager_hpp__
 
 #include "PoolAllocator.hpp"
+#include "ConcurrentPoolAllocator.hpp"
 #include "ArrayAllocator.hpp"
 
 
@@ -36,17 +37,17 @@ namespace memory {
         /**
             
         */
-        PoolAllocator * GetRemovableObjectsAllocator();
+        ConcurrentPoolAllocator * GetRemovableObjectsAllocator();
 
         /**
             
         */
-        PoolAllocator * GetPhysicsObjectsAllocator();
+        ConcurrentPoolAllocator * GetPhysicsObjectsAllocator();
 
         /**
         
         */
-        PoolAllocator * GetWorldLightsAllocator();
+        ConcurrentPoolAllocator * GetWorldLightsAllocator();
 
         /**
         
@@ -56,11 +57,12 @@ namespace memory {
 
     private:
         ArrayAllocator * static_objects_memory_allocator_;
-        PoolAllocator * removable_objecs_memory_allocator_;
+        /* The pools are shared by all threads */
+        ConcurrentPoolAllocator * removable_objecs_memory_allocator_;
 
-        PoolAllocator * physics_objects_memory_allocator_;
+        ConcurrentPoolAllocator * physics_objects_memory_allocator_;
 
-        PoolAllocator * world_lights_memory_allocator_;
+        ConcurrentPoolAllocator * world_lights_memory_allocator_;
 
         /**
             Does nothing in particular. Call Init()
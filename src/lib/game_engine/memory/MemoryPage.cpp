@@ -13,7 +13,7 @@ namespace memory {
     }
 
     MemoryPage::~MemoryPage() {
-        delete mem_;
+        delete[] mem_;
     }
 
     BYTE * MemoryPage::Get(size_t byte_index) {
@@ -2,11 +2,6 @@
 
 #include <cmath>
 
-#include "game_engine/math/Geometry.hpp"
-#include "debug_tools/Assert.hpp"
-
-#include "debug_tools/Console.hpp"
-
 namespace math = game_engine::math;
 
 namespace game_engine {
@@ -17,46 +12,29 @@ namespace physics {
     }
 
     bool CollisionCheck(game_engine::math::AABox<2> box, game_engine::math::Circle2D circle) {
-        _assert(0);
-        return false;
+        return CollisionKernel(CollisionBox_t{ box.min_[0], box.min_[1], box.max_[0], box.max_[1] },
+            CollisionCircle_t{ circle.c_.x(), circle.c_.y(), circle.r_ });
     }
 
     bool CollisionCheck(math::Circle2D a, math::Circle2D b) {
-        return math::IntersectCircle_Circle(a, b);
-    }
-
-    bool CollisionBoundingBox::Check(CollisionNone * other) {
-        return false;
-    }
-
-    bool CollisionBoundingBox::Check(CollisionBoundingBox * other) {
-        return CollisionCheck(bbox_, other->bbox_);
-    }
-
-    bool CollisionBoundingBox::Check(CollisionBoundingCircle * other) {
-        return CollisionCheck(bbox_, other->bcircle_);
-    }
-
-    CollisionType CollisionBoundingBox::GetType()
-    {
-        return CollisionType::COLLISION_BOUNDING_BOX;
-    }
-
-    bool CollisionBoundingCircle::Check(CollisionNone * other) {
-        return false;
-    }
-
-    bool CollisionBoundingCircle::Check(CollisionBoundingBox * other) {
-        return CollisionCheck(other->bbox_, bcircle_);
+        return CollisionKernel(CollisionCircle_t{ a.c_.x(), a.c_.y(), a.r_ }, CollisionCircle_t{ b.c_.x(), b.c_.y(), b.r_ });
     }
 
-    bool CollisionBoundingCircle::Check(CollisionBoundingCircle * other) {
-        return CollisionCheck(bcircle_, other->bcircle_);
+    CollisionShape_t CreateCollisionShape(game_engine::math::AABox<2> box, game_engine::Real_t x, game_engine::Real_t y) {
+        CollisionShape_t shape;
+        shape.type_ = COLLISION_BOUNDING_BOX;
+        shape.bounds_ = { box.min_[0] - x, box.min_[1] - y, box.max_[0] - x, box.max_[1] - y };
+        shape.circle_ = { 0, 0, 0 };
+        return shape;
     }
 
-    CollisionType CollisionBoundingCircle::GetType()
-    {
-        return CollisionType::COLLISION_BOUNDING_CIRCLE;
+    CollisionShape_t CreateCollisionShape(game_engine::math::Circle2D circle, game_engine::Real_t x, game_engine::Real_t y) {
+        CollisionShape_t shape;
+        shape.type_ = COLLISION_BOUNDING_CIRCLE;
+        shape.circle_ = { circle.c_.x() - x, circle.c_.y() - y, std::abs(circle.r_) };
+        shape.bounds_ = { shape.circle_.x_ - shape.circle_.r_, shape.circle_.y_ - shape.circle_.r_,
+            shape.circle_.x_ + shape.circle_.r_, shape.circle_.y_ + shape.circle_.r_ };
+        return shape;
     }
 
 }
@@ -3,6 +3,7 @@
 
 #include <cstdlib>
 #include <exception>
+#include <algorithm>
 
 #include "game_engine/math/Types.hpp"
 #include "game_engine/math/Vector.hpp"
@@ -24,6 +25,26 @@ namespace physics {
         COLLISION_BOUNDING_CIRCLE,
     };
 
+    /* An axis aligned box, plain data for the collision kernels */
+    struct CollisionBox_t {
+        game_engine::Real_t min_x_, min_y_, max_x_, max_y_;
+    };
+
+    /* A circle, plain data for the collision kernels */
+    struct CollisionCircle_t {
+        game_engine::Real_t x_, y_, r_;
+    };
+
+    /**
+        The collision shape of an object, relative to the object's position. The bounds are set for every type,
+        the circle only for COLLISION_BOUNDING_CIRCLE
+    */
+    struct CollisionShape_t {
+        CollisionType type_;
+        CollisionBox_t bounds_;
+        CollisionCircle_t circle_;
+    };
+
     /**
         Check for collision between two rectangles
         @param rect_a The first rectangle
@@ -48,92 +69,94 @@ namespace physics {
     */
     bool CollisionCheck(game_engine::math::Circle2D circ_a, game_engine::math::Circle2D circ_b);
 
+    /**
+        Create the shape of a box, relative to a position
+        @param box The box
+        @param x The position x
+        @param y The position y
+        @return The shape
+    */
+    CollisionShape_t CreateCollisionShape(game_engine::math::AABox<2> box, game_engine::Real_t x, game_engine::Real_t y);
 
-    class CollisionNone;
-    class CollisionBoundingBox;
-    class CollisionBoundingCircle;
-
-    class Collision {
-    public:
-        virtual bool Check(Collision * other) = 0;
-        virtual bool Check(CollisionNone * other) = 0;
-        virtual bool Check(CollisionBoundingCircle * other) = 0;
-        virtual bool Check(CollisionBoundingBox * other) = 0;
-
-        virtual void Translate(game_engine::Real_t x, game_engine::Real_t y) = 0;
-        virtual CollisionType GetType() = 0;
-    };
-
-    class CollisionNone : public Collision {
-    public:
-
-        bool Check(Collision * other) {
-            return other->Check(this);
-        }
-        bool Check(CollisionNone * other) {
-            return false;
-        }
-        bool Check(CollisionBoundingCircle * other) {
-            return false;
-        }
-        bool Check(CollisionBoundingBox * other) {
-            return false;
-        }
-        void Translate(game_engine::Real_t x, game_engine::Real_t y) {
-            return;
-        }
-        CollisionType GetType() {
-            return CollisionType::COLLISION_NONE;
-        }
-    };
-
-    class CollisionBoundingBox : public Collision {
-        friend CollisionBoundingCircle;
-    public:
-        CollisionBoundingBox(game_engine::math::AABox<2> bbox) : bbox_(bbox) {};
-
-        bool Check(Collision * other) {
-            return other->Check(this);
-        }
-
-        bool Check(CollisionNone * other);
-
-        bool Check(CollisionBoundingBox * other);
-
-        bool Check(CollisionBoundingCircle * other);
-        void Translate(game_engine::Real_t x, game_engine::Real_t y) {
-            bbox_.Translate(math::Vector2D(x, y));
-        }
-        CollisionType GetType();
+    /**
+        Create the shape of a circle, relative to a position
+        @param circle The circle
+        @param x The position x
+        @param y The position y
+        @return The shape
+    */
+    CollisionShape_t CreateCollisionShape(game_engine::math::Circle2D circle, game_engine::Real_t x, game_engine::Real_t y);
 
-    private:
-        game_engine::math::AABox<2> bbox_;
-    };
+    /**
+        Box to box kernel. Boxes that touch collide, same as AABox::Overlaps()
+    */
+    inline bool CollisionKernel(const CollisionBox_t& a, const CollisionBox_t& b) {
+        return !(a.max_x_ < b.min_x_ || b.max_x_ < a.min_x_ || a.max_y_ < b.min_y_ || b.max_y_ < a.min_y_);
+    }
 
-    class CollisionBoundingCircle : public Collision {
-        friend CollisionBoundingBox;
-    public:
-        CollisionBoundingCircle(game_engine::math::Circle2D bcircle) : bcircle_(bcircle) {};
+    /**
+        Box to circle kernel, the closest point of the box to the center has to be inside the circle
+    */
+    inline bool CollisionKernel(const CollisionBox_t& box, const CollisionCircle_t& circle) {
+        game_engine::Real_t dx = circle.x_ - std::min(std::max(circle.x_, box.min_x_), box.max_x_);
+        game_engine::Real_t dy = circle.y_ - std::min(std::max(circle.y_, box.min_y_), box.max_y_);
+        return dx * dx + dy * dy < circle.r_ * circle.r_;
+    }
 
-        bool Check(Collision * other) {
-            return other->Check(this);
-        }
+    /**
+        Circle to circle kernel, same as math::IntersectCircle_Circle()
+    */
+    inline bool CollisionKernel(const CollisionCircle_t& a, const CollisionCircle_t& b) {
+        game_engine::Real_t dx = a.x_ - b.x_;
+        game_engine::Real_t dy = a.y_ - b.y_;
+        game_engine::Real_t r = a.r_ + b.r_;
+        return dx * dx + dy * dy < r * r;
+    }
 
-        bool Check(CollisionNone * other);
+    /**
+        Get the bounds of a shape at a position
+        @param shape The shape
+        @param x The position x
+        @param y The position y
+        @return The bounds
+    */
+    inline CollisionBox_t GetCollisionBounds(const CollisionShape_t& shape, game_engine::Real_t x, game_engine::Real_t y) {
+        return { shape.bounds_.min_x_ + x, shape.bounds_.min_y_ + y, shape.bounds_.max_x_ + x, shape.bounds_.max_y_ + y };
+    }
 
-        bool Check(CollisionBoundingBox * other);
+    /**
+        Get the circle of a shape at a position
+        @param shape The shape, of type COLLISION_BOUNDING_CIRCLE
+        @param x The position x
+        @param y The position y
+        @return The circle
+    */
+    inline CollisionCircle_t GetCollisionCircle(const CollisionShape_t& shape, game_engine::Real_t x, game_engine::Real_t y) {
+        return { shape.circle_.x_ + x, shape.circle_.y_ + y, shape.circle_.r_ };
+    }
 
-        bool Check(CollisionBoundingCircle * other);
-        
-        void Translate(game_engine::Real_t x, game_engine::Real_t y) {
-            bcircle_.Translate(x, y);
+    /**
+        Check for collision between two shapes. Picks the kernel for the pair of types, without virtual calls
+        @param a The first shape
+        @param a_x The position x of the first shape
+        @param a_y The position y of the first shape
+        @param b The second shape
+        @param b_x The position x of the second shape
+        @param b_y The position y of the second shape
+        @return true = Collide, false = do not collide
+    */
+    inline bool Collides(const CollisionShape_t& a, game_engine::Real_t a_x, game_engine::Real_t a_y,
+        const CollisionShape_t& b, game_engine::Real_t b_x, game_engine::Real_t b_y)
+    {
+        if (a.type_ == COLLISION_BOUNDING_BOX) {
+            if (b.type_ == COLLISION_BOUNDING_BOX) return CollisionKernel(GetCollisionBounds(a, a_x, a_y), GetCollisionBounds(b, b_x, b_y));
+            if (b.type_ == COLLISION_BOUNDING_CIRCLE) return CollisionKernel(GetCollisionBounds(a, a_x, a_y), GetCollisionCircle(b, b_x, b_y));
+        } else if (a.type_ == COLLISION_BOUNDING_CIRCLE) {
+            if (b.type_ == COLLISION_BOUNDING_BOX) return CollisionKernel(GetCollisionBounds(b, b_x, b_y), GetCollisionCircle(a, a_x, a_y));
+            if (b.type_ == COLLISION_BOUNDING_CIRCLE) return CollisionKernel(GetCollisionCircle(a, a_x, a_y), GetCollisionCircle(b, b_x, b_y));
         }
-        
-        CollisionType GetType();
-
-    private:
-        game_engine::math::Circle2D bcircle_;
-    };
+        return false;
+    }
 
 }
 }
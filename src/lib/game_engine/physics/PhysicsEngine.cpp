@@ -1,6 +1,10 @@
 #include "PhysicsEngine.hpp"
 
+#include <cmath>
+#include <algorithm>
+
 #include "game_engine/memory/MemoryManager.hpp"
+#include "game_engine/memory/FrameAllocator.hpp"
 
 #include "game_engine/core/ErrorCodes.hpp"
 
@@ -28,7 +32,19 @@ namespace physics {
         if (is_inited_) return Error::ERROR_GEN_NOT_INIT;
 
         float length = std::max(world_size.max_[0] - world_size.min_[0], world_size.max_[1] - world_size.min_[1]);
-        world_ = new utility::QuadTree<PhysicsObject *>(world_size.min_, length);
+        world_ = new utility::QuadTreeFlat<PhysicsObject *>(world_size.min_, length, number_of_objects);
+
+        objects_.clear();
+        objects_.reserve(number_of_objects);
+        active_.clear();
+        sweep_.clear();
+        moved_.clear();
+        escaped_.clear();
+        escaped_boxes_.clear();
+        still_pairs_changed_ = false;
+        pairs_valid_ = false;
+        number_of_pairs_ = 0;
+        max_extent_ = 0;
 
         is_inited_ = true;
         return 0;
@@ -43,6 +59,20 @@ namespace physics {
             because Collision objects will be leaked
             Or else, we could offer custom allocation to such objects, and delete them alltogether here
         */
+        delete world_;
+
+        for (size_t i = 0; i < objects_.size(); i++) {
+            objects_[i]->physics_engine_ = nullptr;
+            objects_[i]->active_index_ = -1;
+            objects_[i]->moved_ = false;
+            objects_[i]->broadphase_changed_ = false;
+        }
+        objects_.clear();
+        active_.clear();
+        sweep_.clear();
+        moved_.clear();
+        escaped_.clear();
+        escaped_boxes_.clear();
 
         is_inited_ = false;
         return 0;
@@ -52,24 +82,236 @@ namespace physics {
         return is_inited_;
     }
 
+    /**
+        Get the broadphase box of an object, its bounds enlarged by the margin, and stretched towards the direction
+        of its last move, so that an object moving steadily stays inside for longer
+        @param shape The collision shape of the object
+        @param x The position x of the object
+        @param y The position y of the object
+        @param move_x The last move on the x axis
+        @param move_y The last move on the y axis
+        @return The box
+    */
+    static CollisionBox_t GetBroadphaseBox(const CollisionShape_t& shape, Real_t x, Real_t y, Real_t move_x = 0, Real_t move_y = 0) {
+        CollisionBox_t bounds = GetCollisionBounds(shape, x, y);
+        CollisionBox_t box = { bounds.min_x_ - PHYSICS_ENGINE_BROADPHASE_MARGIN, bounds.min_y_ - PHYSICS_ENGINE_BROADPHASE_MARGIN,
+            bounds.max_x_ + PHYSICS_ENGINE_BROADPHASE_MARGIN, bounds.max_y_ + PHYSICS_ENGINE_BROADPHASE_MARGIN };
+
+        move_x *= PHYSICS_ENGINE_BROADPHASE_PREDICTION;
+        move_y *= PHYSICS_ENGINE_BROADPHASE_PREDICTION;
+        if (move_x < 0) box.min_x_ += move_x;
+        else box.max_x_ += move_x;
+        if (move_y < 0) box.min_y_ += move_y;
+        else box.max_y_ += move_y;
+        return box;
+    }
+
+    /**
+        Check if a box is inside another
+        @param outer The outer box
+        @param inner The inner box
+        @return true = Inside, false = Not inside
+    */
+    static bool IsBoxInside(const CollisionBox_t& outer, const CollisionBox_t& inner) {
+        return outer.min_x_ <= inner.min_x_ && outer.min_y_ <= inner.min_y_ && inner.max_x_ <= outer.max_x_ && inner.max_y_ <= outer.max_y_;
+    }
+
     int PhysicsEngine::Insert(PhysicsObject * object, math::Vector2D& position) {
         bool ret = world_->Insert(position, object);
         if (!ret) return Error::ERROR_OUT_OF_REGION;
 
+        if (object->physics_engine_ == nullptr) {
+            object->physics_engine_ = this;
+            object->active_index_ = -1;
+            object->moved_ = false;
+            objects_.push_back(object);
+        }
+        object->broadphase_box_ = GetBroadphaseBox(object->collision_, object->GetX(), object->GetY());
+        still_pairs_changed_ = true;
+        pairs_valid_ = false;
+
+        /* Neighbours are searched in the quad tree, by their positions, as far as the largest object reaches */
+        const CollisionBox_t& bounds = object->collision_.bounds_;
+        max_extent_ = std::max(max_extent_, std::max(std::max(std::abs(bounds.min_x_), std::abs(bounds.max_x_)),
+            std::max(std::abs(bounds.min_y_), std::abs(bounds.max_y_))));
+
         return 0;
     }
 
     int PhysicsEngine::Update(PhysicsObject * object, math::Vector2D& new_position) {
-        world_->Remove(math::Vector2D(object->GetX(), object->GetY()));
-        
-        bool ret = world_->Insert(new_position, object);
+        bool ret = world_->Move(math::Vector2D(object->GetX(), object->GetY()), new_position, object);
         if (!ret) return Error::ERROR_OUT_OF_REGION;
 
         return 0;
     }
 
     void PhysicsEngine::Remove(PhysicsObject * object) {
-        world_->Remove(math::Vector2D(object->GetX(), object->GetY()));
+        world_->Remove(math::Vector2D(object->GetX(), object->GetY()), object);
+
+        if (object->physics_engine_ != this) return;
+
+        if (object->active_index_ >= 0) Deactivate(object->active_index_);
+        objects_.erase(std::remove(objects_.begin(), objects_.end(), object), objects_.end());
+        moved_.erase(std::remove(moved_.begin(), moved_.end(), object), moved_.end());
+        for (size_t i = 0; i < escaped_.size(); i++) {
+            if (escaped_[i] != object) continue;
+
+            escaped_.erase(escaped_.begin() + i);
+            escaped_boxes_.erase(escaped_boxes_.begin() + i);
+            break;
+        }
+        object->physics_engine_ = nullptr;
+        object->moved_ = false;
+        object->broadphase_changed_ = false;
+
+        /* The pairs might point to the removed object */
+        still_pairs_changed_ = true;
+        pairs_valid_ = false;
+    }
+
+    void PhysicsEngine::Step() {
+
+        if (!is_inited_) return;
+
+        /* Activate the objects that moved */
+        for (size_t i = 0; i < moved_.size(); i++) {
+            PhysicsObject * object = moved_[i];
+            object->active_index_ = static_cast<int>(active_.size());
+            active_.push_back(ActiveObject_t());
+            ActiveObject_t& active = active_.back();
+            active.object_ = object;
+            active.still_steps_ = 0;
+            active.still_pairs_valid_ = false;
+            sweep_.push_back(object);
+        }
+        moved_.clear();
+
+        /* Deactivate the objects that stayed still for a while */
+        for (size_t i = active_.size(); i-- > 0;) {
+            ActiveObject_t& active = active_[i];
+            PhysicsObject * object = active.object_;
+
+            if (object->moved_) {
+                object->moved_ = false;
+                active.still_steps_ = 0;
+            } else if (++active.still_steps_ > PHYSICS_ENGINE_SLEEP_STEPS) {
+                /* It's a still object again, the other active objects have to find it */
+                Deactivate(i);
+                still_pairs_changed_ = true;
+                continue;
+            }
+
+            if (object->broadphase_changed_) active.still_pairs_valid_ = false;
+        }
+        for (size_t i = 0; i < escaped_.size(); i++) escaped_[i]->broadphase_changed_ = false;
+        escaped_.clear();
+        escaped_boxes_.clear();
+
+        /* The pairs with the still objects are kept, unless the box of the active object changed */
+        number_of_pairs_ = 0;
+        for (size_t i = 0; i < active_.size(); i++) {
+            ActiveObject_t& active = active_[i];
+            if (still_pairs_changed_ || !active.still_pairs_valid_) FindStillPairs(active);
+            number_of_pairs_ += active.still_pairs_.size();
+        }
+        still_pairs_changed_ = false;
+
+        FindActivePairs();
+        pairs_valid_ = true;
+    }
+
+    size_t PhysicsEngine::GetNumberOfPairs() {
+        return number_of_pairs_;
+    }
+
+    void PhysicsEngine::SetMoved(PhysicsObject * object, Real_t move_x, Real_t move_y) {
+        if (!object->moved_) {
+            object->moved_ = true;
+            if (object->active_index_ < 0) moved_.push_back(object);
+        }
+
+        /* Moved out of the broadphase box, the pairs don't have the new box until the next step */
+        CollisionBox_t bounds = GetCollisionBounds(object->collision_, object->GetX(), object->GetY());
+        if (IsBoxInside(object->broadphase_box_, bounds)) return;
+
+        object->broadphase_box_ = GetBroadphaseBox(object->collision_, object->GetX(), object->GetY(), move_x, move_y);
+        if (!object->broadphase_changed_) {
+            object->broadphase_changed_ = true;
+            escaped_.push_back(object);
+            escaped_boxes_.push_back(object->broadphase_box_);
+        } else {
+            escaped_boxes_[std::find(escaped_.begin(), escaped_.end(), object) - escaped_.begin()] = object->broadphase_box_;
+        }
+    }
+
+    void PhysicsEngine::Deactivate(size_t index) {
+        PhysicsObject * object = active_[index].object_;
+
+        sweep_.erase(std::find(sweep_.begin(), sweep_.end(), object));
+        object->active_index_ = -1;
+        object->moved_ = false;
+
+        if (index != active_.size() - 1) {
+            std::swap(active_[index], active_.back());
+            active_[index].object_->active_index_ = static_cast<int>(index);
+        }
+        active_.pop_back();
+    }
+
+    void PhysicsEngine::FindStillPairs(ActiveObject_t& active) {
+        const CollisionBox_t& box = active.object_->broadphase_box_;
+
+        /* The still objects are in the quad tree by their position, search as far as their broadphase boxes reach */
+        Real_t reach = max_extent_ + PHYSICS_ENGINE_BROADPHASE_MARGIN;
+        math::AABox<2> search_area(math::Vector2D(box.min_x_ - reach, box.min_y_ - reach), math::Vector2D(box.max_x_ + reach, box.max_y_ + reach));
+
+        std::vector<PhysicsObject *>& pairs = active.still_pairs_;
+        pairs.clear();
+        world_->QueryRange(search_area, pairs);
+
+        /* Keep the still objects whose broadphase boxes overlap, the active ones are found by the sweep */
+        size_t kept = 0;
+        for (size_t i = 0; i < pairs.size(); i++) {
+            PhysicsObject * other = pairs[i];
+            if (other->active_index_ >= 0 || other->physics_engine_ != this) continue;
+            if (!CollisionKernel(box, other->broadphase_box_)) continue;
+
+            pairs[kept++] = other;
+        }
+        pairs.resize(kept);
+        active.still_pairs_valid_ = true;
+    }
+
+    void PhysicsEngine::FindActivePairs() {
+
+        /* Insertion sort, the objects are almost sorted from the previous step */
+        for (size_t i = 1; i < sweep_.size(); i++) {
+            PhysicsObject * object = sweep_[i];
+            Real_t min_x = object->broadphase_box_.min_x_;
+            size_t j = i;
+            while (j > 0 && sweep_[j - 1]->broadphase_box_.min_x_ > min_x) {
+                sweep_[j] = sweep_[j - 1];
+                j--;
+            }
+            sweep_[j] = object;
+        }
+
+        for (size_t i = 0; i < active_.size(); i++) active_[i].active_pairs_.clear();
+
+        /* Sweep on the x axis, every object is checked against the objects that start before it ends */
+        for (size_t i = 0; i < sweep_.size(); i++) {
+            PhysicsObject * a = sweep_[i];
+            const CollisionBox_t& a_box = a->broadphase_box_;
+            for (size_t j = i + 1; j < sweep_.size() && sweep_[j]->broadphase_box_.min_x_ <= a_box.max_x_; j++) {
+                PhysicsObject * b = sweep_[j];
+                const CollisionBox_t& b_box = b->broadphase_box_;
+                if (a_box.max_y_ < b_box.min_y_ || b_box.max_y_ < a_box.min_y_) continue;
+
+                active_[a->active_index_].active_pairs_.push_back(b);
+                active_[b->active_index_].active_pairs_.push_back(a);
+                number_of_pairs_++;
+            }
+        }
     }
 
     void PhysicsEngine::GetObjectsArea(math::AABox<2> search_area, std::vector<PhysicsObject*>& objects) {
@@ -78,7 +320,7 @@ namespace physics {
 
     math::Vector2D PhysicsEngine::CheckCollision(PhysicsObject * object, math::Vector2D new_position) {
 
-        math::Vector2D result = Vector2D(object->GetX(), object->GetY());
+        math::Vector2D result = math::Vector2D(object->GetX(), object->GetY());
 
         if (!is_inited_) {
             dt::Console(dt::CRITICAL, "PhysicsEngine::CheckCollision(): World sector is not initialised");
@@ -93,26 +335,78 @@ namespace physics {
             return result;
         }
 
-        /* Get neighbours around a small area */
-        std::vector<PhysicsObject *> neighbours;
-        math::Vector2D object_position = Vector2D(object->GetX(), object->GetY());
-        world_->QueryRange(math::AABox<2>(object_position - 1.5, object_position + 1.5), neighbours);
+        const CollisionShape_t& shape = object->collision_;
+        Real_t x = object->GetX();
+        Real_t y = object->GetY();
+
+        /* The area the object sweeps, from the old to the new position */
+        CollisionBox_t bounds_old = GetCollisionBounds(shape, x, y);
+        CollisionBox_t bounds_new = GetCollisionBounds(shape, new_position.x(), new_position.y());
+        CollisionBox_t swept = { std::min(bounds_old.min_x_, bounds_new.min_x_), std::min(bounds_old.min_y_, bounds_new.min_y_),
+            std::max(bounds_old.max_x_, bounds_new.max_x_), std::max(bounds_old.max_y_, bounds_new.max_y_) };
+
+        /* 
+            The neighbours are the pairs of the broadphase, if the move stays inside the broadphase box. Otherwise
+            search the quad tree as far as the largest object reaches, use frame memory only if the area is too
+            crowded for the stack buffer
+        */
+        const size_t neighbours_buffer_size = 64;
+        PhysicsObject * neighbours_buffer[neighbours_buffer_size];
+        PhysicsObject ** neighbours = neighbours_buffer;
+        memory::FrameVector<PhysicsObject *> neighbours_overflow;
+        size_t number_of_neighbours;
+        /* The pairs with the active objects, checked after the neighbours */
+        PhysicsObject ** active_neighbours = nullptr;
+        size_t number_of_active_neighbours = 0;
+
+        bool use_pairs = pairs_valid_ && object->active_index_ >= 0 && !object->broadphase_changed_ && IsBoxInside(object->broadphase_box_, swept);
+        if (use_pairs) {
+            ActiveObject_t& active = active_[object->active_index_];
+            neighbours = active.still_pairs_.data();
+            number_of_neighbours = active.still_pairs_.size();
+            active_neighbours = active.active_pairs_.data();
+            number_of_active_neighbours = active.active_pairs_.size();
+        } else {
+            math::AABox<2> search_area(math::Vector2D(swept.min_x_ - max_extent_, swept.min_y_ - max_extent_),
+                math::Vector2D(swept.max_x_ + max_extent_, swept.max_y_ + max_extent_));
+            number_of_neighbours = world_->QueryRange(search_area, neighbours_buffer, neighbours_buffer_size);
+            if (number_of_neighbours > neighbours_buffer_size) {
+                world_->QueryRange(search_area, neighbours_overflow);
+                neighbours = neighbours_overflow.data();
+            }
+        }
 
         /* Calculate offset between new and old position without collision */
-        math::Vector2D offset = math::Vector2D(new_position.x() - object->GetX(), new_position.y() - object->GetY());
+        math::Vector2D offset = math::Vector2D(new_position.x() - x, new_position.y() - y);
 
         /* Check separately in horizontal and vertical directions for collision, and set that offset to zero */
-        for (size_t i = 0; i < neighbours.size(); i++) {
-            PhysicsObject * neighbour = neighbours[i];
+        auto check = [&](PhysicsObject * neighbour) {
+            if (neighbour == object) return;
 
-            if (object->Collides(Vector2D(new_position.x(), object->GetY()), neighbour)) {
+            const CollisionShape_t& neighbour_shape = neighbour->collision_;
+            Real_t neighbour_x = neighbour->GetX();
+            Real_t neighbour_y = neighbour->GetY();
+
+            if (Collides(shape, new_position.x(), y, neighbour_shape, neighbour_x, neighbour_y)) {
                 offset[0] = 0;
             }
-            if (object->Collides(Vector2D(object->GetX(), new_position.y()), neighbour)) {
+            if (Collides(shape, x, new_position.y(), neighbour_shape, neighbour_x, neighbour_y)) {
                 offset[1] = 0;
             }
+        };
+        for (size_t i = 0; i < number_of_neighbours; i++) check(neighbours[i]);
+        for (size_t i = 0; i < number_of_active_neighbours; i++) check(active_neighbours[i]);
+
+        /* The objects that moved out of their boxes during this frame are not in the pairs */
+        if (use_pairs) {
+            const CollisionBox_t& box = object->broadphase_box_;
+            for (size_t i = 0; i < escaped_boxes_.size(); i++) {
+                if (CollisionKernel(box, escaped_boxes_[i])) check(escaped_[i]);
+            }
         }
 
+        if (object->physics_engine_ == this) SetMoved(object, 0, 0);
+
         return result + offset;
     }
 
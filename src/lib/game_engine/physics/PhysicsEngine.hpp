@@ -1,18 +1,35 @@
 #ifndef __PhysicsEngine_hpp__
 #define __PhysicsEngine_hpp__
 
-#include "game_engine/utility/QuadTree.hpp"
+#include <vector>
+#include <utility>
+
+#include "game_engine/utility/QuadTreeFlat.hpp"
 #include "game_engine/utility/CircularBuffer.hpp"
 #include "game_engine/math/Types.hpp"
 
 #include "PhysicsObject.hpp"
 #include "Collision.hpp"
 
+/* Margin added around the bounds of an object in the broadphase, moves smaller than it keep the overlapping pairs */
+#define PHYSICS_ENGINE_BROADPHASE_MARGIN 0.5f
+/* The broadphase box of a moving object is stretched by this many times its last move, towards the direction of the move */
+#define PHYSICS_ENGINE_BROADPHASE_PREDICTION 4.0f
+/* Number of steps an active object can stay still before it's removed from the sweep */
+#define PHYSICS_ENGINE_SLEEP_STEPS 60
+
 namespace game_engine {
 namespace physics {
 
-    /* The physics engine */
+    /**
+        The physics engine. Objects are held in a quad tree. Objects that move are active, and Step() runs a sweep
+        and prune on the x axis over the active objects once per frame, to find the pairs of overlapping broadphase
+        boxes. The pairs of an active object with the still objects are found with the quad tree, and cached between
+        frames while the object stays inside its broadphase box. CheckCollision() then tests a mover only against
+        its pairs
+    */
     class PhysicsEngine {
+        friend PhysicsObject;
     public:
         /* Does nothing, Call Init() */
         PhysicsEngine();
@@ -52,9 +69,9 @@ namespace physics {
         /**
             Update the position of an object inside the engine
             @param object The object
-            @param new_pos_x The new position horizontal coordinate
-            @param new_pos_y The new position vertical coordinate
-            @return always 0. If object not found produces a console warning
+            @param new_position The new position
+            @return 0=OK, ERROR_OUT_OF_REGION=The new position is outside of the world, and the object is no longer
+                in the quad tree until it moves back inside
         */
         int Update(PhysicsObject * object, math::Vector2D& new_position);
 
@@ -66,6 +83,18 @@ namespace physics {
 
         void GetObjectsArea(math::AABox<2> search_area, std::vector<PhysicsObject*>& objects);
 
+        /**
+            Update the broadphase, call once per frame before the objects move. Objects that moved out of their
+            broadphase boxes get new ones, and the overlapping pairs are found again only if a box changed
+        */
+        void Step();
+
+        /**
+            Get the number of overlapping pairs found by the broadphase
+            @return The number of pairs
+        */
+        size_t GetNumberOfPairs();
+
         /**
             Check for collision inside.
             @param object The object to check
@@ -80,7 +109,65 @@ namespace physics {
         bool is_inited_;
         
         /* Data structure to hold the objects */
-        utility::QuadTree<PhysicsObject *> * world_;
+        utility::QuadTreeFlat<PhysicsObject *> * world_;
+
+        /* An object in the sweep */
+        struct ActiveObject_t {
+            PhysicsObject * object_;
+            /* Number of steps without moving */
+            size_t still_steps_;
+            /* The still objects whose broadphase boxes overlap, kept while the broadphase box doesn't change */
+            std::vector<PhysicsObject *> still_pairs_;
+            bool still_pairs_valid_;
+            /* The active objects whose broadphase boxes overlap, found at every step */
+            std::vector<PhysicsObject *> active_pairs_;
+        };
+
+        /* All the objects inserted */
+        std::vector<PhysicsObject *> objects_;
+        /* The active objects */
+        std::vector<ActiveObject_t> active_;
+        /* The active objects, sorted on the minimum x of their broadphase boxes */
+        std::vector<PhysicsObject *> sweep_;
+        /* Still objects that moved since the last step, to activate */
+        std::vector<PhysicsObject *> moved_;
+        /* Objects that moved out of their broadphase boxes since the last step, the pairs don't have them */
+        std::vector<PhysicsObject *> escaped_;
+        /* The new broadphase boxes of the escaped objects, stored together for a fast search */
+        std::vector<CollisionBox_t> escaped_boxes_;
+        /* Objects were inserted, removed or deactivated, the pairs with the still objects have to be found again */
+        bool still_pairs_changed_;
+        /* The pairs hold every possible collision, together with the escaped objects. False until the next step after objects are inserted or removed */
+        bool pairs_valid_;
+        size_t number_of_pairs_;
+        /* The maximum distance of the bounds of any object from its position */
+        Real_t max_extent_;
+
+        /**
+            Mark an object as moving, called when it moves or checks for collision. Gives the object a new
+            broadphase box if it moved out of its box
+            @param object The object
+            @param move_x The move on the x axis
+            @param move_y The move on the y axis
+        */
+        void SetMoved(PhysicsObject * object, Real_t move_x, Real_t move_y);
+
+        /**
+            Remove an object from the active objects
+            @param index The index of the object in the active objects
+        */
+        void Deactivate(size_t index);
+
+        /**
+            Find the still objects whose broadphase boxes overlap with the box of an active object
+            @param active The active object
+        */
+        void FindStillPairs(ActiveObject_t& active);
+
+        /**
+            Sort the active objects on the x axis, and find the overlapping pairs among them
+        */
+        void FindActivePairs();
 
     };
 
@@ -31,7 +31,9 @@ namespace physics {
         pos_y_ = pos_y;
         pos_z_ = pos_z;
 
-        collision_ = new CollisionNone();
+        collision_.type_ = COLLISION_NONE;
+        collision_.bounds_ = { 0, 0, 0, 0 };
+        collision_.circle_ = { 0, 0, 0 };
 
         is_inited_ = true;
         return 0;
@@ -62,39 +64,37 @@ namespace physics {
     }
 
     void PhysicsObject::SetPosition(ge::Real_t pos_x, ge::Real_t pos_y, ge::Real_t pos_z) {
-        
-        collision_->Translate(pos_x - pos_x_, pos_y - pos_y_);
+
+        ge::Real_t move_x = pos_x - pos_x_;
+        ge::Real_t move_y = pos_y - pos_y_;
 
         /* Set the internal parameeters */
         pos_x_ = pos_x;
         pos_y_ = pos_y;
         pos_z_ = pos_z;
+
+        if (physics_engine_ != nullptr && (move_x != 0 || move_y != 0)) physics_engine_->SetMoved(this, move_x, move_y);
     }
 
     void PhysicsObject::SetCollision(physics::PhysicsEngine * engine, game_engine::math::AABox<2> box) {
-        engine->Insert(this, Vector2D(pos_x_, pos_y_));
-        collision_ = new CollisionBoundingBox(box);
+        collision_ = CreateCollisionShape(box, pos_x_, pos_y_);
+        math::Vector2D position(pos_x_, pos_y_);
+        engine->Insert(this, position);
     }
 
-    bool PhysicsObject::Collides(game_engine::math::Vector2D new_position, PhysicsObject * other) {
-        if (!is_inited_) return false;
-
-        /* We do not collide with ourselves */
-        if (other == this) return false;
-
-        /* Move the collision object to new position */
-        ge::Real_t x_offset = new_position.x() - pos_x_;
-        ge::Real_t y_offset = new_position.y() - pos_y_;
-        collision_->Translate(x_offset, y_offset);
-        Collision * neighbour_collision = other->collision_;
-
-        /* Check collision */
-        bool collides = neighbour_collision->Check(collision_);
+    void PhysicsObject::SetCollision(physics::PhysicsEngine * engine, game_engine::math::Circle2D circle) {
+        collision_ = CreateCollisionShape(circle, pos_x_, pos_y_);
+        math::Vector2D position(pos_x_, pos_y_);
+        engine->Insert(this, position);
+    }
 
-        /* Move collision object back */
-        collision_->Translate(-x_offset, -y_offset);
+    CollisionType PhysicsObject::GetCollisionType() {
+        return collision_.type_;
+    }
 
-        return collides;
+    math::AABox<2> PhysicsObject::GetBoundingBox() {
+        CollisionBox_t bounds = GetCollisionBounds(collision_, pos_x_, pos_y_);
+        return math::AABox<2>(math::Vector2D(bounds.min_x_, bounds.min_y_), math::Vector2D(bounds.max_x_, bounds.max_y_));
     }
 
 }
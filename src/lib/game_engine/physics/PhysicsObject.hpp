@@ -76,6 +76,23 @@ namespace physics {
         */
         void SetCollision(physics::PhysicsEngine * engine, game_engine::math::AABox<2> box);
 
+        /**
+            Sets a circle as the collision object, and inserts the object into the physics engine
+        */
+        void SetCollision(physics::PhysicsEngine * engine, game_engine::math::Circle2D circle);
+
+        /**
+            Get the type of the collision object
+            @return The type
+        */
+        CollisionType GetCollisionType();
+
+        /**
+            Get the bounding box of the collision object at the current position
+            @return The bounding box
+        */
+        game_engine::math::AABox<2> GetBoundingBox();
+
     protected:
         bool removable_;
 
@@ -83,9 +100,18 @@ namespace physics {
         bool is_inited_;
         game_engine::Real_t pos_x_, pos_y_, pos_z_;
 
-        Collision * collision_ = nullptr;
-
-        bool Collides(game_engine::math::Vector2D new_position, PhysicsObject * other);
+        CollisionShape_t collision_;
+
+        /* The engine the object is inserted in, nullptr if not inserted */
+        PhysicsEngine * physics_engine_ = nullptr;
+        /* The box used by the broadphase, the bounds enlarged by a margin, so that small moves don't change it */
+        CollisionBox_t broadphase_box_;
+        /* The index in the active objects of the engine, -1 if the object is still */
+        int active_index_ = -1;
+        /* Moved since the last step of the engine */
+        bool moved_ = false;
+        /* Moved out of the broadphase box since the last step of the engine, and got a new one */
+        bool broadphase_changed_ = false;
     };
 
 }
@@ -0,0 +1,630 @@
+#ifndef __BVH_hpp__
+#define __BVH_hpp__
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+
+#include "glm/glm.hpp"
+
+namespace game_engine { namespace utility {
+
+/* An index that points to no node */
+#define GAME_ENGINE_BVH_NULL -1
+/* Number of bins along the split axis in the SAH build */
+#define GAME_ENGINE_BVH_SAH_BINS 12
+
+    /**
+        A dynamic bounding volume hierarchy of axis aligned boxes in 3D space, with data of type Data in the leaves.
+        Every object is a leaf, and its id is the index of the leaf node, which doesn't change until it's removed.
+        Insert() places a leaf next to the sibling that increases the surface area of the tree the least, and Move()
+        refits the ancestors of a leaf. Both apply tree rotations on the way up, that swap a child with a grandchild
+        when the swap makes the surface area of the tree smaller. Rebuild() builds the whole tree again top down with
+        the binned surface area heuristic, it should be called after many objects have been inserted or moved far.
+        Nodes are kept in one arena, and all traversals are iterative. Queries use a member stack, so they can't run
+        at the same time from different threads
+    */
+    template<typename Data>
+    class BVH {
+    public:
+
+        /**
+            @param expected_objects Number of objects to reserve space for
+        */
+        BVH(size_t expected_objects = 0) {
+            nodes_.reserve(2 * expected_objects);
+            Reset();
+        }
+
+        /**
+            Delete everything. The tree can still be used
+        */
+        void Destroy() {
+            nodes_ = std::vector<Node>();
+            stack_ = std::vector<StackEntry_t>();
+            build_items_ = std::vector<BuildItem_t>();
+            Reset();
+        }
+
+        /**
+            Insert an object
+            @param min The minimum point of the box of the object
+            @param max The maximum point of the box of the object
+            @param data The data to store
+            @return The id of the object
+        */
+        int32_t Insert(const glm::vec3& min, const glm::vec3& max, Data data) {
+            int32_t leaf = AllocateNode();
+            nodes_[leaf].min_ = min;
+            nodes_[leaf].max_ = max;
+            nodes_[leaf].data_ = data;
+            objects_++;
+
+            if (root_ == GAME_ENGINE_BVH_NULL) {
+                root_ = leaf;
+                return leaf;
+            }
+
+            /* Go down to the sibling with the smallest cost, the surface area of the new parent and the increase of the ancestors */
+            int32_t index = root_;
+            while (!nodes_[index].IsLeaf()) {
+                Node& node = nodes_[index];
+                float combined_area = Area(glm::min(node.min_, min), glm::max(node.max_, max));
+                float cost = combined_area;
+                float inheritance_cost = combined_area - Area(node.min_, node.max_);
+
+                float cost_left = ChildCost(node.left_, min, max) + inheritance_cost;
+                float cost_right = ChildCost(node.right_, min, max) + inheritance_cost;
+                if (cost < cost_left && cost < cost_right) break;
+
+                index = (cost_left < cost_right) ? node.left_ : node.right_;
+            }
+
+            /* A new parent for the sibling and the leaf */
+            int32_t sibling = index;
+            int32_t old_parent = nodes_[sibling].parent_;
+            int32_t new_parent = AllocateNode();
+            nodes_[new_parent].min_ = glm::min(nodes_[sibling].min_, min);
+            nodes_[new_parent].max_ = glm::max(nodes_[sibling].max_, max);
+            nodes_[new_parent].parent_ = old_parent;
+            nodes_[new_parent].left_ = sibling;
+            nodes_[new_parent].right_ = leaf;
+            nodes_[sibling].parent_ = new_parent;
+            nodes_[leaf].parent_ = new_parent;
+
+            if (old_parent == GAME_ENGINE_BVH_NULL) root_ = new_parent;
+            else ReplaceChild(old_parent, sibling, new_parent);
+
+            RefitAncestors(new_parent);
+            return leaf;
+        }
+
+        /**
+            Remove an object
+            @param id The id of the object
+        */
+        void Remove(int32_t id) {
+            objects_--;
+
+            if (id == root_) {
+                root_ = GAME_ENGINE_BVH_NULL;
+                FreeNode(id);
+                return;
+            }
+
+            /* The sibling takes the place of the parent */
+            int32_t parent = nodes_[id].parent_;
+            int32_t grand_parent = nodes_[parent].parent_;
+            int32_t sibling = (nodes_[parent].left_ == id) ? nodes_[parent].right_ : nodes_[parent].left_;
+
+            nodes_[sibling].parent_ = grand_parent;
+            if (grand_parent == GAME_ENGINE_BVH_NULL) root_ = sibling;
+            else ReplaceChild(grand_parent, parent, sibling);
+
+            FreeNode(parent);
+            FreeNode(id);
+            RefitAncestors(grand_parent);
+        }
+
+        /**
+            Change the box of an object. The ancestors are refitted, and rotated where it helps
+            @param id The id of the object
+            @param min The new minimum point
+            @param max The new maximum point
+        */
+        void Move(int32_t id, const glm::vec3& min, const glm::vec3& max) {
+            nodes_[id].min_ = min;
+            nodes_[id].max_ = max;
+            RefitAncestors(nodes_[id].parent_);
+        }
+
+        /**
+            Build the tree again with the binned surface area heuristic. The ids of the objects don't change
+        */
+        void Rebuild() {
+            if (root_ == GAME_ENGINE_BVH_NULL) return;
+
+            /* Keep the leaves, free the rest */
+            build_items_.clear();
+            stack_.clear();
+            stack_.push_back({ root_, 0 });
+            while (!stack_.empty()) {
+                int32_t index = stack_.back().node_;
+                stack_.pop_back();
+
+                Node& node = nodes_[index];
+                if (node.IsLeaf()) {
+                    build_items_.push_back({ index, 0.5f * (node.min_ + node.max_) });
+                    continue;
+                }
+                stack_.push_back({ node.left_, 0 });
+                stack_.push_back({ node.right_, 0 });
+                FreeNode(index);
+            }
+
+            /* Split ranges of the leaves top down, each task makes a node for its range and links it to the parent */
+            std::vector<BuildTask_t> tasks;
+            tasks.push_back({ GAME_ENGINE_BVH_NULL, 0, build_items_.size(), true });
+            while (!tasks.empty()) {
+                BuildTask_t task = tasks.back();
+                tasks.pop_back();
+
+                int32_t index;
+                if (task.end_ - task.begin_ == 1) {
+                    index = build_items_[task.begin_].leaf_;
+                } else {
+                    index = AllocateNode();
+                    Node& leaf = nodes_[build_items_[task.begin_].leaf_];
+                    glm::vec3 min = leaf.min_, max = leaf.max_;
+                    for (size_t i = task.begin_ + 1; i < task.end_; i++) {
+                        min = glm::min(min, nodes_[build_items_[i].leaf_].min_);
+                        max = glm::max(max, nodes_[build_items_[i].leaf_].max_);
+                    }
+                    nodes_[index].min_ = min;
+                    nodes_[index].max_ = max;
+
+                    size_t middle = Split(task.begin_, task.end_);
+                    tasks.push_back({ index, middle, task.end_, false });
+                    tasks.push_back({ index, task.begin_, middle, true });
+                }
+
+                nodes_[index].parent_ = task.parent_;
+                if (task.parent_ == GAME_ENGINE_BVH_NULL) root_ = index;
+                else if (task.left_) nodes_[task.parent_].left_ = index;
+                else nodes_[task.parent_].right_ = index;
+            }
+        }
+
+        /**
+            Get the data of an object
+            @param id The id of the object
+            @return The data
+        */
+        Data& GetData(int32_t id) {
+            return nodes_[id].data_;
+        }
+
+        /**
+            Get the number of objects
+            @return The number of objects
+        */
+        size_t Size() const {
+            return objects_;
+        }
+
+        /**
+            Get the surface area heuristic cost of the tree, the sum of the areas of the internal nodes relative to the
+            area of the root. Lower is better
+            @return The cost, 0 for a tree with less than two objects
+        */
+        float GetCost() {
+            if (root_ == GAME_ENGINE_BVH_NULL || nodes_[root_].IsLeaf()) return 0;
+
+            float area = 0;
+            stack_.clear();
+            stack_.push_back({ root_, 0 });
+            while (!stack_.empty()) {
+                Node& node = nodes_[stack_.back().node_];
+                stack_.pop_back();
+                if (node.IsLeaf()) continue;
+
+                area += Area(node.min_, node.max_);
+                stack_.push_back({ node.left_, 0 });
+                stack_.push_back({ node.right_, 0 });
+            }
+            return area / Area(nodes_[root_].min_, nodes_[root_].max_);
+        }
+
+        /**
+            Find the objects with boxes not completely outside of a set of planes. A subtree outside of a plane is
+            skipped, and the planes a subtree is completely inside of are not tested for its children, so a subtree
+            inside all the planes is added without any more tests
+            @param planes The planes, a point p is inside plane i when dot(planes[i], vec4(p, 1)) >= 0
+            @param number_of_planes Number of planes, at most 32
+            @param[out] result The data of the objects found are appended here
+        */
+        void QueryFrustum(const glm::vec4 * planes, size_t number_of_planes, std::vector<Data>& result) {
+            if (root_ == GAME_ENGINE_BVH_NULL) return;
+
+            stack_.clear();
+            stack_.push_back({ root_, (number_of_planes >= 32) ? 0xFFFFFFFFu : ((1u << number_of_planes) - 1) });
+            while (!stack_.empty()) {
+                StackEntry_t entry = stack_.back();
+                stack_.pop_back();
+                Node& node = nodes_[entry.node_];
+
+                bool outside = false;
+                for (size_t p = 0; p < number_of_planes && entry.planes_ != 0; p++) {
+                    if ((entry.planes_ & (1u << p)) == 0) continue;
+
+                    /* The vertices furthest along and furthest against the normal */
+                    const glm::vec4& plane = planes[p];
+                    glm::vec3 positive(plane.x >= 0 ? node.max_.x : node.min_.x, plane.y >= 0 ? node.max_.y : node.min_.y, plane.z >= 0 ? node.max_.z : node.min_.z);
+                    glm::vec3 negative(plane.x >= 0 ? node.min_.x : node.max_.x, plane.y >= 0 ? node.min_.y : node.max_.y, plane.z >= 0 ? node.min_.z : node.max_.z);
+                    if (glm::dot(glm::vec3(plane), positive) + plane.w < 0) {
+                        outside = true;
+                        break;
+                    }
+                    if (glm::dot(glm::vec3(plane), negative) + plane.w >= 0) entry.planes_ &= ~(1u << p);
+                }
+                if (outside) continue;
+
+                if (node.IsLeaf()) {
+                    result.push_back(node.data_);
+                } else {
+                    stack_.push_back({ node.right_, entry.planes_ });
+                    stack_.push_back({ node.left_, entry.planes_ });
+                }
+            }
+        }
+
+        /**
+            Find the objects with boxes that overlap a box
+            @param min The minimum point of the box
+            @param max The maximum point of the box
+            @param[out] result The data of the objects found are appended here
+        */
+        void QueryBox(const glm::vec3& min, const glm::vec3& max, std::vector<Data>& result) {
+            if (root_ == GAME_ENGINE_BVH_NULL) return;
+
+            stack_.clear();
+            stack_.push_back({ root_, 0 });
+            while (!stack_.empty()) {
+                Node& node = nodes_[stack_.back().node_];
+                stack_.pop_back();
+                if (!Overlap(node.min_, node.max_, min, max)) continue;
+
+                if (node.IsLeaf()) {
+                    result.push_back(node.data_);
+                } else {
+                    stack_.push_back({ node.right_, 0 });
+                    stack_.push_back({ node.left_, 0 });
+                }
+            }
+        }
+
+        /**
+            Find the first object box hit by a ray. The closer child is visited first, and subtrees further than the
+            closest hit so far are skipped
+            @param origin The origin of the ray
+            @param direction The direction of the ray
+            @param max_distance The maximum distance along the direction
+            @param[out] data The data of the object hit
+            @param[out] distance The distance to the box of the object hit, in multiples of the direction
+            @return true = An object was hit, false = Nothing was hit
+        */
+        bool RayCast(const glm::vec3& origin, const glm::vec3& direction, float max_distance, Data& data, float& distance) {
+            if (root_ == GAME_ENGINE_BVH_NULL) return false;
+
+            glm::vec3 inverse_direction = 1.0f / direction;
+            float closest = max_distance;
+            int32_t hit = GAME_ENGINE_BVH_NULL;
+
+            stack_.clear();
+            stack_.push_back({ root_, 0 });
+            while (!stack_.empty()) {
+                int32_t index = stack_.back().node_;
+                stack_.pop_back();
+                Node& node = nodes_[index];
+
+                /* The node may be further than a hit found after it was pushed */
+                float node_distance;
+                if (!RayBox(origin, inverse_direction, node, closest, node_distance)) continue;
+
+                if (node.IsLeaf()) {
+                    closest = node_distance;
+                    hit = index;
+                    continue;
+                }
+
+                float left_distance, right_distance;
+                bool left = RayBox(origin, inverse_direction, nodes_[node.left_], closest, left_distance);
+                bool right = RayBox(origin, inverse_direction, nodes_[node.right_], closest, right_distance);
+                int32_t first = node.left_, second = node.right_;
+                if (left && right && right_distance < left_distance) std::swap(first, second);
+                if (left && right) {
+                    stack_.push_back({ second, 0 });
+                    stack_.push_back({ first, 0 });
+                } else if (left) {
+                    stack_.push_back({ node.left_, 0 });
+                } else if (right) {
+                    stack_.push_back({ node.right_, 0 });
+                }
+            }
+
+            if (hit == GAME_ENGINE_BVH_NULL) return false;
+            data = nodes_[hit].data_;
+            distance = closest;
+            return true;
+        }
+
+    private:
+
+        struct Node {
+            glm::vec3 min_;
+            glm::vec3 max_;
+            /* For free nodes, parent_ is the next free node */
+            int32_t parent_;
+            int32_t left_;
+            int32_t right_;
+            Data data_;
+
+            bool IsLeaf() const {
+                return left_ == GAME_ENGINE_BVH_NULL;
+            }
+        };
+
+        /* A node to visit, and the planes it has to be tested against */
+        struct StackEntry_t {
+            int32_t node_;
+            uint32_t planes_;
+        };
+
+        /* A leaf and the center of its box, during Rebuild() */
+        struct BuildItem_t {
+            int32_t leaf_;
+            glm::vec3 centroid_;
+        };
+
+        /* A range of build items to make a subtree of, and where to link it */
+        struct BuildTask_t {
+            int32_t parent_;
+            size_t begin_;
+            size_t end_;
+            bool left_;
+        };
+
+        std::vector<Node> nodes_;
+        int32_t root_;
+        int32_t free_nodes_;
+        size_t objects_;
+
+        std::vector<StackEntry_t> stack_;
+        std::vector<BuildItem_t> build_items_;
+
+        void Reset() {
+            nodes_.clear();
+            root_ = GAME_ENGINE_BVH_NULL;
+            free_nodes_ = GAME_ENGINE_BVH_NULL;
+            objects_ = 0;
+        }
+
+        int32_t AllocateNode() {
+            int32_t index;
+            if (free_nodes_ != GAME_ENGINE_BVH_NULL) {
+                index = free_nodes_;
+                free_nodes_ = nodes_[index].parent_;
+            } else {
+                index = static_cast<int32_t>(nodes_.size());
+                nodes_.push_back(Node());
+            }
+            nodes_[index].parent_ = GAME_ENGINE_BVH_NULL;
+            nodes_[index].left_ = GAME_ENGINE_BVH_NULL;
+            nodes_[index].right_ = GAME_ENGINE_BVH_NULL;
+            return index;
+        }
+
+        void FreeNode(int32_t index) {
+            nodes_[index].parent_ = free_nodes_;
+            free_nodes_ = index;
+        }
+
+        static float Area(const glm::vec3& min, const glm::vec3& max) {
+            glm::vec3 d = max - min;
+            return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+        }
+
+        static bool Overlap(const glm::vec3& min_a, const glm::vec3& max_a, const glm::vec3& min_b, const glm::vec3& max_b) {
+            return min_a.x <= max_b.x && max_a.x >= min_b.x && min_a.y <= max_b.y && max_a.y >= min_b.y && min_a.z <= max_b.z && max_a.z >= min_b.z;
+        }
+
+        /**
+            Intersect a ray with the box of a node
+            @param max_distance Hits further than this are ignored
+            @param[out] distance The distance to the entry point, 0 if the origin is inside
+            @return true = hit
+        */
+        static bool RayBox(const glm::vec3& origin, const glm::vec3& inverse_direction, const Node& node, float max_distance, float& distance) {
+            glm::vec3 t1 = (node.min_ - origin) * inverse_direction;
+            glm::vec3 t2 = (node.max_ - origin) * inverse_direction;
+            glm::vec3 t_min = glm::min(t1, t2);
+            glm::vec3 t_max = glm::max(t1, t2);
+
+            float enter = std::max(std::max(t_min.x, t_min.y), std::max(t_min.z, 0.0f));
+            float exit = std::min(std::min(t_max.x, t_max.y), std::min(t_max.z, max_distance));
+            distance = enter;
+            return enter <= exit;
+        }
+
+        /**
+            The cost of placing a box under a child during Insert(), the area of the child with the box, minus the
+            current area of the child if it's not a leaf, since it would only grow
+        */
+        float ChildCost(int32_t child, const glm::vec3& min, const glm::vec3& max) {
+            Node& node = nodes_[child];
+            float area = Area(glm::min(node.min_, min), glm::max(node.max_, max));
+            if (node.IsLeaf()) return area;
+            return area - Area(node.min_, node.max_);
+        }
+
+        void ReplaceChild(int32_t parent, int32_t old_child, int32_t new_child) {
+            if (nodes_[parent].left_ == old_child) nodes_[parent].left_ = new_child;
+            else nodes_[parent].right_ = new_child;
+        }
+
+        void Refit(int32_t index) {
+            Node& node = nodes_[index];
+            node.min_ = glm::min(nodes_[node.left_].min_, nodes_[node.right_].min_);
+            node.max_ = glm::max(nodes_[node.left_].max_, nodes_[node.right_].max_);
+        }
+
+        /**
+            Refit and rotate a node and all its ancestors
+            @param index The first node
+        */
+        void RefitAncestors(int32_t index) {
+            while (index != GAME_ENGINE_BVH_NULL) {
+                Rotate(index);
+                Refit(index);
+                index = nodes_[index].parent_;
+            }
+        }
+
+        /**
+            Swap a child of a node with a child of its sibling, if that makes the sibling smaller. The box of the
+            node doesn't change, since it has the same leaves
+            @param index The node
+        */
+        void Rotate(int32_t index) {
+            int32_t b = nodes_[index].left_;
+            int32_t c = nodes_[index].right_;
+
+            /* 0 = no rotation, 1 = b with c.left, 2 = b with c.right, 3 = c with b.left, 4 = c with b.right */
+            int rotation = 0;
+            float best = 0;
+            if (!nodes_[c].IsLeaf()) {
+                int32_t f = nodes_[c].left_, g = nodes_[c].right_;
+                float area = Area(nodes_[c].min_, nodes_[c].max_);
+                float gain_f = area - Area(glm::min(nodes_[b].min_, nodes_[g].min_), glm::max(nodes_[b].max_, nodes_[g].max_));
+                float gain_g = area - Area(glm::min(nodes_[b].min_, nodes_[f].min_), glm::max(nodes_[b].max_, nodes_[f].max_));
+                if (gain_f > best) { best = gain_f; rotation = 1; }
+                if (gain_g > best) { best = gain_g; rotation = 2; }
+            }
+            if (!nodes_[b].IsLeaf()) {
+                int32_t d = nodes_[b].left_, e = nodes_[b].right_;
+                float area = Area(nodes_[b].min_, nodes_[b].max_);
+                float gain_d = area - Area(glm::min(nodes_[c].min_, nodes_[e].min_), glm::max(nodes_[c].max_, nodes_[e].max_));
+                float gain_e = area - Area(glm::min(nodes_[c].min_, nodes_[d].min_), glm::max(nodes_[c].max_, nodes_[d].max_));
+                if (gain_d > best) { best = gain_d; rotation = 3; }
+                if (gain_e > best) { best = gain_e; rotation = 4; }
+            }
+
+            switch (rotation) {
+            case 1: SwapWithGrandChild(index, true, c, true); break;
+            case 2: SwapWithGrandChild(index, true, c, false); break;
+            case 3: SwapWithGrandChild(index, false, b, true); break;
+            case 4: SwapWithGrandChild(index, false, b, false); break;
+            default: break;
+            }
+        }
+
+        /**
+            Swap a child of a node with a child of the other child, and refit the other child
+            @param index The node
+            @param child_left The child to swap is the left child of the node
+            @param sibling The other child of the node
+            @param grand_child_left The grand child to swap is the left child of the sibling
+        */
+        void SwapWithGrandChild(int32_t index, bool child_left, int32_t sibling, bool grand_child_left) {
+            int32_t child = child_left ? nodes_[index].left_ : nodes_[index].right_;
+            int32_t grand_child = grand_child_left ? nodes_[sibling].left_ : nodes_[sibling].right_;
+
+            if (child_left) nodes_[index].left_ = grand_child;
+            else nodes_[index].right_ = grand_child;
+            nodes_[grand_child].parent_ = index;
+
+            if (grand_child_left) nodes_[sibling].left_ = child;
+            else nodes_[sibling].right_ = child;
+            nodes_[child].parent_ = sibling;
+
+            Refit(sibling);
+        }
+
+        /**
+            Split a range of build items with the binned surface area heuristic. The items are partitioned in place
+            @return The first item of the right part
+        */
+        size_t Split(size_t begin, size_t end) {
+            glm::vec3 centroid_min = build_items_[begin].centroid_;
+            glm::vec3 centroid_max = centroid_min;
+            for (size_t i = begin + 1; i < end; i++) {
+                centroid_min = glm::min(centroid_min, build_items_[i].centroid_);
+                centroid_max = glm::max(centroid_max, build_items_[i].centroid_);
+            }
+
+            glm::vec3 extent = centroid_max - centroid_min;
+            int axis = (extent.x > extent.y) ? ((extent.x > extent.z) ? 0 : 2) : ((extent.y > extent.z) ? 1 : 2);
+            size_t middle = (begin + end) / 2;
+            if (extent[axis] <= 0) return middle;
+
+            /* Count the boxes and grow the bounds of each bin */
+            const int bins = GAME_ENGINE_BVH_SAH_BINS;
+            size_t counts[bins] = {};
+            glm::vec3 bin_min[bins], bin_max[bins];
+            for (int b = 0; b < bins; b++) {
+                bin_min[b] = glm::vec3(std::numeric_limits<float>::max());
+                bin_max[b] = glm::vec3(-std::numeric_limits<float>::max());
+            }
+            float scale = bins / extent[axis];
+            for (size_t i = begin; i < end; i++) {
+                int b = std::min(bins - 1, static_cast<int>((build_items_[i].centroid_[axis] - centroid_min[axis]) * scale));
+                Node& leaf = nodes_[build_items_[i].leaf_];
+                counts[b]++;
+                bin_min[b] = glm::min(bin_min[b], leaf.min_);
+                bin_max[b] = glm::max(bin_max[b], leaf.max_);
+            }
+
+            /* Areas of the right side of every split, then sweep from the left */
+            float right_cost[bins];
+            glm::vec3 grow_min(std::numeric_limits<float>::max()), grow_max(-std::numeric_limits<float>::max());
+            size_t grow_count = 0;
+            for (int b = bins - 1; b > 0; b--) {
+                grow_min = glm::min(grow_min, bin_min[b]);
+                grow_max = glm::max(grow_max, bin_max[b]);
+                grow_count += counts[b];
+                right_cost[b] = (grow_count > 0) ? grow_count * Area(grow_min, grow_max) : 0;
+            }
+
+            int best_split = 0;
+            float best_cost = std::numeric_limits<float>::max();
+            grow_min = glm::vec3(std::numeric_limits<float>::max());
+            grow_max = glm::vec3(-std::numeric_limits<float>::max());
+            grow_count = 0;
+            for (int b = 1; b < bins; b++) {
+                grow_min = glm::min(grow_min, bin_min[b - 1]);
+                grow_max = glm::max(grow_max, bin_max[b - 1]);
+                grow_count += counts[b - 1];
+                if (grow_count == 0 || grow_count == end - begin) continue;
+
+                float cost = grow_count * Area(grow_min, grow_max) + right_cost[b];
+                if (cost < best_cost) {
+                    best_cost = cost;
+                    best_split = b;
+                }
+            }
+            if (best_split == 0) return middle;
+
+            BuildItem_t * split = std::partition(&build_items_[begin], &build_items_[0] + end, [&](const BuildItem_t& item) {
+                return std::min(bins - 1, static_cast<int>((item.centroid_[axis] - centroid_min[axis]) * scale)) < best_split;
+            });
+            size_t result = split - &build_items_[0];
+            if (result == begin || result == end) return middle;
+            return result;
+        }
+    };
+
+}
+}
+
+#endif
@@ -27,7 +27,7 @@ namespace utility {
     }
     
     EventDispatcher::EventDispatcher(size_t number_of_events) {
-        events_ = new HashTable<int, Event *>(number_of_events, 1.0);
+        events_ = new HashTable<EventType, Event *>(number_of_events, 1.0);
     }
     
     bool EventDispatcher::RegisterEvent(EventType type) {
@@ -44,7 +44,7 @@ namespace utility {
     
     bool EventDispatcher::SubscribeToEvent(EventType type, Event::SubId_t id, Event::Fn_t handler) {
     
-        HashTable<int, Event *>::iterator itr = events_->Find(type);
+        HashTable<EventType, Event *>::iterator itr = events_->Find(type);
         if (itr == events_->end()) {
             return false;
         }
@@ -57,7 +57,7 @@ namespace utility {
     
     bool EventDispatcher::UnsubscribeFromEvent(EventType type, Event::SubId_t id) {
     
-        HashTable<int, Event *>::iterator itr = events_->Find(type);
+        HashTable<EventType, Event *>::iterator itr = events_->Find(type);
         if (itr == events_->end()) {
             return false;
         }
@@ -70,7 +70,7 @@ namespace utility {
     
     bool EventDispatcher::NotifyEvent(EventType type) {
         
-        HashTable<int, Event *>::iterator itr = events_->Find(type);
+        HashTable<EventType, Event *>::iterator itr = events_->Find(type);
         if (itr == events_->end()) {
             return false;
         }
@@ -81,7 +81,7 @@ namespace utility {
     
     void EventDispatcher::Dispatch() {
     
-        for (typename HashTable<int, Event *>::iterator itr = events_->begin(); itr != events_->end(); ++itr) {
+        for (typename HashTable<EventType, Event *>::iterator itr = events_->begin(); itr != events_->end(); ++itr) {
             if (itr.GetValue()->notified_) {
                 itr.GetValue()->Notify();
                 itr.GetValue()->notified_ = false;
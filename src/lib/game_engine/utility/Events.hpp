@@ -112,7 +112,7 @@ namespace utility {
     private:
     
         /* Holds the registered events */
-        HashTable<int, Event *> * events_;
+        HashTable<EventType, Event *> * events_;
     };
     
 }
@@ -39,7 +39,10 @@ namespace utility {
     void FIFOWorker::Stop() {
         if (!is_inited_) return;
 
-        run_ = false;
+        {
+            std::unique_lock<std::mutex> l(lock_);
+            run_ = false;
+        }
         condition_.notify_one();
         running_thread_.join();
 
@@ -47,7 +50,13 @@ namespace utility {
     }
 
     void FIFOWorker::BusyWaitAll() {
-        while (executing_ || !tasks_.empty());
+        while (1) {
+            {
+                std::unique_lock<std::mutex> l(lock_);
+                if (!executing_ && tasks_.empty()) return;
+            }
+            std::this_thread::yield();
+        }
     }
 
     void FIFOWorker::run() {
@@ -6,6 +6,7 @@
 #include <mutex>
 #include <condition_variable>
 #include <queue>
+#include <atomic>
 
 #include "Task.hpp"
 
@@ -14,6 +15,10 @@ namespace game_engine {
 
 namespace utility {
 
+    /**
+        A single worker thread with a locked FIFO queue. Superseded by the JobSystem, kept as a baseline for the
+        utility_benchmark
+    */
     class FIFOWorker {
     public:
         /**
@@ -45,7 +50,7 @@ namespace utility {
         void Stop();
 
         /**
-        
+            Spins until all the scheduled tasks have been executed
         */
         void BusyWaitAll();
 
@@ -55,8 +60,8 @@ namespace utility {
         std::condition_variable condition_;
         std::queue<Task> tasks_;
         bool run_;
-        bool is_inited_;
-        bool executing_;
+        std::atomic<bool> is_inited_;
+        std::atomic<bool> executing_;
 
         void run();
     };
@@ -3,18 +3,86 @@
 
 #include <iostream>
 #include <vector>
-
-#include "List.hpp"
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include <functional>
+#include <type_traits>
 
 
 namespace game_engine {
 
 namespace utility {
 
+    /* The highest load of a HashTable, a larger max_load given in the constructor is lowered to this. Above it the
+       probe lengths vary more, and lookups get slower */
+#define GAME_ENGINE_HASHTABLE_MAX_LOAD 0.5
+
+    /**
+        Fibonacci hashing, multiply with 2^64 / golden ratio. The high bits of the result depend on all the bits of the
+        value, and the table selects a slot with the high bits. std::hash of integers and pointers is the identity,
+        consecutive integers end up spread evenly over the slots
+        @param hash The hash value
+        @return The mixed value
+    */
+    inline uint64_t HashTableMix(uint64_t hash) {
+        return hash * 0x9E3779B97F4A7C15ULL;
+    }
+
     /**
-          A Hashtable
+        Hash a sequence of bytes, eight at a time, followed by HashTableMix()
+        @param data The bytes
+        @param size The number of bytes
+        @return The hash value
     */
-    template<typename Key, typename Value> class HashTable {
+    inline uint64_t HashTableBytes(const char * data, size_t size) {
+        uint64_t hash = 0xCBF29CE484222325ULL ^ size;
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            uint64_t word;
+            memcpy(&word, data + i, 8);
+            hash = (hash ^ word) * 0xFF51AFD7ED558CCDULL;
+            hash ^= hash >> 32;
+        }
+        if (i < size) {
+            uint64_t word = 0;
+            memcpy(&word, data + i, size - i);
+            hash = (hash ^ word) * 0xFF51AFD7ED558CCDULL;
+            hash ^= hash >> 32;
+        }
+        return HashTableMix(hash);
+    }
+
+    /**
+        The hash function of a HashTable. Can be specialised for a key type, like the one for strings
+    */
+    template<typename Key> struct HashTableHash {
+        uint64_t operator()(const Key& key) const {
+            return HashTableMix(static_cast<uint64_t>(std::hash<Key>()(key)));
+        }
+    };
+
+    /**
+        Strings can also be looked up with a const char *, without creating an std::string
+    */
+    template<> struct HashTableHash<std::string> {
+        uint64_t operator()(const std::string& key) const {
+            return HashTableBytes(key.data(), key.size());
+        }
+
+        uint64_t operator()(const char * key) const {
+            return HashTableBytes(key, strlen(key));
+        }
+    };
+
+    /**
+        A Hashtable with open addressing. The elements are stored one after the other in an array, in the order they
+        were inserted, and the table of slots points to them. The slots use Robin Hood hashing with linear probing:
+        an element that is further from its home slot takes the place of one that is closer, so that all the
+        elements are close to their home slot, and a search can stop early. The number of slots is a power of two
+    */
+    template<typename Key, typename Value, typename Hash = HashTableHash<Key>> class HashTable {
     private:
 
         /**
@@ -25,288 +93,390 @@ namespace utility {
         private:
             Key key_;
             Value value_;
+            uint64_t hash_;
         public:
-            HashElement(Key key, Value value): key_(key), value_(value) {};
-    
-            bool operator==(const HashElement& other) {
-                return key_ == other.key_;
-            }
+            HashElement(Key key, Value value, uint64_t hash): key_(key), value_(value), hash_(hash) {};
+        };
+
+        /**
+            A slot of the table. The low byte of info_ is the distance from the home slot plus one, 0 for an empty
+            slot, the rest are bits of the hash, to skip most of the key comparisons
+        */
+        struct Slot_t {
+            uint32_t info_;
+            uint32_t index_;
         };
-    
+
         /**
-            Iterator to iterate through the inserted elements
+            Iterator to iterate through the inserted elements, in the order they were inserted
         */
-        class HashIterator : public std::iterator<std::forward_iterator_tag, Key, Value> {
+        class HashIterator {
             friend class HashTable;
-    	    friend class HashElement;
         private:
-            HashElement * pointed_;
-            const std::vector<List<HashElement> * > * hashtable_;
+            std::vector<HashElement> * elements_;
             size_t pointed_index_;
-    	
-            HashIterator(HashElement * pointed, 
-                const std::vector<List<HashElement> * > * hashtable, 
-                size_t index
-            ): pointed_(pointed), pointed_index_(index), hashtable_(hashtable) { };
-    
+
+            HashIterator(std::vector<HashElement> * elements, size_t index): elements_(elements), pointed_index_(index) { };
+
         public:
             Key& GetKey() {
-                return pointed_->key_;
+                return (*elements_)[pointed_index_].key_;
             }
-            
+
             Value& GetValue() {
-                return pointed_->value_;
+                return (*elements_)[pointed_index_].value_;
             }
-    
-    	    const HashIterator& operator++(){
-    
-                /* Find the next in the current bucket list */
-                List<HashElement> * current_bucket_list = hashtable_->at(pointed_index_);
-                typename List<HashElement>::iterator next = current_bucket_list->FindForward(*pointed_);
-                ++next;
-                if (next == current_bucket_list->end()){
-                    /* Find the next bucket list */
-                    pointed_index_ ++;
-                    while(pointed_index_ < hashtable_->size() && hashtable_->at(pointed_index_) == nullptr) 
-                        pointed_index_++;
-    
-                        /* If none exists return the iterator end */
-                        if (pointed_index_ == hashtable_->size()) {
-                            pointed_ = nullptr;
-                            return *this;
-                        }
-    
-                        /* if not, return the first from the new list */
-                        pointed_ = hashtable_->at(pointed_index_)->PeekTop();
-                        return *this;
-                }
-                      
-                pointed_ = &(*next);
+
+            const HashIterator& operator++(){
+                pointed_index_++;
                 return *this;
             }
-    
-            /* Needs implementation */
-            /*const HashIterator& operator+=(int amount){
-                int i = 0;
-                while(i++ < amount) {
-                    pointed_ = pointed_->next;
-    	     	}
-    	     }*/
-    
+
             bool operator!=(const HashIterator& other) const {
-                return this->pointed_ != other.pointed_;
-    	    }
-    
-    	    bool operator==(const HashIterator& other) const {
-    		    return this->pointed_ == other.pointed_;
-    	    }
+                return this->pointed_index_ != other.pointed_index_;
+            }
+
+            bool operator==(const HashIterator& other) const {
+                return this->pointed_index_ == other.pointed_index_;
+            }
         };
-    
-        /* The actual hashtable with list chaining */
-        std::vector<List<HashElement> * > hashtable_;
-        size_t size_, elements_;
+
+        static const uint32_t INFO_DISTANCE_MASK = 0xFF;
+        static const uint32_t INFO_DISTANCE_ONE = 1;
+
+        std::vector<HashElement> elements_;
+        std::vector<Slot_t> slots_;
+        size_t mask_;
+        unsigned int shift_;
         double max_load_;
-        
+        Hash hasher_;
+
+        /**
+            Get the slot of a hash from its high bits, and other bits of the hash kept in the slot
+        */
+        size_t GetHome(uint64_t hash) const {
+            return static_cast<size_t>(hash >> shift_);
+        }
+
+        uint32_t GetInfo(uint64_t hash) const {
+            return static_cast<uint32_t>(hash) & ~INFO_DISTANCE_MASK;
+        }
+
+        /**
+            Set the number of slots, all empty
+            @param number_of_slots A power of two, at least 2
+        */
+        void SetSlots(size_t number_of_slots) {
+            slots_.assign(number_of_slots, Slot_t());
+            mask_ = number_of_slots - 1;
+            shift_ = 64;
+            while (number_of_slots > 1) {
+                number_of_slots /= 2;
+                shift_--;
+            }
+        }
+
+        /**
+            Place an element in the slots
+            @param index The index of the element
+            @return false = The element got too far from its home slot, and the table has to grow, true = OK
+        */
+        bool PlaceSlot(uint32_t index) {
+            uint64_t hash = elements_[index].hash_;
+            Slot_t carried = { GetInfo(hash) | INFO_DISTANCE_ONE, index };
+            size_t position = GetHome(hash);
+            for (;;) {
+                Slot_t& slot = slots_[position];
+                if (slot.info_ == 0) {
+                    slot = carried;
+                    return true;
+                }
+                /* Robin Hood, the element closer to its home moves on */
+                if ((slot.info_ & INFO_DISTANCE_MASK) < (carried.info_ & INFO_DISTANCE_MASK)) {
+                    Slot_t temp = slot;
+                    slot = carried;
+                    carried = temp;
+                }
+                if ((carried.info_ & INFO_DISTANCE_MASK) == INFO_DISTANCE_MASK) return false;
+                carried.info_ += INFO_DISTANCE_ONE;
+                position = (position + 1) & mask_;
+            }
+        }
+
         /**
-            Double the size of the hashtable and re-insert all the elements
+            Set the number of slots, and place all the elements again
+            @param number_of_slots A power of two
         */
-        void Rehash() {
-            size_ = 2 * size_;
-            std::vector<List<HashElement> *> temp;
-            temp = hashtable_;
-            hashtable_ = std::vector<List<HashElement> *> (size_, nullptr);
-            elements_ = 0;
-            for(typename std::vector<List<HashElement> *>::iterator itr = temp.begin(); itr!=temp.end(); ++itr){
-                if (*itr != nullptr)
-                    for(typename List<HashElement>::iterator itr2 = (*itr)->begin(); itr2 != (*itr)->end(); ++itr2) {
-                        Insert((*itr2).key_, (*itr2).value_);
-                    }
+        void Rehash(size_t number_of_slots) {
+            for (;;) {
+                SetSlots(number_of_slots);
+
+                bool placed = true;
+                for (size_t i = 0; i < elements_.size() && placed; i++) placed = PlaceSlot(static_cast<uint32_t>(i));
+                if (placed) return;
+                number_of_slots *= 2;
             }
         }
-    
+
         /**
             Get the hash value for a key
             @param key The key to get the hash
             @return The hash value
         */
-        size_t GetHash(Key key) const {
-            return std::hash<Key>{}(key) % size_;
+        template<typename K> uint64_t GetHash(const K& key) const {
+            return hasher_(key);
+        }
+
+        /* Whether a key type other than Key can be looked up, a const char * when the keys are strings */
+        template<typename K> struct IsStringLookup : std::integral_constant<bool,
+            std::is_same<Key, std::string>::value && std::is_convertible<const K&, const char *>::value> {};
+
+        template<typename K> HashIterator FindKey(const K& key) {
+            size_t position = FindSlot(key, GetHash(key));
+            if (position == slots_.size()) return end();
+            return HashIterator(&elements_, slots_[position].index_);
+        }
+
+        template<typename K> bool RemoveKey(const K& key) {
+            size_t position = FindSlot(key, GetHash(key));
+            if (position == slots_.size()) return false;
+
+            RemoveSlot(position);
+            return true;
+        }
+
+        /**
+            Find the slot of a key
+            @param key The key
+            @param hash The hash of the key
+            @return The position of the slot, or the number of slots if the key is not in the table
+        */
+        template<typename K> size_t FindSlot(const K& key, uint64_t hash) const {
+            uint32_t info = GetInfo(hash) | INFO_DISTANCE_ONE;
+            size_t position = GetHome(hash);
+            for (;;) {
+                const Slot_t& slot = slots_[position];
+                /* An empty slot, or an element closer to its home than the key would be */
+                if ((slot.info_ & INFO_DISTANCE_MASK) < (info & INFO_DISTANCE_MASK)) return slots_.size();
+                if (slot.info_ == info && elements_[slot.index_].key_ == key) return position;
+
+                info += INFO_DISTANCE_ONE;
+                position = (position + 1) & mask_;
+            }
         }
-    
+
+        /**
+            Find the slot that points to an element
+            @param index The index of the element
+            @return The position of the slot
+        */
+        size_t FindSlot(uint32_t index) const {
+            size_t position = GetHome(elements_[index].hash_);
+            while (slots_[position].index_ != index || slots_[position].info_ == 0) position = (position + 1) & mask_;
+            return position;
+        }
+
+        /**
+            Remove the element of a slot. The following elements of the cluster move one slot back, and the last
+            element of the array moves to the place of the removed one
+            @param position The position of the slot
+            @return The index of the removed element, now holding the element that was last
+        */
+        size_t RemoveSlot(size_t position) {
+            uint32_t index = slots_[position].index_;
+
+            size_t next = (position + 1) & mask_;
+            while ((slots_[next].info_ & INFO_DISTANCE_MASK) > INFO_DISTANCE_ONE) {
+                slots_[position] = slots_[next];
+                slots_[position].info_ -= INFO_DISTANCE_ONE;
+                position = next;
+                next = (next + 1) & mask_;
+            }
+            slots_[position] = Slot_t();
+
+            uint32_t last = static_cast<uint32_t>(elements_.size() - 1);
+            if (index != last) {
+                slots_[FindSlot(last)].index_ = index;
+                elements_[index] = elements_[last];
+            }
+            elements_.pop_back();
+            return index;
+        }
+
+        /**
+            Get the smallest power of two that is not smaller than a number
+        */
+        static size_t GetPowerOfTwo(size_t number) {
+            size_t power = 2;
+            while (power < number) power *= 2;
+            return power;
+        }
+
     public:
         /**
             The HashTable's iterator
         */
         typedef HashIterator iterator;
-        
+
         /*
-            Initialize a hash table with a specific size
-            No matter how many elements you insert, the hashtable's size won't change
+            Initialize a hash table with a specific size, rounded up to a power of two. The table grows when the load
+            reaches GAME_ENGINE_HASHTABLE_MAX_LOAD
         */
         HashTable(size_t size){
             if (size <= 0) throw std::out_of_range("Hash table size must be a positive number");
-            hashtable_ = std::vector<List<HashElement> * >(size, nullptr);
-            size_ = size;
-            elements_ = 0;
-            max_load_ = -1;
+            max_load_ = GAME_ENGINE_HASHTABLE_MAX_LOAD;
+            SetSlots(GetPowerOfTwo(size));
         }
-        
+
         /*
-            Initialize a hash table with a specific size and max load (elements/size) equal to max_load
-            When an element is inserted if elements/size > max_load then a rehashing will occur 
-            with the new hashtable size equal to double the previous size
+            Initialize a hash table with a specific size, rounded up to a power of two, and max load (elements/size)
+            equal to max_load, at most GAME_ENGINE_HASHTABLE_MAX_LOAD. When an element is inserted and
+            elements/size > max_load, the size of the table is doubled
         */
         HashTable(size_t size, double max_load){
             if (size <= 0) throw std::out_of_range("Hash table size must be a positive number");
-            hashtable_ = std::vector<List<HashElement> * >(size, nullptr);
-            size_ = size;
-            elements_ = 0;
-            max_load_ = max_load;
+            max_load_ = (max_load > 0 && max_load < GAME_ENGINE_HASHTABLE_MAX_LOAD) ? max_load : GAME_ENGINE_HASHTABLE_MAX_LOAD;
+            SetSlots(GetPowerOfTwo(size));
         }
-        
+
         ~HashTable(){
             Clear();
         }
-    
+
         /*
-            Insert an element to the hashtable. If rehashing is enabled when HashTable was constructed 
-            then this operation might take more time than expected in some cases.
+            Insert an element to the hashtable. If the table has to grow, this operation might take more time than
+            expected in some cases. Iterators are invalidated
             @param key The key of the value to be inserted
             @param value The value to be inserted
             @return true = Ok, false = Already inserted
         */
         bool Insert(Key key, Value value) {
-            size_t hash_value = GetHash(key);
-            
-            HashElement new_elem(key, value);
-            bool ret = false;
-            if (hashtable_.at(hash_value) == nullptr) {
-                hashtable_.at(hash_value) = new List<HashElement>(new_elem);
-                ret = true;
-            } else {
-                List<HashElement> * hashed_elems = hashtable_.at(hash_value);
-                
-                if (hashed_elems->FindForward(new_elem) == hashed_elems->end()){
-                    /* If element does not exist in the bucket list */
-                    hashed_elems->PushTop(new_elem);
-                    ret = true;
-                }
-                
-                /* If it exists, dont do anything */
+            uint64_t hash = GetHash(key);
+            if (FindSlot(key, hash) != slots_.size()) return false;
+
+            elements_.push_back(HashElement(key, value, hash));
+            if (elements_.size() > max_load_ * slots_.size()) {
+                Rehash(2 * slots_.size());
+            } else if (!PlaceSlot(static_cast<uint32_t>(elements_.size() - 1))) {
+                /* The slots changed on the way, place everything again */
+                Rehash(2 * slots_.size());
             }
-            
-            if (ret) elements_++;
-            
-            if ((max_load_ > 0) && (GetLoad() >= max_load_)) Rehash();
-            return ret;
+            return true;
         }
-        
+
         /**
               Get an iterator to the beginning
         */
         HashIterator begin() {
-            size_t i = 0;
-            while(i < hashtable_.size() && hashtable_.at(i) == nullptr) i++;
-            if (i == hashtable_.size()) return HashIterator(nullptr, &hashtable_, hashtable_.size());
-            
-            HashElement * first = hashtable_.at(i)->PeekTop();
-            return HashIterator(first, &hashtable_, i);
-        }
-        
+            return HashIterator(&elements_, 0);
+        }
+
         /**
             Get an iterator to the end. Incrementing or derefercing, or in any way using it,
-            expect for comparison, is not recommended            
+            expect for comparison, is not recommended
         */
         HashIterator end() {
-            return HashIterator(nullptr, &hashtable_, hashtable_.size());
+            return HashIterator(&elements_, elements_.size());
         }
-        
+
         /*
             Search for an element in the HashTable, if not found you get the and end() iterator
             @param key The key to be searched
             @return An iterator to the element, use GetKey(), and GetValue()
         */
-        HashIterator Find(Key key) const {
-            size_t hash_value = GetHash(key);
-            
-            if (hashtable_.at(hash_value) == nullptr) return HashIterator(nullptr, &hashtable_, hashtable_.size());
-            
-            List<HashElement> * hashed_elems = hashtable_.at(hash_value);
-            typename List<HashElement>::iterator itr = hashed_elems->FindForward(HashElement(key, Value()));
-            if (itr != hashed_elems->end()) {
-                return HashIterator(&(*itr), &hashtable_, hash_value);
-            }
-            
-            return HashIterator(nullptr, &hashtable_, hashtable_.size());
+        HashIterator Find(const Key& key) {
+            return FindKey(key);
+        }
+
+        /*
+            Search for an element with a string key using a const char *, without creating an std::string
+            @param key The key to be searched
+            @return An iterator to the element, use GetKey(), and GetValue()
+        */
+        template<typename K, typename std::enable_if<IsStringLookup<K>::value, int>::type = 0> HashIterator Find(const K& key) {
+            return FindKey(key);
         }
-        
+
+        /* Other key types would be converted to Key silently, e.g. an unsigned to an int */
+        template<typename K, typename std::enable_if<!IsStringLookup<K>::value && !std::is_same<K, Key>::value, int>::type = 0> HashIterator Find(const K& key) = delete;
+
         /*
-            Remove an element from the hash table
+            Remove an element from the hash table. Iterators are invalidated
             @param key The key of the element to remove
             @return true = Removed, false = Not found
         */
-        bool Remove(Key key) {
-            size_t hash_value = GetHash(key);
-            
-            bool ret = false;
-            if (hashtable_.at(hash_value) != NULL) 
-                ret = hashtable_.at(hash_value)->Remove(HashElement(key, Value()));
-            
-            if (ret) {
-                elements_--;
-                return false;
-            }
-            
-            return true;
+        bool Remove(const Key& key) {
+            return RemoveKey(key);
+        }
+
+        /*
+            Remove an element with a string key using a const char *. Iterators are invalidated
+            @param key The key of the element to remove
+            @return true = Removed, false = Not found
+        */
+        template<typename K, typename std::enable_if<IsStringLookup<K>::value, int>::type = 0> bool Remove(const K& key) {
+            return RemoveKey(key);
+        }
+
+        template<typename K, typename std::enable_if<!IsStringLookup<K>::value && !std::is_same<K, Key>::value, int>::type = 0> bool Remove(const K& key) = delete;
+
+        /*
+            Remove the element of an iterator, can be used while iterating. The last element takes its place, so
+            the elements that were not visited yet are all visited once
+            @param itr An iterator to an element
+            @return An iterator to the element after the removed one
+        */
+        HashIterator Erase(HashIterator itr) {
+            size_t index = RemoveSlot(FindSlot(static_cast<uint32_t>(itr.pointed_index_)));
+            return HashIterator(&elements_, index);
         }
-        
+
         /*
-            Get hash table's current size. If rehashing is enabled then this value might differ from the one given
-            during object construction
+            Get hash table's current size, the number of slots. Might differ from the one given during
+            object construction
             @return The size
         */
         size_t GetSize() const {
-            return size_;
+            return slots_.size();
         }
-        
+
         /*
               Get number of elements inserted in the hash table
               @return Number of elements
         */
         size_t GetNumberOfElements() const {
-            return elements_;
+            return elements_.size();
         }
-        
+
         /*
               Get the load of the hash table as (inserted elements/ size)
               @return Table load
         */
         double GetLoad() const {
-            return (1.0*elements_) / (1.0*size_);
+            return (1.0 * elements_.size()) / (1.0 * slots_.size());
         }
-        
+
         /*
-              Prints the hash table in a relatively nice format
+              Prints the hash table in a relatively nice format, one slot per line
         */
         void PrettyPrint() const {
             std::cout << "Hash table:" << std::endl;
-            for(typename std::vector<List<HashElement> * >::const_iterator itr = hashtable_.begin(); itr!=hashtable_.end(); ++itr){
-                if (*itr != nullptr)
-                    for (typename List<HashElement>::iterator itr2 = (*itr)->begin(); itr2 != (*itr)->end(); ++itr2) 
-                        std:: cout << "(" << (*itr2).key_ << "," << (*itr2).value_ << ")" << " -> ";
-                std::cout << "null" << std::endl;
+            for (size_t i = 0; i < slots_.size(); i++) {
+                if (slots_[i].info_ != 0) {
+                    const HashElement& element = elements_[slots_[i].index_];
+                    std::cout << "(" << element.key_ << "," << element.value_ << ")" << " distance " << (slots_[i].info_ & INFO_DISTANCE_MASK) - 1 << std::endl;
+                } else {
+                    std::cout << "null" << std::endl;
+                }
             }
         }
-        
+
         /*
-            Removes all the inserted elements in the table
+            Removes all the inserted elements in the table, keeps the size
         */
         void Clear(){
-            for(typename std::vector<List<HashElement> *>::iterator itr = hashtable_.begin(); itr!=hashtable_.end(); ++itr) {
-                delete *itr;
-                *itr = nullptr;
-            }
-            elements_ = 0;
+            elements_.clear();
+            slots_.assign(slots_.size(), Slot_t());
         }
     };
 
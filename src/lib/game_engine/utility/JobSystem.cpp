@@ -0,0 +1,291 @@
+#include "JobSystem.hpp"
+
+#include "debug_tools/Console.hpp"
+namespace dt = debug_tools;
+
+/* Number of jobs in the ring of a thread, more than the queue can hold, so that free slots are found quickly */
+#define JOB_SYSTEM_RING_SIZE (2 * JOB_SYSTEM_QUEUE_SIZE)
+
+namespace game_engine {
+
+namespace utility {
+
+    /* The job system and the index of the calling thread, set for the thread that called Init() and the workers */
+    static thread_local JobSystem * thread_job_system = nullptr;
+    static thread_local int thread_index = -1;
+
+    JobSystem::JobQueue::JobQueue() : top_(0), bottom_(0) {
+        for (size_t i = 0; i < JOB_SYSTEM_QUEUE_SIZE; i++) jobs_[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    bool JobSystem::JobQueue::Push(Job * job) {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        if (b - t >= JOB_SYSTEM_QUEUE_SIZE) return false;
+
+        jobs_[b & (JOB_SYSTEM_QUEUE_SIZE - 1)].store(job, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    Job * JobSystem::JobQueue::Pop() {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            /* Empty */
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Job * job = jobs_[b & (JOB_SYSTEM_QUEUE_SIZE - 1)].load(std::memory_order_relaxed);
+        if (t == b) {
+            /* Last job, race against the thieves */
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) job = nullptr;
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    Job * JobSystem::JobQueue::Steal() {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) return nullptr;
+
+        Job * job = jobs_[t & (JOB_SYSTEM_QUEUE_SIZE - 1)].load(std::memory_order_relaxed);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) return nullptr;
+        return job;
+    }
+
+    JobSystem::JobSystem() {
+        is_inited_ = false;
+    }
+
+    JobSystem::~JobSystem() {
+        Destroy();
+    }
+
+    int JobSystem::Init(size_t number_of_threads) {
+        if (is_inited_) return -1;
+
+        static_assert((JOB_SYSTEM_QUEUE_SIZE & (JOB_SYSTEM_QUEUE_SIZE - 1)) == 0, "JOB_SYSTEM_QUEUE_SIZE must be a power of two");
+
+        if (number_of_threads == 0) number_of_threads = std::thread::hardware_concurrency();
+        if (number_of_threads == 0) number_of_threads = 1;
+
+        run_ = true;
+        queued_jobs_ = 0;
+        sleeping_workers_ = 0;
+        sleeping_waiters_ = 0;
+        thread_data_.clear();
+        for (size_t i = 0; i < number_of_threads; i++) {
+            ThreadData * data = new ThreadData();
+            data->jobs_ = std::unique_ptr<Job[]>(new Job[JOB_SYSTEM_RING_SIZE]);
+            data->next_job_ = 0;
+            thread_data_.push_back(std::unique_ptr<ThreadData>(data));
+        }
+
+        /* The first queue is used by the calling thread */
+        thread_job_system = this;
+        thread_index = 0;
+        for (size_t i = 1; i < number_of_threads; i++) threads_.push_back(std::thread(&JobSystem::run, this, (int)i));
+
+        is_inited_ = true;
+        return 0;
+    }
+
+    int JobSystem::Destroy() {
+        if (!is_inited_) return -1;
+
+        {
+            std::unique_lock<std::mutex> l(sleep_lock_);
+            run_ = false;
+        }
+        worker_condition_.notify_all();
+        for (size_t i = 0; i < threads_.size(); i++) threads_[i].join();
+        threads_.clear();
+
+        /* Execute anything left, in case there were no worker threads */
+        int thread = GetThreadIndex();
+        Job * job;
+        while ((job = GetJob(thread)) != nullptr) Execute(job);
+
+        if (thread_job_system == this) {
+            thread_job_system = nullptr;
+            thread_index = -1;
+        }
+
+        is_inited_ = false;
+        return 0;
+    }
+
+    bool JobSystem::IsInited() {
+        return is_inited_;
+    }
+
+    size_t JobSystem::GetNumberOfThreads() {
+        return thread_data_.size();
+    }
+
+    void JobSystem::Wait(JobCounter * counter) {
+        int thread = GetThreadIndex();
+        while (!counter->IsDone()) {
+            Job * job = GetJob(thread);
+            if (job != nullptr) {
+                Execute(job);
+                continue;
+            }
+
+            /* Nothing to help with, sleep until the counter finishes, or more jobs are scheduled */
+            std::unique_lock<std::mutex> l(sleep_lock_);
+            sleeping_waiters_++;
+            wait_condition_.wait(l, [&]() { return counter->IsDone() || queued_jobs_.load() > 0; });
+            sleeping_waiters_--;
+        }
+
+        /* The thread that finished the last job might still be scheduling the continuations */
+        while (counter->users_.load() > 0) std::this_thread::yield();
+    }
+
+    int JobSystem::GetThreadIndex() {
+        if (thread_job_system == this) return thread_index;
+        return -1;
+    }
+
+    Job * JobSystem::AllocateJob() {
+        int thread = GetThreadIndex();
+        if (thread < 0) {
+            Job * job = new Job();
+            job->heap_ = true;
+            job->in_use_.store(true, std::memory_order_relaxed);
+            return job;
+        }
+
+        /* Find the next free slot in the ring of the thread */
+        ThreadData& data = *thread_data_[thread];
+        for (size_t i = 0; i < JOB_SYSTEM_RING_SIZE; i++) {
+            Job * job = &data.jobs_[data.next_job_];
+            data.next_job_ = (data.next_job_ + 1) % JOB_SYSTEM_RING_SIZE;
+            if (!job->in_use_.load(std::memory_order_acquire)) {
+                job->in_use_.store(true, std::memory_order_relaxed);
+                return job;
+            }
+        }
+
+        /* Every slot is taken by a waiting continuation or a running job */
+        Job * job = new Job();
+        job->heap_ = true;
+        job->in_use_.store(true, std::memory_order_relaxed);
+        return job;
+    }
+
+    void JobSystem::Push(Job * job) {
+        int thread = GetThreadIndex();
+
+        queued_jobs_++;
+        if (thread < 0) {
+            std::unique_lock<std::mutex> l(external_lock_);
+            external_jobs_.push_back(job);
+        } else if (!thread_data_[thread]->queue_.Push(job)) {
+            /* Queue is full */
+            queued_jobs_--;
+            Execute(job);
+            return;
+        }
+
+        WakeUp();
+    }
+
+    Job * JobSystem::GetJob(int thread) {
+        Job * job = nullptr;
+
+        /* Newest job of the own queue first */
+        if (thread >= 0) job = thread_data_[thread]->queue_.Pop();
+
+        /* Then steal the oldest job of another queue */
+        size_t number_of_threads = thread_data_.size();
+        size_t start = (thread >= 0) ? thread : 0;
+        for (size_t i = 1; job == nullptr && i <= number_of_threads; i++) {
+            size_t other = (start + i) % number_of_threads;
+            if ((int)other == thread) continue;
+            job = thread_data_[other]->queue_.Steal();
+        }
+
+        /* And finally the jobs scheduled from outside */
+        if (job == nullptr) {
+            std::unique_lock<std::mutex> l(external_lock_);
+            if (!external_jobs_.empty()) {
+                job = external_jobs_.front();
+                external_jobs_.pop_front();
+            }
+        }
+
+        if (job != nullptr) queued_jobs_--;
+        return job;
+    }
+
+    void JobSystem::Execute(Job * job) {
+        JobCounter * counter = job->counter_;
+        job->function_();
+
+        if (job->heap_) delete job;
+        else job->in_use_.store(false, std::memory_order_release);
+
+        if (counter == nullptr) return;
+
+        /* A waiting thread can destroy the counter once it's done, unless users_ is non zero */
+        counter->users_++;
+        if (counter->pending_.fetch_sub(1) != 1) {
+            counter->users_--;
+            return;
+        }
+
+        /* The counter finished, schedule its continuations, and wake up the threads waiting on it */
+        std::vector<Job *> continuations;
+        {
+            std::unique_lock<std::mutex> l(counter->lock_);
+            continuations.swap(counter->continuations_);
+        }
+        counter->users_--;
+
+        for (size_t i = 0; i < continuations.size(); i++) Push(continuations[i]);
+        WakeUp();
+    }
+
+    void JobSystem::WakeUp() {
+        if (sleeping_workers_.load() == 0 && sleeping_waiters_.load() == 0) return;
+
+        /* Take the sleep lock, so that a thread can't miss the notification between checking and sleeping */
+        {
+            std::unique_lock<std::mutex> l(sleep_lock_);
+        }
+        worker_condition_.notify_one();
+        wait_condition_.notify_all();
+    }
+
+    void JobSystem::run(int thread) {
+        thread_job_system = this;
+        thread_index = thread;
+
+        while (1) {
+            Job * job = GetJob(thread);
+            if (job != nullptr) {
+                Execute(job);
+                continue;
+            }
+
+            /* Sleep until a job is scheduled */
+            std::unique_lock<std::mutex> l(sleep_lock_);
+            sleeping_workers_++;
+            worker_condition_.wait(l, [&]() { return queued_jobs_.load() > 0 || !run_; });
+            sleeping_workers_--;
+            if (!run_ && queued_jobs_.load() == 0) break;
+        }
+    }
+
+}
+}
@@ -0,0 +1,322 @@
+#ifndef __JobSystem_hpp__
+#define __JobSystem_hpp__
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <new>
+#include <utility>
+#include <type_traits>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+/* Size of the inline storage of a job function. Larger functors don't compile, capture by reference instead */
+#define JOB_SYSTEM_FUNCTION_SIZE 64
+/* Maximum number of jobs waiting in the queue of a thread. When full, jobs are executed immediately */
+#define JOB_SYSTEM_QUEUE_SIZE 4096
+
+namespace game_engine {
+
+namespace utility {
+
+    class JobSystem;
+    class JobCounter;
+
+    /**
+        A type erased functor, with inline storage, that doesn't allocate
+    */
+    class JobFunction {
+    public:
+        JobFunction() : invoke_(nullptr), destroy_(nullptr) {};
+
+        ~JobFunction() {
+            Reset();
+        }
+
+        /**
+            Store a functor
+            @param func A functor, i.e a lambda expression, a function, a struct with the operator() defined e.t.c
+        */
+        template<typename F> void Set(F&& func) {
+            typedef typename std::decay<F>::type Functor;
+            static_assert(sizeof(Functor) <= JOB_SYSTEM_FUNCTION_SIZE, "Job function is too large, capture by reference");
+            static_assert(alignof(Functor) <= alignof(std::max_align_t), "Job function alignment is not supported");
+
+            Reset();
+            new (storage_) Functor(std::forward<F>(func));
+            invoke_ = [](void * storage) { (*reinterpret_cast<Functor *>(storage))(); };
+            destroy_ = [](void * storage) { reinterpret_cast<Functor *>(storage)->~Functor(); };
+        }
+
+        /**
+            Call the functor, and destroy it
+        */
+        void operator()() {
+            invoke_(storage_);
+            Reset();
+        }
+
+    private:
+        alignas(std::max_align_t) unsigned char storage_[JOB_SYSTEM_FUNCTION_SIZE];
+        void (*invoke_)(void *);
+        void (*destroy_)(void *);
+
+        void Reset() {
+            if (destroy_ != nullptr) destroy_(storage_);
+            invoke_ = nullptr;
+            destroy_ = nullptr;
+        }
+
+        JobFunction(const JobFunction&) = delete;
+        JobFunction& operator=(const JobFunction&) = delete;
+    };
+
+    /* A scheduled function */
+    struct Job {
+        Job() : counter_(nullptr), in_use_(false), heap_(false) {};
+
+        JobFunction function_;
+        JobCounter * counter_;
+        /* Set while the job is scheduled or executing, the slot in the ring of its thread can't be reused */
+        std::atomic<bool> in_use_;
+        /* Allocated on the heap, by a thread outside of the job system */
+        bool heap_;
+    };
+
+    /**
+        Counts the scheduled jobs that have not finished yet. Wait on it with JobSystem::Wait(), or schedule jobs
+        to run when it reaches zero with JobSystem::ScheduleAfter()
+    */
+    class JobCounter {
+        friend JobSystem;
+    public:
+        JobCounter() : pending_(0), users_(0) {};
+
+        /**
+            Check whether all the jobs counted have finished
+            @return true = Finished, false = Not finished
+        */
+        bool IsDone() {
+            return pending_.load(std::memory_order_acquire) == 0;
+        }
+
+    private:
+        std::atomic<size_t> pending_;
+        /* Threads that are finishing a job of this counter, and might still access it */
+        std::atomic<size_t> users_;
+        /* Jobs to schedule when the counter reaches zero */
+        std::mutex lock_;
+        std::vector<Job *> continuations_;
+    };
+
+    /**
+        A pool of worker threads, sized to the hardware thread count. Every thread has its own lock free work stealing
+        deque (Chase-Lev) of jobs. A thread executes its own jobs newest first, and when it runs out of jobs it steals
+        the oldest jobs of the other threads. The thread that calls Init() takes part in the work while it waits on a
+        JobCounter. Jobs and their functors are stored in a ring per thread, scheduling does not allocate
+    */
+    class JobSystem {
+    public:
+        /**
+            Does nothing explicit. See Init()
+        */
+        JobSystem();
+
+        /**
+            Calls Destroy()
+        */
+        ~JobSystem();
+
+        /**
+            Starts the worker threads
+            @param number_of_threads The total number of threads to use, including the calling thread.
+                0 = The number of hardware threads
+            @return 0 = OK, -1 = Already initialised
+        */
+        int Init(size_t number_of_threads = 0);
+
+        /**
+            Executes all remaining jobs, and stops the worker threads
+            @return 0 = OK, -1 = Not initialised
+        */
+        int Destroy();
+
+        /**
+            Check whether the job system is initialised
+            @return Is initialised
+        */
+        bool IsInited();
+
+        /**
+            Get the number of threads that execute jobs, including the thread that called Init()
+            @return The number of threads
+        */
+        size_t GetNumberOfThreads();
+
+        /**
+            Schedule a job to the queue of the calling thread. Returns immediately
+            @param func A functor, i.e a lambda expression, a function, a struct with the operator() defined e.t.c
+            @param counter A counter to increase, and decrease when the job finishes. Can be nullptr
+        */
+        template<typename F> void Schedule(F&& func, JobCounter * counter) {
+            if (counter != nullptr) counter->pending_.fetch_add(1, std::memory_order_relaxed);
+
+            Job * job = AllocateJob();
+            job->function_.Set(std::forward<F>(func));
+            job->counter_ = counter;
+            Push(job);
+        }
+
+        /**
+            Schedule a job to run after all the jobs of a counter have finished. If they have already finished, the
+            job is scheduled immediately
+            @param dependency The counter to wait for
+            @param func A functor
+            @param counter A counter to increase, and decrease when the job finishes. Can be nullptr
+        */
+        template<typename F> void ScheduleAfter(JobCounter * dependency, F&& func, JobCounter * counter) {
+            if (counter != nullptr) counter->pending_.fetch_add(1, std::memory_order_relaxed);
+
+            Job * job = AllocateJob();
+            job->function_.Set(std::forward<F>(func));
+            job->counter_ = counter;
+
+            {
+                std::unique_lock<std::mutex> l(dependency->lock_);
+                if (!dependency->IsDone()) {
+                    dependency->continuations_.push_back(job);
+                    return;
+                }
+            }
+            Push(job);
+        }
+
+        /**
+            Execute jobs until all the jobs of a counter have finished. Sleeps if there is nothing to execute
+            @param counter The counter
+        */
+        void Wait(JobCounter * counter);
+
+        /**
+            Split a range of indices into batches, execute the batches in parallel, and wait for all of them.
+            The batches depend only on the count and the batch size, not on the number of threads
+            @param count The number of indices, [0, count)
+            @param batch_size The number of indices in every batch
+            @param func Called once for every batch as func(batch index, start, end), with the range [start, end)
+        */
+        template<typename F> void ParallelFor(size_t count, size_t batch_size, F func) {
+            if (batch_size == 0) batch_size = 1;
+
+            JobCounter counter;
+            size_t batch = 0;
+            for (size_t start = 0; start < count; start += batch_size, batch++) {
+                size_t end = std::min(start + batch_size, count);
+                Schedule([&func, batch, start, end]() {
+                    func(batch, start, end);
+                }, &counter);
+            }
+
+            Wait(&counter);
+        }
+
+    private:
+        /* The Chase-Lev work stealing deque of a thread. Only the owner pushes and pops, any thread steals */
+        class JobQueue {
+        public:
+            JobQueue();
+
+            /**
+                Push a job at the bottom, owner only
+                @return false = The queue is full
+            */
+            bool Push(Job * job);
+
+            /**
+                Pop the newest job from the bottom, owner only
+                @return The job, nullptr if empty
+            */
+            Job * Pop();
+
+            /**
+                Steal the oldest job from the top, any thread
+                @return The job, nullptr if empty or another thread took it first
+            */
+            Job * Steal();
+
+        private:
+            std::atomic<int64_t> top_;
+            std::atomic<int64_t> bottom_;
+            std::atomic<Job *> jobs_[JOB_SYSTEM_QUEUE_SIZE];
+        };
+
+        /* The queue and the ring of jobs of a thread */
+        struct ThreadData {
+            JobQueue queue_;
+            std::unique_ptr<Job[]> jobs_;
+            size_t next_job_;
+        };
+
+        bool is_inited_;
+        bool run_;
+        std::vector<std::thread> threads_;
+        std::vector<std::unique_ptr<ThreadData>> thread_data_;
+
+        /* Jobs scheduled by threads outside of the job system */
+        std::mutex external_lock_;
+        std::deque<Job *> external_jobs_;
+
+        /* Number of scheduled jobs that haven't started yet, threads sleep while zero */
+        std::atomic<size_t> queued_jobs_;
+        std::mutex sleep_lock_;
+        std::condition_variable worker_condition_;
+        std::condition_variable wait_condition_;
+        /* Number of sleeping threads, notifications are sent only if there is someone to wake up */
+        std::atomic<size_t> sleeping_workers_;
+        std::atomic<size_t> sleeping_waiters_;
+
+        /**
+            Get the index of the calling thread
+            @return The index, -1 if it's not part of the job system
+        */
+        int GetThreadIndex();
+
+        /**
+            Get a job from the ring of the calling thread, or from the heap for other threads
+            @return The job
+        */
+        Job * AllocateJob();
+
+        /**
+            Schedule a job. If the queue of the thread is full, the job is executed immediately
+        */
+        void Push(Job * job);
+
+        /**
+            Take a job, from the queue of the thread first, or steal one from the other queues
+            @param thread The index of the calling thread, -1 for threads outside of the job system
+            @return The job, nullptr if there are no jobs
+        */
+        Job * GetJob(int thread);
+
+        /**
+            Execute a job, decrease its counter, and schedule the continuations of the counter if it reached zero
+        */
+        void Execute(Job * job);
+
+        /**
+            Wake up the sleeping threads, after a job was scheduled or a counter finished
+        */
+        void WakeUp();
+
+        void run(int thread);
+    };
+
+}
+}
+
+#endif
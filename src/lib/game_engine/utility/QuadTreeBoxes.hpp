@@ -26,8 +26,9 @@ namespace game_engine { namespace utility {
         centered at (0,0). For example, origin = (-5, -5), length = 10
         BUCKET_SIZE = How many boxes to hold at last depth
         MAX_DEPTH = The max depth of the tree
+        Results = The container to push back the ray casting results
     */
-    template<typename Data, int BUCKET_SIZE = 1, int MAX_DEPTH = 13>
+    template<typename Data, int BUCKET_SIZE = 1, int MAX_DEPTH = 13, typename Results = std::vector<Data>>
     class QuadTreeBoxes {
     private:
         class QuadTreeBoxesNode {
@@ -51,7 +52,7 @@ namespace game_engine { namespace utility {
             virtual QuadTreeBoxesNode * Insert(Data data, AABox<2> box, std::unordered_map<Data, AABox<2>>& boxes, size_t depth) = 0;
             virtual size_t Depth() = 0;
     
-            virtual bool RayCastProcessChild(Real_t tx0, Real_t ty0, Real_t tx1, Real_t ty1, unsigned char a, Ray2D& ray, std::unordered_map<Data, AABox<2>>& boxes, std::vector<Data>& results) = 0;
+            virtual bool RayCastProcessChild(Real_t tx0, Real_t ty0, Real_t tx1, Real_t ty1, unsigned char a, Ray2D& ray, std::unordered_map<Data, AABox<2>>& boxes, Results& results) = 0;
     
         protected:
             NodeType type_;
@@ -133,7 +134,7 @@ namespace game_engine { namespace utility {
                 return 0;
             }
     
-            bool RayCastProcessChild(Real_t tx0, Real_t ty0, Real_t tx1, Real_t ty1, unsigned char a, Ray2D& ray, std::unordered_map<Data, AABox<2>>& boxes, std::vector<Data>& results) {
+            bool RayCastProcessChild(Real_t tx0, Real_t ty0, Real_t tx1, Real_t ty1, unsigned char a, Ray2D& ray, std::unordered_map<Data, AABox<2>>& boxes, Results& results) {
     
                 if (tx1 < 0 || ty1 < 0) return false;
     
@@ -207,7 +208,7 @@ namespace game_engine { namespace utility {
                 return current_depth + 1;
             }
     
-            bool RayCastProcessChild(Real_t tx0, Real_t ty0, Real_t tx1, Real_t ty1, unsigned char a, Ray2D& ray, std::unordered_map<Data, AABox<2>>& boxes, std::vector<Data>& results) {
+            bool RayCastProcessChild(Real_t tx0, Real_t ty0, Real_t tx1, Real_t ty1, unsigned char a, Ray2D& ray, std::unordered_map<Data, AABox<2>>& boxes, Results& results) {
                 Real_t txm, tym;
                 int current_node;
     
@@ -329,7 +330,7 @@ namespace game_engine { namespace utility {
             @param r The 2D space ray
             @param[out] results The results will be pushed back here, in first to hit order
         */
-        bool RayCast(Ray2D r, std::vector<Data>& results) {
+        bool RayCast(Ray2D r, Results& results) {
             Ray2D original_ray = r;
     
             unsigned char a = 0;
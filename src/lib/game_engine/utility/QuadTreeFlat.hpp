@@ -0,0 +1,635 @@
+#ifndef __QuadTreeFlat_hpp__
+#define __QuadTreeFlat_hpp__
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include "game_engine/math/Types.hpp"
+#include "game_engine/math/AABox.hpp"
+#include "game_engine/math/Geometry.hpp"
+
+#include "debug_tools/Assert.hpp"
+#include "debug_tools/Console.hpp"
+
+namespace dt = debug_tools;
+
+namespace game_engine { namespace utility {
+
+    /**
+        A Quad tree that holds points in 2D space, of type Data, with a BUCKET_SIZE for the leaf nodes, and a MAXIMUM DEPTH.
+        Same interface as the QuadTree, but the nodes and the points are kept in two contiguous arenas, and referenced
+        by index. The four children of a node are allocated as one block, in Morton order (child index = 2 * x + y,
+        same as the QuadTree), split and collapse only move points between lists, and all traversals are iterative.
+        After the arenas have grown to the working size, insert, remove and query don't allocate.
+        A leaf is split when it exceeds BUCKET_SIZE points, but four sibling leaves are only collapsed when they hold
+        COLLAPSE_SIZE points or less, so that a point moving back and forth doesn't split and collapse a node every frame
+    */
+    template<typename Data, int BUCKET_SIZE = 4, int MAX_DEPTH = 13, int COLLAPSE_SIZE = BUCKET_SIZE / 2>
+    class QuadTreeFlat {
+    public:
+
+        /**
+            If you intent to use ray casting, make sure that the area spanned by the quad tree is centered around (0,0)
+            @param origin The "bottom left" point in the quad tree area
+            @param length The size of the quad tree region in all directions
+            @param expected_points Number of points to reserve space for
+        */
+        QuadTreeFlat(math::Vector2D origin, Real_t length, size_t expected_points = 0) {
+            origin_ = origin;
+            length_ = length;
+
+            nodes_.reserve(1 + 2 * expected_points / BUCKET_SIZE);
+            points_.reserve(expected_points);
+
+            Reset();
+        }
+
+        /**
+            Delete everything. The tree is left with an empty root, and can still be used
+        */
+        void Destroy() {
+            nodes_ = std::vector<Node>();
+            points_ = std::vector<Point>();
+            Reset();
+        }
+
+        /**
+            Insert a data point into the quad tree
+            @param point The position in 2D space
+            @param data The data to store
+            @return true = OK, false = the point is outside of the quad tree region
+        */
+        bool Insert(math::Vector2D point, Data data) {
+            bool inside_x = point[0] > origin_[0] && (point[0] < origin_[0] + length_);
+            bool inside_y = point[1] > origin_[1] && (point[1] < origin_[1] + length_);
+
+            if (!inside_x || !inside_y) {
+                return false;
+            }
+
+            InsertPoint(0, 0, AllocatePoint(point, data));
+            return true;
+        }
+
+        /**
+            Move a point. If the new position is inside the same leaf, the point is updated in place. Other-wise only
+            the subtree of the smallest node that holds both positions is changed
+            @param old_point The current position of the point
+            @param new_point The new position
+            @param data The data stored at the current position
+            @return true = OK, false = the new position is outside of the quad tree region, and the point is removed,
+                like a Remove() and a failed Insert(). A point not found at the current position, e.g. one that was
+                removed when it left the region, is inserted at the new position
+        */
+        bool Move(math::Vector2D old_point, math::Vector2D new_point, Data data) {
+            bool inside_x = new_point[0] > origin_[0] && (new_point[0] < origin_[0] + length_);
+            bool inside_y = new_point[1] > origin_[1] && (new_point[1] < origin_[1] + length_);
+
+            if (!inside_x || !inside_y) {
+                RemovePoint(old_point, &data);
+                return false;
+            }
+
+            int32_t path[MAX_DEPTH + 2];
+            size_t path_size = FindPath(old_point, path);
+            int32_t leaf = path[path_size - 1];
+
+            int32_t previous;
+            int32_t current = FindPoint(leaf, old_point, &data, previous);
+            if (current == NONE) {
+                InsertPoint(0, 0, AllocatePoint(new_point, data));
+                return true;
+            }
+
+            /* Find the smallest node that holds both positions, where the path of the new position leaves the old path */
+            size_t ancestor = 0;
+            while (ancestor + 1 < path_size) {
+                const Node& n = nodes_[path[ancestor]];
+                if (n.children_ + FindChild(n, new_point) != path[ancestor + 1]) break;
+                ancestor++;
+            }
+
+            /* Still inside the same leaf, just update the position */
+            if (ancestor == path_size - 1) {
+                points_[current].point_ = new_point;
+                return true;
+            }
+
+            /* Move the point from the leaf to the subtree of that node, and collapse the nodes left behind */
+            UnlinkPoint(leaf, current, previous);
+            points_[current].point_ = new_point;
+            InsertPoint(path[ancestor], ancestor, current);
+
+            for (size_t i = path_size - 1; i-- > ancestor;) {
+                if (!Collapse(path[i])) break;
+            }
+            return true;
+        }
+
+        /**
+            Get all points inside an area
+            @param search_box The searching area
+            @param[out] results The points inside the area are pushed back here, any allocator
+        */
+        template<typename Allocator> void QueryRange(math::AABox<2> search_box, std::vector<Data, Allocator>& results) {
+            QueryRangeVisit(search_box, [&results](const Data& data) {
+                results.push_back(data);
+            });
+        }
+
+        /**
+            Get all points inside an area, without allocating
+            @param search_box The searching area
+            @param[out] results A buffer to write the points inside the area
+            @param capacity The size of the results buffer
+            @return The number of points inside the area. If larger than capacity, only the first capacity points were written
+        */
+        size_t QueryRange(math::AABox<2> search_box, Data * results, size_t capacity) {
+            size_t found = 0;
+            QueryRangeVisit(search_box, [&found, results, capacity](const Data& data) {
+                if (found < capacity) results[found] = data;
+                found++;
+            });
+            return found;
+        }
+
+        /**
+            Remove a point from the quad tree. If many points are stored at the same position, the first found is removed
+            @param point The 2D space point to remove
+        */
+        void Remove(math::Vector2D point) {
+            RemovePoint(point, nullptr);
+        }
+
+        /**
+            Remove a point with specific data from the quad tree
+            @param point The 2D space point to remove
+            @param data The data stored at that point
+        */
+        void Remove(math::Vector2D point, Data data) {
+            RemovePoint(point, &data);
+        }
+
+        /**
+            Get the depth of the tree
+            @return The depth, zero if the tree is a single leaf
+        */
+        size_t Depth() {
+            size_t max_depth = 0;
+            std::pair<int32_t, size_t> stack[STACK_SIZE];
+            size_t stack_size = 0;
+            stack[stack_size++] = std::make_pair(0, 0);
+            while (stack_size > 0) {
+                std::pair<int32_t, size_t> top = stack[--stack_size];
+                max_depth = std::max(max_depth, top.second);
+
+                int32_t children = nodes_[top.first].children_;
+                if (children == NONE) continue;
+                for (int32_t i = 0; i < 4; i++) stack[stack_size++] = std::make_pair(children + i, top.second + 1);
+            }
+            return max_depth;
+        }
+
+        /**
+            Get the number of points stored
+            @return The number of points
+        */
+        size_t Size() {
+            return size_;
+        }
+
+        /**
+            Perform ray traversal
+            @param r The 2D space ray
+            @param[out] results The results will be pushed back here, in first to hit order, any allocator
+        */
+        template<typename Allocator> void RayCast(math::Ray2D r, std::vector<Data, Allocator>& results) {
+            unsigned char a = 0;
+
+            /**
+                If ray has negative components calculate the reflection of the ray
+            */
+            if (r.Direction()[0] < 0) {
+                r.Origin()[0] = (origin_[0] + length_ / Real_t(2)) * Real_t(2) - r.Origin()[0];
+                r.Direction()[0] = -r.Direction()[0];
+                a |= 2;
+            }
+            if (r.Direction()[1] < 0) {
+                r.Origin()[1] = (origin_[1] + length_ / Real_t(2)) * Real_t(2) - r.Origin()[1];
+                r.Direction()[1] = -r.Direction()[1];
+                a |= 1;
+            }
+
+            /*
+                Compute the starting parametric values of entry and exit for the root node
+            */
+            Real_t divx = Real_t(1) / r.Direction()[0];
+            Real_t divy = Real_t(1) / r.Direction()[1];
+
+            Real_t tx0 = (origin_[0] - r.Origin()[0]) * divx;
+            Real_t tx1 = (origin_[0] + length_ - r.Origin()[0]) * divx;
+            Real_t ty0 = (origin_[1] - r.Origin()[1]) * divy;
+            Real_t ty1 = (origin_[1] + length_ - r.Origin()[1]) * divy;
+
+            /* If there is no intersection, stop */
+            if (!(std::max(tx0, ty0) < std::min(tx1, ty1))) return;
+
+            /* The recursive traversal of the QuadTree with an explicit stack, a frame for every inner node in the current path */
+            RayFrame stack[MAX_DEPTH + 2];
+            size_t stack_size = 0;
+            if (!RayCastVisit(0, tx0, ty0, tx1, ty1, stack, stack_size, results)) return;
+
+            while (stack_size > 0) {
+                RayFrame& f = stack[stack_size - 1];
+                if (f.current_ >= 4) {
+                    stack_size--;
+                    continue;
+                }
+
+                int32_t child = f.children_ + (f.current_ ^ a);
+                switch (f.current_)
+                {
+                case 0: {
+                    f.current_ = RayCastNewNode(f.txm_, 2, f.tym_, 1);
+                    RayCastVisit(child, f.tx0_, f.ty0_, f.txm_, f.tym_, stack, stack_size, results);
+                    break;
+                } case 1: {
+                    f.current_ = RayCastNewNode(f.txm_, 3, f.ty1_, 4);
+                    RayCastVisit(child, f.tx0_, f.tym_, f.txm_, f.ty1_, stack, stack_size, results);
+                    break;
+                } case 2: {
+                    f.current_ = RayCastNewNode(f.tx1_, 4, f.tym_, 3);
+                    RayCastVisit(child, f.txm_, f.ty0_, f.tx1_, f.tym_, stack, stack_size, results);
+                    break;
+                } case 3: {
+                    f.current_ = 4;
+                    RayCastVisit(child, f.txm_, f.tym_, f.tx1_, f.ty1_, stack, stack_size, results);
+                    break;
+                }
+                }
+            }
+        }
+
+    private:
+        static const int32_t NONE = -1;
+        /* Pending nodes in a depth first traversal, at most three siblings per level and the four children of the last */
+        static const size_t STACK_SIZE = 3 * (MAX_DEPTH + 1) + 4;
+
+        /* A node of the tree. Inner nodes point to a block of four children, leaves to a list of points */
+        struct Node {
+            Real_t origin_x_;
+            Real_t origin_y_;
+            Real_t length_;
+            /* Index of the first of the four children, NONE for a leaf. For a free block, the next free block */
+            int32_t children_;
+            /* Index of the first point, and number of points, for a leaf */
+            int32_t points_;
+            int32_t count_;
+        };
+
+        /* A data point, in a singly linked list of a leaf or in the free list */
+        struct Point {
+            math::Vector2D point_;
+            Data data_;
+            int32_t next_;
+        };
+
+        /* A ray traversal stack frame, holds the parametric values of an inner node, and the next child to visit */
+        struct RayFrame {
+            int32_t children_;
+            int current_;
+            Real_t tx0_, ty0_, tx1_, ty1_, txm_, tym_;
+        };
+
+        math::Vector2D origin_;
+        Real_t length_;
+        size_t size_;
+
+        std::vector<Node> nodes_;
+        std::vector<Point> points_;
+        int32_t free_nodes_;
+        int32_t free_points_;
+
+        void Reset() {
+            nodes_.clear();
+            points_.clear();
+            free_nodes_ = NONE;
+            free_points_ = NONE;
+            size_ = 0;
+
+            Node root;
+            root.origin_x_ = origin_[0];
+            root.origin_y_ = origin_[1];
+            root.length_ = length_;
+            root.children_ = NONE;
+            root.points_ = NONE;
+            root.count_ = 0;
+            nodes_.push_back(root);
+        }
+
+        /**
+            Find the child of an inner node, in which a point belongs
+            @param n The node
+            @param point The point
+            @return The index of the child, [0, 3]
+        */
+        static int32_t FindChild(const Node& n, math::Vector2D& point) {
+            Real_t H = n.length_ / 2.0f;
+            int32_t index = 0;
+            if (point[0] >= n.origin_x_ + H) index += 2;
+            if (point[1] >= n.origin_y_ + H) index += 1;
+            return index;
+        }
+
+        int32_t AllocatePoint(math::Vector2D& point, Data& data) {
+            int32_t index;
+            if (free_points_ != NONE) {
+                index = free_points_;
+                free_points_ = points_[index].next_;
+            } else {
+                index = static_cast<int32_t>(points_.size());
+                points_.push_back(Point());
+            }
+            points_[index].point_ = point;
+            points_[index].data_ = data;
+            points_[index].next_ = NONE;
+            size_++;
+            return index;
+        }
+
+        void FreePoint(int32_t index) {
+            points_[index].next_ = free_points_;
+            free_points_ = index;
+            size_--;
+        }
+
+        void LinkPoint(int32_t node, int32_t index) {
+            Node& n = nodes_[node];
+            points_[index].next_ = n.points_;
+            n.points_ = index;
+            n.count_++;
+        }
+
+        /**
+            Get a block of four nodes, from the free list, or at the end of the arena
+            @return The index of the first node
+        */
+        int32_t AllocateBlock() {
+            if (free_nodes_ != NONE) {
+                int32_t block = free_nodes_;
+                free_nodes_ = nodes_[block].children_;
+                return block;
+            }
+
+            int32_t block = static_cast<int32_t>(nodes_.size());
+            nodes_.resize(nodes_.size() + 4);
+            return block;
+        }
+
+        void FreeBlock(int32_t block) {
+            nodes_[block].children_ = free_nodes_;
+            free_nodes_ = block;
+        }
+
+        /**
+            Turn a leaf into an inner node, and move its points to the four new children
+            @param node The leaf
+        */
+        void Split(int32_t node) {
+            int32_t block = AllocateBlock();
+
+            /* Careful, the arena might have been resized */
+            Node& n = nodes_[node];
+            Real_t H = n.length_ / 2.0f;
+            for (int32_t i = 0; i < 4; i++) {
+                Node& child = nodes_[block + i];
+                child.origin_x_ = n.origin_x_ + ((i & 2) ? H : 0);
+                child.origin_y_ = n.origin_y_ + ((i & 1) ? H : 0);
+                child.length_ = H;
+                child.children_ = NONE;
+                child.points_ = NONE;
+                child.count_ = 0;
+            }
+
+            int32_t point = n.points_;
+            n.children_ = block;
+            n.points_ = NONE;
+            n.count_ = 0;
+            while (point != NONE) {
+                int32_t next = points_[point].next_;
+                LinkPoint(block + FindChild(nodes_[node], points_[point].point_), point);
+                point = next;
+            }
+        }
+
+        /**
+            If all the children of an inner node are leaves, and they hold at most COLLAPSE_SIZE points,
+            turn the node into a leaf
+            @param node The inner node
+            @return true = Collapsed, false = Not collapsed
+        */
+        bool Collapse(int32_t node) {
+            int32_t block = nodes_[node].children_;
+            int32_t total = 0;
+            for (int32_t i = 0; i < 4; i++) {
+                if (nodes_[block + i].children_ != NONE) return false;
+                total += nodes_[block + i].count_;
+            }
+            if (total > COLLAPSE_SIZE) return false;
+
+            Node& n = nodes_[node];
+            n.children_ = NONE;
+            n.points_ = NONE;
+            n.count_ = 0;
+            for (int32_t i = 0; i < 4; i++) {
+                int32_t point = nodes_[block + i].points_;
+                while (point != NONE) {
+                    int32_t next = points_[point].next_;
+                    LinkPoint(node, point);
+                    point = next;
+                }
+            }
+            FreeBlock(block);
+            return true;
+        }
+
+        /**
+            Store a point in the subtree of a node, splitting the leaves that become full
+            @param node The root of the subtree
+            @param depth The depth of that node
+            @param index The point
+        */
+        void InsertPoint(int32_t node, size_t depth, int32_t index) {
+            for (;;) {
+                Node& n = nodes_[node];
+                if (n.children_ != NONE) {
+                    node = n.children_ + FindChild(n, points_[index].point_);
+                    depth++;
+                    continue;
+                }
+
+                /* If this leaf has enough space or maximum depth reached, store here */
+                if (n.count_ < BUCKET_SIZE || depth >= MAX_DEPTH) {
+                    LinkPoint(node, index);
+                    return;
+                }
+
+                /* Other-wise split the leaf, and continue with the new inner node */
+                Split(node);
+            }
+        }
+
+        /**
+            Find the path from the root to the leaf where a point belongs
+            @param point The point
+            @param[out] path The nodes in the path, path[i] is at depth i
+            @return The number of nodes in the path
+        */
+        size_t FindPath(math::Vector2D& point, int32_t * path) {
+            size_t path_size = 0;
+            int32_t node = 0;
+            path[path_size++] = node;
+            while (nodes_[node].children_ != NONE) {
+                node = nodes_[node].children_ + FindChild(nodes_[node], point);
+                path[path_size++] = node;
+            }
+            return path_size;
+        }
+
+        /**
+            Find a point in a leaf
+            @param leaf The leaf
+            @param point The position of the point
+            @param data The data to match, nullptr = match any data
+            @param[out] previous The point before the one found in the leaf list, NONE if it's the first
+            @return The point, NONE if not found
+        */
+        int32_t FindPoint(int32_t leaf, math::Vector2D& point, Data * data, int32_t& previous) {
+            previous = NONE;
+            int32_t current = nodes_[leaf].points_;
+            while (current != NONE) {
+                Point& p = points_[current];
+                if (p.point_ == point && (data == nullptr || p.data_ == *data)) return current;
+                previous = current;
+                current = p.next_;
+            }
+            return NONE;
+        }
+
+        void UnlinkPoint(int32_t leaf, int32_t index, int32_t previous) {
+            if (previous == NONE) nodes_[leaf].points_ = points_[index].next_;
+            else points_[previous].next_ = points_[index].next_;
+            nodes_[leaf].count_--;
+        }
+
+        /**
+            Remove a point, and collapse the nodes in its path that became small enough
+            @param point The position of the point
+            @param data The data to match, nullptr = match any data
+        */
+        void RemovePoint(math::Vector2D& point, Data * data) {
+            int32_t path[MAX_DEPTH + 2];
+            size_t path_size = FindPath(point, path);
+            int32_t leaf = path[path_size - 1];
+
+            int32_t previous;
+            int32_t current = FindPoint(leaf, point, data, previous);
+            if (current == NONE) return;
+
+            UnlinkPoint(leaf, current, previous);
+            FreePoint(current);
+
+            /* Collapse bottom up, stop at the first node that can't be collapsed */
+            for (size_t i = path_size - 1; i-- > 0;) {
+                if (!Collapse(path[i])) break;
+            }
+        }
+
+        /**
+            Visit all points inside the search area
+            @param search_box The searching area
+            @param visitor Called for every point found
+        */
+        template<typename Visitor> void QueryRangeVisit(math::AABox<2>& search_box, Visitor visitor) {
+            Real_t min_x = search_box.min_[0];
+            Real_t min_y = search_box.min_[1];
+            Real_t max_x = search_box.max_[0];
+            Real_t max_y = search_box.max_[1];
+
+            int32_t stack[STACK_SIZE];
+            size_t stack_size = 0;
+            stack[stack_size++] = 0;
+            while (stack_size > 0) {
+                const Node& n = nodes_[stack[--stack_size]];
+
+                /* Skip nodes that don't overlap with the search area */
+                if (n.origin_x_ > max_x || n.origin_x_ + n.length_ < min_x || n.origin_y_ > max_y || n.origin_y_ + n.length_ < min_y) continue;
+
+                if (n.children_ != NONE) {
+                    for (int32_t i = 0; i < 4; i++) {
+                        if (nodes_[n.children_ + i].children_ != NONE || nodes_[n.children_ + i].count_ > 0) stack[stack_size++] = n.children_ + i;
+                    }
+                    continue;
+                }
+
+                for (int32_t point = n.points_; point != NONE; point = points_[point].next_) {
+                    const Point& p = points_[point];
+                    if (min_x <= p.point_[0] && p.point_[0] <= max_x && min_y <= p.point_[1] && p.point_[1] <= max_y) visitor(p.data_);
+                }
+            }
+        }
+
+        /**
+            Visit a node during the ray traversal. Leaves are reported immediately, inner nodes are pushed in the stack
+            @return false = The ray exits before this node
+        */
+        template<typename Allocator> bool RayCastVisit(int32_t node, Real_t tx0, Real_t ty0, Real_t tx1, Real_t ty1, RayFrame * stack, size_t& stack_size, std::vector<Data, Allocator>& results) {
+            if (tx1 < 0 || ty1 < 0) return false;
+
+            const Node& n = nodes_[node];
+            if (n.children_ == NONE) {
+                /* If ray casting hit a leaf, add all the points to the results */
+                for (int32_t point = n.points_; point != NONE; point = points_[point].next_)
+                    results.push_back(points_[point].data_);
+                return true;
+            }
+
+            RayFrame& f = stack[stack_size++];
+            f.children_ = n.children_;
+            f.tx0_ = tx0;
+            f.ty0_ = ty0;
+            f.tx1_ = tx1;
+            f.ty1_ = ty1;
+            /* Calculate the middle of the entry and exit point, and the first node to be visited */
+            f.txm_ = Real_t(0.5)*(tx0 + tx1);
+            f.tym_ = Real_t(0.5)*(ty0 + ty1);
+            f.current_ = RayCastFirstNode(tx0, ty0, f.txm_, f.tym_);
+            return true;
+        }
+
+        static int RayCastFirstNode(Real_t tx0, Real_t ty0, Real_t txm, Real_t tym) {
+            unsigned char answer = 0;
+
+            if (tx0 > ty0) {
+                if (tym < tx0) answer |= 1;
+            }
+            else {
+                if (txm < ty0) answer |= 2;
+            }
+
+            return (int)answer;
+        }
+
+        static int RayCastNewNode(Real_t txm, int x, Real_t tym, int y) {
+            if (txm < tym) {
+                return x;
+            }
+            return y;
+        }
+    };
+
+}
+}
+
+#endif
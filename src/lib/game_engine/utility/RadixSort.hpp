@@ -0,0 +1,62 @@
+#ifndef __RadixSort_hpp__
+#define __RadixSort_hpp__
+
+#include <cstdint>
+#include <vector>
+#include <utility>
+
+namespace game_engine {
+namespace utility {
+
+    /**
+        A 64 bit sort key, and the index of the item it belongs to
+    */
+    struct SortKey_t {
+        uint64_t key_;
+        uint32_t index_;
+    };
+
+    /**
+        Sort keys in ascending order, with a least significant digit radix sort of 8 bits per pass. The sort is stable.
+        Passes where all the keys have the same byte are skipped, so keys that use only some of their bits cost less
+        @param keys The keys to sort
+        @param scratch Temporary storage, resized to the number of keys. Keep it between calls to avoid allocations
+    */
+    inline void RadixSort(std::vector<SortKey_t>& keys, std::vector<SortKey_t>& scratch) {
+        size_t n = keys.size();
+        if (n < 2) return;
+        scratch.resize(n);
+
+        /* Count the bytes of all the passes with a single read of the keys */
+        size_t counts[8][256] = {};
+        for (size_t i = 0; i < n; i++) {
+            uint64_t key = keys[i].key_;
+            for (size_t pass = 0; pass < 8; pass++) counts[pass][(key >> (8 * pass)) & 0xFF]++;
+        }
+
+        SortKey_t * source = keys.data();
+        SortKey_t * destination = scratch.data();
+        for (size_t pass = 0; pass < 8; pass++) {
+            size_t * count = counts[pass];
+            size_t shift = 8 * pass;
+            if (count[(source[0].key_ >> shift) & 0xFF] == n) continue;
+
+            /* Counts to offsets */
+            size_t offset = 0;
+            for (size_t b = 0; b < 256; b++) {
+                size_t c = count[b];
+                count[b] = offset;
+                offset += c;
+            }
+
+            for (size_t i = 0; i < n; i++) destination[count[(source[i].key_ >> shift) & 0xFF]++] = source[i];
+            std::swap(source, destination);
+        }
+
+        if (source != keys.data()) keys.swap(scratch);
+    }
+
+}
+}
+
+#endif
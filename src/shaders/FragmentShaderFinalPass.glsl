@@ -59,12 +59,24 @@ uniform float shadow_cascades[4];
 uniform bool use_shadows;
 uniform bool show_cascades;
 
-/* Lights info */
-#define NR_POINT_LIGHTS 36
-uniform PointLight point_light[NR_POINT_LIGHTS];
-uniform uint number_of_point_lights;
-uniform DirectionalLight directional_light;
-uniform CastingLight cast_light;
+/* Lights info, a std140 block written once per frame from LightsBlock_t */
+#define NR_POINT_LIGHTS 128
+layout(std140) uniform Lights {
+    PointLight point_light[NR_POINT_LIGHTS];
+    DirectionalLight directional_light;
+    CastingLight cast_light;
+    uint number_of_point_lights;
+};
+
+/* Light clusters, screen tiles times exponential depth slices. Each cluster is an offset and a count in the light indices */
+uniform usamplerBuffer light_clusters;
+uniform usamplerBuffer light_cluster_indices;
+/* Number of tiles in x and y, and of slices */
+uniform uvec3 light_clusters_size;
+/* Number of tiles per unit of uv */
+uniform vec2 light_clusters_tile_scale;
+/* The slice of a depth is log(depth) * x + y */
+uniform vec2 light_clusters_slice;
 
 
 vec3 CalculateDirectionalLight(DirectionalLight light, vec3 fragment_normal, vec3 view_direction, vec3 fragment_color, float fragment_specular_intensity, float ambient_factor);
@@ -75,6 +87,14 @@ vec3 TransformToViewSpace(vec4 vector){
 	return (matrix_view * vector).xyz;
 }
 
+/* Get the cluster of the fragment, from its screen position and its view space depth */
+int GetLightCluster(vec3 fragment_position_viewspace) {
+    uvec2 tile = min(uvec2(uv * light_clusters_tile_scale), light_clusters_size.xy - 1u);
+    float slice_float = log(max(-fragment_position_viewspace.z, 1e-6)) * light_clusters_slice.x + light_clusters_slice.y;
+    uint slice = min(uint(max(slice_float, 0.0)), light_clusters_size.z - 1u);
+    return int(tile.x + light_clusters_size.x * (tile.y + light_clusters_size.y * slice));
+}
+
 float fragment_in_shadow;
 
 /* Sample shadow map at position, perform PCF */
@@ -159,11 +179,12 @@ void main() {
 	/* Calculate directional light color contribution */
 	vec3 directional_light_color = CalculateDirectionalLight(directional_light, normal_viewspace, view_direction, fragment_color, fragment_specular_intensity, ambient_factor);
 	
-	/* Calculate point lights color contribution */
+	/* Calculate point lights color contribution, only the lights of the cluster reach the fragment */
 	vec3 point_lights_color = vec3(0, 0, 0);
-	for(uint i = 0u; i < NR_POINT_LIGHTS; i++){
-        if (i < number_of_point_lights) 
-            point_lights_color += CalculatePointLight(point_light[i], fragment_position_viewspace, normal_viewspace, view_direction, fragment_color, fragment_specular_intensity, ambient_factor);
+	uvec2 cluster = texelFetch(light_clusters, GetLightCluster(fragment_position_viewspace)).xy;
+	for(uint i = 0u; i < cluster.y; i++){
+        uint light_index = texelFetch(light_cluster_indices, int(cluster.x + i)).r;
+        point_lights_color += CalculatePointLight(point_light[light_index], fragment_position_viewspace, normal_viewspace, view_direction, fragment_color, fragment_specular_intensity, ambient_factor);
     }
 		
 	/* Calculate casting light color contribution */
@@ -12,6 +12,18 @@ struct Material {
     float shininess;
 };
 
+struct PointLight {
+	vec3 position;
+	
+	vec3 ambient;
+	vec3 diffuse;
+	vec3 specular;
+	
+	float constant;
+	float linear;
+	float quadratic;
+};
+
 struct DirectionalLight {
 	vec3 direction;
 	
@@ -20,6 +32,21 @@ struct DirectionalLight {
 	vec3 specular;
 };
 
+struct CastingLight {
+    vec3 position;  
+    vec3 direction;
+    float inner_radius_cosine;
+    float outer_radius_cosine;
+	
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+	
+    float constant;
+    float linear;
+    float quadratic;
+};
+
 in VS_OUT {
     vec2 uv;
     vec3 normal_viewspace;
@@ -28,7 +55,16 @@ in VS_OUT {
 
 uniform Material object_material;
 uniform mat4 matrix_view;
-uniform DirectionalLight directional_light;
+
+/* Lights, the same block as in the final pass shader, only the directional light is used */
+#define NR_POINT_LIGHTS 128
+layout(std140) uniform Lights {
+    PointLight point_light[NR_POINT_LIGHTS];
+    DirectionalLight directional_light;
+    CastingLight cast_light;
+    uint number_of_point_lights;
+};
+
 
 vec3 TransformToViewSpace(vec4 vector){
 	return (matrix_view * vector).xyz;
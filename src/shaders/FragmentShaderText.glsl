@@ -1,12 +1,12 @@
 #version 330 core
 in vec2 texture_coordinates;
+in vec3 text_color;
 out vec4 color;
 
 uniform sampler2D sampler_texture;
-uniform vec3 texture_color;
 
 void main()
 {    
     vec4 sampled = vec4(1.0, 1.0, 1.0, texture(sampler_texture, texture_coordinates).r);
-    color = vec4(texture_color, 1.0) * sampled;
+    color = vec4(text_color, 1.0) * sampled;
 } 
\ No newline at end of file
@@ -0,0 +1,17 @@
+#version 330 core
+
+/* Input vertex attributes */
+layout(location = 0) in vec3 vertex_position_worldspace;
+layout(location = 1) in vec3 vertex_color;
+
+out vec3 color;
+
+/* Values that stay constant */
+uniform mat4 matrix_view;
+uniform mat4 matrix_projection;
+
+void main(){
+
+    color = vertex_color;
+    gl_Position = matrix_projection * matrix_view * vec4(vertex_position_worldspace, 1);
+}
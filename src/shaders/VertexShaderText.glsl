@@ -1,6 +1,8 @@
 #version 330 core
 layout (location = 0) in vec4 vertex; // <vec2 pos, vec2 tex>
+layout (location = 1) in vec3 vertex_color;
 out vec2 texture_coordinates;
+out vec3 text_color;
 
 uniform mat4 matrix_projection;
 
@@ -8,4 +10,5 @@ void main()
 {
     gl_Position = matrix_projection * vec4(vertex.xy, 0.0, 1.0);
     texture_coordinates = vertex.zw;
+    text_color = vertex_color;
 }  
\ No newline at end of file